@@ -27,6 +27,10 @@
 
 #include <vle/manager/Manager.hpp>
 #include <vle/manager/ExperimentGenerator.hpp>
+#include <vle/manager/CombinationSource.hpp>
+#include <vle/manager/ResultSink.hpp>
+#include <vle/value/Binary.hpp>
+#include <vle/value/Map.hpp>
 #include <vle/utils/Tools.hpp>
 #include <vle/utils/Path.hpp>
 #include <vle/utils/Package.hpp>
@@ -37,6 +41,8 @@
 #include <cstdio>
 #include <cstdarg>
 #include <cstring>
+#include <cstdlib>
+#include <boost/thread/mutex.hpp>
 
 #define OMPI_SKIP_MPICXX
 #include <mpi.h>
@@ -53,6 +59,10 @@ void mvle_show_help()
             "\n"
             "Application options:\n"
             "  -s --show         Show the plan\n"
+            "  -m --master       Rank 0 distributes the combinations on\n"
+            "                    demand and writes the results\n"
+            "  -t --threads      Number of threads of each worker rank\n"
+            "  -o --output       Columnar result file of the master mode\n"
             "  -P --package      Start VLE in package mode\n"
             "  -v --version      Show the version\n"));
 }
@@ -123,10 +133,18 @@ bool mvle_mpi_init(int *argc, char ***argv, uint32_t *rank, uint32_t *world)
 {
     int t_rank;
     int t_world;
+    int provided;
     int r;
     bool result = false;
 
-    if ((r = MPI_Init(argc, argv)) == MPI_SUCCESS) {
+    /* The threads of a worker rank communicate with the master one at a
+     * time. */
+    if ((r = MPI_Init_thread(argc, argv, MPI_THREAD_SERIALIZED, &provided))
+        == MPI_SUCCESS) {
+        if (provided < MPI_THREAD_SERIALIZED) {
+            mvle_print_debug(_("MPI does not support threads"));
+        }
+
         if ((r = MPI_Comm_rank(MPI_COMM_WORLD, &t_rank)) == MPI_SUCCESS) {
             /* check the cast of the MPI's rank */
             if (t_rank < 0 or static_cast < unsigned int >(t_rank) >
@@ -157,7 +175,28 @@ bool mvle_mpi_init(int *argc, char ***argv, uint32_t *rank, uint32_t *world)
     return result;
 }
 
-bool mvle_parse_arg(int argc, char **argv, int *vpz, bool *show,
+bool mvle_mpi_threads()
+{
+    int provided;
+
+    return MPI_Query_thread(&provided) == MPI_SUCCESS and
+        provided >= MPI_THREAD_SERIALIZED;
+}
+
+struct mvle_options
+{
+    mvle_options()
+        : show(false), master(false), threads(1)
+    {
+    }
+
+    bool        show;
+    bool        master;
+    uint32_t    threads;
+    std::string output;
+};
+
+bool mvle_parse_arg(int argc, char **argv, int *vpz, mvle_options *options,
         vle::utils::Package& pack)
 {
     int i = 1;
@@ -176,7 +215,24 @@ bool mvle_parse_arg(int argc, char **argv, int *vpz, bool *show,
             return false;
         } else if (std::strcmp(argv[i], "-s") == 0 or
                    std::strcmp(argv[i], "--show") == 0) {
-            *show = true;
+            options->show = true;
+        } else if (std::strcmp(argv[i], "-m") == 0 or
+                   std::strcmp(argv[i], "--master") == 0) {
+            options->master = true;
+        } else if ((std::strcmp(argv[i], "-t") == 0 or
+                    std::strcmp(argv[i], "--threads") == 0) and
+                   i + 1 < argc) {
+            int threads = std::atoi(argv[++i]);
+
+            if (threads < 1) {
+                mvle_print_error(_("bad number of threads: %s"), argv[i]);
+                return false;
+            }
+            options->threads = static_cast < uint32_t >(threads);
+        } else if ((std::strcmp(argv[i], "-o") == 0 or
+                    std::strcmp(argv[i], "--output") == 0) and
+                   i + 1 < argc) {
+            options->output = argv[++i];
         } else {
             *vpz = i;
         }
@@ -208,7 +264,7 @@ void mvle_show(const std::string& vpz)
 
         mvle_print("\n");
 
-        for (uint32_t i = expgen.min(); i < expgen.max(); ++i) {
+        for (uint32_t i = expgen.min(); i <= expgen.max(); ++i) {
             expgen.get(i, &conds);
 
             mvle_print("%d;", i);
@@ -226,11 +282,283 @@ void mvle_show(const std::string& vpz)
     }
 }
 
+/*
+ * Master/worker mode: the workers ask rank 0 for chunks of combinations
+ * (MVLE_TAG_REQUEST), rank 0 answers with a [first, end) range
+ * (MVLE_TAG_CHUNK), empty when the experimental frame is exhausted. The
+ * workers send back each result serialized with the value::BinaryWriter
+ * (MVLE_TAG_RESULT) and a MVLE_TAG_END message when their manager ends.
+ */
+
+enum mvle_tag
+{
+    MVLE_TAG_REQUEST = 1,
+    MVLE_TAG_CHUNK,
+    MVLE_TAG_RESULT,
+    MVLE_TAG_END
+};
+
+/*
+ * Take the chunks of combinations from the master. The mutex is shared
+ * with the mvle_sink: only one thread calls MPI at a time.
+ */
+class mvle_source : public vle::manager::CombinationSource
+{
+public:
+    mvle_source(boost::mutex& mutex)
+        : m_mutex(mutex), m_finished(false)
+    {
+    }
+
+    virtual bool take(uint32_t *first, uint32_t *end)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        if (m_finished) {
+            return false;
+        }
+
+        unsigned int range[2];
+
+        MPI_Send(NULL, 0, MPI_BYTE, 0, MVLE_TAG_REQUEST, MPI_COMM_WORLD);
+        MPI_Recv(range, 2, MPI_UNSIGNED, 0, MVLE_TAG_CHUNK, MPI_COMM_WORLD,
+                 MPI_STATUS_IGNORE);
+
+        if (range[0] >= range[1]) {
+            m_finished = true;
+            return false;
+        }
+
+        *first = range[0];
+        *end = range[1];
+
+        return true;
+    }
+
+private:
+    boost::mutex& m_mutex;
+    bool          m_finished;
+};
+
+/*
+ * Send the results to the master. The serialization is done outside the
+ * lock.
+ */
+class mvle_sink : public vle::manager::ResultSink
+{
+public:
+    mvle_sink(boost::mutex& mutex)
+        : m_mutex(mutex)
+    {
+    }
+
+    virtual void write(uint32_t index, vle::value::Map *result)
+    {
+        std::string buffer;
+        vle::value::BinaryWriter out(buffer);
+
+        out.writeUint32(index);
+        out.writeBoolean(result != 0);
+        if (result) {
+            out.write(result);
+            delete result;
+        }
+
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        MPI_Send(const_cast < char* >(buffer.data()), buffer.size(),
+                 MPI_BYTE, 0, MVLE_TAG_RESULT, MPI_COMM_WORLD);
+    }
+
+private:
+    boost::mutex& m_mutex;
+};
+
+std::string mvle_output(const std::string& vpz, const mvle_options& options)
+{
+    if (not options.output.empty()) {
+        return options.output;
+    }
+
+    return vle::utils::Path::basename(vpz) + ".vlecol";
+}
+
+/*
+ * The rank 0 of the master/worker mode: distribute the combinations and
+ * write the results until all the workers end. If the experimental frame
+ * or the output file fails, the workers are still answered: they receive
+ * empty chunks and their results are dropped until they all end.
+ */
+bool mvle_master(const std::string& vpz, const std::string& output,
+                 uint32_t world, uint32_t threads)
+{
+    vle::manager::GuidedSource *source = 0;
+    vle::manager::ColumnarSink *sink = 0;
+    std::string failure;
+    std::vector < char > buffer;
+    uint32_t running = world - 1;
+    uint32_t received = 0;
+    uint32_t runs = 0;
+
+    try {
+        vle::manager::ExperimentGenerator expgen(vpz, 0, 1);
+        runs = std::max(expgen.size(), 1u) * expgen.replicas();
+        source = new vle::manager::GuidedSource(0, runs - 1,
+                                                (world - 1) * threads);
+        sink = new vle::manager::ColumnarSink(output);
+    } catch (const std::exception& e) {
+        failure = e.what();
+    }
+
+    while (running > 0) {
+        MPI_Status status;
+        int count;
+
+        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        MPI_Get_count(&status, MPI_BYTE, &count);
+
+        buffer.resize(std::max(count, 1));
+        MPI_Recv(&buffer[0], count, MPI_BYTE, status.MPI_SOURCE,
+                 status.MPI_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+        switch (status.MPI_TAG) {
+        case MVLE_TAG_REQUEST: {
+            uint32_t first, end;
+            unsigned int range[2] = { 0, 0 };
+
+            if (failure.empty() and source->take(&first, &end)) {
+                range[0] = first;
+                range[1] = end;
+            }
+
+            MPI_Send(range, 2, MPI_UNSIGNED, status.MPI_SOURCE,
+                     MVLE_TAG_CHUNK, MPI_COMM_WORLD);
+            break;
+        }
+        case MVLE_TAG_RESULT: {
+            if (not failure.empty()) {
+                break;
+            }
+
+            vle::value::Value *result = 0;
+
+            try {
+                vle::value::BinaryReader in(&buffer[0], count);
+                uint32_t index = in.readUint32();
+
+                if (in.readBoolean()) {
+                    result = in.read();
+                }
+
+                if (result and not result->isMap()) {
+                    delete result;
+                    result = 0;
+                }
+
+                sink->write(index, static_cast < vle::value::Map* >(result));
+                received++;
+            } catch (const std::exception& e) {
+                failure = e.what();
+            }
+            break;
+        }
+        case MVLE_TAG_END:
+            running--;
+            break;
+        default:
+            mvle_print_error(_("unknown message %d from rank %d"),
+                             status.MPI_TAG, status.MPI_SOURCE);
+        }
+    }
+
+    if (failure.empty()) {
+        try {
+            sink->close();
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+    }
+
+    delete sink;
+    delete source;
+
+    if (not failure.empty()) {
+        mvle_print_error(_("%s: %s"), vpz.c_str(), failure.c_str());
+        return false;
+    }
+
+    mvle_print(_("%s: %u/%u results written to %s\n"), vpz.c_str(),
+               received, runs, output.c_str());
+
+    return received == runs;
+}
+
+/*
+ * The other ranks of the master/worker mode: run the combinations taken
+ * from the master with several threads.
+ */
+bool mvle_worker(const std::string& vpz,
+                 vle::utils::ModuleManager& modules,
+                 vle::manager::Manager& man,
+                 uint32_t threads)
+{
+    boost::mutex mutex;
+    mvle_source source(mutex);
+    mvle_sink sink(mutex);
+    vle::manager::Error error;
+
+    try {
+        man.run(new vle::vpz::Vpz(vpz), modules, threads, &source, &sink,
+                &error);
+    } catch (const std::exception& e) {
+        error.code = -1;
+        error.message = e.what();
+    }
+
+    /* The master waits the end of all the workers, even on failure. */
+    MPI_Send(NULL, 0, MPI_BYTE, 0, MVLE_TAG_END, MPI_COMM_WORLD);
+
+    if (error.code) {
+        mvle_print_error("Experimental frames `%s' throws error %s",
+                         vpz.c_str(), error.message.c_str());
+    }
+
+    return not error.code;
+}
+
+/*
+ * The master/worker mode without worker: the combinations are run by the
+ * threads of rank 0.
+ */
+bool mvle_alone(const std::string& vpz,
+                const std::string& output,
+                vle::utils::ModuleManager& modules,
+                vle::manager::Manager& man,
+                uint32_t threads)
+{
+    vle::manager::ExperimentGenerator expgen(vpz, 0, 1);
+    vle::manager::GuidedSource source(
+        0, std::max(expgen.size(), 1u) * expgen.replicas() - 1, threads);
+    vle::manager::ColumnarSink sink(output);
+    vle::manager::Error error;
+
+    man.run(new vle::vpz::Vpz(vpz), modules, threads, &source, &sink,
+            &error);
+    sink.close();
+
+    if (error.code) {
+        mvle_print_error("Experimental frames `%s' throws error %s",
+                         vpz.c_str(), error.message.c_str());
+    }
+
+    return not error.code;
+}
+
 int main(int argc, char **argv)
 {
     uint32_t rank = 0;
     uint32_t world = 0;
-    bool show = false;
+    mvle_options options;
     bool result;
 
     vle::Init app;
@@ -238,13 +566,51 @@ int main(int argc, char **argv)
     if ((result = mvle_mpi_init(&argc, &argv, &rank, &world))) {
         int vpz;
         vle::utils::Package pack;
-        if ((result = mvle_parse_arg(argc, argv, &vpz, &show, pack))) {
-            if (show) {
+        if ((result = mvle_parse_arg(argc, argv, &vpz, &options, pack))) {
+            if (options.threads > 1 and not mvle_mpi_threads()) {
+                options.threads = 1;
+            }
+
+            if (options.show) {
                 while (vpz < argc) {
                     mvle_show(
                         pack.getExpFile(argv[vpz], vle::utils::PKG_BINARY));
                     vpz++;
                 }
+            } else if (options.master) {
+                try {
+                    vle::manager::Manager man(vle::manager::LOG_NONE,
+                                              vle::manager::SIMULATION_NONE,
+                                              &std::cout);
+                    vle::utils::ModuleManager modules;
+
+                    mvle_print("MPI node %d/%d start\n", rank, world);
+
+                    while (vpz < argc) {
+                        std::string file = pack.getExpFile(
+                            argv[vpz], vle::utils::PKG_BINARY);
+
+                        if (world == 1) {
+                            result = mvle_alone(
+                                file, mvle_output(file, options), modules,
+                                man, options.threads) and result;
+                        } else if (rank == 0) {
+                            result = mvle_master(
+                                file, mvle_output(file, options), world,
+                                options.threads) and result;
+                        } else {
+                            result = mvle_worker(file, modules, man,
+                                                 options.threads) and result;
+                        }
+
+                        vpz++;
+                    }
+
+                    mvle_print("MPI node %d/%d end\n", rank, world);
+                } catch (const std::exception& e) {
+                    mvle_print_error("manager problem: %s", e.what());
+                    result = false;
+                }
             } else {
                 try {
                     vle::manager::Manager man(vle::manager::LOG_SUMMARY,
@@ -261,7 +627,7 @@ int main(int argc, char **argv)
                             new vle::vpz::Vpz(pack.getExpFile(argv[vpz],
                                     vle::utils::PKG_BINARY)),
                             modules,
-                            1,
+                            options.threads,
                             rank,
                             world,
                             &error);
@@ -27,18 +27,27 @@
 
 #include <vle/manager/Manager.hpp>
 #include <vle/manager/Simulation.hpp>
+#include <vle/manager/details/ProcessPool.hpp>
+#include <vle/vpz/Vpz.hpp>
+#include <vle/vpz/Compiled.hpp>
 #include <vle/utils/Tools.hpp>
 #include <vle/utils/Trace.hpp>
+#include <vle/utils/Profile.hpp>
 #include <vle/utils/Path.hpp>
 #include <vle/utils/Package.hpp>
 #include <vle/utils/Preferences.hpp>
 #include <vle/utils/RemoteManager.hpp>
 #include <vle/utils/i18n.hpp>
+#include <vle/value/Map.hpp>
 #include <vle/vle.hpp>
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <boost/program_options.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 
 #ifndef NDEBUG
 # include <vle/devs/ExternalEvent.hpp>
@@ -237,20 +246,59 @@ static vle::manager::LogOptions convert_log_mode()
     }
 }
 
+/*
+ * The profile of the simulations filled when the --timing option is used,
+ * null otherwise.
+ */
+static vle::utils::Profile *timing_profile = 0;
+
+/*
+ * The simulation options of the manager and simulation modes.
+ */
+static vle::manager::SimulationOptions simulation_options =
+    vle::manager::SIMULATION_NONE | vle::manager::SIMULATION_NO_RETURN;
+
+/*
+ * The number of threads used to build the thread safe dynamics of the
+ * simulations.
+ */
+static uint32_t init_threads = 1;
+
+static vle::vpz::Vpz* parse_vpz(const std::string &filename)
+{
+    vle::utils::ProfileScope scope(timing_profile, "parse");
+
+    return new vle::vpz::Vpz(filename);
+}
+
+static vle::vpz::Vpz* read_vpz(const std::string &param,
+        vle::utils::Package& pkg)
+{
+    return parse_vpz(search_vpz(param, pkg));
+}
+
+static void show_timing()
+{
+    if (timing_profile) {
+        std::cout << _("Timing:\n");
+        timing_profile->write(std::cout);
+    }
+}
+
 static int run_manager(CmdArgs::const_iterator it, CmdArgs::const_iterator end,
         int processor, vle::utils::Package& pkg)
 {
-    vle::manager::Manager man(convert_log_mode(),
-                              vle::manager::SIMULATION_NONE |
-                              vle::manager::SIMULATION_NO_RETURN,
+    vle::manager::Manager man(convert_log_mode(), simulation_options,
                               &std::cout);
     vle::utils::ModuleManager modules;
     int success = EXIT_SUCCESS;
 
+    man.setProfile(timing_profile);
+    man.setInitThreads(init_threads);
+
     for (; it != end; ++it) {
         vle::manager::Error error;
-        vle::value::Matrix *res = man.run(new vle::vpz::Vpz(
-                                               search_vpz(*it, pkg)),
+        vle::value::Matrix *res = man.run(read_vpz(*it, pkg),
                 modules,
                 processor,
                 0,
@@ -267,22 +315,25 @@ static int run_manager(CmdArgs::const_iterator it, CmdArgs::const_iterator end,
         delete res;
     }
 
+    show_timing();
+
     return success;
 }
 
 static int run_simulation(CmdArgs::const_iterator it,
         CmdArgs::const_iterator end, vle::utils::Package& pkg)
 {
-    vle::manager::Simulation sim(convert_log_mode(),
-                                 vle::manager::SIMULATION_NONE |
-                                 vle::manager::SIMULATION_NO_RETURN,
+    vle::manager::Simulation sim(convert_log_mode(), simulation_options,
                                  &std::cout);
     vle::utils::ModuleManager modules;
     int success = EXIT_SUCCESS;
 
+    sim.setProfile(timing_profile);
+    sim.setInitThreads(init_threads);
+
     for (; it != end; ++it) {
         vle::manager::Error error;
-        vle::value::Map *res = sim.run(new vle::vpz::Vpz(search_vpz(*it, pkg)),
+        vle::value::Map *res = sim.run(read_vpz(*it, pkg),
                                        modules,
                                        &error);
 
@@ -296,9 +347,306 @@ static int run_simulation(CmdArgs::const_iterator it,
         delete res;
     }
 
+    show_timing();
+
     return success;
 }
 
+/*
+ * The result of a vpz file run with the jobs option.
+ */
+struct job_result
+{
+    job_result()
+        : wall(0.0), events(0), hasevents(false), success(false)
+    {}
+
+    std::string filename;
+    double      wall;
+    uint64_t    events;
+    bool        hasevents; /* false in manager mode */
+    bool        success;
+};
+
+/*
+ * A thread of the jobs option: it takes the next vpz file of the list,
+ * parses it and runs it until the end of the list. The logs of a file are
+ * written when it ends to not mix the outputs of the threads.
+ */
+struct job
+{
+    const CmdArgs&                  filenames;
+    std::vector < job_result >&     results;
+    std::vector < job_result >::size_type& next;
+    boost::mutex&                   mutex;
+    vle::utils::ModuleManager&      modules;
+    bool                            manager;
+    int                             processor;
+
+    job(const CmdArgs&                          filenames,
+        std::vector < job_result >&             results,
+        std::vector < job_result >::size_type&  next,
+        boost::mutex&                           mutex,
+        vle::utils::ModuleManager&              modules,
+        bool                                    manager,
+        int                                     processor)
+        : filenames(filenames), results(results), next(next), mutex(mutex),
+        modules(modules), manager(manager), processor(processor)
+    {}
+
+    void operator()()
+    {
+        for (;;) {
+            std::vector < job_result >::size_type i;
+
+            {
+                boost::mutex::scoped_lock lock(mutex);
+
+                if (next >= results.size())
+                    return;
+
+                i = next++;
+            }
+
+            std::ostringstream out;
+            vle::manager::Error error;
+            double start = vle::utils::Profile::wallTime();
+
+            try {
+                if (manager)
+                    runManager(filenames[i], out, &error);
+                else
+                    runSimulation(filenames[i], out, results[i], &error);
+            } catch (const std::exception &e) {
+                error.code = -1;
+                error.message = e.what();
+            }
+
+            results[i].filename = filenames[i];
+            results[i].wall = vle::utils::Profile::wallTime() - start;
+            results[i].success = not error.code;
+
+            boost::mutex::scoped_lock lock(mutex);
+
+            std::cout << out.str();
+
+            if (error.code and manager)
+                std::cerr << vle::fmt(_("Experimental frames `%s' throws"
+                                        " error %s")) %
+                    filenames[i] % error.message.c_str();
+            else if (error.code)
+                std::cerr << vle::fmt(_("Simulator `%s' throws error %s")) %
+                    filenames[i] % error.message.c_str();
+        }
+    }
+
+    void runSimulation(const std::string &filename, std::ostream &out,
+                       job_result &result, vle::manager::Error *error)
+    {
+        vle::manager::Simulation sim(convert_log_mode(), simulation_options,
+                                     &out);
+
+        sim.setProfile(timing_profile);
+        sim.setInitThreads(init_threads);
+
+        vle::value::Map *res = sim.run(parse_vpz(filename), modules, error);
+
+        result.events = sim.events();
+        result.hasevents = true;
+
+        delete res;
+    }
+
+    void runManager(const std::string &filename, std::ostream &out,
+                    vle::manager::Error *error)
+    {
+        vle::manager::Manager man(convert_log_mode(), simulation_options,
+                                  &out);
+
+        man.setProfile(timing_profile);
+        man.setInitThreads(init_threads);
+
+        vle::value::Matrix *res = man.run(parse_vpz(filename), modules,
+                                          processor, 0, 1, error);
+
+        delete res;
+    }
+};
+
+/*
+ * The job of the jobs option with the spawn option: the vpz files are
+ * parsed and run by the workers of a process pool, forked before any
+ * thread is started. A worker returns the number of events, the wall time
+ * and the logs of its file.
+ */
+struct spawn_job : vle::manager::ProcessPool::Job,
+                   vle::manager::ProcessPool::Handler
+{
+    const CmdArgs&                  filenames;
+    std::vector < job_result >&     results;
+    vle::utils::ModuleManager&      modules;
+    bool                            manager;
+    int                             processor;
+
+    spawn_job(const CmdArgs&              filenames,
+              std::vector < job_result >& results,
+              vle::utils::ModuleManager&  modules,
+              bool                        manager,
+              int                         processor)
+        : filenames(filenames), results(results), modules(modules),
+        manager(manager), processor(processor)
+    {}
+
+    /*
+     * Run in a worker. The worker is already a subprocess: the simulations
+     * are not spawned again.
+     */
+    virtual vle::value::Map * run(uint32_t index,
+                                  vle::manager::Error *error)
+    {
+        vle::manager::SimulationOptions options = simulation_options &
+            ~vle::manager::SIMULATION_SPAWN_PROCESS;
+        std::ostringstream out;
+        double start = vle::utils::Profile::wallTime();
+
+        vle::value::Map *result = new vle::value::Map();
+
+        try {
+            if (manager) {
+                vle::manager::Manager man(convert_log_mode(), options, &out);
+
+                man.setInitThreads(init_threads);
+                delete man.run(parse_vpz(filenames[index]), modules,
+                               processor, 0, 1, error);
+            } else {
+                vle::manager::Simulation sim(convert_log_mode(), options,
+                                             &out);
+
+                sim.setInitThreads(init_threads);
+                delete sim.run(parse_vpz(filenames[index]), modules, error);
+                result->addDouble("events", sim.events());
+            }
+        } catch (const std::exception &e) {
+            error->code = -1;
+            error->message = e.what();
+        }
+
+        result->addDouble("wall", vle::utils::Profile::wallTime() - start);
+        result->addString("log", out.str());
+
+        return result;
+    }
+
+    /*
+     * Receive the result of a worker in the parent.
+     */
+    virtual void done(uint32_t index, vle::value::Map *result,
+                      const vle::manager::Error &error)
+    {
+        results[index].filename = filenames[index];
+        results[index].success = not error.code;
+
+        if (result) {
+            results[index].wall = result->getDouble("wall");
+            results[index].hasevents = result->exist("events");
+
+            if (results[index].hasevents)
+                results[index].events = static_cast < uint64_t >(
+                    result->getDouble("events"));
+
+            std::cout << result->getString("log");
+            delete result;
+        }
+
+        if (error.code and manager)
+            std::cerr << vle::fmt(_("Experimental frames `%s' throws"
+                                    " error %s")) %
+                filenames[index] % error.message.c_str();
+        else if (error.code)
+            std::cerr << vle::fmt(_("Simulator `%s' throws error %s")) %
+                filenames[index] % error.message.c_str();
+    }
+};
+
+/*
+ * Write the wall time, the number of events and the status of each vpz
+ * file run with the jobs option.
+ */
+static void show_jobs(const std::vector < job_result > &results, int jobs,
+                      double elapsed)
+{
+    std::vector < job_result >::size_type failed = 0;
+
+    std::cout << vle::fmt("\n%-40s %10s %12s %s\n") % _("File") %
+        _("Wall (s)") % _("Events") % _("Status");
+
+    for (std::vector < job_result >::const_iterator it = results.begin();
+         it != results.end(); ++it) {
+        std::string events = it->hasevents ?
+            (vle::fmt("%1%") % it->events).str() : std::string("-");
+
+        std::cout << vle::fmt("%-40s %10.3f %12s %s\n") % it->filename %
+            it->wall % events % (it->success ? _("ok") : _("failed"));
+
+        if (not it->success)
+            failed++;
+    }
+
+    std::cout << vle::fmt(_("%1% file(s), %2% failed, %3% s with %4%"
+                            " job(s)\n")) % results.size() % failed %
+        elapsed % jobs;
+}
+
+/*
+ * Run the vpz files with jobs threads sharing the same module manager.
+ * The vpz files are parsed by the threads: the parser does not change the
+ * global locale and the libxml2 parser is initialized by vle::Init. With
+ * the spawn option, the files are run by a pool of jobs processes instead
+ * of threads: the workers are forked by the main thread.
+ */
+static int run_jobs(CmdArgs::const_iterator it, CmdArgs::const_iterator end,
+                    bool manager, int processor, int jobs,
+                    vle::utils::Package& pkg)
+{
+    CmdArgs filenames;
+
+    for (; it != end; ++it)
+        filenames.push_back(search_vpz(*it, pkg));
+
+    std::vector < job_result > results(filenames.size());
+    std::vector < job_result >::size_type next = 0;
+    vle::utils::ModuleManager modules;
+    double start = vle::utils::Profile::wallTime();
+
+    if (simulation_options & vle::manager::SIMULATION_SPAWN_PROCESS) {
+        spawn_job sj(filenames, results, modules, manager, processor);
+        vle::manager::ProcessPool pool(sj, std::min(
+                static_cast < CmdArgs::size_type >(jobs), filenames.size()));
+
+        pool.run(0, filenames.size() - 1, sj);
+    } else {
+        boost::mutex mutex;
+        boost::thread_group gp;
+
+        for (int i = 0; i < jobs and static_cast < CmdArgs::size_type >(i) <
+                 filenames.size(); ++i)
+            gp.create_thread(job(filenames, results, next, mutex, modules,
+                                 manager, processor));
+
+        gp.join_all();
+    }
+
+    show_jobs(results, jobs, vle::utils::Profile::wallTime() - start);
+    show_timing();
+
+    for (std::vector < job_result >::const_iterator r = results.begin();
+         r != results.end(); ++r)
+        if (not r->success)
+            return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
 static bool init_package(vle::utils::Package& pkg, const CmdArgs &args)
 {
 
@@ -317,7 +665,8 @@ static bool init_package(vle::utils::Package& pkg, const CmdArgs &args)
 }
 
 static int manage_package_mode(const std::string &packagename, bool manager,
-                               int processor, const CmdArgs &args)
+                               int processor, int jobs,
+                               const CmdArgs &args)
 {
     CmdArgs::const_iterator it = args.begin();
     CmdArgs::const_iterator end = args.end();
@@ -388,7 +737,9 @@ static int manage_package_mode(const std::string &packagename, bool manager,
     if (stop)
         ret = EXIT_FAILURE;
     else if (it != end) {
-        if (manager)
+        if (jobs > 1)
+            ret = run_jobs(it, end, manager, processor, jobs, pkg);
+        else if (manager)
             ret = run_manager(it, end, processor, pkg);
         else
             ret = run_simulation(it, end, pkg);
@@ -472,11 +823,11 @@ enum ProgramOptionsCode
 
 struct ProgramOptions
 {
-    ProgramOptions(int *verbose, int *trace, int *processor,
+    ProgramOptions(int *verbose, int *trace, int *processor, int *jobs,
             bool *manager_mode, std::string *packagename,
             std::string *remotecmd, std::string *configvar, CmdArgs *args)
         : generic(_("Allowed options")), hidden(_("Hidden options")),
-        verbose(verbose), trace(trace), processor(processor),
+        verbose(verbose), trace(trace), processor(processor), jobs(jobs),
         manager_mode(manager_mode), packagename(packagename),
         remotecmd(remotecmd), configvar(configvar), args(args)
     {
@@ -493,6 +844,25 @@ struct ProgramOptions
             ("manager,m", _("Use the manager mode to run experimental frames"))
             ("processor,o", po::value < int >(processor)->default_value(1),
              _("Select number of processor in manager mode [>= 0]"))
+            ("jobs,j", po::value < int >(jobs)->default_value(1),
+             _("Select number of vpz files run at the same time in"
+               " package mode, each file is run by a thread or, with the"
+               " spawn option, by a process [> 0]"))
+            ("validate", _("Validate the VPZ files against the DTD while"
+                           " they are read"))
+            ("compiled", _("Read and write the compiled VPZ files (.vpzc)"
+                           " next to the VPZ files"))
+            ("lazy-conditions", _("Parse the values of the conditions of"
+                                  " the VPZ files when they are used"))
+            ("init-threads", po::value < int >()->default_value(1),
+             _("Select number of threads used to build the thread safe"
+               " models at the start of the simulations [> 0]"))
+            ("spawn", _("Run the simulations in subprocesses, in manager"
+                        " mode the processor option is the number of"
+                        " processes"))
+            ("timing", _("Print the wall time, the CPU time, the peak memory"
+                         " and the number of items of each phase of the"
+                         " simulations"))
             ("verbose,V", po::value < int >(verbose)->default_value(0),
              ("Verbose mode 0 - 3. [default 0]\n"
               "0 no trace and no long exception\n"
@@ -552,6 +922,30 @@ struct ProgramOptions
             if (vm.count("manager"))
                 *manager_mode = true;
 
+            if (vm.count("validate"))
+                vle::vpz::Vpz::setValidation(true);
+
+            if (vm.count("compiled"))
+                vle::vpz::Compiled::setEnabled(true);
+
+            if (vm.count("lazy-conditions"))
+                vle::vpz::Vpz::setLazyConditions(true);
+
+            if (*jobs <= 0)
+                throw vle::utils::ArgError(_("jobs must be superior to 0"));
+
+            if (vm["init-threads"].as < int >() <= 0)
+                throw vle::utils::ArgError(
+                    _("init-threads must be superior to 0"));
+
+            init_threads = vm["init-threads"].as < int >();
+
+            if (vm.count("spawn"))
+                simulation_options |= vle::manager::SIMULATION_SPAWN_PROCESS;
+
+            if (vm.count("timing"))
+                timing_profile = new vle::utils::Profile();
+
             if (vm.count("input"))
                 *args = vm["input"].as < CmdArgs >();
 
@@ -598,7 +992,7 @@ struct ProgramOptions
 
     po::options_description desc, generic, hidden;
     po::variables_map vm;
-    int *verbose, *trace, *processor;
+    int *verbose, *trace, *processor, *jobs;
     bool *manager_mode;
     std::string *packagename, *remotecmd, *configvar;
     CmdArgs *args;
@@ -609,13 +1003,15 @@ int main(int argc, char *argv[])
     int ret;
     int verbose = 0;
     int processor = 1;
+    int jobs = 1;
     int trace = -1; /* < 0 = stderr, 0 = file and > 0 = stdout */
     bool manager_mode = false;
     std::string packagename, remotecmd, configvar;
     CmdArgs args;
 
     {
-        ProgramOptions prgs(&verbose, &trace, &processor, &manager_mode,
+        ProgramOptions prgs(&verbose, &trace, &processor, &jobs,
+                &manager_mode,
                 &packagename, &remotecmd, &configvar, &args);
 
         ret = prgs.run(argc, argv);
@@ -631,8 +1027,10 @@ int main(int argc, char *argv[])
 
     switch (ret) {
     case PROGRAM_OPTIONS_PACKAGE:
-        return manage_package_mode(packagename, manager_mode, processor,
+        ret = manage_package_mode(packagename, manager_mode, processor, jobs,
                 args);
+        delete timing_profile;
+        return ret;
     case PROGRAM_OPTIONS_REMOTE:
         return manage_remote_mode(remotecmd, args);
     case PROGRAM_OPTIONS_CONFIG:
@@ -37,6 +37,8 @@
 #include <vle/vpz/AtomicModel.hpp>
 #include <vle/vpz/CoupledModel.hpp>
 #include <vle/utils/Trace.hpp>
+#include <vle/utils/Profile.hpp>
+#include <algorithm>
 #include <functional>
 #include <boost/bind.hpp>
 
@@ -53,7 +55,22 @@ Coordinator::Coordinator(const utils::ModuleManager& modulemgr,
                          const vpz::Experiment& experiment,
                          RootCoordinator& root)
     : m_currentTime(0.0), m_modelFactory(modulemgr, dyn, cls, experiment, root),
-      m_modulemgr(modulemgr), m_isStarted(false)
+      m_modulemgr(modulemgr), m_isStarted(false), m_transaction(0),
+      m_events(0), m_namesIndexed(false), m_pathsIndexed(false)
+{
+}
+
+Coordinator::Coordinator(const utils::ModuleManager& modulemgr,
+                         const vpz::Dynamics& dyn,
+                         const vpz::Classes& cls,
+                         const vpz::Experiment& experiment,
+                         RootCoordinator& root,
+                         const std::string& name,
+                         const vpz::Conditions& overlay)
+    : m_currentTime(0.0),
+      m_modelFactory(modulemgr, dyn, cls, experiment, root, name, overlay),
+      m_modulemgr(modulemgr), m_isStarted(false), m_transaction(0),
+      m_events(0), m_namesIndexed(false), m_pathsIndexed(false)
 {
 }
 
@@ -75,9 +92,23 @@ Coordinator::~Coordinator()
 void Coordinator::init(const vpz::Model& mdls, const Time& current,
                        const Time& duration)
 {
+    utils::Profile* profile = m_modelFactory.root().profile();
+
     m_currentTime = current;
     m_durationTime = duration;
-    buildViews();
+
+    {
+        utils::ProfileScope scope(profile, "views");
+        buildViews();
+        scope.setCount(m_viewList.size());
+    }
+
+    {
+        utils::ProfileScope scope(profile, "graph");
+        m_graph.build(mdls.model());
+        scope.setCount(m_graph.edges());
+    }
+
     addModels(mdls);
     m_toDelete = 0;
     m_isStarted = true;
@@ -113,6 +144,11 @@ void Coordinator::run()
         }
     }
 
+    if (m_transaction > 0) {
+        m_transaction = 1;
+        commitTransaction();
+    }
+
     if (oldToDelete > 0) {
         for (SimulatorList::iterator it = m_deletedSimulator.begin();
              it != m_deletedSimulator.begin() + oldToDelete; ++it) {
@@ -200,6 +236,16 @@ vpz::BaseModel* Coordinator::createModelFromClass(const std::string& classname,
                                                classname, modelname);
 }
 
+void Coordinator::createModelsFromClass(
+    const std::string& classname,
+    vpz::CoupledModel* parent,
+    const std::vector < std::string >& modelnames,
+    std::vector < vpz::BaseModel* >* models)
+{
+    m_modelFactory.createModelsFromClass(*this, parent, classname,
+                                         modelnames, models);
+}
+
 void Coordinator::addObservableToView(vpz::AtomicModel* model,
                                       const std::string& portname,
                                       const std::string& view)
@@ -234,6 +280,22 @@ void Coordinator::delModel(vpz::CoupledModel* parent,
                 "Cannot delete an unknown model '%1%'")) % modelname);
     }
 
+    if (not m_pendingGraph.empty()) {
+        std::vector < vpz::BaseModel* >::iterator it = m_pendingGraph.begin();
+        while (it != m_pendingGraph.end()) {
+            vpz::BaseModel* ancestor = *it;
+            while (ancestor and ancestor != mdl) {
+                ancestor = ancestor->getParent();
+            }
+
+            if (ancestor) {
+                it = m_pendingGraph.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
     if (mdl->isCoupled()) {
         delCoupledModel(static_cast < vpz::CoupledModel* >(mdl));
     } else {
@@ -280,14 +342,71 @@ void Coordinator::getSimulatorsSource(
 }
 
 void Coordinator::updateSimulatorsTarget(
-    std::vector < std::pair < Simulator*, std::string > >& lst)
+    const std::vector < std::pair < Simulator*, std::string > >& lst)
 {
     if (m_isStarted) {
-        for (std::vector < std::pair < Simulator*, std::string > >::iterator
-             it = lst.begin(); it != lst.end(); ++it) {
-            if (it->first != 0) {
-                it->first->updateSimulatorTargets(it->second, m_modelList);
+        if (m_transaction > 0) {
+            m_pendingTargets.insert(m_pendingTargets.end(), lst.begin(),
+                                    lst.end());
+        } else {
+            std::vector < std::pair < Simulator*, std::string > > sorted(lst);
+            std::sort(sorted.begin(), sorted.end());
+            updateTargets(sorted);
+        }
+    }
+}
+
+void Coordinator::updateGraph(vpz::BaseModel* model)
+{
+    if (m_transaction > 0) {
+        m_pendingGraph.push_back(model);
+    } else {
+        m_graph.update(model);
+    }
+}
+
+void Coordinator::commitTransaction()
+{
+    if (m_transaction == 0 or --m_transaction > 0) {
+        return;
+    }
+
+    std::vector < vpz::BaseModel* > graph;
+    std::vector < std::pair < Simulator*, std::string > > targets;
+    graph.swap(m_pendingGraph);
+    targets.swap(m_pendingTargets);
+
+    std::sort(graph.begin(), graph.end());
+    graph.erase(std::unique(graph.begin(), graph.end()), graph.end());
+
+    for (std::vector < vpz::BaseModel* >::iterator it = graph.begin();
+         it != graph.end(); ++it) {
+        m_graph.update(*it);
+    }
+
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()),
+                  targets.end());
+
+    updateTargets(targets);
+}
+
+void Coordinator::updateTargets(
+    std::vector < std::pair < Simulator*, std::string > >& lst)
+{
+    Simulator* previous = 0;
+
+    for (std::vector < std::pair < Simulator*, std::string > >::iterator
+         it = lst.begin(); it != lst.end(); ++it) {
+        /* the simulators deleted in the transaction are cleared and kept
+         * until the end of the bag. */
+        if (it->first != 0 and it->first->getStructure()) {
+            if (it->first != previous) {
+                m_graph.update(it->first->getStructure());
+                previous = it->first;
             }
+            it->first->updateSimulatorTargets(it->second, m_modelList,
+                                              m_graph);
         }
     }
 }
@@ -302,6 +421,7 @@ void Coordinator::removeSimulatorTargetPort(vpz::AtomicModel* model,
                                             const std::string& port)
 {
     getModel(model)->removeTargetPort(port);
+    m_graph.update(model);
 }
 
 // / / / /
@@ -320,6 +440,15 @@ void Coordinator::addModel(vpz::AtomicModel* model, Simulator* simulator)
                     "The Atomic model node '%1% have already a simulator"))
             % model->getName());
     }
+
+    indexModel(model, simulator);
+
+    /* the models built by the executives during the initialization are
+     * not in the graph built from the hierarchy. In a transaction, the
+     * graph is updated by commitTransaction. */
+    if (m_isStarted or m_graph.id(model) == vpz::FlatGraph::npos) {
+        updateGraph(model);
+    }
 }
 
 Simulator* Coordinator::getModel(const vpz::AtomicModel* model) const
@@ -331,14 +460,83 @@ Simulator* Coordinator::getModel(const vpz::AtomicModel* model) const
 
 Simulator* Coordinator::getModel(const std::string& name) const
 {
-    SimulatorMap::const_iterator it = m_modelList.begin();
-    while (it != m_modelList.end()) {
-        if ((*it).first->getName() == name) {
-            return (*it).second;
+    if (not m_namesIndexed) {
+        m_names.rehash(m_modelList.size());
+        for (SimulatorMap::const_iterator it = m_modelList.begin();
+             it != m_modelList.end(); ++it) {
+            m_names.insert(std::make_pair(it->first->getName(), it->second));
+        }
+        m_namesIndexed = true;
+    }
+
+    SimulatorNameIndex::const_iterator it = m_names.find(name);
+    return (it == m_names.end()) ? 0 : it->second;
+}
+
+Simulator* Coordinator::getModelFromPath(const std::string& path) const
+{
+    if (not m_pathsIndexed) {
+        m_paths.rehash(m_modelList.size());
+        for (SimulatorMap::const_iterator it = m_modelList.begin();
+             it != m_modelList.end(); ++it) {
+            m_paths.insert(std::make_pair(it->first->getCompleteName(),
+                                          it->second));
+        }
+        m_pathsIndexed = true;
+    }
+
+    SimulatorPathIndex::const_iterator it = m_paths.find(path);
+    return (it == m_paths.end()) ? 0 : it->second;
+}
+
+vpz::BaseModel* Coordinator::findModel(vpz::CoupledModel* parent,
+                                       const std::string& name) const
+{
+    std::string path(parent->getCompleteName());
+    path += ',';
+    path += name;
+
+    Simulator* simulator = getModelFromPath(path);
+    if (simulator and simulator->getStructure() and
+        simulator->getStructure()->getParent() == parent) {
+        return simulator->getStructure();
+    }
+
+    return parent->findModel(name);
+}
+
+void Coordinator::renameModel(vpz::BaseModel* model,
+                              const std::string& newname)
+{
+    std::vector < vpz::AtomicModel* > lst;
+
+    if (m_namesIndexed or m_pathsIndexed) {
+        if (model->isAtomic()) {
+            lst.push_back(model->toAtomic());
+        } else if (m_pathsIndexed) {
+            vpz::BaseModel::getAtomicModelList(model, lst);
+        }
+
+        for (std::vector < vpz::AtomicModel* >::iterator it = lst.begin();
+             it != lst.end(); ++it) {
+            unindexModel(*it, getModel(*it));
         }
-        ++it;
     }
-    return 0;
+
+    try {
+        vpz::BaseModel::rename(model, newname);
+    } catch (...) {
+        for (std::vector < vpz::AtomicModel* >::iterator it = lst.begin();
+             it != lst.end(); ++it) {
+            indexModel(*it, getModel(*it));
+        }
+        throw;
+    }
+
+    for (std::vector < vpz::AtomicModel* >::iterator it = lst.begin();
+         it != lst.end(); ++it) {
+        indexModel(*it, getModel(*it));
+    }
 }
 
 View* Coordinator::getView(const std::string& name) const
@@ -365,7 +563,9 @@ void Coordinator::delAtomicModel(vpz::AtomicModel* atom)
     }
 
     Simulator* satom = (*it).second;
+    unindexModel(atom, satom);
     m_modelList.erase(it);
+    m_graph.remove(atom);
 
     std::map < std::string , View* >::iterator it2;
     for (it2 = m_viewList.begin(); it2 != m_viewList.end();
@@ -382,6 +582,43 @@ void Coordinator::delAtomicModel(vpz::AtomicModel* atom)
     ++m_toDelete;
 }
 
+void Coordinator::indexModel(vpz::AtomicModel* model, Simulator* simulator)
+{
+    if (m_namesIndexed) {
+        m_names.insert(std::make_pair(model->getName(), simulator));
+    }
+
+    if (m_pathsIndexed) {
+        m_paths[model->getCompleteName()] = simulator;
+    }
+}
+
+void Coordinator::unindexModel(vpz::AtomicModel* model,
+                               Simulator* simulator)
+{
+    if (m_namesIndexed) {
+        std::pair < SimulatorNameIndex::iterator,
+            SimulatorNameIndex::iterator > r =
+                m_names.equal_range(model->getName());
+
+        for (SimulatorNameIndex::iterator it = r.first; it != r.second; ++it) {
+            if (it->second == simulator) {
+                m_names.erase(it);
+                break;
+            }
+        }
+    }
+
+    if (m_pathsIndexed) {
+        SimulatorPathIndex::iterator it =
+            m_paths.find(model->getCompleteName());
+
+        if (it != m_paths.end() and it->second == simulator) {
+            m_paths.erase(it);
+        }
+    }
+}
+
 void Coordinator::delCoupledModel(vpz::CoupledModel* mdl)
 {
     if (not mdl) {
@@ -411,7 +648,7 @@ void Coordinator::dispatchExternalEvent(ExternalEventList& eventList,
          eventList.end(); ++it) {
 
         std::pair < Simulator::iterator, Simulator::iterator > x;
-        x = sim->targets((*it)->getPortName(), m_modelList);
+        x = sim->targets((*it)->getPortName(), m_modelList, m_graph);
 
         if (x.first != x.second and x.first->second.first) {
             for (Simulator::iterator jt = x.first; jt != x.second; ++jt) {
@@ -429,8 +666,9 @@ void Coordinator::dispatchExternalEvent(ExternalEventList& eventList,
 
 void Coordinator::buildViews()
 {
-    const vpz::Outputs& outs(m_modelFactory.outputs());
-    const vpz::Views& views(m_modelFactory.views());
+    const ModelFactory& factory(m_modelFactory);
+    const vpz::Outputs& outs(factory.outputs());
+    const vpz::Views& views(factory.views());
     const vpz::ViewList& viewlist(views.viewlist());
 
     for (vpz::ViewList::const_iterator it = viewlist.begin();
@@ -470,7 +708,7 @@ StreamWriter* Coordinator::buildOutput(const vpz::View& view,
     StreamWriter* stream = new StreamWriter(m_modulemgr);
 
     std::string file((fmt("%1%_%2%") %
-                      m_modelFactory.experiment().name() %
+                      m_modelFactory.experimentName() %
                       view.name()).str());
 
     stream->open(output.plugin(), output.package(), output.location(), file,
@@ -485,6 +723,8 @@ void Coordinator::processInternalEvent(
 {
     const InternalEvent* ev = modelbag.internal();
 
+    ++m_events;
+
     {
         ExternalEventList result;
         sim->output(m_currentTime, result);
@@ -507,6 +747,8 @@ void Coordinator::processExternalEvents(
 {
     const ExternalEventList& lst(modelbag.externals());
 
+    m_events += lst.size();
+
     {
         InternalEvent* internal(sim->externalTransition(lst, m_currentTime));
         if (internal) {
@@ -521,6 +763,8 @@ void Coordinator::processConflictEvents(
     Simulator* sim,
     const EventBagModel& modelbag)
 {
+    m_events += 1 + modelbag.externals().size();
+
     {
         ExternalEventList result;
         sim->output(m_currentTime, result);
@@ -34,6 +34,8 @@
 #include <vle/devs/View.hpp>
 #include <vle/devs/Time.hpp>
 #include <vle/devs/ModelFactory.hpp>
+#include <vle/vpz/FlatGraph.hpp>
+#include <boost/unordered_map.hpp>
 
 namespace vle { namespace devs {
 
@@ -41,6 +43,9 @@ class Executive;
 
 typedef std::vector < Simulator* > SimulatorList;
 typedef std::map < vpz::AtomicModel*, devs::Simulator* > SimulatorMap;
+typedef boost::unordered_multimap < std::string, Simulator* >
+    SimulatorNameIndex;
+typedef boost::unordered_map < std::string, Simulator* > SimulatorPathIndex;
 
 /**
  * @brief Represent the DEVS Coordinator class. This class provide a non
@@ -57,6 +62,21 @@ public:
                 const vpz::Experiment& experiment,
                 RootCoordinator& root);
 
+    /**
+     * @brief Build a Coordinator for a model hierarchy shared with other
+     * simulations, the dynamics, the classes and the experiment are not
+     * copied (see ModelFactory).
+     * @param name The name of the experiment of this simulation.
+     * @param overlay The values of the conditions of this simulation.
+     */
+    Coordinator(const utils::ModuleManager& modulemgr,
+                const vpz::Dynamics& dyn,
+                const vpz::Classes& cls,
+                const vpz::Experiment& experiment,
+                RootCoordinator& root,
+                const std::string& name,
+                const vpz::Conditions& overlay);
+
     ~Coordinator();
 
     /**
@@ -143,6 +163,21 @@ public:
                                        vpz::CoupledModel* parent,
                                        const std::string& modelname);
 
+    /**
+     * @brief Build several new devs::Simulator from the vpz::Classes
+     * information. The class is compiled once (dynamics, initial values and
+     * observables) and all the models are built from this prototype.
+     * @param classname the name of the class to clone.
+     * @param parent the parent of the models.
+     * @param modelnames the new names of the models.
+     * @param models if not null, the models built are appended.
+     * @throw utils::DevsGraphError if a modelname already exist.
+     */
+    void createModelsFromClass(const std::string& classname,
+                               vpz::CoupledModel* parent,
+                               const std::vector < std::string >& modelnames,
+                               std::vector < vpz::BaseModel* >* models = 0);
+
     /**
      * @brief Add an observable, ie. a reference and a model to the
      * specified view.
@@ -173,8 +208,38 @@ public:
         const std::string& port,
         std::vector < std::pair < Simulator*, std::string > >& lst);
 
+    /**
+     * @brief Compute again the targets of the output ports of the
+     * simulators. In a transaction, the ports are stored and computed
+     * by commitTransaction.
+     * @param lst The list of simulators and output ports, not modified.
+     */
     void updateSimulatorsTarget(
-        std::vector < std::pair < Simulator*, std::string > >& lst);
+        const std::vector < std::pair < Simulator*, std::string > >& lst);
+
+    /**
+     * @brief Start a transaction: the updates of the targets of the
+     * simulators and of the connection graph are delayed until the
+     * transaction is committed. Transactions can be nested, only the
+     * commit of the outer transaction does the updates.
+     */
+    void beginTransaction()
+    { ++m_transaction; }
+
+    /**
+     * @brief Commit a transaction: the connection graph is updated once for
+     * all the modified models and the targets of each output port modified
+     * are computed once. The transactions still opened at the end of a bag
+     * are committed by run().
+     */
+    void commitTransaction();
+
+    /**
+     * @brief Check if a transaction is opened.
+     * @return true if a transaction is opened.
+     */
+    bool isTransaction() const
+    { return m_transaction > 0; }
 
     void addSimulatorTargetPort(vpz::AtomicModel* model,
                                 const std::string& port);
@@ -182,6 +247,14 @@ public:
     void removeSimulatorTargetPort(vpz::AtomicModel* model,
                                    const std::string& port);
 
+    /**
+     * @brief Compute again the connections of the atomic models which
+     * depend on the model (see vpz::FlatGraph::update). Use it when the
+     * connections of the model are modified without updateSimulatorsTarget.
+     * @param model The modified model.
+     */
+    void updateGraph(vpz::BaseModel* model);
+
     //
     ///
     //// Some usefull functions.
@@ -205,13 +278,48 @@ public:
     Simulator* getModel(const vpz::AtomicModel* model) const;
 
     /**
-     * Return the devs::Simulator with a specified atomic model name.
-     * Complexity: linear O(n).
+     * Return the devs::Simulator with a specified atomic model name. If
+     * several atomic models share the name, one of them is returned. The
+     * index of the names is built by the first call and then updated by
+     * addModel, delModel and renameModel.
+     * Complexity: constant on average.
      * @param model the name of atomic model to search.
      * @return a reference to the devs::Simulator or 0 if not found.
      */
     Simulator* getModel(const std::string& model) const;
 
+    /**
+     * Return the devs::Simulator with a specified atomic model complete
+     * name (see vpz::BaseModel::getCompleteName), for instance
+     * `top,sub,atom'. The index of the complete names is built by the first
+     * call and then updated by addModel, delModel and renameModel.
+     * Complexity: constant on average.
+     * @param path the complete name of atomic model to search.
+     * @return a reference to the devs::Simulator or 0 if not found.
+     */
+    Simulator* getModelFromPath(const std::string& path) const;
+
+    /**
+     * @brief Rename a model and update the indexes of the names and of
+     * the complete names of the atomic models.
+     * @param model the model to rename.
+     * @param newname the new name of the model.
+     * @throw utils::DevsGraphError if the name already exists in the parent.
+     */
+    void renameModel(vpz::BaseModel* model, const std::string& newname);
+
+    /**
+     * Return the child of a coupled model with a specified name. The atomic
+     * children with a devs::Simulator are found in the index of the
+     * complete names (see getModelFromPath), the others with
+     * vpz::CoupledModel::findModel.
+     * @param parent the coupled model to search in.
+     * @param name the name of the child.
+     * @return the child or 0 if not found.
+     */
+    vpz::BaseModel* findModel(vpz::CoupledModel* parent,
+                              const std::string& name) const;
+
     /**
      * @brief Return the devs::View from a specified View name.
      * Complexity: log O(log(n)).
@@ -238,6 +346,21 @@ public:
     inline const SimulatorMap& modellist() const
     { return m_modelList; }
 
+    /**
+     * @brief Get the number of events processed since the start: one per
+     * internal event and one per external event received by a transition.
+     * @return The number of events.
+     */
+    inline uint64_t events() const
+    { return m_events; }
+
+    /**
+     * @brief Get the atomic to atomic connections of the simulation.
+     * @return A constant reference to the connection graph.
+     */
+    inline const vpz::FlatGraph& graph() const
+    { return m_graph; }
+
     /**
      * @brief Get a constant reference to the list of vpz::Dynamics objects.
      * @return A constant reference to the list of vpz::Dynamics objects.
@@ -303,6 +426,37 @@ private:
     const utils::ModuleManager& m_modulemgr;
     ViewEventList               m_obsEventBuffer;
     bool                        m_isStarted;
+    vpz::FlatGraph              m_graph; /**< The atomic to atomic
+                                           connections. */
+    uint32_t                    m_transaction; /**< The number of
+                                                 opened transactions. */
+    uint64_t                    m_events; /**< The number of internal
+                                            and external events
+                                            processed. */
+    mutable SimulatorNameIndex  m_names; /**< Built on demand by
+                                           getModel. */
+    mutable SimulatorPathIndex  m_paths; /**< Built on demand by
+                                           getModelFromPath. */
+    mutable bool                m_namesIndexed;
+    mutable bool                m_pathsIndexed;
+
+    /**
+     * @brief Add or remove an atomic model from the indexes built.
+     * @param model the atomic model.
+     * @param simulator the simulator of the atomic model.
+     */
+    void indexModel(vpz::AtomicModel* model, Simulator* simulator);
+    void unindexModel(vpz::AtomicModel* model, Simulator* simulator);
+    std::vector < std::pair < Simulator*, std::string > > m_pendingTargets;
+    std::vector < vpz::BaseModel* > m_pendingGraph;
+
+    /**
+     * @brief Update the connection graph and the targets of the
+     * simulators, each model and each output port is computed once.
+     * @param lst The list of simulators and output ports, sorted.
+     */
+    void updateTargets(
+        std::vector < std::pair < Simulator*, std::string > >& lst);
 
     /**
      * @brief Build, for each vpz::View a StreamWriter and View.
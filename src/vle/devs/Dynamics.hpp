@@ -41,6 +41,7 @@
 #include <vle/value/Boolean.hpp>
 #include <vle/value/String.hpp>
 #include <vle/utils/PackageTable.hpp>
+#include <vle/utils/Philox.hpp>
 #include <vle/version.hpp>
 #include <string>
 
@@ -64,6 +65,22 @@
         }                                                               \
     }
 
+/**
+ * Declare a Dynamics whose constructor and init function can run
+ * concurrently with the ones of other models: they only read their
+ * InitEventList and do not share mutable state between instances. At
+ * startup, these models are built and initialized by a thread pool (see
+ * RootCoordinator::setInitThreads).
+ */
+#define DECLARE_DYNAMICS_THREAD_SAFE(mdl)                               \
+    DECLARE_DYNAMICS(mdl)                                               \
+    extern "C" {                                                        \
+        VLE_MODULE void                                                 \
+        vle_dynamics_thread_safe()                                      \
+        {                                                               \
+        }                                                               \
+    }
+
 namespace vle { namespace devs {
 
     class RootCoordinator;
@@ -78,8 +95,9 @@ namespace vle { namespace devs {
     {
     public:
         DynamicsInit(const vpz::AtomicModel& model,
-                     PackageId packageid)
-            : m_model(model), m_packageid(packageid)
+                     PackageId packageid,
+                     uint64_t seed = 0)
+            : m_model(model), m_packageid(packageid), m_seed(seed)
         {}
 
         virtual ~DynamicsInit()
@@ -87,10 +105,12 @@ namespace vle { namespace devs {
 
         const vpz::AtomicModel& model() const { return m_model; }
         PackageId packageid() const { return m_packageid; }
+        uint64_t seed() const { return m_seed; }
 
     private:
         const vpz::AtomicModel&       m_model;
         PackageId                       m_packageid;
+        uint64_t                        m_seed;
     };
 
     /**
@@ -104,11 +124,15 @@ namespace vle { namespace devs {
          * @brief Constructor of Dynamics for an atomic model.
          *
          * @param init The initialiser of Dynamics.
-         * @param events The parameter from the experimental frame.
+         * @param events The parameter from the experimental frame. The
+         * values are shared by all the models built with the same
+         * conditions and live as long as the conditions, clone them to keep
+         * or modify them.
          */
         Dynamics(const DynamicsInit& init,
                  const vle::devs::InitEventList&  /* events */)
-            : m_model(init.model()), m_packageid(init.packageid())
+            : m_model(init.model()), m_packageid(init.packageid()),
+            m_seed(init.seed())
         {}
 
 	/**
@@ -242,6 +266,35 @@ namespace vle { namespace devs {
         inline const std::string& getModelName() const
         { return m_model.getName(); }
 
+        /**
+         * Build the random generator of the model: the stream of the
+         * complete name of the model for the key of the simulation. The
+         * key depends on the seed of the experiment, the combination and
+         * the replica, the streams of two models or two simulations are
+         * independent and each simulation is reproducible.
+         *
+         * @code
+         * class Model : public vle::devs::Dynamics
+         * {
+         *     vle::utils::Philox m_rand;
+         *
+         * public:
+         *     Model(const vle::devs::DynamicsInit& init,
+         *           const vle::devs::InitEventList& events)
+         *         : vle::devs::Dynamics(init, events),
+         *           m_rand(getRandomStream())
+         *     {}
+         * };
+         * @endcode
+         *
+         * @return A new generator at the beginning of the stream.
+         */
+        inline utils::Philox getRandomStream() const
+        {
+            return utils::Philox(m_seed, utils::Philox::stream(
+                    m_model.getCompleteName()));
+        }
+
 	/**
 	 * Build a Double object from a double value
 	 *
@@ -460,6 +513,9 @@ namespace vle { namespace devs {
 
         PackageId m_packageid; /**< An iterator to std::set of the
                                  vle::utils::PackageTable. */
+
+        uint64_t m_seed; /**< The key of the random streams of the
+                           simulation. */
     };
 
 }} // namespace vle devs
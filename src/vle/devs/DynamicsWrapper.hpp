@@ -61,8 +61,9 @@ namespace vle { namespace devs {
     public:
         DynamicsWrapperInit(const vpz::AtomicModel& atom,
                             PackageId packageid,
-                            const std::string& library)
-            : DynamicsInit(atom, packageid), m_library(library)
+                            const std::string& library,
+                            uint64_t seed = 0)
+            : DynamicsInit(atom, packageid, seed), m_library(library)
         {}
 
         virtual ~DynamicsWrapperInit()
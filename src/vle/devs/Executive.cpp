@@ -27,6 +27,7 @@
 
 #include <vle/devs/Executive.hpp>
 #include <vle/vpz/Vpz.hpp>
+#include <boost/lexical_cast.hpp>
 
 namespace vle { namespace devs {
 
@@ -34,7 +35,7 @@ void Executive::addObservableToView(const std::string& model,
                                     const std::string& portname,
                                     const std::string& view)
 {
-    vpz::BaseModel* mdl = cpled()->findModel(model);
+    vpz::BaseModel* mdl = findModel(model);
 
     if (mdl == 0) {
         throw utils::DevsGraphError(fmt(
@@ -82,11 +83,69 @@ Executive::createModelFromClass(const std::string& classname,
     return m_coordinator.createModelFromClass(classname, cpled(), modelname);
 }
 
+void Executive::createModelsFromClass(
+    const std::string& classname,
+    const std::vector < std::string >& modelnames)
+{
+    m_coordinator.createModelsFromClass(classname, cpled(), modelnames);
+}
+
+void Executive::createModelsFromClass(const std::string& classname,
+                                      uint32_t count,
+                                      const std::string& prefix,
+                                      uint32_t first)
+{
+    std::vector < std::string > modelnames;
+    modelnames.reserve(count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        modelnames.push_back(prefix + boost::lexical_cast < std::string >(
+                first + i));
+    }
+
+    createModelsFromClass(classname, modelnames);
+}
+
+const vpz::GridModel* Executive::createGridModel(vpz::GridModel* grid)
+{
+    cpled()->addModel(grid);
+
+    vpz::AtomicModelVector cells;
+    vpz::BaseModel::getAtomicModelList(grid, cells);
+
+    m_coordinator.beginTransaction();
+
+    try {
+        for (vpz::AtomicModelVector::iterator it = cells.begin();
+             it != cells.end(); ++it) {
+            m_coordinator.createModel(*it, (*it)->dynamics(),
+                                      (*it)->conditions(),
+                                      (*it)->observables());
+        }
+    } catch (...) {
+        /* remove the cells already built, then the grid. */
+        for (vpz::AtomicModelVector::iterator it = cells.begin();
+             it != cells.end(); ++it) {
+            if (m_coordinator.getModel(*it)) {
+                m_coordinator.delModel(grid, (*it)->getName());
+            }
+        }
+
+        cpled()->delModel(grid);
+        m_coordinator.commitTransaction();
+        throw;
+    }
+
+    m_coordinator.updateGraph(grid);
+    m_coordinator.commitTransaction();
+    return grid;
+}
+
 void Executive::delModel(const std::string& modelname)
 {
     std::vector < std::pair < Simulator*, std::string > > toupdate;
 
-    vpz::BaseModel* mdl = cpled()->findModel(modelname);
+    vpz::BaseModel* mdl = findModel(modelname);
     if (not mdl) {
         throw utils::DevsGraphError(fmt(
                 _("Executive error: unknown model `%1%'")) %
@@ -103,7 +162,7 @@ void Executive::delModel(const std::string& modelname)
 void Executive::renameModel(const std::string& oldname,
                             const std::string& newname)
 {
-    vpz::BaseModel* mdl = cpled()->findModel(oldname);
+    vpz::BaseModel* mdl = findModel(oldname);
     if (mdl == 0) {
         throw utils::DevsGraphError(
             fmt(_("Executive error: rename `%1%' into `%2%' failed, `%1%' "
@@ -117,7 +176,7 @@ void Executive::renameModel(const std::string& oldname,
     }
 
     try {
-        vpz::BaseModel::rename(mdl, newname);
+        m_coordinator.renameModel(mdl, newname);
     } catch (const std::exception& e) {
         throw utils::DevsGraphError(
             fmt(_("Executive error: rename `%1%' into `%2%' failed: `%3%' ")) %
@@ -132,9 +191,9 @@ void Executive::addConnection(const std::string& srcModelName,
 {
     const std::string& modelName(coupledmodelName());
     vpz::BaseModel* srcModel = (modelName == srcModelName)?
-        cpled() : cpled()->findModel(srcModelName);
+        cpled() : findModel(srcModelName);
     vpz::BaseModel* dstModel = (modelName == dstModelName)?
-        cpled() : cpled()->findModel(dstModelName);
+        cpled() : findModel(dstModelName);
 
     if (srcModel and dstModel) {
         std::vector < std::pair < Simulator*, std::string > > toupdate;
@@ -173,8 +232,8 @@ void Executive::removeConnection(const std::string& srcModelName,
                                  const std::string& dstPortName)
 {
     const std::string& modelName(coupledmodelName());
-    vpz::BaseModel* srcModel = cpled()->findModel(srcModelName);
-    vpz::BaseModel* dstModel = cpled()->findModel(dstModelName);
+    vpz::BaseModel* srcModel = findModel(srcModelName);
+    vpz::BaseModel* dstModel = findModel(dstModelName);
 
     if (not srcModel and srcModelName == modelName) {
         srcModel = cpled();
@@ -189,12 +248,15 @@ void Executive::removeConnection(const std::string& srcModelName,
         if (cpled() == srcModel) {
             m_coordinator.getSimulatorsSource(dstModel, dstPortName, toupdate);
             cpled()->delInputConnection(srcPortName, dstModel, dstPortName);
+            m_coordinator.updateGraph(cpled());
         } else if (cpled() == dstModel) {
             cpled()->delOutputConnection(srcModel, srcPortName, dstPortName);
+            m_coordinator.updateGraph(cpled());
         } else {
             m_coordinator.getSimulatorsSource(dstModel, dstPortName, toupdate);
             cpled()->delInternalConnection(srcModel, srcPortName, dstModel,
                                            dstPortName);
+            m_coordinator.updateGraph(srcModel);
         }
 
         m_coordinator.updateSimulatorsTarget(toupdate);
@@ -209,7 +271,7 @@ void Executive::removeConnection(const std::string& srcModelName,
 void Executive::addInputPort(const std::string& modelName,
                              const std::string& portName)
 {
-    vpz::BaseModel* mdl = cpled()->findModel(modelName);
+    vpz::BaseModel* mdl = findModel(modelName);
     if (not mdl) {
         throw utils::DevsGraphError(fmt(
                 _("Executive error: unknown model `%1%'")) %
@@ -222,7 +284,7 @@ void Executive::addInputPort(const std::string& modelName,
 void Executive::addOutputPort(const std::string& modelName,
                               const std::string& portName)
 {
-    vpz::BaseModel* mdl = cpled()->findModel(modelName);
+    vpz::BaseModel* mdl = findModel(modelName);
     if (not mdl) {
         throw utils::DevsGraphError(fmt(
                 _("Executive error: unknown model `%1%'")) %
@@ -235,7 +297,7 @@ void Executive::addOutputPort(const std::string& modelName,
 void Executive::removeInputPort(const std::string& modelName,
                                 const std::string& portName)
 {
-    vpz::BaseModel* mdl = cpled()->findModel(modelName);
+    vpz::BaseModel* mdl = findModel(modelName);
     if (not mdl) {
         throw utils::DevsGraphError(fmt(
                 _("Executive error: unknown model `%1%'")) %
@@ -251,7 +313,7 @@ void Executive::removeInputPort(const std::string& modelName,
 void Executive::removeOutputPort(const std::string& modelName,
                                  const std::string& portName)
 {
-    vpz::BaseModel* mdl = cpled()->findModel(modelName);
+    vpz::BaseModel* mdl = findModel(modelName);
     if (not mdl) {
         throw utils::DevsGraphError(fmt(
                 _("Executive error: unknown model `%1%'")) %
@@ -32,6 +32,7 @@
 #include <vle/devs/Coordinator.hpp>
 #include <vle/devs/Dynamics.hpp>
 #include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/GridModel.hpp>
 #include <vle/vpz/Dynamics.hpp>
 #include <vle/vpz/Conditions.hpp>
 #include <vle/vpz/Observables.hpp>
@@ -66,8 +67,9 @@ class VLE_API ExecutiveInit : public DynamicsInit
 public:
     ExecutiveInit(const vpz::AtomicModel& model,
                   PackageId packageid,
-                  Coordinator& coordinator)
-        : DynamicsInit(model, packageid), m_coordinator(coordinator)
+                  Coordinator& coordinator,
+                  uint64_t seed = 0)
+        : DynamicsInit(model, packageid, seed), m_coordinator(coordinator)
     {}
 
     virtual ~ExecutiveInit()
@@ -183,6 +185,32 @@ public:
     //
     // / / / /
 
+    /**
+     * @brief Start a transaction of structural changes. Until
+     * commitTransaction is called, createModel, delModel, addConnection,
+     * removeConnection, etc. only record the output ports whose targets
+     * change, the routing is computed once per port by commitTransaction.
+     *
+     * @code
+     * beginTransaction();
+     * for (int i = 0; i < 10000; ++i) {
+     *     addConnection(...);
+     * }
+     * commitTransaction();
+     * @endcode
+     */
+    void beginTransaction()
+    { m_coordinator.beginTransaction(); }
+
+    /**
+     * @brief Commit a transaction of structural changes: compute the
+     * routing of all the output ports recorded since beginTransaction. A
+     * transaction not committed at the end of the transition is committed
+     * by the coordinator.
+     */
+    void commitTransaction()
+    { m_coordinator.commitTransaction(); }
+
     /**
      * @brief Build a new devs::Simulator from the dynamics library. Attach
      * to this model information of dynamics, condition and observable.
@@ -216,6 +244,49 @@ public:
         createModelFromClass(const std::string& classname,
                              const std::string& modelname);
 
+    /**
+     * @brief Build several new devs::Simulator from the vpz::Classes
+     * information. The class is compiled once and the models are stamped
+     * from this prototype, faster than several calls to
+     * createModelFromClass. The prototype is kept until the end of the
+     * simulation, the changes of the class, its conditions or its
+     * observables made after the first instancing are not seen.
+     * @param classname the name of the class to clone.
+     * @param modelnames the new names of the models.
+     * @throw utils::DevsGraphError if a modelname already exist, no model
+     * is then built.
+     */
+    virtual void
+        createModelsFromClass(const std::string& classname,
+                              const std::vector < std::string >& modelnames);
+
+    /**
+     * @brief Build several new devs::Simulator from the vpz::Classes
+     * information named prefix followed by a number: prefix0, prefix1, etc.
+     * @param classname the name of the class to clone.
+     * @param count the number of models to build.
+     * @param prefix the prefix of the names of the models.
+     * @param first the number of the first model.
+     * @throw utils::DevsGraphError if a modelname already exist.
+     */
+    void createModelsFromClass(const std::string& classname,
+                               uint32_t count,
+                               const std::string& prefix,
+                               uint32_t first = 0);
+
+    /**
+     * @brief Attach a vpz::GridModel to the coupled model and build the
+     * devs::Simulator of its cells from their dynamics, conditions and
+     * observables. The implicit connections of the cells are added to the
+     * connection graph of the coordinator.
+     * @param grid the grid to attach, built without parent. The coupled
+     * model takes the ownership of the grid once attached.
+     * @throw utils::DevsGraphError if a model with the same name exists,
+     * the grid is then not attached. If a cell cannot be built, the cells
+     * already built and the grid are deleted before the error is thrown.
+     */
+    virtual const vpz::GridModel* createGridModel(vpz::GridModel* grid);
+
     /**
      * @brief Delete the specified model from coupled model. All
      * connection are deleted, Simulator are deleted and all events are
@@ -359,6 +430,15 @@ private:
      * @return A reference to the coupled model.
      */
     vpz::CoupledModel* cpled() { return getModel().getParent(); }
+
+    /**
+     * @brief Get a child of the current coupled model from the index of the
+     * coordinator.
+     * @param name The name of the child.
+     * @return The child or 0 if not found.
+     */
+    vpz::BaseModel* findModel(const std::string& name)
+    { return m_coordinator.findModel(cpled(), name); }
 };
 
 }} // namespace vle devs
@@ -244,6 +244,41 @@ public:
         return UserModel::createModelFromClass(classname, modelname);
     }
 
+    using UserModel::createModelsFromClass;
+
+    /**
+     * @brief Build several new devs::Simulator from the vpz::Classes
+     * information.
+     * @param classname the name of the class to clone.
+     * @param modelnames the new names of the models.
+     */
+    virtual void createModelsFromClass(
+        const std::string& classname,
+        const std::vector < std::string >& modelnames)
+    {
+        TraceExtension(fmt(
+                _("%1$20.10g %2% [EXE] createModelsFromClass "
+                  "class: %3%, models: %4%")) % mCurrentTime %
+            mName % classname % modelnames.size());
+
+        UserModel::createModelsFromClass(classname, modelnames);
+    }
+
+    /**
+     * @brief Attach a vpz::GridModel and build the devs::Simulator of its
+     * cells.
+     * @param grid the grid to attach.
+     */
+    virtual const vpz::GridModel* createGridModel(vpz::GridModel* grid)
+    {
+        TraceExtension(fmt(
+                _("%1$20.10g %2% [EXE] createGridModel "
+                  "name: %3%, size: %4%x%5%")) % mCurrentTime % mName %
+            grid->getName() % grid->width() % grid->height());
+
+        return UserModel::createGridModel(grid);
+    }
+
     /**
      * @brief Delete the specified model from coupled model. All
      * connection are deleted, Simulator are deleted and all events are
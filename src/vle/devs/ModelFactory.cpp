@@ -35,31 +35,110 @@
 #include <vle/vpz/BaseModel.hpp>
 #include <vle/vpz/AtomicModel.hpp>
 #include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/GridModel.hpp>
 #include <vle/utils/Package.hpp>
 #include <vle/utils/Algo.hpp>
+#include <vle/utils/Profile.hpp>
+#include <boost/checked_delete.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
 
 namespace vle { namespace devs {
 
+
 ModelFactory::ModelFactory(const utils::ModuleManager& modulemgr,
                            const vpz::Dynamics& dyn,
                            const vpz::Classes& cls,
                            const vpz::Experiment& exp,
                            RootCoordinator& root)
-    : mModuleMgr(modulemgr), mDynamics(dyn), mClasses(cls), mExperiment(exp),
-      mRoot(root)
+    : mModuleMgr(modulemgr), mDynamics(new vpz::Dynamics(dyn)),
+      mClasses(new vpz::Classes(cls)), mExperiment(new vpz::Experiment(exp)),
+      mOwner(true), mExperimentName(exp.name()), mRoot(root), mOverlay(0)
+{
+}
+
+ModelFactory::ModelFactory(const utils::ModuleManager& modulemgr,
+                           const vpz::Dynamics& dyn,
+                           const vpz::Classes& cls,
+                           const vpz::Experiment& exp,
+                           RootCoordinator& root,
+                           const std::string& name,
+                           const vpz::Conditions& overlay)
+    : mModuleMgr(modulemgr), mDynamics(&dyn), mClasses(&cls),
+      mExperiment(&exp), mOwner(false), mExperimentName(name), mRoot(root),
+      mOverlay(&overlay)
+{
+}
+
+ModelFactory::~ModelFactory()
+{
+    clearPrototypes();
+    clearInitValues();
+
+    if (mOwner) {
+        delete mDynamics;
+        delete mClasses;
+        delete mExperiment;
+    }
+}
+
+ModelFactory::Prototype::~Prototype()
 {
+    std::for_each(atomics.begin(), atomics.end(),
+                  boost::checked_deleter < AtomicPrototype >());
+}
+
+void ModelFactory::own()
+{
+    if (not mOwner) {
+        clearPrototypes();
+        clearInitValues();
+
+        vpz::Experiment* experiment = new vpz::Experiment(*mExperiment);
+        experiment->setName(mExperimentName);
+
+        mExperiment = experiment;
+        mDynamics = new vpz::Dynamics(*mDynamics);
+        mClasses = new vpz::Classes(*mClasses);
+        mOwner = true;
+    }
 }
 
 void ModelFactory::cleanCache()
 {
-    mDynamics.cleanNoPermanent();
-    mExperiment.cleanNoPermanent();
+    clearPrototypes();
+    clearInitValues();
+
+    if (mOwner) {
+        dynamics().cleanNoPermanent();
+        experiment().cleanNoPermanent();
+    }
+}
+
+void ModelFactory::clearPrototypes()
+{
+    for (PrototypeList::iterator it = mPrototypes.begin();
+         it != mPrototypes.end(); ++it) {
+        delete it->second;
+    }
+    mPrototypes.clear();
+}
+
+void ModelFactory::clearInitValues()
+{
+    for (InitValuesList::iterator it = mInitValues.begin();
+         it != mInitValues.end(); ++it) {
+        it->second->value().clear();
+        delete it->second;
+    }
+    mInitValues.clear();
 }
 
 void ModelFactory::addPermanent(const vpz::Dynamic& dynamics)
 {
     try {
-        mDynamics.add(dynamics);
+        this->dynamics().add(dynamics);
     } catch(const std::exception& e) {
         throw utils::InternalError(fmt(_(
             "Model factory cannot add dynamics %1%: %2%")) % dynamics.name() %
@@ -70,7 +149,7 @@ void ModelFactory::addPermanent(const vpz::Dynamic& dynamics)
 void ModelFactory::addPermanent(const vpz::Condition& condition)
 {
     try {
-        vpz::Conditions& conds(mExperiment.conditions());
+        vpz::Conditions& conds(conditions());
         conds.add(condition);
     } catch(const std::exception& e) {
         throw utils::InternalError(fmt(_(
@@ -82,7 +161,7 @@ void ModelFactory::addPermanent(const vpz::Condition& condition)
 void ModelFactory::addPermanent(const vpz::Observable& observable)
 {
     try {
-        vpz::Views& views(mExperiment.views());
+        vpz::Views& views(this->views());
         views.addObservable(observable);
     } catch(const std::exception& e) {
         throw utils::InternalError(fmt(_(
@@ -97,7 +176,7 @@ void ModelFactory::createModel(Coordinator& coordinator,
                                const std::vector < std::string >& conditions,
                                const std::string& observable)
 {
-    const vpz::Dynamic& dyn = mDynamics.get(dynamics);
+    const vpz::Dynamic& dyn = mDynamics->get(dynamics);
 
     const SimulatorMap& result(coordinator.modellist());
     if (result.find(model) != result.end()) {
@@ -109,61 +188,66 @@ void ModelFactory::createModel(Coordinator& coordinator,
     Simulator* sim = new Simulator(model);
     coordinator.addModel(model, sim);
 
-    value::Map initValues;
-    if (not conditions.empty()) {
-        for (std::vector < std::string >::const_iterator it =
-             conditions.begin(); it != conditions.end(); ++it) {
-	    const vpz::Condition& cnd(mExperiment.conditions().get(*it));
-	    value::MapValue vl;
-	    cnd.fillWithFirstValues(vl);
-
-	    for (value::MapValue::const_iterator itv = vl.begin();
-		 itv != vl.end(); ++itv) {
-
-                if (initValues.exist(itv->first)) {
-                    initValues.value().clear();
-                    throw utils::InternalError(fmt(_(
-                            "Multiples condition with the same init port " \
-                            "name '%1%'")) % itv->first);
-                }
-                initValues.add(itv->first, itv->second);
-            }
+    const value::Map& shared(initValues(conditions));
 
-            vl.clear();
-	}
-    }
+    if (dynamic_cast < vpz::GridModel* >(model->getParent())) {
+        value::Map cellValues;
+        value::Map initValues;
+        initValues.value() = shared.value();
+        fillCellValues(model, initValues, cellValues);
+
+        try {
+            sim->addDynamics(attachDynamics(coordinator, sim, dyn,
+                                            initValues));
+        } catch(const std::exception& /*e*/) {
+            initValues.value().clear();
+            throw;
+        }
 
-    try {
-        sim->addDynamics(attachDynamics(coordinator, sim, dyn, initValues));
-    } catch(const std::exception& /*e*/) {
         initValues.value().clear();
-        throw;
+    } else {
+        sim->addDynamics(attachDynamics(coordinator, sim, dyn, shared));
     }
 
-    initValues.value().clear();
-
     if (not observable.empty()) {
-        vpz::Observable& ob(mExperiment.views().observables().get(observable));
-        const vpz::ObservablePortList& lst(ob.observableportlist());
+        std::vector < std::pair < View*, std::string > > views;
+        getViews(coordinator, observable, views);
 
-        for (vpz::ObservablePortList::const_iterator it = lst.begin();
-             it != lst.end(); ++it) {
-            const vpz::ViewNameList& vnlst(it->second.viewnamelist());
-            for (vpz::ViewNameList::const_iterator jt = vnlst.begin();
-                 jt != vnlst.end(); ++jt) {
+        for (std::vector < std::pair < View*, std::string > >::iterator it =
+             views.begin(); it != views.end(); ++it) {
+            it->first->addObservable(sim, it->second,
+                                     coordinator.getCurrentTime());
+        }
+    }
 
-                View* view = coordinator.getView(*jt);
+    InternalEvent* evt = sim->init(coordinator.getCurrentTime());
+    if (evt) {
+        coordinator.eventtable().putInternalEvent(evt);
+    }
+}
 
-                if (not view) {
-                    throw utils::InternalError(fmt(_(
-                                "The view '%1%' is unknow of coordinator "
-                                "view list")) % *jt);
-                }
+void ModelFactory::createModel(Coordinator& coordinator,
+                               vpz::AtomicModel* model,
+                               const AtomicPrototype& prototype)
+{
+    const SimulatorMap& result(coordinator.modellist());
+    if (result.find(model) != result.end()) {
+        throw utils::InternalError(fmt(_(
+                "The model '%1%' already exist in coordinator")) %
+            model->getName());
+    }
 
-                view->addObservable(sim, it->first,
-                                    coordinator.getCurrentTime());
-            }
-        }
+    Simulator* sim = new Simulator(model);
+    coordinator.addModel(model, sim);
+
+    sim->addDynamics(attachDynamics(coordinator, sim, *prototype.dynamics,
+                                    prototype.initValues, prototype.symbol,
+                                    prototype.type));
+
+    for (std::vector < std::pair < View*, std::string > >::const_iterator it =
+         prototype.views.begin(); it != prototype.views.end(); ++it) {
+        it->first->addObservable(sim, it->second,
+                                 coordinator.getCurrentTime());
     }
 
     InternalEvent* evt = sim->init(coordinator.getCurrentTime());
@@ -172,19 +256,131 @@ void ModelFactory::createModel(Coordinator& coordinator,
     }
 }
 
-void ModelFactory::createModels(Coordinator& coordinator,
-                                const vpz::Model& model)
+const value::Map& ModelFactory::initValues(
+    const std::vector < std::string >& conditions)
 {
-    vpz::AtomicModelVector atomicmodellist;
-    vpz::BaseModel* mdl = model.model();
+    InitValuesList::iterator it = mInitValues.find(conditions);
+    if (it != mInitValues.end()) {
+        return *it->second;
+    }
+
+    value::Map* result = new value::Map();
 
-    if (mdl) {
-        if (mdl->isAtomic()) {
-            atomicmodellist.push_back((vpz::AtomicModel*)mdl);
-        } else {
-            vpz::BaseModel::getAtomicModelList(mdl, atomicmodellist);
+    try {
+        fillInitValues(conditions, *result);
+    } catch (...) {
+        result->value().clear();
+        delete result;
+        throw;
+    }
+
+    mInitValues.insert(std::make_pair(conditions, result));
+    return *result;
+}
+
+void ModelFactory::fillInitValues(
+    const std::vector < std::string >& conditions,
+    value::Map& initValues) const
+{
+    for (std::vector < std::string >::const_iterator it = conditions.begin();
+         it != conditions.end(); ++it) {
+        const vpz::Condition& cnd(mExperiment->conditions().get(*it));
+        value::MapValue vl;
+        cnd.fillWithFirstValues(vl);
+
+        if (mOverlay and mOverlay->exist(*it)) {
+            const vpz::ConditionValues& overlay(
+                mOverlay->get(*it).conditionvalues());
+
+            for (vpz::ConditionValues::const_iterator itv =
+                 overlay.begin(); itv != overlay.end(); ++itv) {
+                if (not itv->second->empty()) {
+                    vl[itv->first] = itv->second->get(0);
+                }
+            }
+        }
+
+        for (value::MapValue::const_iterator itv = vl.begin();
+             itv != vl.end(); ++itv) {
+
+            if (initValues.exist(itv->first)) {
+                initValues.value().clear();
+                throw utils::InternalError(fmt(_(
+                        "Multiples condition with the same init port " \
+                        "name '%1%'")) % itv->first);
+            }
+            initValues.add(itv->first, itv->second);
         }
+    }
+}
 
+void ModelFactory::fillCellValues(const vpz::AtomicModel* model,
+                                  value::Map& initValues,
+                                  value::Map& cellValues) const
+{
+    const vpz::GridModel* grid = dynamic_cast < const vpz::GridModel* >(
+        model->getParent());
+
+    if (grid) {
+        grid->fillInitValues(model, cellValues);
+
+        for (value::MapValue::iterator itv = cellValues.begin();
+             itv != cellValues.end(); ++itv) {
+            if (initValues.exist(itv->first)) {
+                initValues.value().clear();
+                throw utils::InternalError(fmt(_(
+                        "Multiples condition with the same init port " \
+                        "name '%1%'")) % itv->first);
+            }
+            initValues.add(itv->first, itv->second);
+        }
+    }
+}
+
+void ModelFactory::getViews(
+    Coordinator& coordinator,
+    const std::string& observable,
+    std::vector < std::pair < View*, std::string > >& views) const
+{
+    const vpz::Observable& ob(
+        mExperiment->views().observables().get(observable));
+    const vpz::ObservablePortList& lst(ob.observableportlist());
+
+    for (vpz::ObservablePortList::const_iterator it = lst.begin();
+         it != lst.end(); ++it) {
+        const vpz::ViewNameList& vnlst(it->second.viewnamelist());
+        for (vpz::ViewNameList::const_iterator jt = vnlst.begin();
+             jt != vnlst.end(); ++jt) {
+
+            View* view = coordinator.getView(*jt);
+
+            if (not view) {
+                throw utils::InternalError(fmt(_(
+                            "The view '%1%' is unknow of coordinator "
+                            "view list")) % *jt);
+            }
+
+            views.push_back(std::make_pair(view, it->first));
+        }
+    }
+}
+
+void ModelFactory::createModels(Coordinator& coordinator,
+                                const Prototype* prototype,
+                                vpz::BaseModel* model)
+{
+    vpz::AtomicModelVector atomicmodellist;
+    vpz::BaseModel::getAtomicModelList(model, atomicmodellist);
+
+    if (prototype and
+        prototype->atomics.size() == atomicmodellist.size() and
+        not dynamic_cast < vpz::GridModel* >(model->getParent())) {
+        for (vpz::AtomicModelVector::size_type i = 0;
+             i < atomicmodellist.size(); ++i) {
+            createModel(coordinator, atomicmodellist[i],
+                        *prototype->atomics[i]);
+        }
+    } else {
         for (vpz::AtomicModelVector::iterator it = atomicmodellist.begin();
              it != atomicmodellist.end(); ++it) {
             createModel(coordinator,
@@ -196,34 +392,119 @@ void ModelFactory::createModels(Coordinator& coordinator,
     }
 }
 
+const ModelFactory::Prototype*
+ModelFactory::prototype(Coordinator& coordinator,
+                        const std::string& classname)
+{
+    PrototypeList::iterator it = mPrototypes.find(classname);
+    if (it != mPrototypes.end()) {
+        return it->second;
+    }
+
+    const vpz::Class& classe(mClasses->get(classname));
+    vpz::AtomicModelVector atomicmodellist;
+    /* the model of the class is only read. */
+    vpz::BaseModel::getAtomicModelList(
+        const_cast < vpz::BaseModel* >(classe.model()), atomicmodellist);
+
+    Prototype* result = new Prototype();
+
+    try {
+        for (vpz::AtomicModelVector::iterator jt = atomicmodellist.begin();
+             jt != atomicmodellist.end(); ++jt) {
+            if (dynamic_cast < vpz::GridModel* >((*jt)->getParent())) {
+                /* the initial values of the cells depend on the grid. */
+                delete result;
+                result = 0;
+                break;
+            }
+
+            AtomicPrototype* atom = new AtomicPrototype();
+            result->atomics.push_back(atom);
+
+            atom->dynamics = &mDynamics->get((*jt)->dynamics());
+            atom->symbol = getSymbol(*atom->dynamics, &atom->type);
+
+            const value::Map& shared(initValues((*jt)->conditions()));
+            for (value::MapValue::const_iterator itv = shared.begin();
+                 itv != shared.end(); ++itv) {
+                atom->initValues.add(itv->first,
+                                     static_cast < const value::Value* >(
+                                         itv->second));
+            }
+
+            if (not (*jt)->observables().empty()) {
+                getViews(coordinator, (*jt)->observables(), atom->views);
+            }
+        }
+    } catch (...) {
+        delete result;
+        throw;
+    }
+
+    mPrototypes[classname] = result;
+    return result;
+}
+
 vpz::BaseModel* ModelFactory::createModelFromClass(Coordinator& coordinator,
                                                  vpz::CoupledModel* parent,
                                                  const std::string& classname,
                                                  const std::string& modelname)
 {
-    vpz::Class& classe(mClasses.get(classname));
+    const vpz::Class& classe(mClasses->get(classname));
+    const Prototype* proto = prototype(coordinator, classname);
+
     vpz::BaseModel* mdl(classe.model()->clone());
-    vpz::AtomicModelVector atomicmodellist;
-    vpz::BaseModel::getAtomicModelList(mdl, atomicmodellist);
     parent->addModel(mdl, modelname);
+    createModels(coordinator, proto, mdl);
+
+    return mdl;
+}
+
+void ModelFactory::createModelsFromClass(
+    Coordinator& coordinator,
+    vpz::CoupledModel* parent,
+    const std::string& classname,
+    const std::vector < std::string >& modelnames,
+    std::vector < vpz::BaseModel* >* models)
+{
+    std::vector < std::string > names(modelnames);
+    std::sort(names.begin(), names.end());
+
+    for (std::vector < std::string >::size_type i = 0; i < names.size();
+         ++i) {
+        if ((i > 0 and names[i - 1] == names[i]) or parent->exist(names[i])) {
+            throw utils::DevsGraphError(fmt(
+                    _("Cannot build the model '%1%' from the class '%2%': "
+                      "the name already exists")) % names[i] % classname);
+        }
+    }
+
+    const vpz::Class& classe(mClasses->get(classname));
+    const Prototype* proto = prototype(coordinator, classname);
 
-    for (vpz::AtomicModelVector::iterator it = atomicmodellist.begin();
-         it != atomicmodellist.end(); ++it) {
-        createModel(coordinator,
-                    *it,
-                    (*it)->dynamics(),
-                    (*it)->conditions(),
-                    (*it)->observables());
+    if (models) {
+        models->reserve(models->size() + modelnames.size());
     }
 
-    return mdl;
+    for (std::vector < std::string >::const_iterator it = modelnames.begin();
+         it != modelnames.end(); ++it) {
+        vpz::BaseModel* mdl(classe.model()->clone());
+        parent->addModel(mdl, *it);
+        createModels(coordinator, proto, mdl);
+
+        if (models) {
+            models->push_back(mdl);
+        }
+    }
 }
 
 static devs::Dynamics* buildNewDynamicsWrapper(
     devs::Simulator* atom,
     const vpz::Dynamic& dyn,
     const InitEventList& events,
-    void* symbol)
+    void* symbol,
+    uint64_t seed)
 {
     typedef Dynamics*(*fctdw)(const DynamicsWrapperInit&, const InitEventList&);
 
@@ -234,7 +515,7 @@ static devs::Dynamics* buildNewDynamicsWrapper(
         return fct(DynamicsWrapperInit(
                 *atom->getStructure(),
                 pkg_table.get(dyn.package()),
-                dyn.library()), events);
+                dyn.library(), seed), events);
     } catch(const std::exception& e) {
         throw utils::ModellingError(
             fmt(_("Atomic model wrapper `%1%:%2%' (from dynamics `%3%'"
@@ -250,7 +531,8 @@ static devs::Dynamics* buildNewDynamics(
     devs::Simulator* atom,
     const vpz::Dynamic& dyn,
     const InitEventList& events,
-    void *symbol)
+    void *symbol,
+    uint64_t seed)
 {
     typedef Dynamics*(*fctdyn)(const DynamicsInit&, const InitEventList&);
 
@@ -260,7 +542,7 @@ static devs::Dynamics* buildNewDynamics(
         utils::PackageTable pkg_table;
         return fct(DynamicsInit(
                 *atom->getStructure(),
-                pkg_table.get(dyn.package())),
+                pkg_table.get(dyn.package()), seed),
             events);
     } catch(const std::exception& e) {
         throw utils::ModellingError(
@@ -277,7 +559,8 @@ static devs::Dynamics* buildNewExecutive(
     devs::Simulator* atom,
     const vpz::Dynamic& dyn,
     const InitEventList& events,
-    void *symbol)
+    void *symbol,
+    uint64_t seed)
 {
     typedef Dynamics*(*fctexe)(const ExecutiveInit&, const InitEventList&);
 
@@ -288,7 +571,7 @@ static devs::Dynamics* buildNewExecutive(
         return fct(ExecutiveInit(
                 *atom->getStructure(),
                 pkg_table.get(dyn.package()),
-                coordinator), events);
+                coordinator, seed), events);
     } catch(const std::exception& e) {
         throw utils::ModellingError(
             fmt(_("Executive model `%1%:%2%' (from dynamics `%3%'"
@@ -300,17 +583,302 @@ static devs::Dynamics* buildNewExecutive(
     }
 }
 
-devs::Dynamics* ModelFactory::attachDynamics(Coordinator& coordinator,
-                                             devs::Simulator* atom,
-                                             const vpz::Dynamic& dyn,
-                                             const InitEventList& events)
+/*
+ * An atomic model built by ModelFactory::createModels. The thread safe
+ * dynamics are built and initialized by the workers, the other ones by the
+ * registration loop.
+ */
+struct ModelJob
 {
-    void *symbol = NULL;
-    utils::ModuleType type = utils::MODULE_DYNAMICS;
+    ModelJob()
+        : model(0), dynamics(0), symbol(0), type(utils::MODULE_DYNAMICS),
+        events(0), cells(0), simulator(0), event(0), threadsafe(false),
+        registered(false)
+    {}
+
+    vpz::AtomicModel* model;
+    const vpz::Dynamic* dynamics;
+    void* symbol;
+    utils::ModuleType type;
+    const InitEventList* events;
+    value::Map* cells; /* the values of a cell of a GridModel. */
+    Simulator* simulator;
+    InternalEvent* event;
+    bool threadsafe;
+    bool registered;
+    std::string error;
+};
 
+/*
+ * The list of ModelJob, the simulators not registered into the coordinator
+ * and the values of the cells are deleted with the list.
+ */
+struct ModelJobList
+{
+    ~ModelJobList()
+    {
+        for (std::vector < ModelJob >::iterator it = jobs.begin();
+             it != jobs.end(); ++it) {
+            if (it->cells) {
+                const_cast < InitEventList* >(it->events)->value().clear();
+                delete it->events;
+                delete it->cells;
+            }
+
+            delete it->event;
+            if (not it->registered) {
+                delete it->simulator;
+            }
+        }
+    }
+
+    std::vector < ModelJob > jobs;
+};
+
+/*
+ * The boost thread functor which builds or initializes the thread safe
+ * dynamics. The jobs are taken by blocks from a shared index.
+ */
+struct ModelJobWorker
+{
+    ModelJobWorker(std::vector < ModelJob >& jobs, std::size_t& next,
+                   boost::mutex& mutex, const Time& time, uint64_t seed,
+                   bool initialize)
+        : jobs(jobs), next(next), mutex(mutex), time(time), seed(seed),
+        initialize(initialize)
+    {}
+
+    void operator()()
+    {
+        static const std::size_t block = 16;
+
+        for (;;) {
+            std::size_t first, last;
+            {
+                boost::mutex::scoped_lock lock(mutex);
+                first = next;
+                last = std::min(jobs.size(), first + block);
+                next = last;
+            }
+
+            if (first >= last) {
+                return;
+            }
+
+            for (std::size_t i = first; i < last; ++i) {
+                ModelJob& job(jobs[i]);
+
+                if (job.threadsafe and job.error.empty()) {
+                    try {
+                        if (initialize) {
+                            job.event = job.simulator->init(time);
+                        } else {
+                            job.simulator->addDynamics(buildNewDynamics(
+                                    job.simulator, *job.dynamics,
+                                    *job.events, job.symbol, seed));
+                        }
+                    } catch (const std::exception& e) {
+                        job.error.assign(e.what());
+                    } catch (...) {
+                        job.error.assign((fmt(_(
+                                "Atomic model `%1%' throws an unknown error"
+                                " in %2%")) % job.model->getName() %
+                                (initialize ? "init" : "constructor")).str());
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector < ModelJob >& jobs;
+    std::size_t& next;
+    boost::mutex& mutex;
+    const Time& time;
+    uint64_t seed;
+    bool initialize;
+};
+
+/*
+ * Build (initialize false) or initialize the thread safe dynamics of the
+ * jobs with a pool of threads.
+ */
+static void runModelJobs(std::vector < ModelJob >& jobs,
+                         uint32_t threads, const Time& time, uint64_t seed,
+                         bool initialize)
+{
+    std::size_t next = 0;
+    boost::mutex mutex;
+    boost::thread_group gp;
+
+    for (uint32_t i = 0; i < threads; ++i) {
+        gp.create_thread(ModelJobWorker(jobs, next, mutex, time, seed,
+                                        initialize));
+    }
+
+    gp.join_all();
+}
+
+void ModelFactory::createModels(Coordinator& coordinator,
+                                const vpz::Model& model)
+{
+    vpz::AtomicModelVector atomicmodellist;
+    vpz::BaseModel* mdl = model.model();
+
+    if (not mdl) {
+        return;
+    }
+
+    vpz::BaseModel::getAtomicModelList(mdl, atomicmodellist);
+
+    ModelJobList list;
+    std::vector < ModelJob >& jobs(list.jobs);
+    std::size_t threadsafe = 0;
+    const SimulatorMap& result(coordinator.modellist());
+    utils::Profile* profile = mRoot.profile();
+
+    jobs.resize(atomicmodellist.size());
+
+    /* first phase: resolve the dynamics and open their modules, then
+     * compute the initial values of each model and build the
+     * simulators. */
+    {
+        utils::ProfileScope scope(profile, "modules");
+        std::map < const vpz::Dynamic*, ModelJob > modules;
+
+        for (vpz::AtomicModelVector::size_type i = 0;
+             i < atomicmodellist.size(); ++i) {
+            ModelJob& job(jobs[i]);
+            job.model = atomicmodellist[i];
+
+            if (result.find(job.model) != result.end()) {
+                throw utils::InternalError(fmt(_(
+                        "The model '%1%' already exist in coordinator")) %
+                    job.model->getName());
+            }
+
+            job.dynamics = &mDynamics->get(job.model->dynamics());
+
+            std::map < const vpz::Dynamic*, ModelJob >::iterator it =
+                modules.find(job.dynamics);
+            if (it == modules.end()) {
+                ModelJob& module(modules[job.dynamics]);
+                module.symbol = getSymbol(*job.dynamics, &module.type);
+                module.threadsafe = mRoot.initThreads() > 1 and
+                    module.type == utils::MODULE_DYNAMICS and
+                    mModuleMgr.getSymbol(job.dynamics->package(),
+                                         job.dynamics->library(),
+                                         utils::MODULE_DYNAMICS,
+                                         "vle_dynamics_thread_safe");
+                it = modules.find(job.dynamics);
+            }
+
+            job.symbol = it->second.symbol;
+            job.type = it->second.type;
+            job.threadsafe = it->second.threadsafe;
+            if (job.threadsafe) {
+                ++threadsafe;
+            }
+        }
+
+        scope.setCount(modules.size());
+    }
+
+    {
+        utils::ProfileScope scope(profile, "conditions");
+        scope.setCount(jobs.size());
+
+        for (std::vector < ModelJob >::iterator it = jobs.begin();
+             it != jobs.end(); ++it) {
+            it->events = &initValues(it->model->conditions());
+
+            if (dynamic_cast < vpz::GridModel* >(it->model->getParent())) {
+                value::Map* events = new value::Map();
+                events->value() = it->events->value();
+                it->events = events;
+                it->cells = new value::Map();
+                fillCellValues(it->model, *events, *it->cells);
+            }
+
+            it->simulator = new Simulator(it->model);
+        }
+    }
+
+    utils::ProfileScope scope(profile, "dynamics");
+    scope.setCount(jobs.size());
+
+    uint32_t threads = std::min(
+        static_cast < std::size_t >(mRoot.initThreads()), threadsafe);
+
+    /* second phase: build the thread safe dynamics. */
+    if (threadsafe > 0) {
+        runModelJobs(jobs, threads, coordinator.getCurrentTime(),
+                     mRoot.seed(), false);
+    }
+
+    /* third phase: in the order of the models, register the simulators
+     * and their observables into the coordinator, the other dynamics are
+     * built and initialized as in createModel. */
+    for (std::vector < ModelJob >::iterator it = jobs.begin();
+         it != jobs.end(); ++it) {
+        if (not it->error.empty()) {
+            throw utils::ModellingError(it->error);
+        }
+
+        coordinator.addModel(it->model, it->simulator);
+        it->registered = true;
+
+        if (not it->threadsafe) {
+            it->simulator->addDynamics(attachDynamics(coordinator,
+                                                      it->simulator,
+                                                      *it->dynamics,
+                                                      *it->events,
+                                                      it->symbol,
+                                                      it->type));
+        }
+
+        if (not it->model->observables().empty()) {
+            std::vector < std::pair < View*, std::string > > views;
+            getViews(coordinator, it->model->observables(), views);
+
+            for (std::vector < std::pair < View*, std::string > >::iterator
+                 jt = views.begin(); jt != views.end(); ++jt) {
+                jt->first->addObservable(it->simulator, jt->second,
+                                         coordinator.getCurrentTime());
+            }
+        }
+
+        if (not it->threadsafe) {
+            it->event = it->simulator->init(coordinator.getCurrentTime());
+        }
+    }
+
+    /* fourth phase: initialize the thread safe dynamics, after their
+     * observables are registered as in the serial createModel. */
+    if (threadsafe > 0) {
+        runModelJobs(jobs, threads, coordinator.getCurrentTime(),
+                     mRoot.seed(), true);
+    }
+
+    /* the first internal events are pushed in the order of the models. */
+    for (std::vector < ModelJob >::iterator it = jobs.begin();
+         it != jobs.end(); ++it) {
+        if (not it->error.empty()) {
+            throw utils::ModellingError(it->error);
+        }
+
+        if (it->event) {
+            coordinator.eventtable().putInternalEvent(it->event);
+            it->event = 0;
+        }
+    }
+}
+
+void* ModelFactory::getSymbol(const vpz::Dynamic& dyn,
+                              utils::ModuleType* type) const
+{
     try {
-        symbol = mModuleMgr.get(dyn.package(), dyn.library(),
-                                utils::MODULE_DYNAMICS, &type);
+        return mModuleMgr.get(dyn.package(), dyn.library(),
+                              utils::MODULE_DYNAMICS, type);
     } catch (const std::exception& e) {
         throw utils::ModellingError(fmt(
                 _("Dynamic library loading problem: cannot get any"
@@ -318,14 +886,42 @@ devs::Dynamics* ModelFactory::attachDynamics(Coordinator& coordinator,
                   " '%2%' package '%3%'\n:%4%")) % dyn.name() %
             dyn.library() % dyn.package() % e.what());
     }
+}
+
+devs::Dynamics* ModelFactory::attachDynamics(Coordinator& coordinator,
+                                             devs::Simulator* atom,
+                                             const vpz::Dynamic& dyn,
+                                             const InitEventList& events)
+{
+    utils::ModuleType type = utils::MODULE_DYNAMICS;
+    void *symbol = getSymbol(dyn, &type);
 
+    return attachDynamics(coordinator, atom, dyn, events, symbol, type);
+}
+
+devs::Dynamics* ModelFactory::attachDynamics(Coordinator& coordinator,
+                                             devs::Simulator* atom,
+                                             const vpz::Dynamic& dyn,
+                                             const InitEventList& events,
+                                             void* symbol,
+                                             utils::ModuleType type)
+{
     switch (type) {
     case utils::MODULE_DYNAMICS:
-        return buildNewDynamics(atom, dyn, events, symbol);
+        return buildNewDynamics(atom, dyn, events, symbol, mRoot.seed());
     case utils::MODULE_DYNAMICS_EXECUTIVE:
-        return buildNewExecutive(coordinator, atom, dyn, events, symbol);
+        if (mOverlay) {
+            throw utils::ModellingError(fmt(
+                    _("Executive model `%1%:%2%' can not be used with a"
+                      " shared model hierarchy")) %
+                atom->getStructure()->getParentName() %
+                atom->getStructure()->getName());
+        }
+        return buildNewExecutive(coordinator, atom, dyn, events, symbol,
+                                 mRoot.seed());
     case utils::MODULE_DYNAMICS_WRAPPER:
-        return buildNewDynamicsWrapper(atom, dyn, events, symbol);
+        return buildNewDynamicsWrapper(atom, dyn, events, symbol,
+                                       mRoot.seed());
     default:
         throw utils::ModellingError();
     }
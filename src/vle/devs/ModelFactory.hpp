@@ -45,6 +45,7 @@ class RootCoordinator;
 class Coordinator;
 class Simulator;
 class Dynamics;
+class View;
 
 
 /**
@@ -67,91 +68,143 @@ public:
                  const vpz::Experiment& experiment,
                  RootCoordinator& root);
 
+    /**
+     * @brief Build a new ModelFactory for a model hierarchy shared between
+     * several simulations. The dynamics, the classes and the experiment
+     * are neither copied nor modified, they must live as long as the
+     * ModelFactory. The initial values of the ports of the conditions
+     * found in the overlay replace the first values of the ports of the
+     * vpz::Conditions. Executive models are not allowed in this mode since
+     * they modify the model hierarchy.
+     *
+     * @param dyn the shared vpz::Dynamics.
+     * @param cls the shared vpz::Classes.
+     * @param experiment the shared vpz::Experiment.
+     * @param name the name of the experiment of this simulation.
+     * @param overlay the values of the conditions specific to this
+     * simulation, it must live as long as the ModelFactory.
+     */
+    ModelFactory(const utils::ModuleManager& modulemgr,
+                 const vpz::Dynamics& dyn,
+                 const vpz::Classes& cls,
+                 const vpz::Experiment& experiment,
+                 RootCoordinator& root,
+                 const std::string& name,
+                 const vpz::Conditions& overlay);
+
+    /**
+     * @brief Delete the prototypes of the classes and the copies of the
+     * dynamics, the classes and the experiment.
+     */
+    ~ModelFactory();
+
     /**
      * @brief Return the reference to the list of initiale conditions for
      * each models.
      * @return A constant reference to the vpz::Conditions.
      */
     inline const vpz::Conditions& conditions() const
-    { return mExperiment.conditions(); }
+    { return mExperiment->conditions(); }
 
     /**
      * @brief Return the reference to the list of dynamcis.
      * @return A constant reference to the vpz::Dynamics.
      */
     inline const vpz::Dynamics& dynamics() const
-    { return mDynamics; }
+    { return *mDynamics; }
 
     /**
      * @brief Return the reference to the list of views.
      * @return A constant reference to the vpz::Views.
      */
     inline const vpz::Views& views() const
-    { return mExperiment.views(); }
+    { return mExperiment->views(); }
 
     /**
      * @brief Return the reference to the list of outputs.
      * @return A constant reference to the vpz::Outputs.
      */
     inline const vpz::Outputs& outputs() const
-    { return mExperiment.views().outputs(); }
+    { return mExperiment->views().outputs(); }
 
     /**
      * @brief Return the reference to the experiment object.
      * @return A constant reference to the vpz::Experiment.
      */
     inline const vpz::Experiment& experiment() const
-    { return mExperiment; }
+    { return *mExperiment; }
 
     /**
      * @brief Return the reference to the observables object.
      * @return A constant reference to the vpz::Observables.
      */
     inline const vpz::Observables& observables() const
-    { return mExperiment.views().observables(); }
+    { return mExperiment->views().observables(); }
+
+    /**
+     * @brief Return the name of the experiment of the simulation.
+     * @return A constant reference to the name.
+     */
+    inline const std::string& experimentName() const
+    { return mExperimentName; }
 
     /**
      * @brief Return the reference to the list of initiale conditions for
-     * each models.
+     * each models. The shared initial values are dropped since the
+     * conditions can be modified.
      * @return A reference to the vpz::Conditions.
      */
     inline vpz::Conditions& conditions()
-    { return mExperiment.conditions(); }
+    { clearInitValues(); return modifiableExperiment().conditions(); }
 
     /**
      * @brief Return the reference to the list of dynamcis.
      * @return A constant reference to the vpz::Dynamics.
      */
     inline vpz::Dynamics& dynamics()
-    { return mDynamics; }
+    { own(); return *const_cast < vpz::Dynamics* >(mDynamics); }
 
     /**
      * @brief Return the reference to the list of views.
      * @return A reference to the vpz::Views.
      */
     inline vpz::Views& views()
-    { return mExperiment.views(); }
+    { return modifiableExperiment().views(); }
 
     /**
      * @brief Return the reference to the list of outputs.
      * @return A reference to the vpz::Outputs.
      */
     inline vpz::Outputs& outputs()
-    { return mExperiment.views().outputs(); }
+    { return modifiableExperiment().views().outputs(); }
 
     /**
-     * @brief Return the reference to the experiment object.
+     * @brief Return the reference to the experiment object. The shared
+     * initial values are dropped since the conditions can be modified.
      * @return A reference to the vpz::Experiment.
      */
     inline vpz::Experiment& experiment()
-    { return mExperiment; }
+    { clearInitValues(); return modifiableExperiment(); }
 
     /**
      * @brief Return the reference to the observables object.
      * @return A constant reference to the vpz::Observables.
      */
     inline vpz::Observables& observables()
-    { return mExperiment.views().observables(); }
+    { return modifiableExperiment().views().observables(); }
+
+    /**
+     * @brief Get the initial values of the models built with the list of
+     * conditions. The map is built once and shared by these models until
+     * the conditions can be modified. It does not own its values, they
+     * are the first values of the ports of the conditions.
+     * @param conditions The names of the conditions.
+     * @return A constant reference to the shared initial values.
+     * @throw utils::ArgError if a condition does not exist.
+     * @throw utils::InternalError if a port is defined twice.
+     */
+    const value::Map& initValues(
+        const std::vector < std::string >& conditions);
 
     //
     ///
@@ -162,7 +215,8 @@ public:
 
     /**
      * @brief Remove all atomic model information that have no the tag
-     * permantent in the VPZ format.
+     * permantent in the VPZ format, the prototypes of the classes and the
+     * shared initial values.
      */
     void cleanCache();
 
@@ -208,11 +262,29 @@ public:
      * @brief Build a list of devs::Simulator from the dynamics library
      * corresponding to the atomic models from the specified graph
      * hierarchy.
+     *
+     * The dynamics declared with DECLARE_DYNAMICS_THREAD_SAFE are built by
+     * getThreads() threads. Then, in the order of the atomic models, the
+     * simulators and their observables are registered into the
+     * coordinator and the other dynamics are built and initialized. The
+     * thread safe dynamics are then initialized by the threads, so each
+     * dynamics is initialized after its observables are registered, as
+     * with createModel. Finally, the first internal events are pushed in
+     * the order of the atomic models. The "modules", "conditions" and
+     * "dynamics" phases are recorded into the profile of the
+     * RootCoordinator.
      * @param coordinator the coordinator where attach the simulator.
      * @param model the hierachy of model (coupled model) or atomic model.
      */
     void createModels(Coordinator& coordinator, const vpz::Model& vpmdl);
 
+    /**
+     * @brief Get the RootCoordinator of the simulation.
+     * @return A reference to the RootCoordinator.
+     */
+    RootCoordinator& root() const
+    { return mRoot; }
+
     /**
      * @brief Build a new devs::Simulator from the vpz::Classes information.
      * @param classname the name of the class to clone.
@@ -225,18 +297,124 @@ public:
                                        const std::string& classname,
                                        const std::string& modelname);
 
+    /**
+     * @brief Build a list of models and their devs::Simulator from the
+     * same vpz::Class.
+     *
+     * The first time a class is instantiated, it is compiled into a
+     * prototype: the symbols of the dynamics of its atomic models, their
+     * initial values and their views are computed once and shared by all
+     * the instances. The modifications of the dynamics, conditions or
+     * observables used by the class after its first instantiation are
+     * ignored until cleanCache(). Each model is a clone of the model of the
+     * class: the executives change the ports, the connections and the
+     * names of the instances, so only the prototype is shared.
+     * @param coordinator the coordinator where attach the simulators.
+     * @param parent the parent of the models.
+     * @param classname the name of the class to clone.
+     * @param modelnames the names of the new models.
+     * @param models if not null, filled with the new models.
+     * @throw utils::DevsGraphError if a name is duplicated or already
+     * exists in the parent, no model is built in this case.
+     */
+    void createModelsFromClass(Coordinator& coordinator,
+                               vpz::CoupledModel* parent,
+                               const std::string& classname,
+                               const std::vector < std::string >& modelnames,
+                               std::vector < vpz::BaseModel* >* models = 0);
+
 private:
+    /**
+     * The compiled form of an atomic model of a vpz::Class.
+     */
+    struct AtomicPrototype
+    {
+        AtomicPrototype()
+            : dynamics(0), symbol(0), type(utils::MODULE_DYNAMICS)
+        {}
+
+        const vpz::Dynamic* dynamics;
+        void* symbol;
+        utils::ModuleType type;
+        value::Map initValues;
+        std::vector < std::pair < View*, std::string > > views;
+    };
+
+    /**
+     * The compiled form of a vpz::Class: the atomic models in the order of
+     * vpz::BaseModel::getAtomicModelList.
+     */
+    struct Prototype
+    {
+        ~Prototype();
+
+        std::vector < AtomicPrototype* > atomics;
+    };
+
+    /** The prototypes of the classes, null if the class can not be
+     * compiled. */
+    typedef std::map < std::string, Prototype* > PrototypeList;
+
+    /** The initial values of a list of conditions. The values are not
+     * owned, they are the first values of the ports of the conditions. */
+    typedef std::map < std::vector < std::string >, value::Map* >
+        InitValuesList;
+
     ModelFactory(const ModelFactory& other);
     ModelFactory& operator=(const ModelFactory& other);
 
     const utils::ModuleManager& mModuleMgr; /**< A reference to the
                                               utils::ModuleManager. */
 
-    vpz::Dynamics           mDynamics; /**< List of available vpz::Dynamics. */
-    vpz::Classes            mClasses; /**< List of available vpz::Classes. */
-    vpz::Experiment         mExperiment; /**< A reference to the
-                                           vpz::Experiment. */
+    const vpz::Dynamics*    mDynamics; /**< List of available
+                                         vpz::Dynamics. */
+    const vpz::Classes*     mClasses; /**< List of available vpz::Classes. */
+    const vpz::Experiment*  mExperiment; /**< The vpz::Experiment. */
+    bool                    mOwner; /**< true if the dynamics, the classes
+                                      and the experiment are copies owned
+                                      by the ModelFactory. */
+    std::string             mExperimentName; /**< The name of the
+                                               experiment. */
     RootCoordinator&        mRoot;
+    const vpz::Conditions*  mOverlay; /**< The conditions of a shared
+                                        model hierarchy or null. */
+    PrototypeList           mPrototypes; /**< The compiled classes. */
+    InitValuesList          mInitValues; /**< The initial values shared
+                                           by the models. */
+
+    const Prototype* prototype(Coordinator& coordinator,
+                               const std::string& classname);
+
+    void clearPrototypes();
+
+    /**
+     * Copy the shared dynamics, classes and experiment before their first
+     * modification.
+     */
+    void own();
+
+    vpz::Experiment& modifiableExperiment()
+    { own(); return *const_cast < vpz::Experiment* >(mExperiment); }
+
+    void clearInitValues();
+
+    void fillInitValues(const std::vector < std::string >& conditions,
+                        value::Map& initValues) const;
+
+    void fillCellValues(const vpz::AtomicModel* model, value::Map& initValues,
+                        value::Map& cellValues) const;
+
+    void getViews(Coordinator& coordinator, const std::string& observable,
+                  std::vector < std::pair < View*, std::string > >& views)
+        const;
+
+    void* getSymbol(const vpz::Dynamic& dyn, utils::ModuleType* type) const;
+
+    void createModel(Coordinator& coordinator, vpz::AtomicModel* model,
+                     const AtomicPrototype& prototype);
+
+    void createModels(Coordinator& coordinator, const Prototype* prototype,
+                      vpz::BaseModel* model);
 
     /**
      * Try to open the plug-in and return the type of opened plugin
@@ -267,6 +445,13 @@ private:
                                    devs::Simulator* atom,
                                    const vpz::Dynamic& dyn,
                                    const InitEventList& events);
+
+    devs::Dynamics* attachDynamics(Coordinator& coordinator,
+                                   devs::Simulator* atom,
+                                   const vpz::Dynamic& dyn,
+                                   const InitEventList& events,
+                                   void* symbol,
+                                   utils::ModuleType type);
 };
 
 }} // namespace vle devs
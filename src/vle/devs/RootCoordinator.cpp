@@ -27,6 +27,8 @@
 
 #include <vle/devs/RootCoordinator.hpp>
 #include <vle/devs/Coordinator.hpp>
+#include <vle/utils/Profile.hpp>
+#include <vle/utils/Philox.hpp>
 
 namespace vle { namespace devs {
 
@@ -64,8 +66,9 @@ static value::Map * getMatrixFromView(const ViewList &views)
                        /* - - - - - - - - - -*/
 
 RootCoordinator::RootCoordinator(const utils::ModuleManager& modulemgr)
-    : m_rand(0), m_begin(0), m_currentTime(0), m_end(1.0), m_result(0),
-      m_coordinator(0), m_root(0), m_modulemgr(modulemgr)
+    : m_rand(0), m_combination(0), m_replica(0), m_seed(0), m_instance(0),
+      m_begin(0), m_currentTime(0), m_end(1.0), m_result(0), m_coordinator(0),
+      m_root(0), m_profile(0), m_initThreads(1), m_modulemgr(modulemgr)
 {
 }
 
@@ -85,18 +88,65 @@ void RootCoordinator::load(const vpz::Vpz& io)
     m_begin = io.project().experiment().begin();
     m_end = m_begin + io.project().experiment().duration();
     m_currentTime = m_begin;
+    m_instance = io.project().instance();
 
-    m_coordinator = new Coordinator(m_modulemgr,
-                                    io.project().dynamics(),
-                                    io.project().classes(),
-                                    io.project().experiment(),
-                                    *this);
+    initStreams(io.project().experiment());
+
+    {
+        utils::ProfileScope scope(m_profile, "coordinator");
+        scope.setCount(
+            io.project().experiment().conditions().conditionlist().size());
+
+        m_coordinator = new Coordinator(m_modulemgr,
+                                        io.project().dynamics(),
+                                        io.project().classes(),
+                                        io.project().experiment(),
+                                        *this);
+    }
 
     m_coordinator->init(io.project().model(), m_currentTime, m_end);
 
     m_root = io.project().model().model();
 }
 
+void RootCoordinator::load(const vpz::Vpz& io, const std::string& experiment,
+                           int instance, const vpz::Conditions& overlay)
+{
+    if (m_coordinator) {
+        delete m_coordinator;
+        delete m_root;
+        m_root = 0;
+    }
+
+    m_begin = io.project().experiment().begin();
+    m_end = m_begin + io.project().experiment().duration();
+    m_currentTime = m_begin;
+    m_instance = instance;
+
+    initStreams(io.project().experiment());
+
+    {
+        utils::ProfileScope scope(m_profile, "coordinator");
+        scope.setCount(
+            io.project().experiment().conditions().conditionlist().size());
+
+        m_coordinator = new Coordinator(m_modulemgr,
+                                        io.project().dynamics(),
+                                        io.project().classes(),
+                                        io.project().experiment(),
+                                        *this, experiment, overlay);
+    }
+
+    m_coordinator->init(io.project().model(), m_currentTime, m_end);
+}
+
+void RootCoordinator::initStreams(const vpz::Experiment& experiment)
+{
+    /* The legacy generator keeps its seed 0: the simulations which use
+     * it are not changed by the streams. */
+    m_seed = utils::Philox::key(experiment.seed(), m_combination, m_replica);
+}
+
 void RootCoordinator::init()
 {
     m_currentTime = m_begin;
@@ -116,6 +166,11 @@ bool RootCoordinator::run()
     return true;
 }
 
+uint64_t RootCoordinator::events() const
+{
+    return m_coordinator ? m_coordinator->events() : 0;
+}
+
 void RootCoordinator::finish()
 {
     if (m_coordinator) {
@@ -40,6 +40,12 @@ namespace vle { namespace vpz {
 
 }} // namespace vle graph
 
+namespace vle { namespace utils {
+
+    class Profile;
+
+}} // namespace vle utils
+
 namespace vle { namespace devs {
 
     class Coordinator;
@@ -64,6 +70,23 @@ namespace vle { namespace devs {
          */
         void load(const vpz::Vpz& vp);
 
+        /**
+         * @brief initialise a new Coordinator with a vpz::Vpz shared with
+         * other simulations. The model hierarchy is neither copied nor
+         * deleted by the RootCoordinator and must not be modified until the
+         * end of the simulation, executive models are not allowed. The
+         * experiment name and the values of the conditions specific to this
+         * simulation come from the overlay. The dynamics, the classes and
+         * the experiment are not copied (see ModelFactory).
+         * @param vp a reference to a structure shared between simulations.
+         * @param experiment the name of the experiment of this simulation.
+         * @param instance the number of the instance of this simulation.
+         * @param overlay the values of the conditions of this simulation.
+         * This object must live until the end of the simulation.
+         */
+        void load(const vpz::Vpz& vp, const std::string& experiment,
+                  int instance, const vpz::Conditions& overlay);
+
         /**
          * @brief Initialise RootCoordinator and his Coordinator: initiale time
          * is define, coordinator init function is call.
@@ -90,6 +113,14 @@ namespace vle { namespace devs {
         inline const Time& getCurrentTime()
         { return m_currentTime; }
 
+        /**
+         * @brief Return the number of internal and external events
+         * processed by the coordinator.
+         * @return The number of events, 0 before the load or after the
+         * finish.
+         */
+        uint64_t events() const;
+
         /**
          * Return an allocated \c value::Map.
          *
@@ -102,17 +133,86 @@ namespace vle { namespace devs {
         value::Map * outputs() { return m_result; }
 
         /**
-         * @brief Return a reference to the random generator.
+         * @brief Return a reference to the random generator. It is seeded
+         * with 0 and is independent of the random streams.
          * @return Return a reference to the random generator.
          */
         utils::Rand& rand() { return m_rand; }
 
+        /**
+         * @brief Assign the combination and the replica of the next
+         * simulations. With the seed of the experiment, they define the key
+         * of the random streams of the simulation (see utils::Philox::key).
+         * @param combination The combination number.
+         * @param replica The replica number.
+         */
+        void setStream(uint32_t combination, uint32_t replica)
+        { m_combination = combination; m_replica = replica; }
+
+        /**
+         * @brief Get the key of the random streams of the simulation, valid
+         * after the load() function. The random generator of each model is
+         * the stream of its complete name (see Dynamics::getRandomStream).
+         * @return The key of the random streams.
+         */
+        uint64_t seed() const { return m_seed; }
+
+        /**
+         * @brief Get the number of the instance of the simulation, valid
+         * after the load() function (see vpz::Project::instance).
+         * @return The number of the instance.
+         */
+        int instance() const { return m_instance; }
+
+        /**
+         * @brief Assign a profile to record the wall time, the CPU time, the
+         * peak RSS and the number of items of each phase of the load() and
+         * init() functions (coordinator, modules, conditions, dynamics,
+         * views, graph).
+         * @param profile The profile, null to disable the profiling. It is
+         * not deleted by the RootCoordinator.
+         */
+        void setProfile(utils::Profile* profile) { m_profile = profile; }
+
+        /**
+         * @brief Get the profile of the load() and init() phases.
+         * @return The profile or null.
+         */
+        utils::Profile* profile() const { return m_profile; }
+
+        /**
+         * @brief Set the number of threads used by load() to build the
+         * thread safe dynamics. 1 by default, all the dynamics are then
+         * built by the calling thread.
+         * @param threads The number of threads, 0 is replaced by 1.
+         */
+        void setInitThreads(uint32_t threads)
+        { m_initThreads = threads ? threads : 1; }
+
+        /**
+         * @brief Get the number of threads used to build the thread safe
+         * dynamics.
+         * @return The number of threads.
+         */
+        uint32_t initThreads() const { return m_initThreads; }
+
     private:
         RootCoordinator(const RootCoordinator& other);
         RootCoordinator& operator=(const RootCoordinator& other);
 
+        /**
+         * @brief Compute the key of the random streams from the experiment.
+         * The random generator returned by rand() is not reseeded.
+         */
+        void initStreams(const vpz::Experiment& experiment);
+
         utils::Rand         m_rand;
 
+        uint32_t            m_combination;
+        uint32_t            m_replica;
+        uint64_t            m_seed;
+        int                 m_instance;
+
         /** @brief Store the beginning of the simulation. */
         devs::Time          m_begin;
 
@@ -127,7 +227,8 @@ namespace vle { namespace devs {
 
         Coordinator*        m_coordinator;
         vpz::BaseModel*     m_root;
-
+        utils::Profile*     m_profile;
+        uint32_t            m_initThreads;
 
         const utils::ModuleManager& m_modulemgr;
     };
@@ -29,6 +29,7 @@
 #include <vle/devs/Dynamics.hpp>
 #include <vle/devs/Time.hpp>
 #include <vle/vpz/AtomicModel.hpp>
+#include <cassert>
 
 namespace vle { namespace devs {
 
@@ -57,30 +58,31 @@ void Simulator::clear()
 void
 Simulator::updateSimulatorTargets(
         const std::string& port,
-        std::map < vpz::AtomicModel*, devs::Simulator* >& simulators)
+        std::map < vpz::AtomicModel*, devs::Simulator* >& simulators,
+        const vpz::FlatGraph& graph)
 {
     mTargets.erase(port);
 
-    vpz::ModelPortList result;
-    m_atomicModel->getAtomicModelsTarget(port, result);
+    uint32_t id = graph.id(m_atomicModel);
+    assert(id != vpz::FlatGraph::npos);
 
-    if (result.begin() == result.end()) {
+    vpz::FlatGraph::EdgeRange edges(graph.targets(id, graph.portId(port)));
+
+    if (edges.first == edges.second) {
         mTargets.insert(value_type(port, TargetSimulator(
-                   (Simulator*)0, std::string())));
+                    (Simulator*)0, std::string())));
     } else {
-        for (vpz::ModelPortList::iterator it = result.begin(); it !=
-                result.end(); ++it) {
-
-            std::map < vpz::AtomicModel*, devs::Simulator* >::iterator target;
-            target = simulators.find(
-                    reinterpret_cast < vpz::AtomicModel*>(it->first));
+        for (const vpz::FlatGraph::Edge* it = edges.first;
+             it != edges.second; ++it) {
+            std::map < vpz::AtomicModel*, devs::Simulator* >::iterator
+                target = simulators.find(graph.model(it->model));
 
             if (target == simulators.end()) {
                 mTargets.erase(port);
                 break;
             } else {
                 mTargets.insert(std::make_pair(port, TargetSimulator(
-                            target->second, it->second)));
+                            target->second, graph.portName(it->port))));
             }
         }
     }
@@ -89,12 +91,13 @@ Simulator::updateSimulatorTargets(
 std::pair < Simulator::iterator, Simulator::iterator >
 Simulator::targets(
     const std::string& port,
-    std::map < vpz::AtomicModel*, devs::Simulator* >& simulators)
+    std::map < vpz::AtomicModel*, devs::Simulator* >& simulators,
+    const vpz::FlatGraph& graph)
 {
     std::pair < iterator, iterator > x = mTargets.equal_range(port);
 
     if (x.first == x.second) {
-        updateSimulatorTargets(port, simulators);
+        updateSimulatorTargets(port, simulators, graph);
         x = mTargets.equal_range(port);
     } else if (x.first->second.first == 0) {
         x = make_pair(mTargets.end(), mTargets.end());
@@ -35,6 +35,7 @@
 #include <vle/devs/ExternalEventList.hpp>
 #include <vle/devs/Dynamics.hpp>
 #include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/FlatGraph.hpp>
 
 namespace vle { namespace devs {
 
@@ -115,25 +116,31 @@ namespace vle { namespace devs {
                              /*-*-*-*-*-*-*-*-*-*/
 
         /**
-         * @brief Call this function to browse the model's structure (atomic
-         * and coupled models) to find all devs::Simulator connected to the
-         * specified output port.
+         * @brief Call this function to find all devs::Simulator connected to
+         * the specified output port. The connections are read from the
+         * vpz::FlatGraph: the Coordinator builds it at init and updates it
+         * for each simulator added afterwards, so the model is always in
+         * the graph when events are dispatched.
          * @param port The output port used to build simulators' target list.
          * @param simulators list of available simulators.
+         * @param graph the atomic to atomic connections.
          */
         void updateSimulatorTargets(
             const std::string& port,
-            std::map < vpz::AtomicModel*, devs::Simulator* >& simulators);
+            std::map < vpz::AtomicModel*, devs::Simulator* >& simulators,
+            const vpz::FlatGraph& graph);
 
         /**
          * @brief Get two iterators (begin, end) on TargetSimulator.
          * @param port The output port to get the simulators' target list.
          * @param simulators list of available simulators.
+         * @param graph the atomic to atomic connections.
          * @return Two iterators.
          */
         std::pair < iterator, iterator > targets(
             const std::string& port,
-            std::map < vpz::AtomicModel*, devs::Simulator* >& simulators);
+            std::map < vpz::AtomicModel*, devs::Simulator* >& simulators,
+            const vpz::FlatGraph& graph);
 
         /**
          * @brief Add an empty target port.
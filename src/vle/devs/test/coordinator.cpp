@@ -33,16 +33,29 @@
 #include <boost/test/auto_unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/filesystem.hpp>
 #include <stdexcept>
 #include <limits>
 #include <fstream>
 #include <vle/devs/Coordinator.hpp>
+#include <vle/devs/Executive.hpp>
+#include <vle/devs/ModelFactory.hpp>
+#include <vle/devs/ObservationEvent.hpp>
 #include <vle/devs/RootCoordinator.hpp>
 #include <vle/vpz/CoupledModel.hpp>
 #include <vle/vpz/Dynamics.hpp>
 #include <vle/vpz/Experiment.hpp>
+#include <vle/vpz/GridModel.hpp>
 #include <vle/vpz/Classes.hpp>
+#include <vle/vpz/Vpz.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
 #include <vle/utils/ModuleManager.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include <vle/utils/Package.hpp>
+#include <vle/utils/Path.hpp>
+#include <vle/utils/i18n.hpp>
+#include <cstdlib>
 
 using namespace vle;
 
@@ -65,3 +78,524 @@ BOOST_AUTO_TEST_CASE(test_del_coupled_model)
     delete depth0;
     delete simdepth2;
 }
+
+BOOST_AUTO_TEST_CASE(test_model_indexes)
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    devs::Coordinator coord(modules,dyns,classes,expe,root);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vpz::CoupledModel* sub(top->addCoupledModel("sub"));
+    vpz::AtomicModel* a = sub->addAtomicModel("a");
+    vpz::AtomicModel* b = top->addAtomicModel("b");
+    devs::Simulator* sima = new devs::Simulator(a);
+    devs::Simulator* simb = new devs::Simulator(b);
+    coord.addModel(a, sima);
+
+    BOOST_REQUIRE_EQUAL(coord.getModel("a"), sima);
+    BOOST_REQUIRE_EQUAL(coord.getModelFromPath("top,sub,a"), sima);
+    BOOST_REQUIRE(not coord.getModel("b"));
+    BOOST_REQUIRE(not coord.getModelFromPath("top,b"));
+
+    coord.addModel(b, simb);
+    BOOST_REQUIRE_EQUAL(coord.getModel("b"), simb);
+    BOOST_REQUIRE_EQUAL(coord.getModelFromPath("top,b"), simb);
+
+    coord.renameModel(sub, "sub2");
+    BOOST_REQUIRE(not coord.getModelFromPath("top,sub,a"));
+    BOOST_REQUIRE_EQUAL(coord.getModelFromPath("top,sub2,a"), sima);
+
+    coord.renameModel(a, "c");
+    BOOST_REQUIRE(not coord.getModel("a"));
+    BOOST_REQUIRE_EQUAL(coord.getModel("c"), sima);
+    BOOST_REQUIRE_EQUAL(coord.getModelFromPath("top,sub2,c"), sima);
+
+    BOOST_REQUIRE_THROW(coord.renameModel(b, "sub2"), utils::DevsGraphError);
+    BOOST_REQUIRE_EQUAL(coord.getModel("b"), simb);
+    BOOST_REQUIRE_EQUAL(coord.getModelFromPath("top,b"), simb);
+
+    coord.delModel(top, "b");
+    BOOST_REQUIRE(not coord.getModel("b"));
+    BOOST_REQUIRE(not coord.getModelFromPath("top,b"));
+
+    coord.delModel(top, "sub2");
+    BOOST_REQUIRE(not coord.getModel("c"));
+    BOOST_REQUIRE(not coord.getModelFromPath("top,sub2,c"));
+
+    delete top;
+    delete sima;
+    delete simb;
+}
+
+BOOST_AUTO_TEST_CASE(test_find_model)
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    devs::Coordinator coord(modules,dyns,classes,expe,root);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vpz::CoupledModel* sub(top->addCoupledModel("sub"));
+    vpz::AtomicModel* a = sub->addAtomicModel("a");
+    vpz::AtomicModel* b = top->addAtomicModel("a");
+    vpz::AtomicModel* c = top->addAtomicModel("c");
+    coord.addModel(a, new devs::Simulator(a));
+    coord.addModel(b, new devs::Simulator(b));
+
+    BOOST_REQUIRE_EQUAL(coord.findModel(top, "a"), b);
+    BOOST_REQUIRE_EQUAL(coord.findModel(sub, "a"), a);
+    /* the coupled models and the atomic models without simulator. */
+    BOOST_REQUIRE_EQUAL(coord.findModel(top, "sub"), sub);
+    BOOST_REQUIRE_EQUAL(coord.findModel(top, "c"), c);
+    BOOST_REQUIRE(not coord.findModel(sub, "c"));
+
+    coord.renameModel(sub, "sub2");
+    BOOST_REQUIRE_EQUAL(coord.findModel(sub, "a"), a);
+    coord.renameModel(b, "b");
+    BOOST_REQUIRE(not coord.findModel(top, "a"));
+    BOOST_REQUIRE_EQUAL(coord.findModel(top, "b"), b);
+
+    coord.delModel(top, "b");
+    BOOST_REQUIRE(not coord.findModel(top, "b"));
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_class_instances)
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    vpz::CoupledModel* cls = new vpz::CoupledModel("cls", 0);
+    cls->addCoupledModel("inner")->addInputPort("in");
+    classes.add("cls").setModel(cls);
+    devs::RootCoordinator root(modules);
+    devs::Coordinator coord(modules, dyns, classes, expe, root);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+
+    std::vector < std::string > names;
+    names.push_back("a");
+    names.push_back("b");
+    names.push_back("c");
+    std::vector < vpz::BaseModel* > models;
+    coord.createModelsFromClass("cls", top, names, &models);
+
+    BOOST_REQUIRE_EQUAL(models.size(), 3);
+    BOOST_REQUIRE_EQUAL(top->getModelList().size(), 3);
+
+    /* each instance owns its structure. */
+    std::vector < vpz::CoupledModel* > inners;
+    for (int i = 0; i < 3; ++i) {
+        BOOST_REQUIRE_EQUAL(top->findModel(names[i]), models[i]);
+        BOOST_REQUIRE(models[i]->isCoupled());
+        inners.push_back(vpz::BaseModel::toCoupled(
+                vpz::BaseModel::toCoupled(models[i])->findModel("inner")));
+        BOOST_REQUIRE(inners[i]);
+        BOOST_REQUIRE(inners[i]->existInputPort("in"));
+    }
+    BOOST_REQUIRE(inners[0] != inners[1] and inners[1] != inners[2]);
+
+    inners[0]->addOutputPort("out");
+    inners[1]->delInputPort("in");
+    BOOST_REQUIRE(not inners[2]->existOutputPort("out"));
+    BOOST_REQUIRE(inners[2]->existInputPort("in"));
+
+    coord.delModel(top, "a");
+    BOOST_REQUIRE_EQUAL(top->getModelList().size(), 2);
+    BOOST_REQUIRE(inners[2]->existInputPort("in"));
+
+    /* the class is unchanged by its instances. */
+    vpz::BaseModel* d = coord.createModelFromClass("cls", top, "d");
+    vpz::BaseModel* inner = vpz::BaseModel::toCoupled(d)->findModel("inner");
+    BOOST_REQUIRE(inner->existInputPort("in"));
+    BOOST_REQUIRE(not inner->existOutputPort("out"));
+    BOOST_REQUIRE(not cls->findModel("inner")->existOutputPort("out"));
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_init_values)
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    vpz::Condition cnd("c");
+    cnd.addValueToPort("x", value::Double(1.0));
+    expe.conditions().add(cnd);
+    devs::RootCoordinator root(modules);
+    devs::ModelFactory factory(modules, dyns, classes, expe, root);
+
+    std::vector < std::string > conditions(1, "c");
+
+    /* the models built with the same conditions share the map and its
+     * values are the first values of the condition ports. */
+    const devs::ModelFactory& constfactory(factory);
+    const value::Map& first(factory.initValues(conditions));
+    const value::Map& second(factory.initValues(conditions));
+    BOOST_REQUIRE_EQUAL(&first, &second);
+    BOOST_REQUIRE_EQUAL(first.get("x"),
+                        &constfactory.conditions().get("c").firstValue("x"));
+
+    /* the non-const accessors drop the shared maps. */
+    factory.conditions().get("c").setValueToPort("x", value::Double(2.0));
+    BOOST_REQUIRE_EQUAL(factory.initValues(conditions).getDouble("x"), 2.0);
+
+    factory.experiment().conditions().get("c").setValueToPort(
+        "x", value::Double(3.0));
+    BOOST_REQUIRE_EQUAL(factory.initValues(conditions).getDouble("x"), 3.0);
+}
+
+/*
+ * A started coordinator of the model `top' with an executive `exe' and the
+ * atomic models `a' (output port `out') and `b' (input port `in') without
+ * dynamics.
+ */
+struct Transaction
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root;
+    devs::Coordinator coord;
+    utils::PackageTable packages;
+    vpz::CoupledModel* top;
+    devs::Simulator* sima;
+    devs::Executive* exe;
+    devs::SimulatorMap simulators;
+
+    Transaction()
+        : root(modules), coord(modules, dyns, classes, expe, root),
+        top(new vpz::CoupledModel("top", 0))
+    {
+        vpz::Model model;
+        model.setModel(top);
+        coord.init(model, 0.0, 1.0);
+
+        vpz::AtomicModel* a = top->addAtomicModel("a");
+        a->addOutputPort("out");
+        vpz::AtomicModel* b = top->addAtomicModel("b");
+        b->addInputPort("in");
+        sima = new devs::Simulator(a);
+        coord.addModel(a, sima);
+        coord.addModel(b, new devs::Simulator(b));
+
+        devs::InitEventList events;
+        exe = new devs::Executive(
+            devs::ExecutiveInit(*top->addAtomicModel("exe"),
+                                packages.get("vle.devs.test"), coord),
+            events);
+    }
+
+    ~Transaction()
+    {
+        delete exe;
+        delete top;
+    }
+
+    /* The number of targets of the output port `out' of `a'. */
+    int targets()
+    {
+        simulators = coord.modellist();
+        std::pair < devs::Simulator::iterator, devs::Simulator::iterator > x =
+            sima->targets("out", simulators, coord.graph());
+
+        int result = 0;
+        for (; x.first != x.second; ++x.first) {
+            if (x.first->second.first) {
+                ++result;
+            }
+        }
+        return result;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(test_transaction_commit, Transaction)
+{
+    BOOST_REQUIRE_EQUAL(targets(), 0);
+
+    exe->beginTransaction();
+    BOOST_REQUIRE(coord.isTransaction());
+    exe->addConnection("a", "out", "b", "in");
+    BOOST_REQUIRE(top->existInternalConnection("a", "out", "b", "in"));
+    /* the routing is computed by the commit. */
+    BOOST_REQUIRE_EQUAL(targets(), 0);
+    exe->commitTransaction();
+    BOOST_REQUIRE(not coord.isTransaction());
+    BOOST_REQUIRE_EQUAL(targets(), 1);
+
+    /* outside a transaction, the routing is computed at once. */
+    exe->removeConnection("a", "out", "b", "in");
+    BOOST_REQUIRE_EQUAL(targets(), 0);
+    exe->addConnection("a", "out", "b", "in");
+    BOOST_REQUIRE_EQUAL(targets(), 1);
+
+    /* a commit without transaction does nothing. */
+    exe->commitTransaction();
+    BOOST_REQUIRE(not coord.isTransaction());
+    BOOST_REQUIRE_EQUAL(targets(), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_transaction_nested, Transaction)
+{
+    BOOST_REQUIRE_EQUAL(targets(), 0);
+
+    exe->beginTransaction();
+    exe->beginTransaction();
+    exe->addConnection("a", "out", "b", "in");
+    exe->commitTransaction();
+    /* only the outer commit computes the routing. */
+    BOOST_REQUIRE(coord.isTransaction());
+    BOOST_REQUIRE_EQUAL(targets(), 0);
+
+    exe->addInputPort("b", "in2");
+    exe->addConnection("a", "out", "b", "in2");
+    exe->commitTransaction();
+    BOOST_REQUIRE(not coord.isTransaction());
+    BOOST_REQUIRE_EQUAL(targets(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_transaction_error, Transaction)
+{
+    exe->addConnection("a", "out", "b", "in");
+    BOOST_REQUIRE_EQUAL(targets(), 1);
+
+    /* the changes done before an error are kept and routed by the
+     * commit, the failed change is not applied. */
+    exe->beginTransaction();
+    exe->removeConnection("a", "out", "b", "in");
+    BOOST_REQUIRE_THROW(exe->addConnection("a", "out", "unknown", "in"),
+                        utils::DevsGraphError);
+    BOOST_REQUIRE_THROW(exe->createModelFromClass("unknown", "c"),
+                        utils::ArgError);
+    BOOST_REQUIRE(not top->exist("c"));
+    exe->commitTransaction();
+
+    BOOST_REQUIRE(not top->existInternalConnection("a", "out", "b", "in"));
+    BOOST_REQUIRE_EQUAL(targets(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_transaction_graph, Transaction)
+{
+    /* a model added in a transaction enters the graph at the commit. */
+    exe->beginTransaction();
+    vpz::AtomicModel* c = top->addAtomicModel("c");
+    coord.addModel(c, new devs::Simulator(c));
+    BOOST_REQUIRE_EQUAL(coord.graph().id(c), vpz::FlatGraph::npos);
+    exe->commitTransaction();
+    BOOST_REQUIRE(coord.graph().id(c) != vpz::FlatGraph::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_grid_error, Transaction)
+{
+    vpz::Dynamic& dyn(dyns.add(vpz::Dynamic("unknown")));
+    dyn.setPackage("vle.devs.test");
+    dyn.setLibrary("unknown");
+
+    vpz::GridModel* grid = new vpz::GridModel("grid", 0, 2);
+    grid->addCell(0, 0, "c0")->setDynamics("unknown");
+    grid->addCell(1, 0, "c1")->setDynamics("unknown");
+    std::vector < vpz::AtomicModel* > cells;
+    cells.push_back(grid->getCell(0, 0));
+    cells.push_back(grid->getCell(1, 0));
+
+    devs::SimulatorMap::size_type size = coord.modellist().size();
+
+    /* the cells built and the grid are removed on error. */
+    BOOST_REQUIRE_THROW(exe->createGridModel(grid), std::exception);
+    BOOST_REQUIRE(not top->exist("grid"));
+    BOOST_REQUIRE(not coord.isTransaction());
+    BOOST_REQUIRE_EQUAL(coord.modellist().size(), size);
+    BOOST_REQUIRE(not coord.getModel(cells[0]));
+    BOOST_REQUIRE(not coord.getModel(cells[1]));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_transaction_targets, Transaction)
+{
+    BOOST_REQUIRE_EQUAL(targets(), 0);
+    exe->addConnection("a", "out", "b", "in");
+
+    /* the list of the caller is not sorted in place. */
+    std::vector < std::pair < devs::Simulator*, std::string > > lst;
+    lst.push_back(std::make_pair(sima, std::string("z")));
+    lst.push_back(std::make_pair(sima, std::string("out")));
+    coord.updateSimulatorsTarget(lst);
+    BOOST_REQUIRE_EQUAL(lst[0].second, "z");
+    BOOST_REQUIRE_EQUAL(lst[1].second, "out");
+    BOOST_REQUIRE_EQUAL(targets(), 1);
+}
+
+/*
+ * Simulate a ring of models of the counter dynamics (see counter.cpp)
+ * built with the specified number of threads. The time of each bag and the
+ * counters of each model are appended to the result.
+ */
+static std::vector < double > runCounters(uint32_t threads)
+{
+    const int number = 64;
+    std::vector < double > result;
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Dynamic& dyn(dyns.add(vpz::Dynamic("counter")));
+    dyn.setPackage("vle.devs.test");
+    dyn.setLibrary("counter");
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    devs::Coordinator coord(modules, dyns, classes, expe, root);
+
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    for (int i = 0; i < number; ++i) {
+        vpz::AtomicModel* mdl = top->addAtomicModel(
+            "m" + boost::lexical_cast < std::string >(i));
+        mdl->setDynamics("counter");
+        mdl->addInputPort("in");
+        mdl->addOutputPort("out");
+    }
+    for (int i = 0; i < number; ++i) {
+        top->addInternalConnection(
+            "m" + boost::lexical_cast < std::string >(i), "out",
+            "m" + boost::lexical_cast < std::string >((i + 1) % number),
+            "in");
+    }
+    vpz::Model model;
+    model.setModel(top);
+
+    root.setInitThreads(threads);
+    coord.init(model, 0.0, 10.0);
+
+    while (coord.getNextTime() <= 10.0) {
+        coord.run();
+        result.push_back(coord.getCurrentTime());
+    }
+
+    uint64_t events = 0;
+    for (int i = 0; i < number; ++i) {
+        devs::Simulator* sim = coord.getModelFromPath(
+            "top,m" + boost::lexical_cast < std::string >(i));
+        BOOST_REQUIRE(sim);
+
+        const char* ports[] = { "internal", "external" };
+        for (int j = 0; j < 2; ++j) {
+            devs::ObservationEvent event(coord.getCurrentTime(), sim, "view",
+                                         ports[j]);
+            value::Value* value = sim->dynamics()->observation(event);
+            result.push_back(value::toInteger(value));
+            events += value::toInteger(value);
+            delete value;
+        }
+    }
+
+    /* The coordinator counts the internal transitions and the external
+     * events received by the models. */
+    BOOST_REQUIRE_EQUAL(coord.events(), events);
+
+    coord.finish();
+    delete top;
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_init)
+{
+    namespace fs = boost::filesystem;
+
+    /* install the counter module, built with this test, into a temporary
+     * VLE_HOME. */
+    fs::path home(fs::temp_directory_path() /
+                  fs::unique_path("vle-%%%%-%%%%"));
+    fs::create_directories(home);
+#ifdef _WIN32
+    ::_putenv((vle::fmt("VLE_HOME=%1%") % home.string()).str().c_str());
+    std::string module("libcounter.dll");
+#else
+    ::setenv("VLE_HOME", home.string().c_str(), 1);
+    std::string module("libcounter.so");
+#endif
+    utils::Path::kill();
+
+    fs::path plugins(utils::Package("vle.devs.test").getPluginSimulatorDir(
+            utils::PKG_BINARY));
+    fs::create_directories(plugins);
+    BOOST_REQUIRE(fs::exists(module));
+    fs::copy_file(module, plugins / module);
+
+    std::vector < double > serial = runCounters(1);
+    std::vector < double > parallel = runCounters(4);
+
+    BOOST_REQUIRE(not serial.empty());
+    BOOST_REQUIRE(serial.size() > 2 * 64);
+    BOOST_CHECK_EQUAL_COLLECTIONS(serial.begin(), serial.end(),
+                                  parallel.begin(), parallel.end());
+
+    utils::Path::kill();
+    fs::remove_all(home);
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_experiment)
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    vpz::Condition cnd("cnd");
+    cnd.addValueToPort("x", new value::Double(1.0));
+    expe.conditions().add(cnd);
+    vpz::Conditions overlay;
+    devs::RootCoordinator root(modules);
+
+    devs::Coordinator copied(modules, dyns, classes, expe, root);
+    devs::Coordinator shared(modules, dyns, classes, expe, root, "exp-1",
+                             overlay);
+    const devs::Coordinator& ccopied(copied);
+    const devs::Coordinator& cshared(shared);
+
+    BOOST_REQUIRE(&ccopied.conditions() != &expe.conditions());
+    BOOST_REQUIRE(&ccopied.dynamics() != &dyns);
+    BOOST_REQUIRE_EQUAL(&cshared.conditions(), &expe.conditions());
+    BOOST_REQUIRE_EQUAL(&cshared.dynamics(), &dyns);
+
+    /* the shared experiment is copied before its first modification. */
+    shared.conditions().get("cnd").clearValueOfPort("x");
+    BOOST_REQUIRE(&cshared.conditions() != &expe.conditions());
+    BOOST_REQUIRE(cshared.conditions().get("cnd").getSetValues("x").empty());
+    BOOST_REQUIRE_EQUAL(
+        expe.conditions().get("cnd").getSetValues("x").size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_instance)
+{
+    utils::ModuleManager modules;
+    vpz::Vpz vpz;
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vpz.project().model().setModel(top);
+    vpz.project().setInstance(7);
+    vpz.project().experiment().setName("exp");
+    vpz.project().experiment().setDuration(1.0);
+    vpz::Conditions overlay;
+
+    for (int i = 0; i < 3; ++i) {
+        devs::RootCoordinator root(modules);
+        root.load(vpz, "exp-run", i, overlay);
+        BOOST_REQUIRE_EQUAL(root.instance(), i);
+
+        root.init();
+        while (root.run()) {
+        }
+        root.finish();
+    }
+
+    devs::RootCoordinator root(modules);
+    root.load(vpz);
+    BOOST_REQUIRE_EQUAL(root.instance(), 7);
+
+    /* the shared model hierarchy is not deleted by the simulations. */
+    BOOST_REQUIRE_EQUAL(vpz.project().model().model(), top);
+    BOOST_REQUIRE_EQUAL(vpz.project().experiment().name(), "exp");
+    vpz.project().model().clear();
+}
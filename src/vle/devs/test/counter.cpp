@@ -0,0 +1,101 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/devs/Dynamics.hpp>
+#include <vle/devs/ExternalEvent.hpp>
+#include <vle/devs/ObservationEvent.hpp>
+#include <vle/value/Integer.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace vle { namespace devs { namespace test {
+
+/*
+ * A thread safe dynamics for the unit tests of the coordinator: the model
+ * `m<i>' sends an event on its output port every 1 + i % 3 and counts its
+ * internal transitions and the events received. The time advance is only
+ * known after init.
+ */
+class Counter : public Dynamics
+{
+public:
+    Counter(const DynamicsInit& init, const InitEventList& events)
+        : Dynamics(init, events), m_ta(infinity), m_internal(0),
+        m_external(0)
+    {}
+
+    virtual ~Counter()
+    {}
+
+    virtual Time init(const Time& /* time */)
+    {
+        m_ta = 1 + boost::lexical_cast < int >(
+            getModelName().substr(1)) % 3;
+        return m_ta;
+    }
+
+    virtual void output(const Time& /* time */,
+                        ExternalEventList& output) const
+    {
+        if (getModel().existOutputPort("out")) {
+            output.push_back(new ExternalEvent("out"));
+        }
+    }
+
+    virtual Time timeAdvance() const
+    {
+        return m_ta;
+    }
+
+    virtual void internalTransition(const Time& /* time */)
+    {
+        ++m_internal;
+    }
+
+    virtual void externalTransition(const ExternalEventList& events,
+                                    const Time& /* time */)
+    {
+        m_external += events.size();
+    }
+
+    virtual value::Value* observation(const ObservationEvent& event) const
+    {
+        if (event.onPort("internal")) {
+            return new value::Integer(m_internal);
+        }
+        return new value::Integer(m_external);
+    }
+
+private:
+    Time m_ta;
+    int m_internal;
+    int m_external;
+};
+
+}}} // namespace vle devs test
+
+DECLARE_DYNAMICS_THREAD_SAFE(vle::devs::test::Counter)
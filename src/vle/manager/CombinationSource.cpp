@@ -0,0 +1,64 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/CombinationSource.hpp>
+#include <algorithm>
+
+namespace vle { namespace manager {
+
+GuidedSource::GuidedSource(uint32_t first, uint32_t last, uint32_t threads)
+    : m_next(first), m_last(last), m_threads(threads ? threads : 1)
+{
+}
+
+bool GuidedSource::take(uint32_t *first, uint32_t *end)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_next > m_last) {
+        return false;
+    }
+
+    uint32_t size = chunk(m_last - m_next + 1, m_threads);
+
+    *first = m_next;
+    *end = m_next + size;
+    m_next += size;
+
+    return true;
+}
+
+uint32_t GuidedSource::chunk(uint64_t remaining, uint32_t threads)
+{
+    uint64_t size = remaining / (2 * static_cast < uint64_t >(threads));
+
+    return static_cast < uint32_t >(std::max(static_cast < uint64_t >(1),
+                                             size));
+}
+
+}} // namespace vle manager
@@ -0,0 +1,107 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_COMBINATIONSOURCE_HPP
+#define VLE_MANAGER_COMBINATIONSOURCE_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/utils/Types.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace vle { namespace manager {
+
+/**
+ * @c manager::CombinationSource distributes the combinations of an
+ * experimental frame to the threads of the @c manager::Manager.
+ *
+ * The combinations are taken by chunks, @c take is called from all the
+ * threads, the implementations must be thread-safe.
+ */
+class VLE_API CombinationSource
+{
+public:
+    virtual ~CombinationSource()
+    {
+    }
+
+    /**
+     * Take the next chunk of combinations.
+     *
+     * @param first The first combination of the chunk.
+     * @param end The combination after the last of the chunk.
+     *
+     * @return false if there is no more combination.
+     */
+    virtual bool take(uint32_t *first, uint32_t *end) = 0;
+};
+
+/**
+ * @c manager::GuidedSource distributes the combinations [first, last]
+ * from a shared index. The size of a chunk decreases with the number
+ * of remaining combinations (guided self-scheduling): the first chunks
+ * are large to limit the contention on the index, the last are small to
+ * balance the end of the experimental frame between the threads.
+ */
+class VLE_API GuidedSource : public CombinationSource
+{
+public:
+    /**
+     * Build a source.
+     *
+     * @param first The first combination.
+     * @param last The last combination, if lower than first, the source
+     * is empty.
+     * @param threads The number of consumers of the source.
+     */
+    GuidedSource(uint32_t first, uint32_t last, uint32_t threads);
+
+    virtual bool take(uint32_t *first, uint32_t *end);
+
+    /**
+     * Get the size of the next chunk without taking it.
+     *
+     * @param remaining The number of remaining combinations.
+     * @param threads The number of consumers.
+     *
+     * @return The size of the chunk.
+     */
+    static uint32_t chunk(uint64_t remaining, uint32_t threads);
+
+private:
+    GuidedSource(const GuidedSource &other);
+    GuidedSource& operator=(const GuidedSource &other);
+
+    uint64_t      m_next;
+    uint64_t      m_last;
+    uint32_t      m_threads;
+    boost::mutex  m_mutex;
+};
+
+}} // namespace vle manager
+
+#endif
@@ -0,0 +1,516 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/ExperimentDesign.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <limits>
+#include <cmath>
+
+namespace vle { namespace manager {
+
+/*
+ * Degree, coefficients and initial direction numbers of the primitive
+ * polynomials of the dimensions 2 to 21 of the Sobol sequence (S. Joe
+ * and F. Y. Kuo, new-joe-kuo-6.21201). The first dimension is the van
+ * der Corput sequence.
+ */
+static const uint32_t sobol_table[20][9] = {
+    { 1, 0, 1 },
+    { 2, 1, 1, 3 },
+    { 3, 1, 1, 3, 1 },
+    { 3, 2, 1, 1, 1 },
+    { 4, 1, 1, 1, 3, 3 },
+    { 4, 4, 1, 3, 5, 13 },
+    { 5, 2, 1, 1, 5, 5, 17 },
+    { 5, 4, 1, 1, 5, 5, 5 },
+    { 5, 7, 1, 1, 7, 11, 19 },
+    { 5, 11, 1, 1, 5, 1, 1 },
+    { 5, 13, 1, 1, 1, 3, 11 },
+    { 5, 14, 1, 3, 5, 5, 31 },
+    { 6, 1, 1, 3, 3, 9, 7, 49 },
+    { 6, 13, 1, 1, 1, 15, 21, 21 },
+    { 6, 16, 1, 3, 1, 13, 27, 49 },
+    { 6, 19, 1, 1, 1, 15, 7, 5 },
+    { 6, 22, 1, 3, 1, 15, 13, 25 },
+    { 6, 25, 1, 1, 5, 5, 19, 61 },
+    { 7, 1, 1, 3, 7, 11, 23, 15, 103 },
+    { 7, 4, 1, 3, 7, 13, 13, 15, 69 }
+};
+
+static const uint32_t sobol_dimensions = 21;
+
+static void sobolDirections(uint32_t dimension, uint32_t *v)
+{
+    if (dimension == 0) {
+        for (uint32_t k = 0; k < 32; ++k) {
+            v[k] = 1u << (31 - k);
+        }
+        return;
+    }
+
+    const uint32_t *row = sobol_table[dimension - 1];
+    const uint32_t s = row[0];
+    const uint32_t a = row[1];
+
+    for (uint32_t k = 0; k < s; ++k) {
+        v[k] = row[k + 2] << (31 - k);
+    }
+
+    for (uint32_t k = s; k < 32; ++k) {
+        v[k] = v[k - s] ^ (v[k - s] >> s);
+        for (uint32_t j = 1; j < s; ++j) {
+            if ((a >> (s - 1 - j)) & 1) {
+                v[k] ^= v[k - j];
+            }
+        }
+    }
+}
+
+static uint32_t prime(uint32_t dimension)
+{
+    uint32_t p = 2;
+
+    for (uint32_t found = 0; ; ++p) {
+        bool isprime = true;
+
+        for (uint32_t d = 2; d * d <= p and isprime; ++d) {
+            isprime = p % d != 0;
+        }
+
+        if (isprime and found++ == dimension) {
+            return p;
+        }
+    }
+}
+
+static double radicalInverse(uint32_t index, uint32_t base)
+{
+    const double inverse = 1.0 / base;
+    double factor = inverse;
+    double result = 0.0;
+
+    while (index > 0) {
+        result += (index % base) * factor;
+        index /= base;
+        factor *= inverse;
+    }
+
+    return result;
+}
+
+static uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+ * The combination i takes the i-th value of each factor.
+ */
+class LinearDesign : public ExperimentDesign
+{
+public:
+    LinearDesign(const Factors& factors)
+        : m_factors(factors), m_size(0)
+    {
+        for (Factors::const_iterator it = factors.begin();
+             it != factors.end(); ++it) {
+            uint32_t size = it->values->size();
+
+            if (m_size == 0) {
+                m_size = size;
+            } else if (size != m_size) {
+                throw utils::InternalError(
+                    fmt(_("ExperimentGenerator: bad combination size for the"
+                          " condition `%1%' port `%2%': %3%")) %
+                    it->condition % it->port % size);
+            }
+        }
+    }
+
+    virtual uint32_t size() const
+    {
+        return m_size;
+    }
+
+    virtual value::Value* get(uint32_t index, uint32_t factor) const
+    {
+        return m_factors[factor].values->get(index)->clone();
+    }
+
+private:
+    Factors  m_factors;
+    uint32_t m_size;
+};
+
+/*
+ * The full factorial design: the combination is decomposed in a mixed
+ * radix number, one digit per factor, the last factor is the least
+ * significant digit.
+ */
+class FactorialDesign : public ExperimentDesign
+{
+public:
+    FactorialDesign(const Factors& factors)
+        : m_factors(factors), m_strides(factors.size()), m_size(0)
+    {
+        uint64_t size = 1;
+
+        for (uint32_t i = factors.size(); i > 0; --i) {
+            m_strides[i - 1] = size;
+            size *= factors[i - 1].values->size();
+
+            if (size > std::numeric_limits < uint32_t >::max()) {
+                throw utils::ArgError(
+                    fmt(_("ExperimentGenerator: too many combinations in the"
+                          " full factorial design at the condition `%1%'"
+                          " port `%2%'")) % factors[i - 1].condition %
+                    factors[i - 1].port);
+            }
+        }
+
+        if (not factors.empty()) {
+            m_size = size;
+        }
+    }
+
+    virtual uint32_t size() const
+    {
+        return m_size;
+    }
+
+    virtual value::Value* get(uint32_t index, uint32_t factor) const
+    {
+        const value::Set *values = m_factors[factor].values;
+
+        return values->get((index / m_strides[factor]) %
+                           values->size())->clone();
+    }
+
+private:
+    Factors                 m_factors;
+    std::vector < uint32_t > m_strides;
+    uint32_t                m_size;
+};
+
+/*
+ * The base of the sampling designs: a point of the unit hypercube is
+ * scaled to the range [min, max] of each factor.
+ */
+class SamplingDesign : public ExperimentDesign
+{
+public:
+    SamplingDesign(const vpz::Experiment& experiment, const Factors& factors)
+        : m_size(experiment.samples()), m_seed(experiment.seed())
+    {
+        if (m_size == 0) {
+            throw utils::ArgError(
+                fmt(_("ExperimentGenerator: the `%1%' combination needs a"
+                      " number of samples")) % experiment.combination());
+        }
+
+        for (Factors::const_iterator it = factors.begin();
+             it != factors.end(); ++it) {
+            const value::Set& values = *it->values;
+
+            if (values.size() != 2 or
+                not (values.get(0)->isDouble() or
+                     values.get(0)->isInteger()) or
+                not (values.get(1)->isDouble() or
+                     values.get(1)->isInteger())) {
+                throw utils::ArgError(
+                    fmt(_("ExperimentGenerator: the condition `%1%' port"
+                          " `%2%' must be a range of two numbers")) %
+                    it->condition % it->port);
+            }
+
+            m_integers.push_back(values.get(0)->isInteger() and
+                                 values.get(1)->isInteger());
+            m_min.push_back(number(values.get(0)));
+            m_max.push_back(number(values.get(1)));
+        }
+    }
+
+    virtual uint32_t size() const
+    {
+        return m_size;
+    }
+
+    virtual value::Value* get(uint32_t index, uint32_t factor) const
+    {
+        double u = point(index, factor);
+
+        if (m_integers[factor]) {
+            double count = m_max[factor] - m_min[factor] + 1.0;
+            double result = m_min[factor] + std::floor(u * count);
+
+            return value::Integer::create(
+                static_cast < int32_t >(std::min(result, m_max[factor])));
+        }
+
+        return value::Double::create(
+            m_min[factor] + u * (m_max[factor] - m_min[factor]));
+    }
+
+protected:
+    /*
+     * Get the coordinate of the combination in the dimension of the
+     * factor, in [0, 1[.
+     */
+    virtual double point(uint32_t index, uint32_t factor) const = 0;
+
+    uint32_t m_size;
+    uint32_t m_seed;
+
+private:
+    static double number(const value::Value *value)
+    {
+        return value->isInteger() ? value::toInteger(value) :
+            value::toDouble(value);
+    }
+
+    std::vector < bool >   m_integers;
+    std::vector < double > m_min;
+    std::vector < double > m_max;
+};
+
+/*
+ * Each factor is split into samples strata, a pseudo-random permutation
+ * per factor assigns a stratum to each combination, the point is drawn
+ * in its stratum.
+ */
+class LatinHypercubeDesign : public SamplingDesign
+{
+public:
+    LatinHypercubeDesign(const vpz::Experiment& experiment,
+                         const Factors& factors)
+        : SamplingDesign(experiment, factors)
+    {
+    }
+
+protected:
+    virtual double point(uint32_t index, uint32_t factor) const
+    {
+        uint32_t stratum = permute(index, m_size,
+                                   static_cast < uint32_t >(
+                                       mix(m_seed ^ (static_cast < uint64_t >(
+                                                   factor) << 32))));
+
+        return (stratum + uniform(m_seed, index, factor)) / m_size;
+    }
+};
+
+class SobolDesign : public SamplingDesign
+{
+public:
+    SobolDesign(const vpz::Experiment& experiment, const Factors& factors)
+        : SamplingDesign(experiment, factors),
+        m_directions(factors.size() * 32)
+    {
+        if (factors.size() > sobol_dimensions) {
+            throw utils::ArgError(
+                fmt(_("ExperimentGenerator: the sobol combination accepts"
+                      " %1% factors at most")) % sobol_dimensions);
+        }
+
+        for (uint32_t i = 0; i < factors.size(); ++i) {
+            sobolDirections(i, &m_directions[i * 32]);
+        }
+    }
+
+protected:
+    virtual double point(uint32_t index, uint32_t factor) const
+    {
+        const uint32_t *v = &m_directions[factor * 32];
+        uint32_t gray = index ^ (index >> 1);
+        uint32_t result = 0;
+
+        for (uint32_t k = 0; gray; ++k, gray >>= 1) {
+            if (gray & 1) {
+                result ^= v[k];
+            }
+        }
+
+        return result / 4294967296.0;
+    }
+
+private:
+    std::vector < uint32_t > m_directions;
+};
+
+class HaltonDesign : public SamplingDesign
+{
+public:
+    HaltonDesign(const vpz::Experiment& experiment, const Factors& factors)
+        : SamplingDesign(experiment, factors)
+    {
+        for (uint32_t i = 0; i < factors.size(); ++i) {
+            m_bases.push_back(prime(i));
+        }
+    }
+
+protected:
+    virtual double point(uint32_t index, uint32_t factor) const
+    {
+        return radicalInverse(index, m_bases[factor]);
+    }
+
+private:
+    std::vector < uint32_t > m_bases;
+};
+
+class RandomDesign : public SamplingDesign
+{
+public:
+    RandomDesign(const vpz::Experiment& experiment, const Factors& factors)
+        : SamplingDesign(experiment, factors)
+    {
+    }
+
+protected:
+    virtual double point(uint32_t index, uint32_t factor) const
+    {
+        return uniform(m_seed, index, factor);
+    }
+};
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+ExperimentDesign* ExperimentDesign::create(const vpz::Experiment& experiment,
+                                           const Factors& factors)
+{
+    const std::string& combination = experiment.combination();
+
+    if (combination.empty() or combination == "linear") {
+        return new LinearDesign(factors);
+    } else if (combination == "total") {
+        return new FactorialDesign(factors);
+    } else if (combination == "lhs") {
+        return new LatinHypercubeDesign(experiment, factors);
+    } else if (combination == "sobol") {
+        return new SobolDesign(experiment, factors);
+    } else if (combination == "halton") {
+        return new HaltonDesign(experiment, factors);
+    } else if (combination == "random") {
+        return new RandomDesign(experiment, factors);
+    }
+
+    throw utils::ArgError(
+        fmt(_("ExperimentGenerator: unknown combination `%1%'")) %
+        combination);
+}
+
+double ExperimentDesign::sobol(uint32_t index, uint32_t dimension)
+{
+    if (dimension >= sobol_dimensions) {
+        throw utils::ArgError(
+            fmt(_("ExperimentGenerator: the sobol combination accepts"
+                  " %1% factors at most")) % sobol_dimensions);
+    }
+
+    uint32_t v[32];
+    uint32_t gray = index ^ (index >> 1);
+    uint32_t result = 0;
+
+    sobolDirections(dimension, v);
+
+    for (uint32_t k = 0; gray; ++k, gray >>= 1) {
+        if (gray & 1) {
+            result ^= v[k];
+        }
+    }
+
+    return result / 4294967296.0;
+}
+
+double ExperimentDesign::halton(uint32_t index, uint32_t dimension)
+{
+    return radicalInverse(index, prime(dimension));
+}
+
+/*
+ * A hash based bijection of the smallest power of two greater or equal
+ * to size, restricted to [0, size[ by cycle walking (A. Kensler,
+ * Correlated Multi-Jittered Sampling, 2013).
+ */
+uint32_t ExperimentDesign::permute(uint32_t index, uint32_t size,
+                                   uint32_t seed)
+{
+    if (size <= 1) {
+        return 0;
+    }
+
+    uint32_t w = size - 1;
+    w |= w >> 1;
+    w |= w >> 2;
+    w |= w >> 4;
+    w |= w >> 8;
+    w |= w >> 16;
+
+    do {
+        index ^= seed;
+        index *= 0xe170893d;
+        index ^= seed >> 16;
+        index ^= (index & w) >> 4;
+        index ^= seed >> 8;
+        index *= 0x0929eb3f;
+        index ^= seed >> 23;
+        index ^= (index & w) >> 1;
+        index *= 1 | seed >> 27;
+        index *= 0x6935fa69;
+        index ^= (index & w) >> 11;
+        index *= 0x74dcb303;
+        index ^= (index & w) >> 2;
+        index *= 0x9e501cc3;
+        index ^= (index & w) >> 2;
+        index *= 0xc860a3df;
+        index &= w;
+        index ^= index >> 5;
+    } while (index >= size);
+
+    return static_cast < uint32_t >((static_cast < uint64_t >(index) + seed)
+                                    % size);
+}
+
+double ExperimentDesign::uniform(uint32_t seed, uint32_t index,
+                                 uint32_t dimension)
+{
+    uint64_t h = mix(mix((static_cast < uint64_t >(seed) << 32) | dimension)
+                     ^ index);
+
+    return (h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+}} // namespace vle manager
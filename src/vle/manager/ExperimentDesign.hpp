@@ -0,0 +1,154 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_EXPERIMENTDESIGN_HPP
+#define VLE_MANAGER_EXPERIMENTDESIGN_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/value/Set.hpp>
+#include <vle/vpz/Experiment.hpp>
+#include <string>
+#include <vector>
+
+namespace vle { namespace manager {
+
+/**
+ * A factor of an experimental design: a port of a condition with more
+ * than one value. The values are owned by the @e vpz::Experiment.
+ */
+struct VLE_API ExperimentFactor
+{
+    ExperimentFactor(const std::string& condition, const std::string& port,
+                     const value::Set *values)
+        : condition(condition), port(port), values(values)
+    {
+    }
+
+    std::string       condition;
+    std::string       port;
+    const value::Set *values;
+};
+
+/**
+ * @c manager::ExperimentDesign computes the value of the factors for a
+ * combination of an experimental frame. The values are computed from
+ * the combination number on demand, the plan is never stored: the
+ * memory used does not depend on the number of combinations and any
+ * combination can be built by any thread, process or MPI rank.
+ *
+ * The design is selected by the @e combination attribute of the @e
+ * vpz::Experiment:
+ * - @e linear (default): the combination @e i takes the @e i-th value of
+ *   each factor, all the factors must have the same number of values.
+ * - @e total: the full factorial design over the values of the factors,
+ *   the last factor varies the fastest.
+ * - @e lhs, @e sobol, @e halton and @e random: @e samples points of a
+ *   Latin hypercube, a Sobol sequence, a Halton sequence or a uniform
+ *   random sampling. Each factor is a range defined by two numeric
+ *   values [min, max]. The result is a @e value::Integer in [min, max]
+ *   if both bounds are integers, a @e value::Double in [min, max[
+ *   otherwise. The @e lhs and @e random designs use the @e seed of the
+ *   experiment.
+ */
+class VLE_API ExperimentDesign
+{
+public:
+    typedef std::vector < ExperimentFactor > Factors;
+
+    virtual ~ExperimentDesign()
+    {
+    }
+
+    /**
+     * Get the number of combinations.
+     *
+     * @return The number of combinations of the design.
+     */
+    virtual uint32_t size() const = 0;
+
+    /**
+     * Build the value of a factor for a combination.
+     *
+     * @param index The combination, lower than @e size().
+     * @param factor The factor, lower than the number of factors.
+     *
+     * @return A new value, the caller is in charge to freed it.
+     */
+    virtual value::Value* get(uint32_t index, uint32_t factor) const = 0;
+
+    /**
+     * Build the design of an experiment.
+     *
+     * @param experiment The experiment which defines the combination, the
+     * number of samples and the seed.
+     * @param factors The factors of the design.
+     *
+     * @throw utils::ArgError if the combination is unknown or if the
+     * factors do not fit the design.
+     *
+     * @return A new design, the caller is in charge to freed it.
+     */
+    static ExperimentDesign* create(const vpz::Experiment& experiment,
+                                    const Factors& factors);
+
+    /**
+     * Get the @e index-th point of the Sobol sequence (Gray code order)
+     * in the @e dimension. Up to 21 dimensions.
+     *
+     * @return A real in [0, 1[.
+     */
+    static double sobol(uint32_t index, uint32_t dimension);
+
+    /**
+     * Get the @e index-th point of the Halton sequence in the @e
+     * dimension: the radical inverse of @e index in the base of the @e
+     * dimension-th prime number.
+     *
+     * @return A real in [0, 1[.
+     */
+    static double halton(uint32_t index, uint32_t dimension);
+
+    /**
+     * Get the image of @e index by a pseudo-random permutation of [0,
+     * @e size[ selected by @e seed.
+     *
+     * @return An integer in [0, @e size[.
+     */
+    static uint32_t permute(uint32_t index, uint32_t size, uint32_t seed);
+
+    /**
+     * Get a pseudo-random number from a counter.
+     *
+     * @return A real in [0, 1[ which depends only of the parameters.
+     */
+    static double uniform(uint32_t seed, uint32_t index, uint32_t dimension);
+};
+
+}} // namespace vle manager
+
+#endif
@@ -26,9 +26,12 @@
 
 
 #include <vle/manager/ExperimentGenerator.hpp>
+#include <vle/manager/ExperimentDesign.hpp>
 #include <vle/vpz/Condition.hpp>
 #include <vle/vpz/Vpz.hpp>
 #include <vle/vpz/BaseModel.hpp>
+#include <algorithm>
+#include <limits>
 
 
 namespace vle { namespace manager {
@@ -42,80 +45,82 @@ class ExperimentGenerator::Pimpl
     Pimpl(const Pimpl& other);
     Pimpl& operator=(const Pimpl& other);
 
-    int computeMaximumValue()
+    /*
+     * Collect the ports with more than one value, the factors of the
+     * experimental design, and build the design.
+     */
+    void computeDesign()
     {
-        int result = 0;
-
         const vpz::Conditions& cnds(mVpz.project().experiment().conditions());
+        bool single = false;
 
-        vpz::ConditionList::const_iterator it = cnds.conditionlist().begin();
-        while (it != cnds.conditionlist().end()) {
-            const vpz::Condition& cnd(it->second);
-            vpz::ConditionValues::const_iterator jt;
-
-            if (not cnd.conditionvalues().empty()) {
-                for (jt = cnd.conditionvalues().begin(); jt !=
-                     cnd.conditionvalues().end(); ++jt) {
-
-                    int conditionsize = jt->second->size();
-
-                    if (result == 0 or result == 1) {
-                        result = conditionsize;
-                    } else {
-                        if (conditionsize != 0 and conditionsize != 1
-                            and result != conditionsize) {
-                            throw utils::InternalError(
-                                fmt(_("ExperimentGenerator: bad combination "
-                                      "size for the condition `%1%' port "
-                                      "`%2%': %3%")) % it->first % jt->first %
-                                conditionsize);
-                        }
-                    }
+        vpz::ConditionList::const_iterator it;
+        for (it = cnds.begin(); it != cnds.end(); ++it) {
+            const vpz::ConditionValues& cnv = it->second.conditionvalues();
+
+            for (vpz::ConditionValues::const_iterator jt = cnv.begin();
+                 jt != cnv.end(); ++jt) {
+                if (jt->second->size() > 1) {
+                    mFactors.push_back(ExperimentFactor(it->first, jt->first,
+                                                        jt->second));
+                } else if (jt->second->size() == 1) {
+                    single = true;
                 }
-                ++it;
             }
         }
 
-        return result;
+        mDesign = ExperimentDesign::create(mVpz.project().experiment(),
+                                           mFactors);
+        mCompleteSize = mDesign->size();
+
+        /* An experiment without factor has one combination. */
+        if (mFactors.empty() and mCompleteSize == 0 and single) {
+            mCompleteSize = 1;
+        }
     }
 
+    /*
+     * Split the combinations between the ranks: the first (size % world)
+     * ranks get one more combination than the others. A rank without
+     * combination gets an empty range (min > max). An experiment without
+     * multiple values has one combination.
+     */
     void computeRange()
     {
-        mCompleteSize = computeMaximumValue();
+        computeDesign();
 
-        uint32_t number = mCompleteSize / mWorld;
+        uint32_t size = std::max(mCompleteSize, 1u);
+        uint32_t number = size / mWorld;
+        uint32_t remainder = size % mWorld;
+        uint32_t count = number + (mRank < remainder ? 1 : 0);
 
-        if (number > 0) {
-            mMin = number * mRank;
-            mMax = number * (mRank + 1) - 1;
+        mMin = number * mRank + std::min(mRank, remainder);
+        mMax = mMin + count - 1;
 
-            if (mMax > mCompleteSize) {
-                mMax = mCompleteSize;
-            }
-        } else {
-            uint32_t modulo = mCompleteSize % mWorld;
-
-            if (modulo > mRank) {
-                mMin = mRank;
-                mMax = mRank + 1;
-            } else {
-                mMin = modulo;
-                mMax = modulo;
-            }
+        mReplicas = std::max(mVpz.project().experiment().replicas(), 1u);
+
+        if (static_cast < uint64_t >(size) * mReplicas >
+            std::numeric_limits < uint32_t >::max()) {
+            throw utils::ArgError(
+                fmt(_("ExperimentGenerator: too many replicas (%1%) for %2%"
+                      " combinations")) % mReplicas % size);
         }
     }
 
 public:
     vpz::Vpz mVpz;
+    ExperimentDesign::Factors mFactors;
+    ExperimentDesign *mDesign;
     uint32_t mRank;
     uint32_t mWorld;
     uint32_t mCompleteSize;
     uint32_t mMin;
     uint32_t mMax;
+    uint32_t mReplicas;
 
     Pimpl(const std::string& filename, uint32_t rank, uint32_t size)
-        : mVpz(filename), mRank(rank), mWorld(size), mCompleteSize(0), mMin(0),
-        mMax(0)
+        : mVpz(filename), mDesign(0), mRank(rank), mWorld(size),
+        mCompleteSize(0), mMin(0), mMax(0), mReplicas(1)
     {
         if (rank >= size) {
             throw utils::InternalError(_("Bad rank"));
@@ -124,9 +129,20 @@ public:
         computeRange();
     }
 
+    /*
+     * Parse the lazy conditions of the vpz before the copy: the copy and
+     * the vpz share the parsed values instead of parsing each port twice.
+     */
+    static const vpz::Vpz& load(const vpz::Vpz& vpz)
+    {
+        vpz.project().experiment().conditions().load();
+
+        return vpz;
+    }
+
     Pimpl(const vpz::Vpz& vpz, uint32_t rank, uint32_t size)
-        : mVpz(vpz), mRank(rank), mWorld(size), mCompleteSize(0), mMin(0),
-        mMax(0)
+        : mVpz(load(vpz)), mDesign(0), mRank(rank), mWorld(size),
+        mCompleteSize(0), mMin(0), mMax(0), mReplicas(1)
     {
         if (rank >= size) {
             throw utils::InternalError(_("Bad rank"));
@@ -137,14 +153,44 @@ public:
 
     ~Pimpl()
     {
+        delete mDesign;
         delete mVpz.project().model().model();
     }
 
+    /*
+     * Build the value of the port for the combination. The factor is
+     * the number of the next port with more than one value. A port
+     * without value stays empty.
+     */
+    value::Set* value(uint32_t index, const std::string& condition,
+                      const std::string& port, const value::Set& values,
+                      uint32_t *factor)
+    {
+        value::Set *cpy = new value::Set();
+
+        if (values.empty()) {
+            return cpy;
+        } else if (values.size() == 1) {
+            cpy->add(values.get(0)->clone());
+        } else if (values.size() > 1 and index < mCompleteSize) {
+            cpy->add(mDesign->get(index, (*factor)++));
+        } else {
+            delete cpy;
+            throw utils::InternalError(fmt(
+                    _("ExperimentGenerator can not access to the index"
+                      " `%1%' of the condition `%2%' port `%3%' ")) %
+                index % condition % port);
+        }
+
+        return cpy;
+    }
+
     void get(uint32_t index, vpz::Conditions *conditions)
     {
         const vpz::Conditions& cnds(mVpz.project().experiment().conditions());
         conditions->deleteValueSet();
         vpz::ConditionList& cdldst(conditions->conditionlist());
+        uint32_t factor = 0;
 
         vpz::ConditionList::const_iterator it;
         for (it = cnds.begin(); it != cnds.end(); ++it) {
@@ -159,20 +205,43 @@ public:
             for (vpz::ConditionValues::const_iterator jt = cnvsrc.begin();
                  jt != cnvsrc.end(); ++jt) {
 
-                value::Set *cpy = new value::Set();
-
-                if (jt->second->size() == 1) {
-                    cpy->add(jt->second->get(0)->clone());
-                } else if (jt->second->size() > 1 and jt->second->size() >
-                           index) {
-                    cpy->add(jt->second->get(index)->clone());
-                } else {
-                    throw utils::InternalError(fmt(
-                            _("ExperimentGenerator can not access to the index"
-                              " `%1%' of the condition `%2%' port `%3%' ")) %
-                        index % it->first % jt->first);
+                value::Set *cpy = value(index, it->first, jt->first,
+                                        *jt->second, &factor);
+
+                delete cnvdst[jt->first];
+                cnvdst[jt->first] = cpy;
+            }
+        }
+    }
+
+    void getOverlay(uint32_t index, vpz::Conditions *overlay)
+    {
+        const vpz::Conditions& cnds(mVpz.project().experiment().conditions());
+        overlay->deleteValueSet();
+        vpz::ConditionList& cdldst(overlay->conditionlist());
+        uint32_t factor = 0;
+
+        vpz::ConditionList::const_iterator it;
+        for (it = cnds.begin(); it != cnds.end(); ++it) {
+            const vpz::ConditionValues& cnvsrc = it->second.conditionvalues();
+
+            for (vpz::ConditionValues::const_iterator jt = cnvsrc.begin();
+                 jt != cnvsrc.end(); ++jt) {
+
+                if (jt->second->size() <= 1) {
+                    continue;
                 }
 
+                value::Set *cpy = value(index, it->first, jt->first,
+                                        *jt->second, &factor);
+
+                std::pair < vpz::ConditionList::iterator, bool > r =
+                    cdldst.insert(std::make_pair(
+                            it->first, vpz::Condition(it->first)));
+
+                vpz::ConditionValues& cnvdst =
+                    r.first->second.conditionvalues();
+
                 delete cnvdst[jt->first];
                 cnvdst[jt->first] = cpy;
             }
@@ -207,6 +276,12 @@ void ExperimentGenerator::get(uint32_t index, vpz::Conditions *conditions)
     mPimpl->get(index, conditions);
 }
 
+void ExperimentGenerator::getOverlay(uint32_t index,
+                                     vpz::Conditions *overlay)
+{
+    mPimpl->getOverlay(index, overlay);
+}
+
 uint32_t ExperimentGenerator::min() const
 {
     return mPimpl->mMin;
@@ -222,4 +297,9 @@ uint32_t ExperimentGenerator::size() const
     return mPimpl->mCompleteSize;
 }
 
+uint32_t ExperimentGenerator::replicas() const
+{
+    return mPimpl->mReplicas;
+}
+
 }}  // namespace vle manager
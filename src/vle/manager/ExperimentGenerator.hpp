@@ -52,12 +52,16 @@ namespace vle { namespace manager {
  * assert(expgen.min() == 90);
  * assert(expgen.max() == 99);
  *
- * for (uint32_t i = expgen.min(); i < expgen.max(); ++i) {
+ * for (uint32_t i = expgen.min(); i <= expgen.max(); ++i) {
  *   vpz::Conditions conds;
  *   expgen.get(i, &conds);
  * }
  * @endcode
  *
+ * The values of the ports with more than one value are computed for each
+ * index by the @e ExperimentDesign selected by the combination of the
+ * experiment (linear, total, lhs, sobol, halton or random).
+ *
  * The class ExperimentGenerator is no copyable and nonassignable and uses the
  * Pimpl idiom.
  */
@@ -90,7 +94,7 @@ public:
      * Get the conditions of the specified index.
      *
      * The @e index parameter would be greater or equal to @e min() and lower
-     * the @e max().
+     * or equal to @e max().
      *
      * @param[in] index The index in the experiment generator table.
      * @param[out] conditions Conditions to fill with new conditions.
@@ -98,16 +102,33 @@ public:
     void get(uint32_t index, vpz::Conditions *conditions);
 
     /**
-     * The minimal index of experiences produce by the object.
+     * Get only the values of the conditions which change with the index.
+     *
+     * The ports with a single value or without value are the same for
+     * all the indexes and are not added into the @e overlay. The @e overlay is used with a
+     * shared @e vpz::Vpz (see @e Simulation::run).
      *
-     * @return An integer lower than @e max().
+     * @param[in] index The index in the experiment generator table.
+     * @param[out] overlay Conditions to fill with the values of the ports
+     * with more than one value.
+     */
+    void getOverlay(uint32_t index, vpz::Conditions *overlay);
+
+    /**
+     * The minimal index of experiences produce by the object. The
+     * combinations are split between the ranks: the first (size() %
+     * world) ranks get one more combination than the others.
+     *
+     * @return An integer lower or equal to @e max(), or @e max() + 1 if
+     * the rank has no combination.
      */
     uint32_t min() const;
 
     /**
-     * The maximal index of experiences produce by the object.
+     * The maximal index of experiences produce by the object, included.
      *
-     * @return An integer greater than @e min().
+     * @return An integer greater or equal to @e min(), or @e min() - 1
+     * if the rank has no combination.
      */
     uint32_t max() const;
 
@@ -118,6 +139,16 @@ public:
      */
     uint32_t size() const;
 
+    /**
+     * Get the number of replicas of each experience. The replicas of
+     * the experiences [min(), max()] are the runs [min() * replicas(),
+     * (max() + 1) * replicas()[, the run @e r is the replica @e r %
+     * replicas() of the experience @e r / replicas().
+     *
+     * @return The number of replicas, at least 1.
+     */
+    uint32_t replicas() const;
+
 private:
     ExperimentGenerator(const ExperimentGenerator& other);
     ExperimentGenerator& operator=(const ExperimentGenerator& other);
@@ -33,26 +33,34 @@
 #include <vle/manager/Manager.hpp>
 #include <vle/manager/ExperimentGenerator.hpp>
 #include <vle/manager/Simulation.hpp>
+#include <vle/manager/ResultSink.hpp>
+#include <vle/manager/ResultCache.hpp>
+#include <vle/manager/ReplicationControl.hpp>
+#include <vle/manager/CombinationSource.hpp>
+#include <vle/manager/details/ProcessPool.hpp>
 #include <vle/utils/Tools.hpp>
 #include <vle/utils/Trace.hpp>
+#include <vle/utils/Profile.hpp>
 #include <vle/vpz/Vpz.hpp>
 #include <vle/vpz/BaseModel.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace vle { namespace manager {
 
 /**
- * Assign an new name to the experiment.
- *
- * This function assign a new name to the experiment file.
+ * Build the name of the experiment of a combination.
  *
- * @param destination The experiment where change the name.
  * @param name The base name of the experiment.
  * @param number The combination number.
+ *
+ * @return The name of the experiment.
  */
-static void setExperimentName(vpz::Vpz           *destination,
-                              const std::string&  name,
-                              uint32_t            number)
+static std::string getExperimentName(const std::string&  name,
+                                     uint32_t            number)
 {
     std::string result(name.size() + 12, '-');
 
@@ -60,11 +68,369 @@ static void setExperimentName(vpz::Vpz           *destination,
     result.replace(name.size() + 1, std::string::npos,
                    utils::to < uint32_t >(number));
 
+    return result;
+}
+
+/**
+ * Build the name of the experiment of a run.
+ *
+ * @param name The base name of the experiment.
+ * @param expgen The experiment generator.
+ * @param run The run number.
+ *
+ * @return The name of the experiment, the combination number is
+ * followed by the replica number if the experiment has replicas.
+ */
+static std::string getRunName(const std::string&         name,
+                              const ExperimentGenerator& expgen,
+                              uint32_t                   run)
+{
+    std::string result = getExperimentName(name, run / expgen.replicas());
+
+    if (expgen.replicas() > 1) {
+        result += '-';
+        result += utils::to < uint32_t >(run % expgen.replicas());
+    }
 
+    return result;
+}
+
+/**
+ * Assign an new name to the experiment.
+ *
+ * This function assign a new name to the experiment file.
+ *
+ * @param destination The experiment where change the name.
+ * @param name The new name of the experiment.
+ * @param number The run number.
+ */
+static void setExperimentName(vpz::Vpz           *destination,
+                              const std::string&  name,
+                              uint32_t            number)
+{
     destination->project().setInstance(number);
-    destination->project().experiment().setName(result);
+    destination->project().experiment().setName(name);
+}
+
+/**
+ * Get the first run of the combinations of the experiment generator.
+ */
+static uint32_t firstRun(const ExperimentGenerator& expgen)
+{
+    return expgen.min() * expgen.replicas();
+}
+
+/**
+ * Get the last run of the combinations of the experiment generator, lower
+ * than the first if there is no combination.
+ */
+static uint32_t lastRun(const ExperimentGenerator& expgen)
+{
+    return (expgen.max() + 1) * expgen.replicas() - 1;
+}
+
+/**
+ * Check if the vpz can be shared between the simulations.
+ *
+ * The model hierarchy of the vpz can be shared if no dynamics is an
+ * executive. The lazy conditions are already parsed by the
+ * ExperimentGenerator, before the copies of the vpz and the threads.
+ *
+ * @param vpz The experiment.
+ * @param modulemgr The module manager to load the dynamics.
+ *
+ * @return true if the vpz can be shared, false otherwise.
+ */
+static bool isShareable(const vpz::Vpz&             vpz,
+                        const utils::ModuleManager& modulemgr)
+{
+    const vpz::DynamicList& dyns(vpz.project().dynamics().dynamiclist());
+
+    for (vpz::DynamicList::const_iterator it = dyns.begin();
+         it != dyns.end(); ++it) {
+        utils::ModuleType type = utils::MODULE_DYNAMICS;
+
+        try {
+            modulemgr.get(it->second.package(), it->second.library(),
+                          utils::MODULE_DYNAMICS, &type);
+        } catch (const std::exception& /*e*/) {
+            return false;
+        }
+
+        if (type == utils::MODULE_DYNAMICS_EXECUTIVE) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
+/**
+ * Run the simulation of a combination.
+ *
+ * If the vpz is shared, only the values of the conditions of the
+ * combination are built, otherwise the vpz is cloned. The time spent
+ * is recorded in the "experiment" phase of the profile of the
+ * simulation. The random streams of the simulation depend on the
+ * combination and the replica of the run.
+ *
+ * @param sim The simulation.
+ * @param vpz The experiment.
+ * @param vpzname The base name of the experiment.
+ * @param expgen The experiment generator.
+ * @param run The run number.
+ * @param shared true if the vpz is shared between the simulations.
+ * @param modulemgr The module manager.
+ * @param error The error of the simulation.
+ *
+ * @return The result of the simulation.
+ */
+static value::Map * runCombination(Simulation&                 sim,
+                                   const vpz::Vpz             *vpz,
+                                   const std::string&          vpzname,
+                                   ExperimentGenerator&        expgen,
+                                   uint32_t                    run,
+                                   bool                        shared,
+                                   const utils::ModuleManager& modulemgr,
+                                   Error                      *error)
+{
+    uint32_t index = run / expgen.replicas();
+
+    sim.setStream(index, run % expgen.replicas());
+
+    if (shared) {
+        vpz::Conditions overlay;
+
+        {
+            utils::ProfileScope scope(sim.profile(), "experiment");
+            expgen.getOverlay(index, &overlay);
+        }
+
+        return sim.run(*vpz, getRunName(vpzname, expgen, run), run,
+                       overlay, modulemgr, error);
+    } else {
+        vpz::Vpz *file;
+
+        {
+            utils::ProfileScope scope(sim.profile(), "experiment");
+            file = new vpz::Vpz(*vpz);
+            setExperimentName(file, getRunName(vpzname, expgen, run), run);
+            expgen.get(index, &file->project().experiment().conditions());
+        }
+
+        return sim.run(file, modulemgr, error);
+    }
+}
+
+/**
+ * Get the key of a run in the result cache: the identity of the
+ * experiment, the values of the conditions which change with the
+ * combination and the replica of the run. The key is the same whether
+ * the vpz is shared or not.
+ *
+ * @param cache The result cache.
+ * @param identity The identity of the experiment.
+ * @param expgen The experiment generator.
+ * @param run The run number.
+ *
+ * @return The key of the run.
+ */
+static std::string getRunKey(const ResultCache&   cache,
+                             const std::string&   identity,
+                             ExperimentGenerator& expgen,
+                             uint32_t             run)
+{
+    uint32_t index = run / expgen.replicas();
+    vpz::Conditions overlay;
+
+    expgen.getOverlay(index, &overlay);
+
+    return cache.key(identity, &overlay, index, run % expgen.replicas());
+}
+
+/**
+ * Get the result of a run from the cache or run its simulation and store
+ * its result into the cache. The time spent to build the key and to read
+ * the cache is recorded in the "cache" phase of the profile of the
+ * simulation.
+ *
+ * @param cache The result cache, if null the simulation is run.
+ * @param identity The identity of the experiment.
+ *
+ * @see runCombination for the other parameters.
+ *
+ * @return The result of the simulation.
+ */
+static value::Map * runCachedCombination(Simulation&                 sim,
+                                         const vpz::Vpz             *vpz,
+                                         const std::string&          vpzname,
+                                         ExperimentGenerator&        expgen,
+                                         uint32_t                    run,
+                                         bool                        shared,
+                                         const utils::ModuleManager& modulemgr,
+                                         ResultCache                *cache,
+                                         const std::string&          identity,
+                                         Error                      *error)
+{
+    if (not cache) {
+        return runCombination(sim, vpz, vpzname, expgen, run, shared,
+                              modulemgr, error);
+    }
+
+    std::string key;
+    value::Map *result;
+
+    {
+        utils::ProfileScope scope(sim.profile(), "cache");
+        key = getRunKey(*cache, identity, expgen, run);
+        result = cache->get(key);
+    }
+
+    if (result) {
+        error->code = 0;
+        return result;
+    }
+
+    result = runCombination(sim, vpz, vpzname, expgen, run, shared,
+                            modulemgr, error);
+
+    if (not error->code and result) {
+        cache->put(key, result);
+    }
+
+    return result;
+}
+
+/**
+ * Give the result of a combination to the sink.
+ *
+ * @param sink The sink, if null the result is deleted.
+ * @param index The combination number.
+ * @param result The result of the simulation.
+ * @param error Filled if the sink fails.
+ */
+static void writeResult(ResultSink    *sink,
+                        uint32_t       index,
+                        value::Map    *result,
+                        Error         *error)
+{
+    if (not sink) {
+        delete result;
+        return;
+    }
+
+    try {
+        sink->write(index, result);
+    } catch (const std::exception& e) {
+        error->code = -1;
+        error->message = e.what();
+    }
+}
+
+/**
+ * Flush the sink at the end of the experimental frame.
+ *
+ * @param sink The sink, can be null.
+ * @param error Filled if the sink fails.
+ */
+static void flushResult(ResultSink *sink, Error *error)
+{
+    if (sink) {
+        try {
+            sink->flush();
+        } catch (const std::exception& e) {
+            error->code = -1;
+            error->message = e.what();
+        }
+    }
+}
+
+/**
+ * The @c RunSource distributes one by one the runs of a list of ranges
+ * [first, end).
+ */
+class RunSource : public CombinationSource
+{
+public:
+    typedef std::vector < std::pair < uint32_t, uint32_t > > RangeList;
+
+    RunSource(const RangeList& ranges)
+        : m_ranges(ranges), m_range(0),
+          m_next(ranges.empty() ? 0 : ranges.front().first)
+    {
+    }
+
+    virtual bool take(uint32_t *first, uint32_t *end)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        while (m_range < m_ranges.size() and
+               m_next >= m_ranges[m_range].second) {
+            if (++m_range < m_ranges.size()) {
+                m_next = m_ranges[m_range].first;
+            }
+        }
+
+        if (m_range >= m_ranges.size()) {
+            return false;
+        }
+
+        *first = m_next++;
+        *end = m_next;
+
+        return true;
+    }
+
+private:
+    const RangeList&     m_ranges;
+    RangeList::size_type m_range;
+    uint32_t             m_next;
+    boost::mutex         m_mutex;
+};
+
+/**
+ * The @c ReplicationSink updates the estimates of the @c
+ * ReplicationControl with the results of the replicas then gives them to
+ * the sink of the experimental frame.
+ */
+class ReplicationSink : public ResultSink
+{
+public:
+    ReplicationSink(ReplicationControl &control, ResultSink *sink,
+                    uint32_t replicas)
+        : m_control(control), m_sink(sink), m_replicas(replicas)
+    {
+    }
+
+    virtual void write(uint32_t index, value::Map *result)
+    {
+        try {
+            m_control.update(index / m_replicas, result);
+        } catch (...) {
+            delete result;
+            throw;
+        }
+
+        if (m_sink) {
+            m_sink->write(index, result);
+        } else {
+            delete result;
+        }
+    }
+
+    virtual void flush()
+    {
+        if (m_sink) {
+            m_sink->flush();
+        }
+    }
+
+private:
+    ReplicationControl &m_control;
+    ResultSink         *m_sink;
+    uint32_t            m_replicas;
+};
+
 struct Manager::Pimpl
 {
     Pimpl(LogOptions            logoptions,
@@ -72,7 +438,11 @@ struct Manager::Pimpl
           std::ostream         *output)
         : mLogOption(logoptions),
           mSimulationOption(simulationoptions),
-          mOutputStream(output)
+          mOutputStream(output),
+          mProfile(0),
+          mInitThreads(1),
+          mCache(0),
+          mReplication(0)
     {
     }
 
@@ -104,6 +474,21 @@ struct Manager::Pimpl
         }
     }
 
+    /**
+     * The utilization of a thread of the @c worker.
+     */
+    struct utilization
+    {
+        utilization()
+            : simulations(0), chunks(0), busy(0.0)
+        {
+        }
+
+        uint32_t simulations;
+        uint32_t chunks;
+        double   busy;
+    };
+
     /**
      * The @c worker is a boost thread functor to execute threaded
      * source code.
@@ -111,28 +496,37 @@ struct Manager::Pimpl
      */
     struct worker
     {
+        Pimpl                &pimpl;
         const vpz::Vpz       *vpz;
         ExperimentGenerator  &expgen;
         utils::ModuleManager &modulemgr;
-        LogOptions            mLogOption;
-        SimulationOptions     mSimulationOption;
-        uint32_t              index;
-        uint32_t              threads;
-        value::Matrix        *result;
+        CombinationSource    &source;
+        utilization          &usage;
+        bool                  shared;
+        ResultSink           *sink;
         Error                *error;
+        boost::mutex         &errormutex;
+        utils::Profile       *profile;
+        ResultCache          *cache;
+        const std::string    &identity;
 
-        worker(const vpz::Vpz        *vpz,
+        worker(Pimpl&                 pimpl,
+               const vpz::Vpz        *vpz,
                ExperimentGenerator&   expgen,
                utils::ModuleManager&  modulemgr,
-               LogOptions             logoptions,
-               SimulationOptions      simulationoptions,
-               uint32_t               index,
-               uint32_t               threads,
-               value::Matrix         *result,
-               Error                 *error)
-            : vpz(vpz), expgen(expgen), modulemgr(modulemgr),
-              mLogOption(logoptions), mSimulationOption(simulationoptions),
-              index(index), threads(threads), result(result), error(error)
+               CombinationSource&     source,
+               utilization&           usage,
+               bool                   shared,
+               ResultSink            *sink,
+               Error                 *error,
+               boost::mutex&          errormutex,
+               utils::Profile        *profile,
+               ResultCache           *cache,
+               const std::string&     identity)
+            : pimpl(pimpl), vpz(vpz), expgen(expgen), modulemgr(modulemgr),
+              source(source), usage(usage), shared(shared), sink(sink),
+              error(error), errormutex(errormutex), profile(profile),
+              cache(cache), identity(identity)
         {
         }
 
@@ -143,79 +537,383 @@ struct Manager::Pimpl
         void operator()()
         {
             std::string vpzname(vpz->project().experiment().name());
+            uint32_t first, end;
 
-            for (uint32_t i = expgen.min() + index; i <= expgen.max();
-                 i += threads) {
-                Simulation sim(mLogOption, mSimulationOption, NULL);
-                Error err;
-                vpz::Vpz *file = new vpz::Vpz(*vpz);
-                setExperimentName(file, vpzname, i);
-                expgen.get(i, &file->project().experiment().conditions());
+            while (source.take(&first, &end)) {
+                double start = utils::Profile::wallTime();
 
-                value::Map *simresult = sim.run(file, modulemgr, &err);
+                for (uint32_t i = first; i < end; ++i) {
+                    Simulation sim(pimpl.mLogOption, pimpl.mSimulationOption,
+                                   NULL);
+                    Error err;
 
-                if (err.code) {
-                    // writeRunLog(err.message);
+                    sim.setProfile(profile);
+                    sim.setInitThreads(pimpl.mInitThreads);
 
-                    if (not error->code) {
-                        error->code = -1;
-                        error->message = _("Manager failure.");
+                    value::Map *simresult = runCachedCombination(
+                        sim, vpz, vpzname, expgen, i, shared, modulemgr,
+                        cache, identity, &err);
+
+                    if (not err.code) {
+                        writeResult(sink, i, simresult, &err);
+                    }
+
+                    if (err.code) {
+                        boost::mutex::scoped_lock lock(errormutex);
+
+                        pimpl.writeRunLog(err.message);
+
+                        if (not error->code) {
+                            error->code = -1;
+                            error->message = _("Manager failure.");
+                        }
                     }
-                } else {
-                    result->add(i, 0, simresult);
                 }
+
+                usage.simulations += end - first;
+                usage.chunks++;
+                usage.busy += utils::Profile::wallTime() - start;
             }
         }
     };
 
+    /**
+     * Build the @c manager::MatrixSink of the results if no sink is
+     * defined and if the results are returned.
+     */
+    MatrixSink * buildMatrixSink(ResultSink                **sink,
+                                 const ExperimentGenerator&  expgen)
+    {
+        MatrixSink *matrix = 0;
+
+        if (not *sink and
+            not (mSimulationOption & manager::SIMULATION_NO_RETURN)) {
+            matrix = new MatrixSink(expgen.size(), expgen.replicas());
+            *sink = matrix;
+        }
+
+        return matrix;
+    }
+
+    /**
+     * Get the result cache of the experimental frame, null if no cache is
+     * assigned or if the results are not returned.
+     */
+    ResultCache * getCache() const
+    {
+        if (mSimulationOption & manager::SIMULATION_NO_RETURN) {
+            return 0;
+        }
+
+        return mCache;
+    }
+
+    /**
+     * Get the identity of the experiment in the result cache, empty if
+     * there is no cache.
+     */
+    std::string getIdentity(const vpz::Vpz& vpz) const
+    {
+        ResultCache *cache = getCache();
+
+        return cache ? cache->identity(vpz.project()) : std::string();
+    }
+
+    /**
+     * Get the results of the @c manager::MatrixSink and delete it.
+     */
+    value::Matrix * releaseMatrixSink(MatrixSink *matrix)
+    {
+        value::Matrix *result = 0;
+
+        if (matrix) {
+            result = matrix->release();
+            delete matrix;
+        }
+
+        return result;
+    }
+
     value::Matrix * runManagerThread(vpz::Vpz              *vpz,
                                      utils::ModuleManager&  modulemgr,
                                      uint32_t               threads,
                                      uint32_t               rank,
                                      uint32_t               world,
+                                     CombinationSource     *source,
+                                     ResultSink            *sink,
                                      Error                 *error)
     {
+        utils::ProfileScope scope(mProfile, "generator");
         ExperimentGenerator expgen(*vpz, rank, world);
         std::string vpzname(vpz->project().experiment().name());
         boost::thread_group gp;
-        value::Matrix *result = new value::Matrix(expgen.size(), 1, expgen.size(), 1);
+        MatrixSink *matrix = buildMatrixSink(&sink, expgen);
+        bool shared = isShareable(*vpz, modulemgr);
+        std::string identity = getIdentity(*vpz);
+
+        scope.setCount(expgen.size());
+        scope.stop();
+
+        error->code = 0;
+        error->message.clear();
+
+        GuidedSource guided(firstRun(expgen), lastRun(expgen), threads);
+        CombinationSource &combinations(source ? *source : guided);
+        std::vector < utilization > usages(threads);
+        boost::mutex errormutex;
+        double start = utils::Profile::wallTime();
 
         for (uint32_t i = 0; i < threads; ++i) {
-            gp.create_thread(worker(vpz, expgen, modulemgr,
-                                    mLogOption, mSimulationOption,
-                                    i, threads, result, error));
+            gp.create_thread(worker(*this, vpz, expgen, modulemgr,
+                                    combinations, usages[i], shared, sink,
+                                    error, errormutex, mProfile,
+                                    getCache(), identity));
         }
 
         gp.join_all();
+        flushResult(sink, error);
+
+        writeUtilization(usages, utils::Profile::wallTime() - start);
 
          delete vpz->project().model().model();
          delete vpz;
 
-         return result;
+         return releaseMatrixSink(matrix);
+    }
+
+    /**
+     * Write the number of simulations and the busy time of each thread
+     * into the summary log.
+     *
+     * @param usages The utilization of the threads.
+     * @param elapsed The wall time of the experimental frame.
+     */
+    void writeUtilization(const std::vector < utilization >& usages,
+                          double elapsed)
+    {
+        double busy = 0.0;
+
+        for (std::vector < utilization >::size_type i = 0;
+             i < usages.size(); ++i) {
+            writeSummaryLog(
+                fmt(_("Manager thread %1%: %2% simulations in %3% chunks,"
+                      " %4% s busy (%5%%%)\n"))
+                % i % usages[i].simulations % usages[i].chunks
+                % usages[i].busy
+                % (elapsed > 0.0 ? 100.0 * usages[i].busy / elapsed : 100.0));
+
+            busy += usages[i].busy;
+        }
+
+        writeSummaryLog(
+            fmt(_("Manager: %1% s elapsed, speedup %2%\n"))
+            % elapsed % (elapsed > 0.0 ? busy / elapsed : 1.0));
+    }
+
+    /**
+     * The @c process runs the combinations in the worker processes of a
+     * @c ProcessPool and gives their results to the sink in the parent
+     * process. The result cache is only used by the parent process.
+     */
+    struct process : ProcessPool::Job, ProcessPool::Handler
+    {
+        Pimpl                &pimpl;
+        const vpz::Vpz       *vpz;
+        std::string           vpzname;
+        ExperimentGenerator  &expgen;
+        utils::ModuleManager &modulemgr;
+        bool                  shared;
+        ResultSink           *sink;
+        Error                *error;
+        ResultCache          *cache;
+        std::string           identity;
+
+        process(Pimpl                 &pimpl,
+                const vpz::Vpz        *vpz,
+                ExperimentGenerator&   expgen,
+                utils::ModuleManager&  modulemgr,
+                bool                   shared,
+                ResultSink            *sink,
+                Error                 *error)
+            : pimpl(pimpl), vpz(vpz),
+              vpzname(vpz->project().experiment().name()), expgen(expgen),
+              modulemgr(modulemgr), shared(shared), sink(sink), error(error),
+              cache(pimpl.getCache()), identity(pimpl.getIdentity(*vpz))
+        {
+        }
+
+        /**
+         * Run the runs [first, last] in the pool (see the run of a wave).
+         */
+        void run(ProcessPool& pool, uint32_t first, uint32_t last)
+        {
+            if (not cache) {
+                pool.run(first, last, *this);
+            } else {
+                run(pool, RunSource::RangeList(
+                        1, std::make_pair(first, last + 1)));
+            }
+        }
+
+        /**
+         * Run the runs of a wave in the pool. The results found in the
+         * cache are given to the sink, the other runs are sent to the
+         * workers in a single dispatch.
+         */
+        void run(ProcessPool& pool, const RunSource::RangeList& wave)
+        {
+            std::vector < uint32_t > indexes;
+
+            for (RunSource::RangeList::const_iterator it = wave.begin();
+                 it != wave.end(); ++it) {
+                for (uint32_t i = it->first; i < it->second; ++i) {
+                    value::Map *result = cache ? cache->get(
+                        getRunKey(*cache, identity, expgen, i)) : 0;
+
+                    if (result) {
+                        Error status;
+                        writeResult(sink, i, result, &status);
+                        report(status);
+                    } else {
+                        indexes.push_back(i);
+                    }
+                }
+            }
+
+            pool.run(indexes, *this);
+        }
+
+        /**
+         * Report the error of a run.
+         */
+        void report(const Error &status)
+        {
+            if (status.code) {
+                pimpl.writeRunLog(status.message);
+
+                if (not error->code) {
+                    error->code = -1;
+                    error->message = _("Manager failure.");
+                }
+            }
+        }
+
+        virtual value::Map * run(uint32_t index, Error *err)
+        {
+            Simulation sim(pimpl.mLogOption, pimpl.mSimulationOption &
+                           ~manager::SIMULATION_SPAWN_PROCESS, NULL);
+
+            sim.setInitThreads(pimpl.mInitThreads);
+
+            return runCombination(sim, vpz, vpzname, expgen, index, shared,
+                                  modulemgr, err);
+        }
+
+        virtual void done(uint32_t index, value::Map *result,
+                          const Error &err)
+        {
+            Error status(err);
+
+            if (not status.code) {
+                if (cache and result) {
+                    cache->put(getRunKey(*cache, identity, expgen, index),
+                               result);
+                }
+
+                writeResult(sink, index, result, &status);
+            } else {
+                delete result;
+            }
+
+            report(status);
+        }
+    };
+
+    value::Matrix * runManagerProcess(vpz::Vpz             *vpz,
+                                      utils::ModuleManager &modulemgr,
+                                      uint32_t              processes,
+                                      uint32_t              rank,
+                                      uint32_t              world,
+                                      CombinationSource    *source,
+                                      ResultSink           *sink,
+                                      Error                *error)
+    {
+        utils::ProfileScope scope(mProfile, "generator");
+        ExperimentGenerator expgen(*vpz, rank, world);
+        MatrixSink *matrix = buildMatrixSink(&sink, expgen);
+        bool shared = isShareable(*vpz, modulemgr);
+
+        scope.setCount(expgen.size());
+        scope.stop();
+
+        error->code = 0;
+        error->message.clear();
+
+        try {
+            process job(*this, vpz, expgen, modulemgr, shared, sink, error);
+            ProcessPool pool(job, processes);
+
+            if (source) {
+                uint32_t first, end;
+
+                while (source->take(&first, &end)) {
+                    job.run(pool, first, end - 1);
+                }
+            } else {
+                job.run(pool, firstRun(expgen), lastRun(expgen));
+            }
+        } catch (const std::exception& e) {
+            error->code = -1;
+            error->message = e.what();
+        }
+
+        flushResult(sink, error);
+
+        delete vpz->project().model().model();
+        delete vpz;
+
+        return releaseMatrixSink(matrix);
     }
 
     value::Matrix * runManagerMono(vpz::Vpz             *vpz,
                                    utils::ModuleManager &modulemgr,
                                    uint32_t              rank,
                                    uint32_t              world,
+                                   CombinationSource    *source,
+                                   ResultSink           *sink,
                                    Error                *error)
     {
+        utils::ProfileScope scope(mProfile, "generator");
         Simulation sim(mLogOption, mSimulationOption, NULL);
         ExperimentGenerator expgen(*vpz, rank, world);
         std::string vpzname(vpz->project().experiment().name());
-        value::Matrix *result = 0;
+        MatrixSink *matrix = buildMatrixSink(&sink, expgen);
+        bool shared = isShareable(*vpz, modulemgr);
+        std::string identity = getIdentity(*vpz);
+
+        sim.setProfile(mProfile);
+        sim.setInitThreads(mInitThreads);
+        scope.setCount(expgen.size());
+        scope.stop();
 
         error->code = 0;
         error->message.clear();
 
-        if (mSimulationOption & manager::SIMULATION_NO_RETURN) {
-            for (uint32_t i = expgen.min(); i <= expgen.max(); ++i) {
+        GuidedSource guided(firstRun(expgen), lastRun(expgen), 1);
+        CombinationSource &combinations(source ? *source : guided);
+        uint32_t first, end;
+
+        while (combinations.take(&first, &end)) {
+            for (uint32_t i = first; i < end; ++i) {
                 Error err;
-                vpz::Vpz *file = new vpz::Vpz(*vpz);
-                setExperimentName(file, vpzname, i);
-                expgen.get(i, &file->project().experiment().conditions());
 
-                sim.run(file, modulemgr, &err);
+                value::Map *simresult = runCachedCombination(
+                    sim, vpz, vpzname, expgen, i, shared, modulemgr,
+                    getCache(), identity, &err);
+
+                if (not err.code) {
+                    writeResult(sink, i, simresult, &err);
+                }
 
                 if (err.code) {
                     writeRunLog(err.message);
@@ -226,39 +924,243 @@ struct Manager::Pimpl
                     }
                 }
             }
-        } else {
-            result = new value::Matrix(expgen.size(), 1, expgen.size(), 1);
+        }
 
-            for (uint32_t i = expgen.min(); i <= expgen.max(); ++i) {
-                Error err;
-                vpz::Vpz *file = new vpz::Vpz(*vpz);
-                setExperimentName(file, vpzname, i);
-                expgen.get(i, &file->project().experiment().conditions());
+        flushResult(sink, error);
 
-                value::Map *simresult = sim.run(file, modulemgr, &err);
+        delete vpz->project().model().model();
+        delete vpz;
 
-                if (err.code) {
-                    writeRunLog(err.message);
+        return releaseMatrixSink(matrix);
+    }
 
-                    if (not error->code) {
-                        error->code = -1;
-                        error->message = _("Manager failure.");
+    /**
+     * Build the next wave of the sequential replication: the ranges of
+     * runs of the combinations which are neither precise nor at the end
+     * of their replicas.
+     *
+     * @param expgen The experiment generator.
+     * @param scheduled The number of replicas already scheduled for each
+     * combination, updated with the wave.
+     * @param wave The ranges [first, end) of runs of the wave.
+     */
+    void buildWave(const ExperimentGenerator&  expgen,
+                   std::vector < uint32_t >&   scheduled,
+                   RunSource::RangeList&       wave)
+    {
+        const uint32_t replicas = expgen.replicas();
+
+        wave.clear();
+
+        for (uint32_t c = expgen.min(); c <= expgen.max(); ++c) {
+            uint32_t& done(scheduled[c - expgen.min()]);
+
+            if (done >= replicas or mReplication->isPrecise(c)) {
+                continue;
+            }
+
+            uint32_t count = std::min(mReplication->wave(), replicas - done);
+
+            wave.push_back(std::make_pair(c * replicas + done,
+                                          c * replicas + done + count));
+            done += count;
+        }
+    }
+
+    /**
+     * Run the replicas of the combinations in waves until the @c
+     * ReplicationControl stops them. The runs of a wave are distributed
+     * between the threads, or the worker processes with the @c
+     * manager::SIMULATION_SPAWN_PROCESS option. The replicas of the
+     * combinations keep their run numbers, their results are the same as
+     * with a fixed number of replicas.
+     */
+    value::Matrix * runManagerSequential(vpz::Vpz             *vpz,
+                                         utils::ModuleManager &modulemgr,
+                                         uint32_t              threads,
+                                         uint32_t              rank,
+                                         uint32_t              world,
+                                         ResultSink           *sink,
+                                         Error                *error)
+    {
+        utils::ProfileScope scope(mProfile, "generator");
+        ExperimentGenerator expgen(*vpz, rank, world);
+        MatrixSink *matrix = buildMatrixSink(&sink, expgen);
+        bool shared = isShareable(*vpz, modulemgr);
+        std::string identity = getIdentity(*vpz);
+
+        scope.setCount(expgen.size());
+        scope.stop();
+
+        error->code = 0;
+        error->message.clear();
+
+        ReplicationSink replication(*mReplication, sink, expgen.replicas());
+        std::vector < uint32_t > scheduled(expgen.max() + 1 - expgen.min(),
+                                           0);
+        std::vector < utilization > usages(threads);
+        RunSource::RangeList wave;
+        boost::mutex errormutex;
+        double start = utils::Profile::wallTime();
+        uint32_t waves = 0;
+
+        mReplication->start(expgen.min(), expgen.max());
+
+        try {
+            if (mSimulationOption & manager::SIMULATION_SPAWN_PROCESS) {
+                process job(*this, vpz, expgen, modulemgr, shared,
+                            &replication, error);
+                ProcessPool pool(job, threads);
+
+                for (buildWave(expgen, scheduled, wave); not wave.empty();
+                     buildWave(expgen, scheduled, wave), ++waves) {
+                    job.run(pool, wave);
+                }
+            } else {
+                for (buildWave(expgen, scheduled, wave); not wave.empty();
+                     buildWave(expgen, scheduled, wave), ++waves) {
+                    RunSource runs(wave);
+                    boost::thread_group gp;
+
+                    for (uint32_t i = 0; i < threads; ++i) {
+                        gp.create_thread(
+                            worker(*this, vpz, expgen, modulemgr, runs,
+                                   usages[i], shared, &replication, error, errormutex,
+                                   mProfile, getCache(), identity));
                     }
-                } else {
-                    result->add(i, 0, simresult);
+
+                    gp.join_all();
                 }
             }
+        } catch (const std::exception& e) {
+            error->code = -1;
+            error->message = e.what();
         }
 
+        flushResult(&replication, error);
+
+        if (not (mSimulationOption & manager::SIMULATION_SPAWN_PROCESS)) {
+            writeUtilization(usages, utils::Profile::wallTime() - start);
+        }
+
+        writeReplication(expgen, waves);
+
         delete vpz->project().model().model();
         delete vpz;
 
+        return releaseMatrixSink(matrix);
+    }
+
+    /**
+     * Write the number of replicas used by each combination into the
+     * summary log.
+     */
+    void writeReplication(const ExperimentGenerator& expgen, uint32_t waves)
+    {
+        uint64_t total = 0;
+
+        for (uint32_t c = expgen.min(); c <= expgen.max(); ++c) {
+            uint32_t replicas = mReplication->replicas(c);
+
+            writeSummaryLog(
+                fmt(_("Manager replication: combination %1%: %2% replicas"
+                      " (%3%)\n")) % c % replicas
+                % (mReplication->isPrecise(c) ? _("precise") :
+                   _("not precise")));
+
+            total += replicas;
+        }
+
+        writeSummaryLog(
+            fmt(_("Manager replication: %1% replicas in %2% waves, at most"
+                  " %3% replicas per combination\n")) % total % waves
+            % expgen.replicas());
+    }
+
+    value::Matrix * run(vpz::Vpz             *exp,
+                        utils::ModuleManager &modulemgr,
+                        uint32_t              thread,
+                        uint32_t              rank,
+                        uint32_t              world,
+                        CombinationSource    *source,
+                        ResultSink           *sink,
+                        Error                *error)
+    {
+        value::Matrix *result = 0;
+
+        if (thread <= 0) {
+            throw vle::utils::ArgError(
+                fmt(_("Manager error: thread must be superior to 0 (%1%)"))
+                % thread);
+        }
+
+        if (world <= rank) {
+            throw vle::utils::ArgError(
+                fmt(_("Manager error: rank (%1%) must be inferior"
+                      " to world (%2%)"))  % rank % world);
+        }
+
+        if (world <= 0) {
+            throw vle::utils::ArgError(
+                fmt(_("Manager error: world (%1%) must be superior to 0."))
+                % world);
+        }
+
+        if (mReplication) {
+            if (source) {
+                throw vle::utils::ArgError(
+                    _("Manager error: the replication control cannot be used"
+                      " with a combination source"));
+            }
+
+            if (mSimulationOption & manager::SIMULATION_NO_RETURN) {
+                throw vle::utils::ArgError(
+                    _("Manager error: the replication control needs the"
+                      " results of the simulations"));
+            }
+
+            if (mReplication->statistics() == 0) {
+                throw vle::utils::ArgError(
+                    _("Manager error: the replication control has no"
+                      " statistic"));
+            }
+        }
+
+        writeSummaryLog(_("Manager started"));
+
+        if (mReplication) {
+            result = runManagerSequential(exp, modulemgr, thread, rank,
+                                          world, sink, error);
+        } else if (mSimulationOption & manager::SIMULATION_SPAWN_PROCESS) {
+            result = runManagerProcess(exp, modulemgr, thread, rank, world,
+                                       source, sink, error);
+        } else if (thread > 1) {
+            result = runManagerThread(exp, modulemgr, thread, rank, world,
+                                      source, sink, error);
+        } else {
+            result = runManagerMono(exp, modulemgr, rank, world, source,
+                                    sink, error);
+        }
+
+        if (getCache()) {
+            writeSummaryLog(
+                fmt(_("Manager cache: %1% hits, %2% misses, %3% evictions,"
+                      " %4% bytes\n")) % mCache->hits() % mCache->misses()
+                % mCache->evictions() % mCache->size());
+        }
+
+        writeSummaryLog(_("Manager ended"));
+
         return result;
     }
 
     LogOptions            mLogOption;
     SimulationOptions     mSimulationOption;
     std::ostream         *mOutputStream;
+    utils::Profile       *mProfile;
+    uint32_t              mInitThreads;
+    ResultCache          *mCache;
+    ReplicationControl   *mReplication;
     uint32_t              mCurrentTime;
     uint32_t              mduration;
 };
@@ -275,6 +1177,26 @@ Manager::~Manager()
     delete mPimpl;
 }
 
+void Manager::setProfile(utils::Profile *profile)
+{
+    mPimpl->mProfile = profile;
+}
+
+void Manager::setInitThreads(uint32_t threads)
+{
+    mPimpl->mInitThreads = threads;
+}
+
+void Manager::setCache(ResultCache *cache)
+{
+    mPimpl->mCache = cache;
+}
+
+void Manager::setReplicationControl(ReplicationControl *control)
+{
+    mPimpl->mReplication = control;
+}
+
 value::Matrix * Manager::run(vpz::Vpz             *exp,
                              utils::ModuleManager &modulemgr,
                              uint32_t              thread,
@@ -282,38 +1204,41 @@ value::Matrix * Manager::run(vpz::Vpz             *exp,
                              uint32_t              world,
                              Error                *error)
 {
-    value::Matrix *result = 0;
+    return mPimpl->run(exp, modulemgr, thread, rank, world, 0, 0, error);
+}
 
-    if (thread <= 0) {
-        throw vle::utils::ArgError(
-            fmt(_("Manager error: thread must be superior to 0 (%1%)"))
-            % thread);
+void Manager::run(vpz::Vpz             *exp,
+                  utils::ModuleManager &modulemgr,
+                  uint32_t              thread,
+                  uint32_t              rank,
+                  uint32_t              world,
+                  ResultSink           *sink,
+                  Error                *error)
+{
+    if (not sink) {
+        throw vle::utils::ArgError(_("Manager error: undefined result sink"));
     }
 
-    if (world <= rank) {
-        throw vle::utils::ArgError(
-            fmt(_("Manager error: rank (%1%) must be inferior"
-                  " to world (%2%)"))  % rank % world);
-    }
+    mPimpl->run(exp, modulemgr, thread, rank, world, 0, sink, error);
+}
 
-    if (world <= 0) {
+void Manager::run(vpz::Vpz             *exp,
+                  utils::ModuleManager &modulemgr,
+                  uint32_t              thread,
+                  CombinationSource    *source,
+                  ResultSink           *sink,
+                  Error                *error)
+{
+    if (not source) {
         throw vle::utils::ArgError(
-            fmt(_("Manager error: world (%1%) must be superior to 0."))
-            % world);
+            _("Manager error: undefined combination source"));
     }
 
-    mPimpl->writeSummaryLog(_("Manager started"));
-
-    if (thread > 1) {
-        result = mPimpl->runManagerThread(exp, modulemgr, thread, rank,
-                                          world, error);
-    } else {
-        result = mPimpl->runManagerMono(exp, modulemgr, rank, world, error);
+    if (not sink) {
+        throw vle::utils::ArgError(_("Manager error: undefined result sink"));
     }
 
-    mPimpl->writeSummaryLog(_("Manager ended"));
-
-    return result;
+    mPimpl->run(exp, modulemgr, thread, 0, 1, source, sink, error);
 }
 
 }} // namespace vle manager
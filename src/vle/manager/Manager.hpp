@@ -33,8 +33,19 @@
 #include <vle/manager/Types.hpp>
 #include <vle/vpz/Vpz.hpp>
 
+namespace vle { namespace utils {
+
+class Profile;
+
+}}
+
 namespace vle { namespace manager {
 
+class CombinationSource;
+class ReplicationControl;
+class ResultCache;
+class ResultSink;
+
 /**
  * @c manager::Manager permits to run experimental frames.
  *
@@ -45,6 +56,14 @@ namespace vle { namespace manager {
  * value is a @c value::Matrix or NULL if the @c value::Matrix is
  * empty.
  *
+ * Each combination is simulated @c vpz::Experiment::replicas times.
+ * The runs of the combinations are numbered combination * replicas +
+ * replica, the threads, processes, sources and sinks work on the run
+ * numbers. Each run gets its own random streams from the seed of the
+ * experiment, its combination and its replica (see @c
+ * devs::Dynamics::getRandomStream): the replicas can run in parallel
+ * and the results are reproducible.
+ *
  * @attention You are in charge to freed the manager result @c
  * value::Matrix.
  */
@@ -57,6 +76,57 @@ public:
 
     ~Manager();
 
+    /**
+     * Assign a profile to record the phases of the experimental frame:
+     * the building of the experiment generator (generator), the building
+     * of the conditions of each combination (experiment) and the phases
+     * of each simulation (see @c manager::Simulation::setProfile).
+     *
+     * @param profile The profile, null to disable the profiling. It is
+     * not deleted by the @c manager::Manager.
+     */
+    void setProfile(utils::Profile *profile);
+
+    /**
+     * Assign the number of threads used to build the thread safe dynamics
+     * of each simulation (see @c manager::Simulation::setInitThreads).
+     *
+     * @param threads The number of threads, 1 by default.
+     */
+    void setInitThreads(uint32_t threads);
+
+    /**
+     * Assign a cache of the results to the next experimental frames. The
+     * runs found in the cache are not simulated (see @c
+     * manager::ResultCache), the results of the successful runs are
+     * stored. The numbers of hits and misses are written into the summary
+     * log. The cache is not used with the @c
+     * manager::SIMULATION_NO_RETURN option.
+     *
+     * @param cache The cache, null to disable the cache. It is not
+     * deleted by the @c manager::Manager.
+     */
+    void setCache(ResultCache *cache);
+
+    /**
+     * Assign a control of the replicas to the next experimental frames.
+     *
+     * With a control, the replicas of each combination are run in waves
+     * of @c manager::ReplicationControl::wave replicas. After each wave,
+     * the combinations whose statistics are precise enough stop, the
+     * others run the next wave. The number of replicas of the experiment
+     * (@c vpz::Experiment::replicas) is the maximum number of replicas of
+     * a combination. The number of replicas used by each combination is
+     * written into the summary log and is given by the control.
+     *
+     * The control cannot be used with a @c manager::CombinationSource or
+     * with the @c manager::SIMULATION_NO_RETURN option.
+     *
+     * @param control The control, null to run all the replicas. It is not
+     * deleted by the @c manager::Manager.
+     */
+    void setReplicationControl(ReplicationControl *control);
+
     /**
      * Run an part or a complete experimental frames with mono thread
      * or multi-thread.
@@ -73,6 +143,11 @@ public:
      * the experimental frame. (4, 0, 2) defines four thread by half
      * of experimental frame.
      *
+     * With the @c manager::SIMULATION_SPAWN_PROCESS option, @e thread
+     * is the number of worker processes forked at the start of the
+     * experimental frame. A crash of a simulation is reported as an
+     * error of its combination, its worker is replaced.
+     *
      * @return A @c value::Matrix to freed.
      */
     value::Matrix * run(vpz::Vpz             *exp,
@@ -82,6 +157,53 @@ public:
                         uint32_t              world,
                         Error                *error);
 
+    /**
+     * Run an part or a complete experimental frames and give the result
+     * of each combination to a sink as soon as its simulation is
+     * finished. The results are not kept by the @c manager::Manager.
+     *
+     * @param exp
+     * @param modulemgr
+     * @param thread
+     * @param rank
+     * @param world
+     * @param sink The sink of the results, called by all the threads.
+     * @param error
+     *
+     * @throw utils::ArgError if the sink is null.
+     */
+    void run(vpz::Vpz             *exp,
+             utils::ModuleManager &modulemgr,
+             uint32_t              thread,
+             uint32_t              rank,
+             uint32_t              world,
+             ResultSink           *sink,
+             Error                *error);
+
+    /**
+     * Run the combinations of a complete experimental frame given by a
+     * source and give their results to a sink. The threads take the
+     * chunks of runs from the source until it is empty, the
+     * source can distribute the combinations between several @c
+     * manager::Manager (for example, between MPI processes).
+     *
+     * @param exp
+     * @param modulemgr
+     * @param thread
+     * @param source The source of the combinations, called by all the
+     * threads.
+     * @param sink The sink of the results, called by all the threads.
+     * @param error
+     *
+     * @throw utils::ArgError if the source or the sink is null.
+     */
+    void run(vpz::Vpz             *exp,
+             utils::ModuleManager &modulemgr,
+             uint32_t              thread,
+             CombinationSource    *source,
+             ResultSink           *sink,
+             Error                *error);
+
 private:
     Manager(const Manager& other);
     Manager& operator=(const Manager& other);
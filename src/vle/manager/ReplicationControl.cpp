@@ -0,0 +1,240 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/ReplicationControl.hpp>
+#include <vle/value/Matrix.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/math/distributions/students_t.hpp>
+#include <cmath>
+#include <limits>
+
+namespace vle { namespace manager {
+
+/*
+ * Get the value of a column at the last line of a matrix whose first line
+ * gives the names of the columns.
+ */
+static double getStatistic(const value::Map&  result,
+                           const std::string& view,
+                           const std::string& column)
+{
+    value::Map::const_iterator it = result.value().find(view);
+
+    if (it == result.end() or not it->second or
+        not it->second->isMatrix()) {
+        throw utils::ArgError(
+            fmt(_("Replication control: the view `%1%' is not in the"
+                  " result")) % view);
+    }
+
+    const value::Matrix& matrix(it->second->toMatrix());
+
+    for (value::Matrix::size_type col = 0; col < matrix.columns(); ++col) {
+        const value::Value *name = matrix.get(col, 0);
+
+        if (name and name->isString() and
+            name->toString().value() == column) {
+            const value::Value *cell = matrix.rows() > 1 ?
+                matrix.get(col, matrix.rows() - 1) : 0;
+
+            if (cell and cell->isDouble()) {
+                return cell->toDouble().value();
+            } else if (cell and cell->isInteger()) {
+                return cell->toInteger().value();
+            } else if (cell and cell->isBoolean()) {
+                return cell->toBoolean().value() ? 1.0 : 0.0;
+            }
+
+            throw utils::ArgError(
+                fmt(_("Replication control: the column `%1%' of the view"
+                      " `%2%' has no numeric value")) % column % view);
+        }
+    }
+
+    throw utils::ArgError(
+        fmt(_("Replication control: the column `%1%' is not in the view"
+              " `%2%'")) % column % view);
+}
+
+ReplicationControl::ReplicationControl(uint32_t wave, double confidence)
+    : m_wave(wave), m_confidence(confidence), m_first(0)
+{
+    if (wave == 0) {
+        throw utils::ArgError(
+            _("Replication control: the wave must be greater than 0"));
+    }
+
+    if (not (confidence > 0.0 and confidence < 1.0)) {
+        throw utils::ArgError(
+            fmt(_("Replication control: bad confidence level %1%"))
+            % confidence);
+    }
+}
+
+void ReplicationControl::addStatistic(const std::string& view,
+                                      const std::string& column,
+                                      double             halfwidth,
+                                      double             precision)
+{
+    if (halfwidth < 0.0 or precision < 0.0 or
+        (halfwidth == 0.0 and precision == 0.0)) {
+        throw utils::ArgError(
+            fmt(_("Replication control: bad targets for `%1%:%2%'"))
+            % view % column);
+    }
+
+    Statistic statistic;
+    statistic.view = view;
+    statistic.column = column;
+    statistic.halfwidth = halfwidth;
+    statistic.precision = precision;
+
+    m_statistics.push_back(statistic);
+}
+
+void ReplicationControl::start(uint32_t first, uint32_t last)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::vector < uint32_t >::size_type size = last < first ? 0 :
+        static_cast < uint64_t >(last) - first + 1;
+
+    m_first = first;
+    m_replicas.assign(size, 0);
+    m_estimates.assign(size * m_statistics.size(), Estimate());
+}
+
+void ReplicationControl::update(uint32_t combination, const value::Map *result)
+{
+    if (combination < m_first or combination - m_first >= m_replicas.size()) {
+        throw utils::ArgError(
+            fmt(_("Replication control: combination %1% is not started"))
+            % combination);
+    }
+
+    if (not result) {
+        throw utils::ArgError(
+            fmt(_("Replication control: no result for the combination %1%"))
+            % combination);
+    }
+
+    std::vector < double > values(m_statistics.size());
+
+    for (std::vector < Statistic >::size_type i = 0;
+         i < m_statistics.size(); ++i) {
+        values[i] = getStatistic(*result, m_statistics[i].view,
+                                 m_statistics[i].column);
+    }
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    uint32_t index = combination - m_first;
+
+    m_replicas[index]++;
+
+    for (std::vector < double >::size_type i = 0; i < values.size(); ++i) {
+        Estimate& e(m_estimates[index * m_statistics.size() + i]);
+        double delta = values[i] - e.mean;
+
+        e.count++;
+        e.mean += delta / e.count;
+        e.squares += delta * (values[i] - e.mean);
+    }
+}
+
+bool ReplicationControl::isPrecise(uint32_t combination) const
+{
+    if (replicas(combination) < 2) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < m_statistics.size(); ++i) {
+        const Statistic& statistic(m_statistics[i]);
+        double width = halfWidth(combination, i);
+
+        if (not ((statistic.halfwidth > 0.0 and
+                  width <= statistic.halfwidth) or
+                 (statistic.precision > 0.0 and
+                  width <= statistic.precision *
+                  std::abs(mean(combination, i))))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t ReplicationControl::replicas(uint32_t combination) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (combination < m_first or combination - m_first >= m_replicas.size()) {
+        return 0;
+    }
+
+    return m_replicas[combination - m_first];
+}
+
+double ReplicationControl::mean(uint32_t combination,
+                                uint32_t statistic) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    return estimate(combination, statistic).mean;
+}
+
+double ReplicationControl::halfWidth(uint32_t combination,
+                                     uint32_t statistic) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    const Estimate& e(estimate(combination, statistic));
+
+    if (e.count < 2) {
+        return std::numeric_limits < double >::infinity();
+    }
+
+    boost::math::students_t student(e.count - 1);
+    double t = boost::math::quantile(student, (1.0 + m_confidence) / 2.0);
+
+    return t * std::sqrt(e.squares / (e.count - 1) / e.count);
+}
+
+const ReplicationControl::Estimate&
+ReplicationControl::estimate(uint32_t combination, uint32_t statistic) const
+{
+    if (combination < m_first or combination - m_first >= m_replicas.size()
+        or statistic >= m_statistics.size()) {
+        throw utils::ArgError(
+            fmt(_("Replication control: no statistic %1% for the"
+                  " combination %2%")) % statistic % combination);
+    }
+
+    return m_estimates[(combination - m_first) * m_statistics.size() +
+                       statistic];
+}
+
+}} // namespace vle manager
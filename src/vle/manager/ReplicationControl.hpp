@@ -0,0 +1,228 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_REPLICATIONCONTROL_HPP
+#define VLE_MANAGER_REPLICATIONCONTROL_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/utils/Types.hpp>
+#include <boost/thread/mutex.hpp>
+#include <string>
+#include <vector>
+
+namespace vle { namespace manager {
+
+/**
+ * @c manager::ReplicationControl stops the replicas of the
+ * combinations when their outputs are precise enough.
+ *
+ * The @c manager::Manager runs the replicas of the combinations in
+ * waves (see @c manager::Manager::setReplicationControl). After each
+ * wave, the mean and the confidence interval of Student of each
+ * statistic are updated. A combination stops when the confidence
+ * intervals of all its statistics reach their targets, or when
+ * all the replicas of the experiment (@c vpz::Experiment::replicas) are
+ * run.
+ *
+ * A statistic is the value of a column at the last line of a view: the
+ * value at the end of the simulation for a FINISH view. The first line of
+ * the @c value::Matrix of the view gives the names of the columns, for
+ * example "top:model.port". The value is a @c value::Double, a @c
+ * value::Integer or a @c value::Boolean.
+ *
+ * @code
+ * manager::ReplicationControl control(10, 0.95);
+ * control.addStatistic("view", "top:model.port", 0.0, 0.01);
+ *
+ * vpz->project().experiment().setReplicas(1000); // the cap
+ * manager::Manager man(manager::LOG_SUMMARY, manager::SIMULATION_NONE,
+ *                      &std::cout);
+ * man.setReplicationControl(&control);
+ * value::Matrix *result = man.run(vpz, modules, 4, 0, 1, &error);
+ * std::cout << control.replicas(0) << " replicas\n";
+ * @endcode
+ */
+class VLE_API ReplicationControl
+{
+public:
+    /**
+     * Build a control without statistic.
+     *
+     * @param wave The number of replicas of a combination run in a wave.
+     * @param confidence The level of the confidence intervals.
+     *
+     * @throw utils::ArgError if @e wave is 0 or if @e confidence is not
+     * in (0, 1).
+     */
+    ReplicationControl(uint32_t wave = 10, double confidence = 0.95);
+
+    /**
+     * Add a statistic. The target is reached if the half-width of the
+     * confidence interval is lower than @e halfwidth or lower than @e
+     * precision times the absolute value of the mean.
+     *
+     * @param view The name of the view.
+     * @param column The name of the column.
+     * @param halfwidth The target half-width, 0 to disable.
+     * @param precision The target relative half-width, 0 to disable.
+     *
+     * @throw utils::ArgError if the targets are negative or both disabled.
+     */
+    void addStatistic(const std::string& view,
+                      const std::string& column,
+                      double             halfwidth,
+                      double             precision = 0.0);
+
+    uint32_t wave() const
+    {
+        return m_wave;
+    }
+
+    double confidence() const
+    {
+        return m_confidence;
+    }
+
+    /**
+     * Get the number of statistics.
+     */
+    uint32_t statistics() const
+    {
+        return m_statistics.size();
+    }
+
+    /**
+     * Clear the estimates and prepare the combinations [first, last].
+     * Called by the @c manager::Manager at the start of an experimental
+     * frame.
+     *
+     * @param first The first combination.
+     * @param last The last combination, lower than first if there is no
+     * combination.
+     */
+    void start(uint32_t first, uint32_t last);
+
+    /**
+     * Update the estimates of a combination with the result of one of its
+     * replicas. This function is thread-safe.
+     *
+     * @param combination The combination number.
+     * @param result The result of the replica.
+     *
+     * @throw utils::ArgError if the combination is not started, if the
+     * result is null or if a statistic is not found in the result.
+     */
+    void update(uint32_t combination, const value::Map *result);
+
+    /**
+     * Check if the confidence intervals of all the statistics of a
+     * combination reach their targets. At least two replicas are needed.
+     *
+     * @param combination The combination number.
+     *
+     * @return true if the combination can stop.
+     */
+    bool isPrecise(uint32_t combination) const;
+
+    /**
+     * Get the number of replicas used to estimate the statistics of a
+     * combination.
+     */
+    uint32_t replicas(uint32_t combination) const;
+
+    /**
+     * Get the mean of a statistic of a combination.
+     */
+    double mean(uint32_t combination, uint32_t statistic) const;
+
+    /**
+     * Get the half-width of the confidence interval of a statistic of a
+     * combination, infinite with less than two replicas.
+     */
+    double halfWidth(uint32_t combination, uint32_t statistic) const;
+
+    /**
+     * Get the first combination of the experimental frame.
+     */
+    uint32_t first() const
+    {
+        return m_first;
+    }
+
+    /**
+     * Get the last combination of the experimental frame.
+     */
+    uint32_t last() const
+    {
+        return m_first + m_replicas.size() - 1;
+    }
+
+private:
+    ReplicationControl(const ReplicationControl &other);
+    ReplicationControl& operator=(const ReplicationControl &other);
+
+    struct Statistic
+    {
+        std::string view;
+        std::string column;
+        double      halfwidth;
+        double      precision;
+    };
+
+    /**
+     * The online estimate of a statistic (B. P. Welford, "Note on a
+     * method for calculating corrected sums of squares and products",
+     * Technometrics 4(3), 1962).
+     */
+    struct Estimate
+    {
+        Estimate()
+            : count(0), mean(0.0), squares(0.0)
+        {
+        }
+
+        uint32_t count;
+        double   mean;
+        double   squares;
+    };
+
+    const Estimate& estimate(uint32_t combination, uint32_t statistic) const;
+
+    uint32_t                  m_wave;
+    double                    m_confidence;
+    std::vector < Statistic > m_statistics;
+    uint32_t                  m_first;
+    std::vector < uint32_t >  m_replicas;
+    std::vector < Estimate >  m_estimates;
+    mutable boost::mutex      m_mutex;
+};
+
+}} // namespace vle manager
+
+#endif
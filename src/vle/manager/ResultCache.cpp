@@ -0,0 +1,422 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/ResultCache.hpp>
+#include <vle/vpz/Compiled.hpp>
+#include <vle/vpz/Project.hpp>
+#include <vle/value/Binary.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/Philox.hpp>
+#include <vle/utils/Trace.hpp>
+#include <vle/utils/i18n.hpp>
+#include <vle/version.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <ctime>
+#include <vector>
+
+namespace vle { namespace manager {
+
+namespace fs = boost::filesystem;
+
+/*
+ * A file of the cache is: a magic number, the version of the format, a
+ * marker to detect the byte order, the key and the result written by the
+ * value::BinaryWriter.
+ */
+static const uint32_t CACHE_MAGIC = 0x48434c56;
+static const uint32_t CACHE_FORMAT = 1;
+static const uint32_t CACHE_ENDIAN = 0x01020304;
+
+static const char cacheExtension[] = ".vlerc";
+
+/*
+ * Read a little-endian 32 bits number.
+ */
+static uint32_t readWord(const unsigned char* bytes)
+{
+    return static_cast < uint32_t >(bytes[0]) |
+        (static_cast < uint32_t >(bytes[1]) << 8) |
+        (static_cast < uint32_t >(bytes[2]) << 16) |
+        (static_cast < uint32_t >(bytes[3]) << 24);
+}
+
+/*
+ * Build a 128 bits hash of a buffer with the Davies-Meyer construction
+ * over the Philox block: each 64 bits block of the padded buffer is the
+ * key of the encryption of the state, the result is added to the state.
+ * The padding is a 0x80 byte, zeros and the size of the buffer.
+ */
+static std::string digest(const std::string& buffer)
+{
+    uint32_t state[4] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a };
+    std::string padded(buffer);
+    uint64_t size = buffer.size();
+
+    padded.push_back('\x80');
+    while (padded.size() % 8 != 0) {
+        padded.push_back('\0');
+    }
+    for (int i = 0; i < 8; ++i) {
+        padded.push_back(static_cast < char >((size >> (8 * i)) & 0xff));
+    }
+
+    const unsigned char *bytes =
+        reinterpret_cast < const unsigned char* >(padded.data());
+
+    for (std::string::size_type i = 0; i < padded.size(); i += 8) {
+        const uint32_t key[2] = { readWord(bytes + i),
+                                  readWord(bytes + i + 4) };
+        uint32_t output[4];
+
+        utils::Philox::block(state, key, output);
+
+        for (int j = 0; j < 4; ++j) {
+            state[j] ^= output[j];
+        }
+    }
+
+    static const char digits[] = "0123456789abcdef";
+    std::string result(32, '0');
+
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            result[8 * i + 7 - j] = digits[(state[i] >> (4 * j)) & 0xf];
+        }
+    }
+
+    return result;
+}
+
+/*
+ * A file of the cache with its size and the time of its last use.
+ */
+struct CacheEntry
+{
+    CacheEntry(const fs::path& path, uint64_t size, std::time_t time)
+        : path(path), size(size), time(time)
+    {
+    }
+
+    bool operator<(const CacheEntry& other) const
+    {
+        return time < other.time;
+    }
+
+    fs::path    path;
+    uint64_t    size;
+    std::time_t time;
+};
+
+/*
+ * List the files of the cache directory.
+ */
+static void listEntries(const std::string& directory,
+                        std::vector < CacheEntry >& entries)
+{
+    boost::system::error_code ec;
+
+    for (fs::directory_iterator it(directory, ec), end; not ec and it != end;
+         it.increment(ec)) {
+        if (it->path().extension() == cacheExtension) {
+            boost::system::error_code err;
+            uint64_t size = fs::file_size(it->path(), err);
+            std::time_t time = fs::last_write_time(it->path(), err);
+
+            if (not err) {
+                entries.push_back(CacheEntry(it->path(), size, time));
+            }
+        }
+    }
+}
+
+ResultCache::ResultCache(const std::string& directory, uint64_t capacity)
+    : m_directory(directory), m_capacity(capacity), m_size(0), m_hits(0),
+      m_misses(0), m_evictions(0)
+{
+    boost::system::error_code ec;
+
+    fs::create_directories(m_directory, ec);
+    if (ec or not fs::is_directory(m_directory)) {
+        throw utils::FileError(
+            fmt(_("Result cache: cannot build the directory `%1%'"))
+            % m_directory);
+    }
+
+    std::vector < CacheEntry > entries;
+    listEntries(m_directory, entries);
+
+    for (std::vector < CacheEntry >::const_iterator it = entries.begin();
+         it != entries.end(); ++it) {
+        m_size += it->size;
+    }
+
+    if (m_size > m_capacity) {
+        evict();
+    }
+}
+
+ResultCache::~ResultCache()
+{
+}
+
+std::string ResultCache::identity(const vpz::Project& project) const
+{
+    std::string buffer;
+    value::BinaryWriter out(buffer);
+
+    out.writeString(VLE_VERSION);
+    vpz::Compiled::write(buffer, project);
+
+    const vpz::Dynamics& dynamics(project.dynamics());
+    for (vpz::Dynamics::const_iterator it = dynamics.begin();
+         it != dynamics.end(); ++it) {
+        out.writeString(utils::ModuleManager::buildModuleIdentity(
+                it->second.package(), it->second.library(),
+                utils::MODULE_DYNAMICS));
+    }
+
+    const vpz::Outputs& outputs(project.experiment().views().outputs());
+    for (vpz::Outputs::const_iterator it = outputs.begin();
+         it != outputs.end(); ++it) {
+        out.writeString(utils::ModuleManager::buildModuleIdentity(
+                it->second.package(), it->second.plugin(),
+                utils::MODULE_OOV));
+    }
+
+    return digest(buffer);
+}
+
+std::string ResultCache::key(const std::string&     identity,
+                             const vpz::Conditions *overlay,
+                             uint32_t               combination,
+                             uint32_t               replica) const
+{
+    std::string buffer;
+    value::BinaryWriter out(buffer);
+
+    out.writeString(identity);
+    out.writeUint32(combination);
+    out.writeUint32(replica);
+    out.writeBoolean(overlay != 0);
+    if (overlay) {
+        vpz::Compiled::write(buffer, *overlay);
+    }
+
+    return digest(buffer);
+}
+
+value::Map * ResultCache::get(const std::string& key)
+{
+    const std::string file(filename(key));
+    value::Map *result = 0;
+    bool found = false;
+
+    try {
+        std::ifstream in(file.c_str(), std::ios::in | std::ios::binary);
+
+        if (in) {
+            std::string buffer((std::istreambuf_iterator < char >(in)),
+                               std::istreambuf_iterator < char >());
+            value::BinaryReader reader(buffer.data(), buffer.size());
+
+            if (reader.readUint32() == CACHE_MAGIC and
+                reader.readUint32() == CACHE_FORMAT and
+                reader.readUint32() == CACHE_ENDIAN and
+                reader.readString() == key) {
+                value::Value *value = reader.read();
+
+                if (value and not value->isMap()) {
+                    delete value;
+                    throw utils::ArgError(_("the result is not a map"));
+                }
+
+                result = static_cast < value::Map* >(value);
+                found = true;
+
+                /* The time of the last use is the modification time. */
+                boost::system::error_code ec;
+                fs::last_write_time(file, std::time(0), ec);
+            }
+        }
+    } catch (const std::exception& e) {
+        TraceAlways(fmt(_("Result cache: cannot read `%1%': %2%")) % file
+                    % e.what());
+        boost::system::error_code ec;
+        fs::remove(file, ec);
+    }
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (found) {
+        m_hits++;
+    } else {
+        m_misses++;
+    }
+
+    return result;
+}
+
+void ResultCache::put(const std::string& key, const value::Map *result)
+{
+    const std::string file(filename(key));
+    std::string buffer;
+    value::BinaryWriter out(buffer);
+    uint64_t previous = 0;
+
+    out.writeUint32(CACHE_MAGIC);
+    out.writeUint32(CACHE_FORMAT);
+    out.writeUint32(CACHE_ENDIAN);
+    out.writeString(key);
+    out.write(result);
+
+    /*
+     * The buffer is written into a temporary file and renamed to avoid
+     * reading of a partial file by another thread or process.
+     */
+    try {
+        fs::path tmp(fs::unique_path(file + "-%%%%%%%%"));
+        {
+            std::ofstream stream(tmp.string().c_str(),
+                                 std::ios::out | std::ios::binary);
+            stream.write(buffer.data(), buffer.size());
+
+            if (not stream) {
+                stream.close();
+                fs::remove(tmp);
+                TraceAlways(fmt(_("Result cache: cannot write `%1%'")) %
+                            file);
+                return;
+            }
+        }
+
+        /* The size of a replaced result is removed from the size. */
+        boost::system::error_code ec;
+        previous = fs::file_size(file, ec);
+        if (ec) {
+            previous = 0;
+        }
+
+        fs::rename(tmp, file);
+    } catch (const std::exception& e) {
+        TraceAlways(fmt(_("Result cache: cannot write `%1%': %2%")) % file
+                    % e.what());
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_size = m_size - std::min(m_size, previous) + buffer.size();
+    if (m_size > m_capacity) {
+        evict();
+    }
+}
+
+void ResultCache::clear()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::vector < CacheEntry > entries;
+
+    listEntries(m_directory, entries);
+
+    for (std::vector < CacheEntry >::const_iterator it = entries.begin();
+         it != entries.end(); ++it) {
+        boost::system::error_code ec;
+        fs::remove(it->path, ec);
+    }
+
+    m_size = 0;
+}
+
+uint64_t ResultCache::size() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    return m_size;
+}
+
+uint64_t ResultCache::hits() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    return m_hits;
+}
+
+uint64_t ResultCache::misses() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    return m_misses;
+}
+
+uint64_t ResultCache::evictions() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    return m_evictions;
+}
+
+std::string ResultCache::filename(const std::string& key) const
+{
+    return (fs::path(m_directory) / (key + cacheExtension)).string();
+}
+
+void ResultCache::evict()
+{
+    /*
+     * The directory is read again since other processes can share it: the
+     * size is the real size of the files after the eviction.
+     */
+    std::vector < CacheEntry > entries;
+    listEntries(m_directory, entries);
+    std::sort(entries.begin(), entries.end());
+
+    uint64_t total = 0;
+    for (std::vector < CacheEntry >::const_iterator it = entries.begin();
+         it != entries.end(); ++it) {
+        total += it->size;
+    }
+
+    for (std::vector < CacheEntry >::const_iterator it = entries.begin();
+         it != entries.end() and total > m_capacity; ++it) {
+        boost::system::error_code ec;
+
+        fs::remove(it->path, ec);
+        if (not ec) {
+            total -= it->size;
+            m_evictions++;
+        }
+    }
+
+    m_size = total;
+}
+
+}} // namespace vle manager
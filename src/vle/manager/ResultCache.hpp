@@ -0,0 +1,203 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_RESULTCACHE_HPP
+#define VLE_MANAGER_RESULTCACHE_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/utils/Types.hpp>
+#include <boost/thread/mutex.hpp>
+#include <string>
+
+namespace vle { namespace vpz {
+
+class Project;
+class Conditions;
+
+}}
+
+namespace vle { namespace manager {
+
+/**
+ * @c manager::ResultCache stores the results of the simulations in a
+ * local directory, indexed by the content of the simulations.
+ *
+ * The key of a simulation is a 128 bits hash (Davies-Meyer over the
+ * Philox block, see @c utils::Philox::block) of:
+ *  - the version of VLE;
+ *  - the canonical binary representation of the @c vpz::Project (see
+ *    @c vpz::Compiled::write);
+ *  - the identities of the dynamics and output modules (see @c
+ *    utils::ModuleManager::buildModuleIdentity): a rebuilt module
+ *    invalidates the results;
+ *  - the values of the conditions of the run;
+ *  - the combination and the replica of the run, which select its random
+ *    streams.
+ *
+ * A run whose key is found returns the stored @c value::Map without
+ * simulation. Only the results returned by the simulation are stored,
+ * the files written by the output plug-ins are not.
+ *
+ * The result of a key is stored in its own file, written into a
+ * temporary file then renamed: several processes can share the same
+ * directory. When the size of the files exceeds the capacity, the files
+ * used the least recently are removed. The errors of the cache are
+ * traced and the simulations run as if the cache was empty.
+ *
+ * The functions are thread-safe.
+ *
+ * @code
+ * manager::ResultCache cache("/tmp/vle-cache", 1024 * 1024 * 1024);
+ * manager::Manager man(manager::LOG_NONE, manager::SIMULATION_NONE, 0);
+ * man.setCache(&cache);
+ * value::Matrix *result = man.run(vpz, modules, 4, 0, 1, &error);
+ * std::cout << cache.hits() << " hits " << cache.misses() << " misses\n";
+ * @endcode
+ */
+class VLE_API ResultCache
+{
+public:
+    /**
+     * Open a cache directory.
+     *
+     * @param directory The directory of the cache, built if it does not
+     * exist.
+     * @param capacity The maximal size in bytes of the files of the
+     * cache.
+     *
+     * @throw utils::FileError if the directory cannot be built.
+     */
+    ResultCache(const std::string& directory,
+                uint64_t capacity = 1024 * 1024 * 1024);
+
+    ~ResultCache();
+
+    /**
+     * Build the identity of a project: the hash of the project and of the
+     * identities of its modules. It is computed once for all the runs of
+     * an experimental frame.
+     *
+     * @param project The project.
+     *
+     * @return A string of 32 hexadecimal digits.
+     */
+    std::string identity(const vpz::Project& project) const;
+
+    /**
+     * Build the key of a run.
+     *
+     * @param identity The identity of the project (see @c identity).
+     * @param overlay The values of the conditions of the run or null if
+     * the conditions of the project are used.
+     * @param combination The combination number.
+     * @param replica The replica number.
+     *
+     * @return A string of 32 hexadecimal digits.
+     */
+    std::string key(const std::string&     identity,
+                    const vpz::Conditions *overlay,
+                    uint32_t               combination,
+                    uint32_t               replica) const;
+
+    /**
+     * Get the result of a key.
+     *
+     * @param key The key of the run.
+     *
+     * @return A new @c value::Map to freed or null if the key is not in
+     * the cache.
+     */
+    value::Map * get(const std::string& key);
+
+    /**
+     * Store the result of a key, the previous result of the key is
+     * replaced. The least recently used results are removed if the
+     * capacity is exceeded.
+     *
+     * @param key The key of the run.
+     * @param result The result to store, can be null.
+     */
+    void put(const std::string& key, const value::Map *result);
+
+    /**
+     * Remove the results of the cache.
+     */
+    void clear();
+
+    const std::string& directory() const
+    {
+        return m_directory;
+    }
+
+    uint64_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /**
+     * Get the size in bytes of the files of the cache, updated by the
+     * calls of @c put and by the evictions.
+     */
+    uint64_t size() const;
+
+    /**
+     * Get the number of calls of @c get which found a result.
+     */
+    uint64_t hits() const;
+
+    /**
+     * Get the number of calls of @c get which did not find a result.
+     */
+    uint64_t misses() const;
+
+    /**
+     * Get the number of results removed to respect the capacity.
+     */
+    uint64_t evictions() const;
+
+private:
+    ResultCache(const ResultCache &other);
+    ResultCache& operator=(const ResultCache &other);
+
+    std::string filename(const std::string& key) const;
+
+    void evict();
+
+    std::string          m_directory;
+    uint64_t             m_capacity;
+    uint64_t             m_size;
+    uint64_t             m_hits;
+    uint64_t             m_misses;
+    uint64_t             m_evictions;
+    mutable boost::mutex m_mutex;
+};
+
+}} // namespace vle manager
+
+#endif
@@ -0,0 +1,553 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/ResultSink.hpp>
+#include <vle/value/Boolean.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/String.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <cstring>
+
+namespace vle { namespace manager {
+
+/*
+ * The columnar file is:
+ *  - the magic string;
+ *  - the records: the combination number, a flag set if the result is
+ *    not null, the number of matrices and for each matrix, its name, its
+ *    number of columns and lines, a flag set if the names of the columns
+ *    are stored and for each column, its name, its type, a byte per line
+ *    set if the value is not null and the values which are not null;
+ *  - the index: the number of records and for each record, its
+ *    combination number and its offset;
+ *  - the offset of the index and the magic string.
+ *
+ * The integers and doubles are stored in the byte order of the host.
+ */
+
+static const char columnarMagic[8] = { 'V', 'L', 'E', 'C', 'O', 'L',
+                                       '0', '1' };
+
+enum ColumnType
+{
+    COLUMN_DOUBLE = 0,
+    COLUMN_INTEGER = 1,
+    COLUMN_BOOLEAN = 2,
+    COLUMN_STRING = 3
+};
+
+template < typename T >
+static void put(std::string& out, const T& value)
+{
+    out.append(reinterpret_cast < const char* >(&value), sizeof(T));
+}
+
+static void putString(std::string& out, const std::string& str)
+{
+    put(out, static_cast < uint32_t >(str.size()));
+    out.append(str);
+}
+
+static bool isNullCell(const value::Value* cell)
+{
+    return not cell or cell->isNull();
+}
+
+/*
+ * Get the type of a column from all its lines from the first one, the
+ * null cells are ignored: the type of its values if they are all double,
+ * all integer or all boolean, string otherwise. A column of null cells
+ * is double.
+ */
+static ColumnType getColumnType(const value::Matrix& matrix,
+                                value::Matrix::size_type column,
+                                value::Matrix::size_type first)
+{
+    bool found = false;
+    ColumnType result = COLUMN_DOUBLE;
+
+    for (value::Matrix::size_type row = first; row < matrix.rows(); ++row) {
+        const value::Value* cell = matrix.get(column, row);
+        ColumnType type;
+
+        if (isNullCell(cell)) {
+            continue;
+        }
+
+        switch (cell->getType()) {
+        case value::Value::DOUBLE:
+            type = COLUMN_DOUBLE;
+            break;
+        case value::Value::INTEGER:
+            type = COLUMN_INTEGER;
+            break;
+        case value::Value::BOOLEAN:
+            type = COLUMN_BOOLEAN;
+            break;
+        default:
+            return COLUMN_STRING;
+        }
+
+        if (not found) {
+            result = type;
+            found = true;
+        } else if (type != result) {
+            return COLUMN_STRING;
+        }
+    }
+
+    return result;
+}
+
+static bool hasHeader(const value::Matrix& matrix)
+{
+    if (matrix.rows() == 0 or matrix.columns() == 0) {
+        return false;
+    }
+
+    for (value::Matrix::size_type col = 0; col < matrix.columns(); ++col) {
+        const value::Value* cell = matrix.get(col, 0);
+
+        if (not cell or not cell->isString()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void putMatrix(std::string& out, const std::string& name,
+                      const value::Matrix& matrix)
+{
+    bool header = hasHeader(matrix);
+    value::Matrix::size_type first = header ? 1 : 0;
+
+    putString(out, name);
+    put(out, static_cast < uint32_t >(matrix.columns()));
+    put(out, static_cast < uint32_t >(matrix.rows() - first));
+    put(out, static_cast < uint8_t >(header));
+
+    for (value::Matrix::size_type col = 0; col < matrix.columns(); ++col) {
+        if (header) {
+            putString(out, value::toString(matrix.get(col, 0)));
+        }
+
+        ColumnType type = getColumnType(matrix, col, first);
+        put(out, static_cast < uint8_t >(type));
+
+        for (value::Matrix::size_type row = first; row < matrix.rows();
+             ++row) {
+            put(out, static_cast < uint8_t >(
+                    not isNullCell(matrix.get(col, row))));
+        }
+
+        for (value::Matrix::size_type row = first; row < matrix.rows();
+             ++row) {
+            const value::Value* cell = matrix.get(col, row);
+
+            if (isNullCell(cell)) {
+                continue;
+            }
+
+            switch (type) {
+            case COLUMN_DOUBLE:
+                put(out, cell->toDouble().value());
+                break;
+            case COLUMN_INTEGER:
+                put(out, cell->toInteger().value());
+                break;
+            case COLUMN_BOOLEAN:
+                put(out, static_cast < uint8_t >(cell->toBoolean().value()));
+                break;
+            case COLUMN_STRING:
+                putString(out, cell->isString() ? cell->toString().value()
+                          : cell->writeToString());
+                break;
+            }
+        }
+    }
+}
+
+static void putRecord(std::string& out, uint32_t index,
+                      const value::Map* result)
+{
+    put(out, index);
+    put(out, static_cast < uint8_t >(result != 0));
+
+    if (not result) {
+        return;
+    }
+
+    uint32_t matrices = 0;
+    for (value::Map::const_iterator it = result->begin();
+         it != result->end(); ++it) {
+        if (it->second and it->second->isMatrix()) {
+            ++matrices;
+        }
+    }
+
+    put(out, matrices);
+    for (value::Map::const_iterator it = result->begin();
+         it != result->end(); ++it) {
+        if (it->second and it->second->isMatrix()) {
+            putMatrix(out, it->first, it->second->toMatrix());
+        }
+    }
+}
+
+template < typename T >
+static T get(std::istream& in, const std::string& filename)
+{
+    T value;
+
+    if (not in.read(reinterpret_cast < char* >(&value), sizeof(T))) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': unexpected end of file")) %
+            filename);
+    }
+
+    return value;
+}
+
+static std::string getString(std::istream& in, const std::string& filename)
+{
+    uint32_t size = get < uint32_t >(in, filename);
+    std::string result(size, '\0');
+
+    if (size > 0 and not in.read(&result[0], size)) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': unexpected end of file")) %
+            filename);
+    }
+
+    return result;
+}
+
+static value::Matrix * getMatrix(std::istream& in,
+                                 const std::string& filename)
+{
+    uint32_t columns = get < uint32_t >(in, filename);
+    uint32_t rows = get < uint32_t >(in, filename);
+    bool header = get < uint8_t >(in, filename);
+    uint32_t first = header ? 1 : 0;
+
+    value::Matrix *matrix = new value::Matrix(columns, rows + first,
+                                              1, 1);
+
+    try {
+        std::vector < uint8_t > present(rows);
+
+        for (uint32_t col = 0; col < columns; ++col) {
+            if (header) {
+                matrix->addString(col, 0, getString(in, filename));
+            }
+
+            uint8_t type = get < uint8_t >(in, filename);
+
+            for (uint32_t row = 0; row < rows; ++row) {
+                present[row] = get < uint8_t >(in, filename);
+            }
+
+            for (uint32_t row = 0; row < rows; ++row) {
+                if (not present[row]) {
+                    continue;
+                }
+
+                switch (type) {
+                case COLUMN_DOUBLE:
+                    matrix->addDouble(col, row + first,
+                                      get < double >(in, filename));
+                    break;
+                case COLUMN_INTEGER:
+                    matrix->addInt(col, row + first,
+                                   get < int32_t >(in, filename));
+                    break;
+                case COLUMN_BOOLEAN:
+                    matrix->addBoolean(col, row + first,
+                                       get < uint8_t >(in, filename));
+                    break;
+                case COLUMN_STRING:
+                    matrix->addString(col, row + first,
+                                      getString(in, filename));
+                    break;
+                default:
+                    throw utils::FileError(
+                        fmt(_("Columnar file `%1%': unknown column type"
+                              " %2%")) % filename % (int)type);
+                }
+            }
+        }
+    } catch (...) {
+        delete matrix;
+        throw;
+    }
+
+    return matrix;
+}
+
+                       /* - - - - - - - - - -*/
+
+MatrixSink::MatrixSink(uint32_t size, uint32_t replicas)
+    : m_matrix(new value::Matrix(size, replicas, size, replicas)),
+    m_replicas(replicas ? replicas : 1)
+{
+}
+
+MatrixSink::~MatrixSink()
+{
+    delete m_matrix;
+}
+
+void MatrixSink::write(uint32_t index, value::Map *result)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_matrix->add(index / m_replicas, index % m_replicas, result);
+}
+
+value::Matrix * MatrixSink::release()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    value::Matrix *result = m_matrix;
+    m_matrix = 0;
+    return result;
+}
+
+                       /* - - - - - - - - - -*/
+
+ColumnarSink::ColumnarSink(const std::string &filename,
+                           std::size_t capacity)
+    : m_filename(filename), m_capacity(capacity), m_offset(0)
+{
+    m_file.open(filename.c_str(), std::ios::out | std::ios::binary |
+                std::ios::trunc);
+
+    if (not m_file.is_open()) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': cannot open file")) % filename);
+    }
+
+    m_buffer.reserve(capacity);
+    m_buffer.append(columnarMagic, sizeof(columnarMagic));
+    m_offset = m_buffer.size();
+}
+
+ColumnarSink::~ColumnarSink()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void ColumnarSink::write(uint32_t index, value::Map *result)
+{
+    std::string record;
+
+    try {
+        putRecord(record, index, result);
+    } catch (...) {
+        delete result;
+        throw;
+    }
+
+    delete result;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (not m_file.is_open()) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': file is closed")) % m_filename);
+    }
+
+    m_index.push_back(std::make_pair(index, m_offset));
+    m_offset += record.size();
+
+    if (m_buffer.size() + record.size() > m_capacity) {
+        flushBuffer();
+    }
+
+    if (record.size() > m_capacity) {
+        if (not m_file.write(record.data(), record.size())) {
+            throw utils::FileError(
+                fmt(_("Columnar file `%1%': cannot write file")) %
+                m_filename);
+        }
+    } else {
+        m_buffer.append(record);
+    }
+}
+
+void ColumnarSink::flush()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_file.is_open()) {
+        flushBuffer();
+        m_file.flush();
+    }
+}
+
+void ColumnarSink::close()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (not m_file.is_open()) {
+        return;
+    }
+
+    uint64_t offset = m_offset;
+
+    put(m_buffer, static_cast < uint32_t >(m_index.size()));
+    for (IndexList::const_iterator it = m_index.begin();
+         it != m_index.end(); ++it) {
+        put(m_buffer, it->first);
+        put(m_buffer, it->second);
+    }
+    put(m_buffer, offset);
+    m_buffer.append(columnarMagic, sizeof(columnarMagic));
+
+    flushBuffer();
+    m_file.close();
+    m_index.clear();
+
+    if (m_file.fail()) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': cannot write file")) % m_filename);
+    }
+}
+
+void ColumnarSink::flushBuffer()
+{
+    if (not m_buffer.empty()) {
+        if (not m_file.write(m_buffer.data(), m_buffer.size())) {
+            throw utils::FileError(
+                fmt(_("Columnar file `%1%': cannot write file")) %
+                m_filename);
+        }
+
+        m_buffer.clear();
+    }
+}
+
+                       /* - - - - - - - - - -*/
+
+ColumnarReader::ColumnarReader(const std::string &filename)
+    : m_filename(filename)
+{
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    char magic[sizeof(columnarMagic)];
+
+    if (not in.is_open()) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': cannot open file")) % filename);
+    }
+
+    if (not in.read(magic, sizeof(magic)) or
+        std::memcmp(magic, columnarMagic, sizeof(magic))) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': bad file format")) % filename);
+    }
+
+    in.seekg(-static_cast < std::streamoff >(sizeof(uint64_t) +
+                                             sizeof(magic)), std::ios::end);
+    uint64_t offset = get < uint64_t >(in, filename);
+
+    if (not in.read(magic, sizeof(magic)) or
+        std::memcmp(magic, columnarMagic, sizeof(magic))) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': file not closed")) % filename);
+    }
+
+    in.seekg(offset);
+    uint32_t size = get < uint32_t >(in, filename);
+
+    m_index.reserve(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        uint32_t index = get < uint32_t >(in, filename);
+        uint64_t record = get < uint64_t >(in, filename);
+
+        m_index.push_back(std::make_pair(index, record));
+        m_offsets.insert(std::make_pair(index, record));
+    }
+}
+
+std::vector < uint32_t > ColumnarReader::indexes() const
+{
+    std::vector < uint32_t > result;
+
+    result.reserve(m_index.size());
+    for (IndexList::const_iterator it = m_index.begin();
+         it != m_index.end(); ++it) {
+        result.push_back(it->first);
+    }
+
+    return result;
+}
+
+value::Map * ColumnarReader::read(uint32_t index) const
+{
+    OffsetList::const_iterator it = m_offsets.find(index);
+
+    if (it == m_offsets.end()) {
+        return 0;
+    }
+
+    std::ifstream in(m_filename.c_str(), std::ios::in | std::ios::binary);
+    in.seekg(it->second);
+
+    if (get < uint32_t >(in, m_filename) != index) {
+        throw utils::FileError(
+            fmt(_("Columnar file `%1%': bad index of combination %2%")) %
+            m_filename % index);
+    }
+
+    if (not get < uint8_t >(in, m_filename)) {
+        return 0;
+    }
+
+    uint32_t matrices = get < uint32_t >(in, m_filename);
+    value::Map *result = new value::Map();
+
+    try {
+        for (uint32_t i = 0; i < matrices; ++i) {
+            std::string name = getString(in, m_filename);
+            result->add(name, getMatrix(in, m_filename));
+        }
+    } catch (...) {
+        delete result;
+        throw;
+    }
+
+    return result;
+}
+
+}} // namespace vle manager
@@ -0,0 +1,254 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_RESULTSINK_HPP
+#define VLE_MANAGER_RESULTSINK_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/value/Matrix.hpp>
+#include <boost/thread/mutex.hpp>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vle { namespace manager {
+
+/**
+ * @c manager::ResultSink receives the results of the combinations of
+ * an experimental frame as soon as their simulations are finished.
+ *
+ * The @c manager::Manager calls @c write from all its threads, the
+ * implementations must be thread-safe.
+ */
+class VLE_API ResultSink
+{
+public:
+    virtual ~ResultSink()
+    {
+    }
+
+    /**
+     * Receive the result of a combination.
+     *
+     * @param index The run number: the combination number multiplied by
+     * the number of replicas of the experiment plus the replica number,
+     * the combination number without replicas.
+     * @param result The result of the simulation: the key is the name of
+     * the @c devs::View and the value is a @c value::Matrix. The sink is
+     * in charge to freed the result, null with the @c
+     * manager::SIMULATION_NO_RETURN option.
+     */
+    virtual void write(uint32_t index, value::Map *result) = 0;
+
+    /**
+     * Called by the @c manager::Manager at the end of the experimental
+     * frame.
+     */
+    virtual void flush()
+    {
+    }
+};
+
+/**
+ * @c manager::MatrixSink stores the results in memory in a @c
+ * value::Matrix: the column is the combination number, the line the
+ * replica.
+ */
+class VLE_API MatrixSink : public ResultSink
+{
+public:
+    /**
+     * Build a sink for a number of combinations.
+     *
+     * @param size The initial number of columns of the @c value::Matrix.
+     * @param replicas The number of lines of the @c value::Matrix.
+     */
+    MatrixSink(uint32_t size, uint32_t replicas = 1);
+
+    virtual ~MatrixSink();
+
+    virtual void write(uint32_t index, value::Map *result);
+
+    /**
+     * Get the @c value::Matrix of the results. The sink releases the
+     * ownership of the @c value::Matrix.
+     *
+     * @return A @c value::Matrix to freed.
+     */
+    value::Matrix * release();
+
+private:
+    MatrixSink(const MatrixSink &other);
+    MatrixSink& operator=(const MatrixSink &other);
+
+    value::Matrix *m_matrix;
+    uint32_t       m_replicas;
+    boost::mutex   m_mutex;
+};
+
+/**
+ * @c manager::ColumnarSink writes the results into a single columnar
+ * file, keyed by combination number.
+ *
+ * The result of a combination is written as a record: for each @c
+ * value::Matrix of the result, the values of each column are stored
+ * contiguously. Columns of @c value::Double, @c value::Integer or @c
+ * value::Boolean are stored in binary, the other values are stored as
+ * strings. If the first line of a @c value::Matrix contains only
+ * strings, it is stored as the names of the columns. An index of the
+ * records is written at the end of the file by @c close. The numbers
+ * are stored in the byte order of the host.
+ *
+ * The records are serialized by the calling thread then appended to a
+ * buffer flushed to the file when it exceeds its capacity, the memory
+ * used does not depend on the number of combinations (except the index:
+ * twelve bytes per combination).
+ *
+ * @code
+ * manager::ColumnarSink sink("results.vlecol");
+ * manager::Error error;
+ * manager.run(vpz, modulemgr, 4, 0, 1, &sink, &error);
+ * sink.close();
+ *
+ * manager::ColumnarReader reader("results.vlecol");
+ * value::Map *result = reader.read(reader.indexes().front());
+ * @endcode
+ */
+class VLE_API ColumnarSink : public ResultSink
+{
+public:
+    /**
+     * Open the file and write its header.
+     *
+     * @param filename The name of the file, replaced if it exists.
+     * @param capacity The size in bytes of the buffer.
+     *
+     * @throw utils::FileError if the file cannot be opened.
+     */
+    ColumnarSink(const std::string &filename,
+                 std::size_t capacity = 4 * 1024 * 1024);
+
+    /**
+     * Close the file if it is not already closed. The errors are
+     * ignored.
+     */
+    virtual ~ColumnarSink();
+
+    /**
+     * Serialize the result and append it to the buffer.
+     *
+     * @throw utils::FileError if the buffer cannot be written.
+     */
+    virtual void write(uint32_t index, value::Map *result);
+
+    /**
+     * Write the buffer into the file.
+     *
+     * @throw utils::FileError if the buffer cannot be written.
+     */
+    virtual void flush();
+
+    /**
+     * Write the buffer and the index of the records, then close the
+     * file. Next calls do nothing.
+     *
+     * @throw utils::FileError if the file cannot be written.
+     */
+    void close();
+
+private:
+    ColumnarSink(const ColumnarSink &other);
+    ColumnarSink& operator=(const ColumnarSink &other);
+
+    void flushBuffer();
+
+    typedef std::vector < std::pair < uint32_t, uint64_t > > IndexList;
+
+    std::string    m_filename;
+    std::ofstream  m_file;
+    std::string    m_buffer;
+    std::size_t    m_capacity;
+    uint64_t       m_offset; /* the offset of the end of the buffer. */
+    IndexList      m_index;
+    boost::mutex   m_mutex;
+};
+
+/**
+ * @c manager::ColumnarReader reads the results of a file written by a
+ * @c manager::ColumnarSink.
+ */
+class VLE_API ColumnarReader
+{
+public:
+    /**
+     * Open the file and read the index of the records.
+     *
+     * @param filename The name of the file.
+     *
+     * @throw utils::FileError if the file cannot be read or is not a
+     * closed columnar file.
+     */
+    ColumnarReader(const std::string &filename);
+
+    /**
+     * Get the combination numbers stored in the file, in the order of
+     * the records.
+     *
+     * @return The list of combination numbers.
+     */
+    std::vector < uint32_t > indexes() const;
+
+    /**
+     * Read the result of a combination. The @c value::Double, @c
+     * value::Integer and @c value::Boolean values are restored, the
+     * others are read as @c value::String.
+     *
+     * @param index The combination number.
+     *
+     * @return The result to freed, null if the combination is not
+     * stored or if its result was null.
+     *
+     * @throw utils::FileError if the record cannot be read.
+     */
+    value::Map * read(uint32_t index) const;
+
+private:
+    typedef std::vector < std::pair < uint32_t, uint64_t > > IndexList;
+    typedef std::map < uint32_t, uint64_t > OffsetList;
+
+    std::string m_filename;
+    IndexList   m_index; /* the records in the order of the file. */
+    OffsetList  m_offsets; /* the offset of the record of a combination. */
+};
+
+}} // namespace vle manager
+
+#endif
@@ -29,8 +29,14 @@
 #include <vle/utils/ModuleManager.hpp>
 #include <vle/utils/Tools.hpp>
 #include <vle/utils/Trace.hpp>
+#include <vle/utils/Profile.hpp>
 #include <vle/devs/RootCoordinator.hpp>
 #include <vle/manager/Simulation.hpp>
+#include <vle/manager/ResultCache.hpp>
+#include <vle/manager/details/ProcessPool.hpp>
+#include <vle/value/Binary.hpp>
+#include <vle/vpz/BaseModel.hpp>
+#include <vle/vpz/Compiled.hpp>
 #include <boost/timer.hpp>
 #include <boost/progress.hpp>
 
@@ -38,9 +44,24 @@ namespace vle { namespace manager {
 
 struct Simulation::Pimpl
 {
+    struct process;
+
     std::ostream      *m_out;
     LogOptions         m_logoptions;
     SimulationOptions  m_simulationoptions;
+    const vpz::Conditions *m_overlay; /* conditions of a shared vpz or
+                                         null. */
+    std::string        m_experiment;
+    int                m_instance;
+    utils::Profile    *m_profile;
+    uint32_t           m_initThreads;
+    ResultCache       *m_cache;
+    uint32_t           m_combination;
+    uint32_t           m_replica;
+    uint64_t           m_events;
+    process           *m_process;
+    ProcessPool       *m_pool; /* the workers of the spawned simulations,
+                                  forked at the first one. */
 
 public:
     Pimpl(LogOptions         logoptions,
@@ -48,16 +69,101 @@ public:
           std::ostream      *output)
         : m_out(output),
           m_logoptions(logoptions),
-          m_simulationoptions(simulationoptionts)
+          m_simulationoptions(simulationoptionts),
+          m_overlay(0),
+          m_instance(0),
+          m_profile(0),
+          m_initThreads(1),
+          m_cache(0),
+          m_combination(0),
+          m_replica(0),
+          m_events(0),
+          m_process(0),
+          m_pool(0)
     {
-        if (m_simulationoptions & manager::SIMULATION_SPAWN_PROCESS)
-            TraceAlways(
-                _("Simulation: SIMULATION_SPAWN_PROCESS is not yet"
-                    " implemented"));
     }
 
     ~Pimpl()
     {
+        delete m_pool;
+        delete m_process;
+    }
+
+    /**
+     * Load the models into the root coordinator. The vpz is shared with
+     * other simulations if an overlay is defined.
+     */
+    void load(devs::RootCoordinator& root, const vpz::Vpz& vpz)
+    {
+        root.setProfile(m_profile);
+        root.setInitThreads(m_initThreads);
+        root.setStream(m_combination, m_replica);
+
+        if (m_overlay) {
+            root.load(vpz, m_experiment, m_instance, *m_overlay);
+        } else {
+            root.load(vpz);
+        }
+    }
+
+    /**
+     * Delete the vpz if it is not shared with other simulations.
+     */
+    void clean(vpz::Vpz *vpz)
+    {
+        if (not m_overlay) {
+            delete vpz;
+        }
+    }
+
+    /**
+     * Delete the vpz and its models if the vpz is not shared with other
+     * simulations and is not loaded into a root coordinator.
+     */
+    void release(vpz::Vpz *vpz)
+    {
+        if (not m_overlay) {
+            delete vpz->project().model().model();
+            delete vpz;
+        }
+    }
+
+    /**
+     * Run the simulation until its end.
+     */
+    void run(devs::RootCoordinator& root)
+    {
+        utils::ProfileScope scope(m_profile, "run");
+        uint64_t bags = 0;
+
+        while (root.run()) {
+            ++bags;
+        }
+
+        scope.setCount(bags);
+        m_events = root.events();
+    }
+
+    /**
+     * Finish the simulation and get the results.
+     */
+    value::Map * finish(devs::RootCoordinator& root)
+    {
+        utils::ProfileScope scope(m_profile, "finish");
+
+        root.finish();
+        return root.outputs();
+    }
+
+    /**
+     * Write the wall time and the CPU time spent since the beginning of
+     * the simulation.
+     */
+    void writeTime(double wall, const boost::timer& timer)
+    {
+        write(fmt(_(" - Time spent in kernel .........: %1% s"
+                    " (cpu %2% s)"))
+              % (utils::Profile::wallTime() - wall) % timer.elapsed());
     }
 
     template <typename T>
@@ -76,6 +182,7 @@ public:
     {
         value::Map   *result = 0;
         boost::timer  timer;
+        double        wall = utils::Profile::wallTime();
 
         try {
             devs::RootCoordinator root(modulemgr);
@@ -86,13 +193,12 @@ public:
             write(fmt(_("[%1%]\n")) % vpz->filename());
             write(_(" - Coordinator load models ......: "));
 
-            root.load(*vpz);
+            load(root, *vpz);
 
             write(_("ok\n"));
 
             write(_(" - Clean project file ...........: "));
-            vpz->clear();
-            delete vpz;
+            clean(vpz);
             write(_("ok\n"));
 
             write(_(" - Coordinator initializing .....: "));
@@ -101,27 +207,33 @@ public:
 
             write(_(" - Simulation run................: "));
 
-            boost::progress_display display(100, *m_out, "\n   ", "   ", "   ");
-            long                    previous = 0;
-
-            while (root.run()) {
-                long pc = std::floor(100. * (root.getCurrentTime() - begin) /
-                                     duration);
-
-                display  += pc - previous;
-                previous  = pc;
+            {
+                utils::ProfileScope scope(m_profile, "run");
+                boost::progress_display display(100, *m_out, "\n   ", "   ",
+                                                "   ");
+                long previous = 0;
+                uint64_t bags = 0;
+
+                while (root.run()) {
+                    long pc = std::floor(100. *
+                                         (root.getCurrentTime() - begin) /
+                                         duration);
+
+                    display  += pc - previous;
+                    previous  = pc;
+                    ++bags;
+                }
+
+                display += 100 - previous;
+                scope.setCount(bags);
+                m_events = root.events();
             }
 
-            display += 100 - previous;
-
             write(_(" - Coordinator cleaning .........: "));
-            root.finish();
+            result = finish(root);
             write(_("ok\n"));
 
-            result = root.outputs();
-
-            write(fmt(_(" - Time spent in kernel .........: %1% s"))
-                  % timer.elapsed());
+            writeTime(wall, timer);
 
             error->code    = 0;
         } catch(const std::exception& e) {
@@ -140,6 +252,7 @@ public:
     {
         value::Map   *result = 0;
         boost::timer  timer;
+        double        wall = utils::Profile::wallTime();
 
         try {
             devs::RootCoordinator root(modulemgr);
@@ -147,13 +260,12 @@ public:
             write(fmt(_("[%1%]\n")) % vpz->filename());
             write(_(" - Coordinator load models ......: "));
 
-            root.load(*vpz);
+            load(root, *vpz);
 
             write(_("ok\n"));
 
             write(_(" - Clean project file ...........: "));
-            vpz->clear();
-            delete vpz;
+            clean(vpz);
             write(_("ok\n"));
 
             write(_(" - Coordinator initializing .....: "));
@@ -162,17 +274,14 @@ public:
 
             write(_(" - Simulation run................: "));
 
-            while (root.run());
+            run(root);
             write(_("ok\n"));
 
             write(_(" - Coordinator cleaning .........: "));
-            root.finish();
+            result = finish(root);
             write(_("ok\n"));
 
-            result = root.outputs();
-
-            write(fmt(_(" - Time spent in kernel .........: %1% s"))
-                  % timer.elapsed());
+            writeTime(wall, timer);
 
             error->code    = 0;
         } catch(const std::exception& e) {
@@ -185,6 +294,180 @@ public:
         return result;
     }
 
+    value::Map * runLocal(vpz::Vpz                   *vpz,
+                          const utils::ModuleManager &modulemgr,
+                          Error                      *error)
+    {
+        if (m_logoptions != manager::LOG_NONE) {
+            if (m_logoptions & manager::LOG_RUN and m_out) {
+                return runVerboseRun(vpz, modulemgr, error);
+            } else {
+                return runVerboseSummary(vpz, modulemgr, error);
+            }
+        } else {
+            return runQuiet(vpz, modulemgr, error);
+        }
+    }
+
+    /**
+     * Write the experiment of a simulation into the request of a worker:
+     * the stream of the simulation, the overlay and the project (see @c
+     * vpz::Compiled).
+     */
+    void writeRequest(std::string& request, const vpz::Vpz& vpz) const
+    {
+        value::BinaryWriter out(request);
+
+        out.writeUint32(m_combination);
+        out.writeUint32(m_replica);
+        out.writeString(vpz.filename());
+        out.writeBoolean(m_overlay != 0);
+
+        if (m_overlay) {
+            std::string conditions;
+            vpz::Compiled::write(conditions, *m_overlay);
+
+            out.writeString(m_experiment);
+            out.writeInt32(m_instance);
+            out.writeString(conditions);
+        }
+
+        vpz::Compiled::write(request, vpz.project());
+    }
+
+    /**
+     * Rebuild the experiment of a simulation from the request of a
+     * worker.
+     */
+    void readRequest(const std::string& request, vpz::Vpz *vpz,
+                     vpz::Conditions *overlay)
+    {
+        value::BinaryReader in(request.data(), request.size());
+
+        m_combination = in.readUint32();
+        m_replica = in.readUint32();
+        vpz->setFilename(in.readString());
+        m_overlay = 0;
+
+        if (in.readBoolean()) {
+            m_experiment = in.readString();
+            m_instance = in.readInt32();
+
+            std::string conditions = in.readString();
+            vpz::Compiled::read(conditions.data(), conditions.size(),
+                                *overlay);
+            m_overlay = overlay;
+        }
+
+        vpz::Compiled::read(request.data() + in.position(),
+                            request.size() - in.position(), vpz->project());
+    }
+
+    /**
+     * The simulations run in a subprocess: the experiment is sent to a
+     * worker of the @c ProcessPool of the simulation, the worker rebuilds
+     * and runs it, the result is sent back by the @c ProcessPool.
+     */
+    struct process : ProcessPool::Job, ProcessPool::Handler
+    {
+        Pimpl                      &pimpl;
+        const utils::ModuleManager *modulemgr;
+        value::Map                 *result;
+        Error                      *error;
+
+        process(Pimpl &pimpl, const utils::ModuleManager &modulemgr)
+            : pimpl(pimpl), modulemgr(&modulemgr), result(0), error(0)
+        {
+        }
+
+        virtual value::Map * run(uint32_t /*index*/, Error *err)
+        {
+            err->code = -1;
+            err->message = _("Simulation: no experiment to simulate");
+
+            return 0;
+        }
+
+        virtual value::Map * runRequest(uint32_t           /*index*/,
+                                        const std::string &request,
+                                        Error             *err)
+        {
+            vpz::Vpz *vpz = new vpz::Vpz();
+            vpz::Conditions overlay;
+
+            try {
+                pimpl.readRequest(request, vpz, &overlay);
+            } catch (...) {
+                delete vpz;
+                throw;
+            }
+
+            value::Map *res = pimpl.runLocal(vpz, *modulemgr, err);
+
+            if (pimpl.m_overlay) {
+                delete vpz->project().model().model();
+                delete vpz;
+            }
+
+            if (pimpl.m_simulationoptions & manager::SIMULATION_NO_RETURN) {
+                delete res;
+                res = 0;
+            }
+
+            return res;
+        }
+
+        virtual void done(uint32_t /*index*/, value::Map *res,
+                          const Error &err)
+        {
+            result = res;
+            *error = err;
+        }
+    };
+
+    value::Map * runProcess(vpz::Vpz                   *vpz,
+                            const utils::ModuleManager &modulemgr,
+                            Error                      *error)
+    {
+        std::string request;
+
+        try {
+            writeRequest(request, *vpz);
+
+            /* The workers keep the modules of the fork. */
+            if (m_process and m_process->modulemgr != &modulemgr) {
+                delete m_pool;
+                m_pool = 0;
+                m_process->modulemgr = &modulemgr;
+            }
+
+            if (not m_process) {
+                m_process = new process(*this, modulemgr);
+            }
+
+            if (not m_pool) {
+                m_pool = new ProcessPool(*m_process, 1);
+            }
+
+            m_process->result = 0;
+            m_process->error = error;
+            m_pool->run(0, request, *m_process);
+        } catch (const std::exception& e) {
+            error->message = (fmt(_("/!\\ vle error reported: %1%\n"))
+                              % e.what()).str();
+            error->code    = -1;
+        }
+
+        release(vpz);
+
+        value::Map *result = m_process ? m_process->result : 0;
+        if (m_process) {
+            m_process->result = 0;
+        }
+
+        return result;
+    }
+
     value::Map * runQuiet(vpz::Vpz                   *vpz,
                           const utils::ModuleManager &modulemgr,
                           Error                      *error)
@@ -193,16 +476,14 @@ public:
 
         try {
             devs::RootCoordinator root(modulemgr);
-            root.load(*vpz);
-            vpz->clear();
-            delete vpz;
+            load(root, *vpz);
+            clean(vpz);
 
             root.init();
-            while (root.run()) {}
-            root.finish();
+            run(root);
+            result = finish(root);
 
             error->code    = 0;
-            result         = root.outputs();
         } catch(const std::exception& e) {
             error->message = (fmt(_("/!\\ vle error reported: %1%\n"))
                               % e.what()).str();
@@ -226,22 +507,114 @@ Simulation::~Simulation()
     delete mPimpl;
 }
 
+void Simulation::setProfile(utils::Profile *profile)
+{
+    mPimpl->m_profile = profile;
+}
+
+utils::Profile * Simulation::profile() const
+{
+    return mPimpl->m_profile;
+}
+
+void Simulation::setInitThreads(uint32_t threads)
+{
+    mPimpl->m_initThreads = threads;
+}
+
+uint32_t Simulation::initThreads() const
+{
+    return mPimpl->m_initThreads;
+}
+
+void Simulation::setStream(uint32_t combination, uint32_t replica)
+{
+    mPimpl->m_combination = combination;
+    mPimpl->m_replica = replica;
+}
+
+void Simulation::setCache(ResultCache *cache)
+{
+    mPimpl->m_cache = cache;
+}
+
+uint64_t Simulation::events() const
+{
+    return mPimpl->m_events;
+}
+
 value::Map * Simulation::run(vpz::Vpz                   *vpz,
                              const utils::ModuleManager &modulemgr,
                              Error                      *error)
+{
+    mPimpl->m_overlay = 0;
+
+    return runSimulation(vpz, modulemgr, error);
+}
+
+value::Map * Simulation::run(const vpz::Vpz             &vpz,
+                             const std::string          &experiment,
+                             int                         instance,
+                             const vpz::Conditions      &overlay,
+                             const utils::ModuleManager &modulemgr,
+                             Error                      *error)
+{
+    mPimpl->m_overlay = &overlay;
+    mPimpl->m_experiment = experiment;
+    mPimpl->m_instance = instance;
+
+    /* The vpz is neither modified nor deleted if an overlay is defined. */
+    value::Map *result = runSimulation(const_cast < vpz::Vpz* >(&vpz),
+                                       modulemgr, error);
+
+    mPimpl->m_overlay = 0;
+    mPimpl->m_experiment.clear();
+
+    return result;
+}
+
+value::Map * Simulation::runSimulation(vpz::Vpz                   *vpz,
+                                       const utils::ModuleManager &modulemgr,
+                                       Error                      *error)
 {
     error->code = 0;
     value::Map *result = NULL;
+    std::string key;
+
+    mPimpl->m_events = 0;
+
+    /* The results are not returned: the cache is useless. */
+    ResultCache *cache = mPimpl->m_cache;
+    if (mPimpl->m_simulationoptions & manager::SIMULATION_NO_RETURN) {
+        cache = 0;
+    }
+
+    if (cache) {
+        {
+            utils::ProfileScope scope(mPimpl->m_profile, "cache");
 
-    if (mPimpl->m_logoptions != manager::LOG_NONE) {
-        if (mPimpl->m_logoptions & manager::LOG_RUN and mPimpl->m_out) {
-            result = mPimpl->runVerboseRun(vpz, modulemgr, error);
+            key = cache->key(cache->identity(vpz->project()),
+                             mPimpl->m_overlay, mPimpl->m_combination,
+                             mPimpl->m_replica);
+            result = cache->get(key);
+        }
+
+        if (result) {
+            mPimpl->release(vpz);
+        }
+    }
+
+    if (not result) {
+        if (mPimpl->m_simulationoptions &
+            manager::SIMULATION_SPAWN_PROCESS) {
+            result = mPimpl->runProcess(vpz, modulemgr, error);
         } else {
-            result = mPimpl->runVerboseSummary(vpz, modulemgr, error);
+            result = mPimpl->runLocal(vpz, modulemgr, error);
         }
 
-    } else {
-        result = mPimpl->runQuiet(vpz, modulemgr, error);
+        if (cache and not error->code and result) {
+            cache->put(key, result);
+        }
     }
 
     if (mPimpl->m_simulationoptions & manager::SIMULATION_NO_RETURN) {
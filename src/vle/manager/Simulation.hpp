@@ -33,8 +33,16 @@
 #include <vle/manager/Types.hpp>
 #include <vle/vpz/Vpz.hpp>
 
+namespace vle { namespace utils {
+
+class Profile;
+
+}}
+
 namespace vle { namespace manager {
 
+class ResultCache;
+
 /**
  * @c manager::Simulation permits to run single simulation.
  *
@@ -54,11 +62,103 @@ public:
 
     ~Simulation();
 
+    /**
+     * Assign a profile to record the phases of the next simulations: the
+     * phases of @c devs::RootCoordinator::load (coordinator, views,
+     * graph, modules, conditions, dynamics), the run and the finish.
+     *
+     * @param profile The profile, null to disable the profiling. It is
+     * not deleted by the @c manager::Simulation.
+     */
+    void setProfile(utils::Profile *profile);
+
+    /**
+     * Get the profile of the simulations.
+     *
+     * @return The profile or null.
+     */
+    utils::Profile * profile() const;
+
+    /**
+     * Assign the number of threads used to build the thread safe dynamics
+     * at the start of the next simulations (see @c
+     * devs::RootCoordinator::setInitThreads).
+     *
+     * @param threads The number of threads, 1 by default.
+     */
+    void setInitThreads(uint32_t threads);
+
+    /**
+     * Get the number of threads used to build the thread safe dynamics.
+     *
+     * @return The number of threads.
+     */
+    uint32_t initThreads() const;
+
+    /**
+     * Assign the combination and the replica of the next simulations:
+     * with the seed of the experiment, they select the random streams of
+     * the models (see @c devs::RootCoordinator::setStream).
+     *
+     * @param combination The combination number.
+     * @param replica The replica number.
+     */
+    void setStream(uint32_t combination, uint32_t replica);
+
+    /**
+     * Assign a cache of the results to the next simulations. A simulation
+     * found in the cache is not run (see @c manager::ResultCache), the
+     * results of the successful simulations are stored. The cache is not
+     * used with the @c manager::SIMULATION_NO_RETURN option.
+     *
+     * @param cache The cache, null to disable the cache. It is not
+     * deleted by the @c manager::Simulation.
+     */
+    void setCache(ResultCache *cache);
+
+    /**
+     * Get the number of internal and external events processed by the
+     * last simulation.
+     *
+     * @return The number of events, 0 if the simulation failed, was found
+     * in the cache or was run in a subprocess.
+     */
+    uint64_t events() const;
+
     value::Map * run(vpz::Vpz                   *vpz,
                      const utils::ModuleManager &modulemgr,
                      Error                      *error);
 
+    /**
+     * Run a simulation of a @c vpz::Vpz shared with other simulations.
+     *
+     * The model hierarchy, the dynamics, the classes and the experiment
+     * of the @c vpz::Vpz are neither copied nor deleted (see @c
+     * devs::RootCoordinator::load), several threads can run the same @c
+     * vpz::Vpz at the same time. The vpz must not have executive models.
+     *
+     * @param vpz The shared @c vpz::Vpz.
+     * @param experiment The name of the experiment of this simulation.
+     * @param instance The number of the instance of this simulation (see
+     * @c vpz::Project::instance).
+     * @param overlay The values of the conditions of this simulation,
+     * they replace the first values of the conditions of the @c
+     * vpz::Vpz.
+     * @param modulemgr The @c utils::ModuleManager.
+     * @param error The error of the simulation.
+     */
+    value::Map * run(const vpz::Vpz             &vpz,
+                     const std::string          &experiment,
+                     int                         instance,
+                     const vpz::Conditions      &overlay,
+                     const utils::ModuleManager &modulemgr,
+                     Error                      *error);
+
 private:
+    value::Map * runSimulation(vpz::Vpz                   *vpz,
+                               const utils::ModuleManager &modulemgr,
+                               Error                      *error);
+
     Simulation(const Simulation &other);
     Simulation& operator=(const Simulation &other);
 
@@ -98,7 +98,13 @@ enum LogOptions {
 enum SimulationOptions {
     SIMULATION_NONE          = 0, /**< Default option. */
     SIMULATION_SPAWN_PROCESS = 1 << 0, /**< Launch the simulation in a
-                                        * subprocess.  */
+                                        * subprocess. The @c
+                                        * manager::Manager runs the
+                                        * combinations in a pool of
+                                        * pre-forked processes, a @c
+                                        * manager::Simulation keeps
+                                        * its subprocess for its next
+                                        * simulations. */
     SIMULATION_NO_RETURN     = 1 << 1 /**< The simulation result are empty. */
 };
 
@@ -0,0 +1,183 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_DETAILS_PROCESSPOOL_HPP
+#define VLE_MANAGER_DETAILS_PROCESSPOOL_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/manager/Types.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/utils/Types.hpp>
+#include <string>
+#include <vector>
+
+namespace vle { namespace manager {
+
+/**
+ * The @c ProcessPool runs jobs identified by an index in pre-forked
+ * worker processes (unix). The workers are forked by the constructor
+ * and inherit the memory of the parent: the loaded modules and the
+ * parsed experiments are not copied.
+ *
+ * The parent sends the indexes to the idle workers through a pipe.
+ * The result of a job is written with the @c value::BinaryWriter into
+ * a shared memory block of the worker (or into the pipe if it is too
+ * large) then rebuilt by the parent. If a worker dies during a job, the
+ * job is reported as an error and the worker is replaced.
+ *
+ * The data built by the parent after the fork (for example a new
+ * experiment) is sent to the worker with the index as a request, so
+ * a pool can be kept and reused by the successive jobs of its owner.
+ *
+ * On Windows, the jobs are run in the calling process.
+ */
+class VLE_API ProcessPool
+{
+public:
+    /**
+     * The job run by the workers.
+     */
+    struct Job
+    {
+        virtual ~Job()
+        {
+        }
+
+        /**
+         * Run a job in a worker process.
+         *
+         * @param index The index of the job.
+         * @param error The error of the job.
+         *
+         * @return The result of the job, can be null.
+         */
+        virtual value::Map * run(uint32_t index, Error *error) = 0;
+
+        /**
+         * Run a job in a worker process with the request sent by the
+         * parent. By default, the request is ignored and the job is run
+         * by @c run.
+         *
+         * @param index The index of the job.
+         * @param request The request of the job.
+         * @param error The error of the job.
+         *
+         * @return The result of the job, can be null.
+         */
+        virtual value::Map * runRequest(uint32_t           index,
+                                        const std::string& /*request*/,
+                                        Error             *error)
+        {
+            return run(index, error);
+        }
+    };
+
+    /**
+     * The receiver of the results, called in the parent process.
+     */
+    struct Handler
+    {
+        virtual ~Handler()
+        {
+        }
+
+        /**
+         * Receive the result of a job.
+         *
+         * @param index The index of the job.
+         * @param result The result of the job, to freed.
+         * @param error The error of the job or of the worker.
+         */
+        virtual void done(uint32_t index, value::Map *result,
+                          const Error &error) = 0;
+    };
+
+    /**
+     * Fork the workers.
+     *
+     * @param job The job to run.
+     * @param processes The number of workers.
+     * @param memory The size in bytes of the shared memory block of a
+     * worker.
+     *
+     * @throw utils::InternalError if the workers cannot be forked.
+     */
+    ProcessPool(Job &job, uint32_t processes,
+                std::size_t memory = 16 * 1024 * 1024);
+
+    /**
+     * Stop and wait the workers.
+     */
+    ~ProcessPool();
+
+    /**
+     * Run the jobs [first, last] in the workers. The results are given to
+     * the handler in the order of their end.
+     *
+     * @param first The index of the first job.
+     * @param last The index of the last job.
+     * @param handler The receiver of the results.
+     *
+     * @throw utils::InternalError if a worker cannot be replaced.
+     */
+    void run(uint32_t first, uint32_t last, Handler &handler);
+
+    /**
+     * Run the jobs of a list of indexes in the workers. The results are
+     * given to the handler in the order of their end.
+     *
+     * @param indexes The indexes of the jobs.
+     * @param handler The receiver of the results.
+     *
+     * @throw utils::InternalError if a worker cannot be replaced.
+     */
+    void run(const std::vector < uint32_t > &indexes, Handler &handler);
+
+    /**
+     * Run the job @e index with a request in a worker. The request is
+     * given to @c Job::runRequest.
+     *
+     * @param index The index of the job.
+     * @param request The request of the job.
+     * @param handler The receiver of the result.
+     *
+     * @throw utils::InternalError if a worker cannot be replaced.
+     */
+    void run(uint32_t index, const std::string &request, Handler &handler);
+
+private:
+    ProcessPool(const ProcessPool &other);
+    ProcessPool& operator=(const ProcessPool &other);
+
+    class Pimpl;
+    Pimpl *mPimpl;
+};
+
+}} // namespace vle manager
+
+#endif
@@ -0,0 +1,607 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/details/ProcessPool.hpp>
+#include <vle/value/Binary.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace vle { namespace manager {
+
+/*
+ * The header of a job sent to a worker. The request follows the header
+ * in the pipe.
+ */
+struct ProcessCommand
+{
+    uint32_t index;
+    uint32_t request;   /* 1 if the job has a request. */
+    uint64_t size;      /* size of the request. */
+};
+
+/*
+ * The header of the response of a worker. The error message and the
+ * result (if it is not in the shared memory) follow the header in the
+ * pipe.
+ */
+struct ProcessResponse
+{
+    uint32_t index;
+    int32_t  code;
+    uint32_t message;   /* size of the error message. */
+    uint32_t shared;    /* 1 if the result is in the shared memory. */
+    uint64_t size;      /* size of the result. */
+};
+
+static bool writeAll(int fd, const void *buffer, std::size_t size)
+{
+    const char *current = static_cast < const char* >(buffer);
+
+    while (size > 0) {
+        ssize_t written = ::write(fd, current, size);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        current += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+static bool readAll(int fd, void *buffer, std::size_t size)
+{
+    char *current = static_cast < char* >(buffer);
+
+    while (size > 0) {
+        ssize_t nb = ::read(fd, current, size);
+
+        if (nb < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        } else if (nb == 0) {
+            return false;
+        }
+
+        current += nb;
+        size -= nb;
+    }
+
+    return true;
+}
+
+/*
+ * The indexes of the jobs to run: a list of ranges [first, end).
+ */
+typedef std::vector < std::pair < uint64_t, uint64_t > > Ranges;
+
+/*
+ * The main loop of a worker: read the jobs until the command pipe is
+ * closed, run the jobs and send the responses.
+ */
+static void runWorker(ProcessPool::Job &job, int command, int response,
+                      char *memory, std::size_t capacity)
+{
+    ProcessCommand order;
+    std::string request;
+
+    while (readAll(command, &order, sizeof(order))) {
+        uint32_t index = order.index;
+        Error error;
+        value::Map *result = 0;
+        std::string buffer;
+
+        request.resize(order.size);
+        if (order.size > 0 and not readAll(command, &request[0],
+                                           order.size)) {
+            return;
+        }
+
+        try {
+            if (order.request) {
+                result = job.runRequest(index, request, &error);
+            } else {
+                result = job.run(index, &error);
+            }
+
+            if (result) {
+                value::BinaryWriter out(buffer);
+                out.write(result);
+            }
+        } catch (const std::exception& e) {
+            error.code = -1;
+            error.message = e.what();
+        } catch (...) {
+            error.code = -1;
+            error.message = _("ProcessPool: unknown error");
+        }
+
+        delete result;
+
+        ProcessResponse header;
+        header.index = index;
+        header.code = error.code;
+        header.message = error.message.size();
+        header.shared = buffer.size() <= capacity;
+        header.size = buffer.size();
+
+        if (header.shared) {
+            std::memcpy(memory, buffer.data(), buffer.size());
+        }
+
+        if (not writeAll(response, &header, sizeof(header)) or
+            not writeAll(response, error.message.data(),
+                         error.message.size()) or
+            (not header.shared and
+             not writeAll(response, buffer.data(), buffer.size()))) {
+            return;
+        }
+    }
+}
+
+class ProcessPool::Pimpl
+{
+public:
+    struct Worker
+    {
+        Worker()
+            : pid(-1), command(-1), response(-1), memory(0), busy(false),
+            index(0)
+        {
+        }
+
+        pid_t     pid;
+        int       command;  /* parent to worker. */
+        int       response; /* worker to parent. */
+        char     *memory;
+        bool      busy;
+        uint32_t  index;
+    };
+
+    Pimpl(Job &job, uint32_t processes, std::size_t memory)
+        : m_job(job), m_workers(processes), m_capacity(memory)
+    {
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = SIG_IGN;
+        ::sigaction(SIGPIPE, &action, &m_sigpipe);
+
+        try {
+            for (std::vector < Worker >::iterator it = m_workers.begin();
+                 it != m_workers.end(); ++it) {
+                void *shm = ::mmap(0, m_capacity, PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_ANON, -1, 0);
+
+                if (shm == MAP_FAILED) {
+                    throw utils::InternalError(
+                        fmt(_("ProcessPool: cannot map memory: %1%")) %
+                        std::strerror(errno));
+                }
+
+                it->memory = static_cast < char* >(shm);
+                spawn(*it);
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    ~Pimpl()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (std::vector < Worker >::iterator it = m_workers.begin();
+             it != m_workers.end(); ++it) {
+            stop(*it, false);
+
+            if (it->memory) {
+                ::munmap(it->memory, m_capacity);
+                it->memory = 0;
+            }
+        }
+
+        ::sigaction(SIGPIPE, &m_sigpipe, 0);
+    }
+
+    /**
+     * Fork a new worker. The worker closes the pipes of the other
+     * workers and never returns.
+     */
+    void spawn(Worker &worker)
+    {
+        int command[2], response[2];
+
+        if (::pipe(command) == -1) {
+            throw utils::InternalError(
+                fmt(_("ProcessPool: cannot open pipe: %1%")) %
+                std::strerror(errno));
+        }
+
+        if (::pipe(response) == -1) {
+            ::close(command[0]);
+            ::close(command[1]);
+            throw utils::InternalError(
+                fmt(_("ProcessPool: cannot open pipe: %1%")) %
+                std::strerror(errno));
+        }
+
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(0);
+
+        pid_t pid = ::fork();
+
+        if (pid == -1) {
+            ::close(command[0]);
+            ::close(command[1]);
+            ::close(response[0]);
+            ::close(response[1]);
+            throw utils::InternalError(
+                fmt(_("ProcessPool: cannot fork: %1%")) %
+                std::strerror(errno));
+        }
+
+        if (pid == 0) {
+            ::close(command[1]);
+            ::close(response[0]);
+
+            for (std::vector < Worker >::iterator it = m_workers.begin();
+                 it != m_workers.end(); ++it) {
+                if (it->command != -1) {
+                    ::close(it->command);
+                }
+                if (it->response != -1) {
+                    ::close(it->response);
+                }
+            }
+
+            /* an error out of a job must not unwind into the copy of the
+             * stack of the parent. */
+            int status = 0;
+
+            try {
+                runWorker(m_job, command[0], response[1], worker.memory,
+                          m_capacity);
+            } catch (...) {
+                status = 1;
+            }
+
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(0);
+            ::_exit(status);
+        }
+
+        ::close(command[0]);
+        ::close(response[1]);
+
+        worker.pid = pid;
+        worker.command = command[1];
+        worker.response = response[0];
+        worker.busy = false;
+    }
+
+    /**
+     * Close the pipes of a worker and wait its end.
+     *
+     * @return The status of the worker.
+     */
+    int stop(Worker &worker, bool kill)
+    {
+        int status = 0;
+
+        if (worker.command != -1) {
+            ::close(worker.command);
+            worker.command = -1;
+        }
+
+        if (worker.response != -1) {
+            ::close(worker.response);
+            worker.response = -1;
+        }
+
+        if (worker.pid > 0) {
+            if (kill) {
+                ::kill(worker.pid, SIGKILL);
+            }
+
+            while (::waitpid(worker.pid, &status, 0) == -1 and
+                   errno == EINTR) {
+            }
+
+            worker.pid = -1;
+        }
+
+        worker.busy = false;
+
+        return status;
+    }
+
+    /**
+     * Stop a dead worker and build the error of its job.
+     */
+    Error crash(Worker &worker)
+    {
+        int status = stop(worker, true);
+        Error error;
+
+        error.code = -1;
+        if (WIFSIGNALED(status)) {
+            error.message = (fmt(_("ProcessPool: worker killed by signal"
+                                   " %1%")) % WTERMSIG(status)).str();
+        } else {
+            error.message = (fmt(_("ProcessPool: worker exited with status"
+                                   " %1%")) % WEXITSTATUS(status)).str();
+        }
+
+        return error;
+    }
+
+    /**
+     * Read the response of a worker.
+     *
+     * @return false if the worker is dead.
+     */
+    bool receive(Worker &worker, Handler &handler)
+    {
+        ProcessResponse header;
+
+        if (not readAll(worker.response, &header, sizeof(header))) {
+            return false;
+        }
+
+        Error error;
+        error.code = header.code;
+        error.message.resize(header.message);
+
+        if (header.message > 0 and not readAll(worker.response,
+                                               &error.message[0],
+                                               header.message)) {
+            return false;
+        }
+
+        std::string buffer;
+        const char *data = worker.memory;
+
+        if (not header.shared) {
+            buffer.resize(header.size);
+            if (header.size > 0 and not readAll(worker.response, &buffer[0],
+                                                header.size)) {
+                return false;
+            }
+            data = buffer.data();
+        }
+
+        worker.busy = false;
+
+        value::Map *result = 0;
+        if (header.size > 0) {
+            try {
+                value::BinaryReader in(data, header.size);
+                value::Value *value = in.read();
+
+                if (value and not value->isMap()) {
+                    delete value;
+                    throw utils::InternalError(
+                        _("ProcessPool: bad result type"));
+                }
+
+                result = static_cast < value::Map* >(value);
+            } catch (const std::exception& e) {
+                error.code = -1;
+                error.message = e.what();
+            }
+        }
+
+        handler.done(header.index, result, error);
+
+        return true;
+    }
+
+    /**
+     * Send a job to a worker.
+     *
+     * @return false if the worker is dead.
+     */
+    bool send(Worker &worker, uint32_t index, const std::string *request)
+    {
+        ProcessCommand order;
+        order.index = index;
+        order.request = request ? 1 : 0;
+        order.size = request ? request->size() : 0;
+
+        return writeAll(worker.command, &order, sizeof(order)) and
+            (not request or writeAll(worker.command, request->data(),
+                                     request->size()));
+    }
+
+    /**
+     * Run the jobs of the ranges in the workers, with the same request if
+     * it is not null.
+     */
+    void run(const Ranges &ranges, const std::string *request,
+             Handler &handler)
+    {
+        Ranges::const_iterator range = ranges.begin();
+        uint64_t next = range != ranges.end() ? range->first : 0;
+        std::vector < pollfd > fds;
+        std::vector < Worker* > polled;
+
+        for (;;) {
+            for (std::vector < Worker >::iterator it = m_workers.begin();
+                 it != m_workers.end() and range != ranges.end(); ++it) {
+                if (it->pid <= 0) {
+                    spawn(*it);
+                }
+
+                if (not it->busy) {
+                    uint32_t index = next;
+
+                    if (not send(*it, index, request)) {
+                        stop(*it, true);
+                        spawn(*it);
+
+                        if (not send(*it, index, request)) {
+                            throw utils::InternalError(
+                                fmt(_("ProcessPool: cannot send job %1%"))
+                                % index);
+                        }
+                    }
+
+                    it->busy = true;
+                    it->index = index;
+
+                    if (++next >= range->second and
+                        ++range != ranges.end()) {
+                        next = range->first;
+                    }
+                }
+            }
+
+            fds.clear();
+            polled.clear();
+            for (std::vector < Worker >::iterator it = m_workers.begin();
+                 it != m_workers.end(); ++it) {
+                if (it->busy) {
+                    pollfd fd;
+                    fd.fd = it->response;
+                    fd.events = POLLIN;
+                    fd.revents = 0;
+                    fds.push_back(fd);
+                    polled.push_back(&*it);
+                }
+            }
+
+            if (fds.empty()) {
+                break;
+            }
+
+            if (::poll(&fds[0], fds.size(), -1) == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throw utils::InternalError(
+                    fmt(_("ProcessPool: poll failed: %1%")) %
+                    std::strerror(errno));
+            }
+
+            for (std::vector < pollfd >::size_type i = 0; i < fds.size();
+                 ++i) {
+                if (fds[i].revents) {
+                    Worker &worker(*polled[i]);
+
+                    if (not receive(worker, handler)) {
+                        uint32_t index = worker.index;
+                        Error error = crash(worker);
+
+                        handler.done(index, 0, error);
+                    }
+                }
+            }
+        }
+    }
+
+    Job                   &m_job;
+    std::vector < Worker > m_workers;
+    std::size_t            m_capacity;
+    struct sigaction       m_sigpipe;
+};
+
+ProcessPool::ProcessPool(Job &job, uint32_t processes, std::size_t memory)
+    : mPimpl(new Pimpl(job, processes ? processes : 1, memory))
+{
+}
+
+ProcessPool::~ProcessPool()
+{
+    delete mPimpl;
+}
+
+void ProcessPool::run(uint32_t first, uint32_t last, Handler &handler)
+{
+    Ranges ranges;
+
+    if (first <= last) {
+        ranges.push_back(Ranges::value_type(
+                first, static_cast < uint64_t >(last) + 1));
+    }
+
+    mPimpl->run(ranges, 0, handler);
+}
+
+void ProcessPool::run(const std::vector < uint32_t > &indexes,
+                      Handler &handler)
+{
+    Ranges ranges;
+
+    for (std::vector < uint32_t >::const_iterator it = indexes.begin();
+         it != indexes.end(); ++it) {
+        if (not ranges.empty() and ranges.back().second == *it) {
+            ++ranges.back().second;
+        } else {
+            ranges.push_back(Ranges::value_type(
+                    *it, static_cast < uint64_t >(*it) + 1));
+        }
+    }
+
+    mPimpl->run(ranges, 0, handler);
+}
+
+void ProcessPool::run(uint32_t index, const std::string &request,
+                      Handler &handler)
+{
+    Ranges ranges(1, Ranges::value_type(
+            index, static_cast < uint64_t >(index) + 1));
+
+    mPimpl->run(ranges, &request, handler);
+}
+
+}} // namespace vle manager
@@ -0,0 +1,136 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/details/ProcessPool.hpp>
+#include <vle/utils/Trace.hpp>
+#include <vle/utils/i18n.hpp>
+
+namespace vle { namespace manager {
+
+/*
+ * The indexes of the jobs to run: a list of ranges [first, end).
+ */
+typedef std::vector < std::pair < uint64_t, uint64_t > > Ranges;
+
+/*
+ * Windows does not provide fork: the jobs are run in the calling
+ * process, without isolation.
+ */
+class ProcessPool::Pimpl
+{
+public:
+    Pimpl(Job &job)
+        : m_job(job)
+    {
+        TraceAlways(_("ProcessPool: worker processes are not available,"
+                      " the jobs are run in the current process"));
+    }
+
+    void run(const Ranges &ranges, const std::string *request,
+             Handler &handler)
+    {
+        for (Ranges::const_iterator range = ranges.begin();
+             range != ranges.end(); ++range) {
+            for (uint64_t index = range->first; index < range->second;
+                 ++index) {
+                Error error;
+                value::Map *result = 0;
+
+                try {
+                    if (request) {
+                        result = m_job.runRequest(index, *request, &error);
+                    } else {
+                        result = m_job.run(index, &error);
+                    }
+                } catch (const std::exception& e) {
+                    error.code = -1;
+                    error.message = e.what();
+                } catch (...) {
+                    error.code = -1;
+                    error.message = _("ProcessPool: unknown error");
+                }
+
+                handler.done(index, result, error);
+            }
+        }
+    }
+
+    Job &m_job;
+};
+
+ProcessPool::ProcessPool(Job &job, uint32_t /*processes*/,
+                         std::size_t /*memory*/)
+    : mPimpl(new Pimpl(job))
+{
+}
+
+ProcessPool::~ProcessPool()
+{
+    delete mPimpl;
+}
+
+void ProcessPool::run(uint32_t first, uint32_t last, Handler &handler)
+{
+    Ranges ranges;
+
+    if (first <= last) {
+        ranges.push_back(Ranges::value_type(
+                first, static_cast < uint64_t >(last) + 1));
+    }
+
+    mPimpl->run(ranges, 0, handler);
+}
+
+void ProcessPool::run(const std::vector < uint32_t > &indexes,
+                      Handler &handler)
+{
+    Ranges ranges;
+
+    for (std::vector < uint32_t >::const_iterator it = indexes.begin();
+         it != indexes.end(); ++it) {
+        if (not ranges.empty() and ranges.back().second == *it) {
+            ++ranges.back().second;
+        } else {
+            ranges.push_back(Ranges::value_type(
+                    *it, static_cast < uint64_t >(*it) + 1));
+        }
+    }
+
+    mPimpl->run(ranges, 0, handler);
+}
+
+void ProcessPool::run(uint32_t index, const std::string &request,
+                      Handler &handler)
+{
+    Ranges ranges(1, Ranges::value_type(
+            index, static_cast < uint64_t >(index) + 1));
+
+    mPimpl->run(ranges, &request, handler);
+}
+
+}} // namespace vle manager
@@ -0,0 +1,242 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE manager_processpool_test
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <vle/manager/details/ProcessPool.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/value/String.hpp>
+#include <vle/utils/Exception.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include <csignal>
+#include <unistd.h>
+#include <vle/vle.hpp>
+
+struct F
+{
+    vle::Init a;
+
+    F() : a() { }
+    ~F() { }
+};
+
+BOOST_GLOBAL_FIXTURE(F)
+
+using namespace vle;
+
+/*
+ * The job of the tests: the index 1 fails, the index 2 throws, the index
+ * 3 kills its worker, the index 4 returns a result larger than the
+ * shared memory, the index 100 throws a value which is not an exception.
+ * The others return their index and the pid of their worker.
+ */
+struct Job : manager::ProcessPool::Job, manager::ProcessPool::Handler
+{
+    std::map < uint32_t, value::Map* > results;
+    std::map < uint32_t, manager::Error > errors;
+
+    ~Job()
+    {
+        for (std::map < uint32_t, value::Map* >::iterator it =
+                 results.begin(); it != results.end(); ++it) {
+            delete it->second;
+        }
+    }
+
+    virtual value::Map * run(uint32_t index, manager::Error *error)
+    {
+        switch (index) {
+        case 1:
+            error->code = -1;
+            error->message = "failure";
+            return 0;
+        case 2:
+            throw utils::InternalError("exception");
+        case 3:
+            ::kill(::getpid(), SIGKILL);
+        case 100:
+            throw index;
+        default:
+            break;
+        }
+
+        value::Map *result = new value::Map();
+        result->addInt("index", index);
+        result->addInt("pid", ::getpid());
+
+        if (index == 4) {
+            result->addString("data", std::string(4096, 'x'));
+        }
+
+        return result;
+    }
+
+    virtual value::Map * runRequest(uint32_t           index,
+                                    const std::string &request,
+                                    manager::Error    *error)
+    {
+        value::Map *result = run(index, error);
+
+        if (result) {
+            result->addString("request", request);
+        }
+
+        return result;
+    }
+
+    virtual void done(uint32_t index, value::Map *result,
+                      const manager::Error &error)
+    {
+        BOOST_REQUIRE(results.find(index) == results.end());
+
+        results[index] = result;
+        errors[index] = error;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(processpool_results)
+{
+    Job job;
+
+    {
+        manager::ProcessPool pool(job, 2, 1024);
+        pool.run(0, 9, job);
+    }
+
+    BOOST_REQUIRE_EQUAL(job.results.size(), 10);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        if (i >= 1 and i <= 3) {
+            continue;
+        }
+
+        BOOST_REQUIRE_EQUAL(job.errors[i].code, 0);
+        BOOST_REQUIRE(job.results[i]);
+        BOOST_REQUIRE_EQUAL(job.results[i]->getInt("index"), i);
+        BOOST_REQUIRE(job.results[i]->getInt("pid") != ::getpid());
+    }
+
+    /* The result of the index 4 does not fit into the shared memory, it
+     * is sent through the pipe. */
+    BOOST_REQUIRE_EQUAL(job.results[4]->getString("data"),
+                        std::string(4096, 'x'));
+}
+
+BOOST_AUTO_TEST_CASE(processpool_errors)
+{
+    Job job;
+
+    {
+        manager::ProcessPool pool(job, 1);
+        pool.run(1, 5, job);
+    }
+
+    BOOST_REQUIRE_EQUAL(job.results.size(), 5);
+
+    BOOST_REQUIRE(not job.results[1]);
+    BOOST_REQUIRE_EQUAL(job.errors[1].code, -1);
+    BOOST_REQUIRE_EQUAL(job.errors[1].message, "failure");
+
+    BOOST_REQUIRE(not job.results[2]);
+    BOOST_REQUIRE_EQUAL(job.errors[2].code, -1);
+    BOOST_REQUIRE_EQUAL(job.errors[2].message, "exception");
+
+    /* The crashed worker is replaced and runs the next jobs. */
+    BOOST_REQUIRE(not job.results[3]);
+    BOOST_REQUIRE_EQUAL(job.errors[3].code, -1);
+    BOOST_REQUIRE(job.errors[3].message.find("signal") !=
+                  std::string::npos);
+
+    BOOST_REQUIRE_EQUAL(job.errors[4].code, 0);
+    BOOST_REQUIRE_EQUAL(job.errors[5].code, 0);
+    BOOST_REQUIRE_EQUAL(job.results[5]->getInt("index"), 5);
+}
+
+BOOST_AUTO_TEST_CASE(processpool_requests)
+{
+    Job job;
+    manager::ProcessPool pool(job, 1);
+
+    /* The request is built after the fork and the worker is reused. */
+    pool.run(5, "first", job);
+    pool.run(6, std::string("second\0third", 12), job);
+
+    BOOST_REQUIRE_EQUAL(job.results.size(), 2);
+    BOOST_REQUIRE_EQUAL(job.results[5]->getString("request"), "first");
+    BOOST_REQUIRE_EQUAL(job.results[6]->getString("request"),
+                        std::string("second\0third", 12));
+    BOOST_REQUIRE_EQUAL(job.results[5]->getInt("pid"),
+                        job.results[6]->getInt("pid"));
+}
+
+BOOST_AUTO_TEST_CASE(processpool_unknown_error)
+{
+    Job job;
+
+    {
+        manager::ProcessPool pool(job, 1);
+        pool.run(100, 101, job);
+    }
+
+    /* The error is reported and the worker runs the next job. */
+    BOOST_REQUIRE(not job.results[100]);
+    BOOST_REQUIRE_EQUAL(job.errors[100].code, -1);
+    BOOST_REQUIRE(job.errors[100].message.find("unknown") !=
+                  std::string::npos);
+    BOOST_REQUIRE_EQUAL(job.errors[101].code, 0);
+    BOOST_REQUIRE_EQUAL(job.results[101]->getInt("index"), 101);
+}
+
+BOOST_AUTO_TEST_CASE(processpool_indexes)
+{
+    Job job;
+    std::vector < uint32_t > indexes;
+    indexes.push_back(0);
+    indexes.push_back(5);
+    indexes.push_back(6);
+    indexes.push_back(9);
+
+    {
+        manager::ProcessPool pool(job, 2);
+        pool.run(indexes, job);
+    }
+
+    BOOST_REQUIRE_EQUAL(job.results.size(), indexes.size());
+
+    for (std::vector < uint32_t >::const_iterator it = indexes.begin();
+         it != indexes.end(); ++it) {
+        BOOST_REQUIRE_EQUAL(job.errors[*it].code, 0);
+        BOOST_REQUIRE_EQUAL(job.results[*it]->getInt("index"), *it);
+    }
+}
@@ -36,9 +36,23 @@
 #include <boost/lexical_cast.hpp>
 #include <stdexcept>
 #include <iostream>
+#include <sstream>
 #include <vle/vpz/Vpz.hpp>
 #include <vle/manager/Manager.hpp>
 #include <vle/manager/ExperimentGenerator.hpp>
+#include <vle/manager/ReplicationControl.hpp>
+#include <vle/manager/ResultCache.hpp>
+#include <vle/manager/ResultSink.hpp>
+#include <vle/manager/CombinationSource.hpp>
+#include <vle/manager/ExperimentDesign.hpp>
+#include <vle/manager/Simulation.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/String.hpp>
+#include <cstdio>
+#include <vector>
 #include <vle/vle.hpp>
 
 struct F
@@ -166,28 +180,26 @@ BOOST_AUTO_TEST_CASE(experimentgenerator_greater_than_exp)
 
     manager::ExperimentGenerator expgen1(vpz, 0, 5);
     BOOST_CHECK_EQUAL(expgen1.min(), 0);
-    BOOST_CHECK_EQUAL(expgen1.max(), 1);
+    BOOST_CHECK_EQUAL(expgen1.max(), 0);
     BOOST_CHECK_EQUAL(expgen1.size(), 3);
 
     manager::ExperimentGenerator expgen2(vpz, 1, 5);
     BOOST_CHECK_EQUAL(expgen2.min(), 1);
-    BOOST_CHECK_EQUAL(expgen2.max(), 2);
+    BOOST_CHECK_EQUAL(expgen2.max(), 1);
     BOOST_CHECK_EQUAL(expgen2.size(), 3);
 
     manager::ExperimentGenerator expgen3(vpz, 2, 5);
     BOOST_CHECK_EQUAL(expgen3.min(), 2);
-    BOOST_CHECK_EQUAL(expgen3.max(), 3);
+    BOOST_CHECK_EQUAL(expgen3.max(), 2);
     BOOST_CHECK_EQUAL(expgen3.size(), 3);
 
     manager::ExperimentGenerator expgen4(vpz, 3, 5);
-    BOOST_CHECK_EQUAL(expgen4.min(), expgen4.max()); /* no job for experiment
-                                                        generator 4 and 5.
-                                                        max() - min() returns
-                                                        null. */
+    BOOST_CHECK(expgen4.min() > expgen4.max()); /* no job for experiment
+                                                   generator 4 and 5. */
     BOOST_CHECK_EQUAL(expgen4.size(), 3);
 
     manager::ExperimentGenerator expgen5(vpz, 4, 5);
-    BOOST_CHECK_EQUAL(expgen5.min(), expgen5.max());
+    BOOST_CHECK(expgen5.min() > expgen5.max());
     BOOST_CHECK_EQUAL(expgen5.size(), 3);
 }
 
@@ -224,3 +236,582 @@ BOOST_AUTO_TEST_CASE(experimentgenerator_max_1_max_1)
     BOOST_CHECK_EQUAL(expgen1.max(), 6);
     BOOST_CHECK_EQUAL(expgen1.size(), 7);
 }
+
+BOOST_AUTO_TEST_CASE(experimentgenerator_overlay)
+{
+    vpz::Vpz vpz;
+    vpz.parseMemory(xml);
+
+    vpz::Project& project(vpz.project());
+    vpz::Conditions& cnds(project.experiment().conditions());
+
+    {
+        vpz::Condition& cnd1(cnds.get("cond1"));
+        cnd1.clearValueOfPort("init1");
+        cnd1.clearValueOfPort("init2");
+        for (int i = 0; i < 7; ++i) {
+            cnd1.addValueToPort("init1", new value::Double(i));
+        }
+        cnd1.addValueToPort("init2", new value::Double(0));
+    }
+
+    {
+        vpz::Condition& cnd2(cnds.get("cond2"));
+        cnd2.clearValueOfPort("init3");
+        cnd2.clearValueOfPort("init4");
+        cnd2.addValueToPort("init3", new value::Double(1));
+        cnd2.addValueToPort("init4", new value::Double(7));
+    }
+
+    manager::ExperimentGenerator expgen(vpz, 0, 1);
+    BOOST_REQUIRE_EQUAL(expgen.size(), 7);
+
+    vpz::Conditions overlay;
+    expgen.getOverlay(3, &overlay);
+
+    BOOST_REQUIRE(overlay.exist("cond1"));
+    BOOST_REQUIRE(not overlay.exist("cond2"));
+
+    const vpz::Condition& cnd1(overlay.get("cond1"));
+    BOOST_REQUIRE_EQUAL(cnd1.conditionvalues().size(), 1);
+    BOOST_REQUIRE_EQUAL(cnd1.getSetValues("init1").size(), 1);
+    BOOST_REQUIRE_CLOSE(cnd1.getSetValues("init1").getDouble(0), 3.0, 1e-10);
+
+    expgen.getOverlay(6, &overlay);
+    BOOST_REQUIRE_CLOSE(overlay.get("cond1").getSetValues("init1")
+                        .getDouble(0), 6.0, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(shared_simulation)
+{
+    vpz::Vpz vpz;
+    vpz.parseMemory(xml);
+
+    vpz::Project& project(vpz.project());
+    vpz::BaseModel* atomic = project.model().model();
+    project.model().setModel(new vpz::CoupledModel("top", 0));
+    project.setInstance(-1);
+
+    vpz::Condition& cnd1(project.experiment().conditions().get("cond1"));
+    cnd1.clearValueOfPort("init1");
+    cnd1.clearValueOfPort("init2");
+    for (int i = 0; i < 4; ++i) {
+        cnd1.addValueToPort("init1", new value::Double(i));
+    }
+    cnd1.addValueToPort("init2", new value::Double(0));
+
+    vpz::Condition& cnd2(project.experiment().conditions().get("cond2"));
+    cnd2.clearValueOfPort("init3");
+    cnd2.clearValueOfPort("init4");
+    cnd2.addValueToPort("init3", new value::Double(1));
+    cnd2.addValueToPort("init4", new value::Double(7));
+
+    manager::ExperimentGenerator expgen(vpz, 0, 1);
+    BOOST_REQUIRE_EQUAL(expgen.size(), 4);
+
+    utils::ModuleManager modules;
+    manager::Simulation sim(manager::LOG_NONE, manager::SIMULATION_NONE, 0);
+
+    for (uint32_t i = 0; i < expgen.size(); ++i) {
+        vpz::Conditions overlay;
+        expgen.getOverlay(i, &overlay);
+
+        manager::Error error;
+        sim.setStream(i, 0);
+        value::Map *result = sim.run(vpz, "test1-" +
+                                     boost::lexical_cast < std::string >(i),
+                                     i, overlay, modules, &error);
+
+        BOOST_REQUIRE_EQUAL(error.code, 0);
+        delete result;
+
+        BOOST_REQUIRE_CLOSE(overlay.get("cond1").getSetValues("init1")
+                            .getDouble(0), static_cast < double >(i), 1e-10);
+    }
+
+    /* the runs have their own experiment name, instance and values, the
+     * shared vpz is not modified. */
+    BOOST_REQUIRE_EQUAL(project.experiment().name(), "test1");
+    BOOST_REQUIRE_EQUAL(project.instance(), -1);
+    BOOST_REQUIRE_EQUAL(cnd1.getSetValues("init1").size(), 4);
+    BOOST_REQUIRE_CLOSE(cnd1.getSetValues("init1").getDouble(3), 3.0, 1e-10);
+
+    delete project.model().model();
+    delete atomic;
+}
+
+BOOST_AUTO_TEST_CASE(spawn_simulation)
+{
+    utils::ModuleManager modules;
+    manager::Simulation sim(manager::LOG_NONE,
+                            manager::SIMULATION_SPAWN_PROCESS, 0);
+
+    /* The subprocess of the first simulation runs the next ones. */
+    for (int i = 0; i < 2; ++i) {
+        vpz::Vpz *vpz = new vpz::Vpz();
+        vpz->parseMemory(xml);
+        delete vpz->project().model().model();
+        vpz->project().model().setModel(new vpz::CoupledModel("top", 0));
+
+        manager::Error error;
+        value::Map *result = sim.run(vpz, modules, &error);
+
+        BOOST_REQUIRE_EQUAL(error.code, 0);
+        delete result;
+    }
+
+    vpz::Vpz vpz;
+    vpz.parseMemory(xml);
+    vpz::BaseModel* atomic = vpz.project().model().model();
+    vpz.project().model().setModel(new vpz::CoupledModel("top", 0));
+
+    vpz::Conditions overlay;
+    manager::ExperimentGenerator expgen(vpz, 0, 1);
+    expgen.getOverlay(1, &overlay);
+
+    manager::Error error;
+    sim.setStream(1, 0);
+    value::Map *result = sim.run(vpz, "test1-1", 1, overlay, modules,
+                                 &error);
+
+    BOOST_REQUIRE_EQUAL(error.code, 0);
+    delete result;
+
+    /* The failure of the worker is reported. */
+    vpz::Vpz *failure = new vpz::Vpz();
+    failure->parseMemory(xml);
+    result = sim.run(failure, modules, &error);
+
+    BOOST_REQUIRE_EQUAL(error.code, -1);
+    BOOST_REQUIRE(not result);
+
+    overlay.deleteValueSet();
+    delete vpz.project().model().model();
+    delete atomic;
+}
+
+BOOST_AUTO_TEST_CASE(thread_errors)
+{
+    utils::ModuleManager modules;
+    std::ostringstream out;
+    manager::Manager man(manager::LOG_RUN, manager::SIMULATION_NONE, &out);
+    manager::Error error;
+
+    /* The atomic model A has no dynamics, each run fails and its message
+     * is written into the run log by the threads. */
+    vpz::Vpz *vpz = new vpz::Vpz();
+    vpz->parseMemory(xml);
+
+    value::Matrix *result = man.run(vpz, modules, 2, 0, 1, &error);
+    delete result;
+
+    BOOST_REQUIRE_EQUAL(error.code, -1);
+    BOOST_REQUIRE(not out.str().empty());
+
+    /* The error of the previous experimental frame is reset. */
+    vpz = new vpz::Vpz();
+    vpz->parseMemory(xml);
+    delete vpz->project().model().model();
+    vpz->project().model().setModel(new vpz::CoupledModel("top", 0));
+
+    out.str("");
+    result = man.run(vpz, modules, 2, 0, 1, &error);
+    delete result;
+
+    BOOST_REQUIRE_EQUAL(error.code, 0);
+    BOOST_REQUIRE(error.message.empty());
+    BOOST_REQUIRE(out.str().empty());
+}
+
+BOOST_AUTO_TEST_CASE(columnar_sink)
+{
+    const char *filename = "test_columnar_sink.vlecol";
+
+    {
+        manager::ColumnarSink sink(filename, 64);
+
+        for (uint32_t i = 0; i < 5; ++i) {
+            value::Matrix *matrix = new value::Matrix(3, 4, 1, 1);
+            matrix->addString(0, 0, "time");
+            matrix->addString(1, 0, "top:a.x");
+            matrix->addString(2, 0, "top:a.n");
+
+            for (uint32_t row = 1; row < 4; ++row) {
+                matrix->addDouble(0, row, row);
+                matrix->addDouble(1, row, i * 10.0 + row);
+                if (row != 2) {
+                    matrix->addInt(2, row, i);
+                }
+            }
+
+            value::Map *result = new value::Map();
+            result->add("view", matrix);
+            sink.write(4 - i, result);
+        }
+
+        sink.write(7, 0);
+        sink.close();
+    }
+
+    manager::ColumnarReader reader(filename);
+    std::vector < uint32_t > indexes = reader.indexes();
+
+    BOOST_REQUIRE_EQUAL(indexes.size(), 6);
+    BOOST_REQUIRE_EQUAL(indexes[0], 4);
+    BOOST_REQUIRE_EQUAL(indexes[5], 7);
+    BOOST_REQUIRE(not reader.read(7));
+    BOOST_REQUIRE(not reader.read(8));
+
+    value::Map *result = reader.read(1);
+    BOOST_REQUIRE(result);
+
+    const value::Matrix& matrix(result->getMatrix("view"));
+    BOOST_REQUIRE_EQUAL(matrix.columns(), 3);
+    BOOST_REQUIRE_EQUAL(matrix.rows(), 4);
+    BOOST_REQUIRE_EQUAL(matrix.getString(1, 0), "top:a.x");
+    BOOST_REQUIRE_CLOSE(matrix.getDouble(1, 3), 33.0, 1e-10);
+    BOOST_REQUIRE_EQUAL(matrix.getInt(2, 1), 3);
+    BOOST_REQUIRE(not matrix.get(2, 2));
+
+    delete result;
+    std::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(experimentgenerator_remainder)
+{
+    vpz::Vpz vpz;
+    vpz.parseMemory(xml);
+
+    vpz::Conditions& cnds(vpz.project().experiment().conditions());
+    vpz::Condition& cnd1(cnds.get("cond1"));
+    cnd1.clearValueOfPort("init1");
+    cnd1.clearValueOfPort("init2");
+    for (int i = 0; i < 10; ++i) {
+        cnd1.addValueToPort("init1", new value::Double(i));
+    }
+    cnd1.addValueToPort("init2", new value::Double(0));
+
+    vpz::Condition& cnd2(cnds.get("cond2"));
+    cnd2.clearValueOfPort("init3");
+    cnd2.clearValueOfPort("init4");
+
+    uint32_t next = 0;
+    for (uint32_t rank = 0; rank < 3; ++rank) {
+        manager::ExperimentGenerator expgen(vpz, rank, 3);
+        BOOST_REQUIRE_EQUAL(expgen.size(), 10);
+        BOOST_REQUIRE_EQUAL(expgen.min(), next);
+        BOOST_REQUIRE_EQUAL(expgen.max() - expgen.min() + 1,
+                            rank == 0 ? 4 : 3);
+        next = expgen.max() + 1;
+    }
+    BOOST_REQUIRE_EQUAL(next, 10);
+}
+
+BOOST_AUTO_TEST_CASE(guided_source)
+{
+    manager::GuidedSource source(5, 104, 4);
+    uint32_t first, end, next = 5, previous = 100;
+
+    while (source.take(&first, &end)) {
+        BOOST_REQUIRE_EQUAL(first, next);
+        BOOST_REQUIRE(end > first);
+        BOOST_REQUIRE(end - first <= previous);
+        previous = end - first;
+        next = end;
+    }
+
+    BOOST_REQUIRE_EQUAL(next, 105);
+    BOOST_REQUIRE_EQUAL(previous, 1);
+}
+
+BOOST_AUTO_TEST_CASE(experimentdesign_total)
+{
+    vpz::Vpz vpz;
+    vpz.parseMemory(xml);
+    vpz.project().experiment().setCombination("total");
+
+    manager::ExperimentGenerator expgen(vpz, 0, 1);
+    BOOST_REQUIRE_EQUAL(expgen.size(), 16);
+    BOOST_REQUIRE_EQUAL(expgen.max(), 15);
+
+    vpz::Conditions cnds;
+    expgen.get(5, &cnds);
+
+    BOOST_REQUIRE_CLOSE(value::toDouble(
+            cnds.get("cond1").getSetValues("init1").get(0)), 123., 1e-10);
+    BOOST_REQUIRE_EQUAL(value::toInteger(
+            cnds.get("cond1").getSetValues("init2").get(0)), 2);
+    BOOST_REQUIRE_CLOSE(value::toDouble(
+            cnds.get("cond2").getSetValues("init3").get(0)), .123, 1e-10);
+    BOOST_REQUIRE_EQUAL(value::toInteger(
+            cnds.get("cond2").getSetValues("init4").get(0)), -2);
+    cnds.deleteValueSet();
+}
+
+BOOST_AUTO_TEST_CASE(experimentdesign_lhs)
+{
+    vpz::Vpz vpz;
+    vpz.parseMemory(xml);
+    vpz.project().experiment().setCombination("lhs");
+    vpz.project().experiment().setSamples(10);
+    vpz.project().experiment().setSeed(42);
+
+    vpz::Conditions& cnds(vpz.project().experiment().conditions());
+    vpz::Condition& cnd1(cnds.get("cond1"));
+    cnd1.clearValueOfPort("init1");
+    cnd1.addValueToPort("init1", new value::Double(0.));
+    cnd1.addValueToPort("init1", new value::Double(10.));
+    cnd1.clearValueOfPort("init2");
+    cnd1.addValueToPort("init2", new value::Integer(0));
+    cnd1.addValueToPort("init2", new value::Integer(9));
+    cnds.get("cond2").clearValueOfPort("init3");
+    cnds.get("cond2").clearValueOfPort("init4");
+
+    manager::ExperimentGenerator expgen(vpz, 0, 1);
+    BOOST_REQUIRE_EQUAL(expgen.size(), 10);
+
+    std::vector < int > doubles(10, 0), integers(10, 0);
+    vpz::Conditions overlay;
+
+    for (uint32_t i = expgen.min(); i <= expgen.max(); ++i) {
+        expgen.getOverlay(i, &overlay);
+
+        double x = value::toDouble(
+            overlay.get("cond1").getSetValues("init1").get(0));
+        int32_t y = value::toInteger(
+            overlay.get("cond1").getSetValues("init2").get(0));
+
+        BOOST_REQUIRE(x >= 0. and x < 10.);
+        BOOST_REQUIRE(y >= 0 and y <= 9);
+        doubles[static_cast < int >(x)]++;
+        integers[y]++;
+    }
+    overlay.deleteValueSet();
+
+    for (int i = 0; i < 10; ++i) {
+        BOOST_REQUIRE_EQUAL(doubles[i], 1);
+        BOOST_REQUIRE_EQUAL(integers[i], 1);
+    }
+
+    vpz.project().experiment().setSamples(0);
+    BOOST_REQUIRE_THROW(manager::ExperimentGenerator(vpz, 0, 1),
+                        utils::ArgError);
+}
+
+BOOST_AUTO_TEST_CASE(experimentdesign_sequences)
+{
+    BOOST_REQUIRE_EQUAL(manager::ExperimentDesign::sobol(0, 0), 0.);
+    BOOST_REQUIRE_EQUAL(manager::ExperimentDesign::sobol(1, 0), .5);
+    BOOST_REQUIRE_EQUAL(manager::ExperimentDesign::sobol(2, 0), .75);
+    BOOST_REQUIRE_EQUAL(manager::ExperimentDesign::sobol(3, 0), .25);
+    BOOST_REQUIRE_CLOSE(manager::ExperimentDesign::halton(1, 1), 1. / 3.,
+                        1e-10);
+    BOOST_REQUIRE_CLOSE(manager::ExperimentDesign::halton(7, 2),
+                        2. / 5. + 1. / 25., 1e-10);
+
+    /* The first 2^k points of each dimension of the Sobol sequence are
+     * stratified in 2^k intervals. */
+    for (uint32_t d = 0; d < 21; ++d) {
+        std::vector < int > strata(64, 0);
+
+        for (uint32_t i = 0; i < 64; ++i) {
+            strata[static_cast < int >(
+                    manager::ExperimentDesign::sobol(i, d) * 64)]++;
+        }
+
+        for (uint32_t i = 0; i < 64; ++i) {
+            BOOST_REQUIRE_EQUAL(strata[i], 1);
+        }
+    }
+
+    BOOST_REQUIRE_THROW(manager::ExperimentDesign::sobol(0, 21),
+                        utils::ArgError);
+
+    std::vector < int > images(1000, 0);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        images[manager::ExperimentDesign::permute(i, 1000, 1234)]++;
+    }
+    for (uint32_t i = 0; i < 1000; ++i) {
+        BOOST_REQUIRE_EQUAL(images[i], 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(experimentgenerator_replicas)
+{
+    vpz::Vpz vpz;
+    vpz.parseMemory(xml);
+    vpz.project().experiment().setReplicas(3);
+
+    manager::ExperimentGenerator expgen(vpz, 1, 2);
+    BOOST_REQUIRE_EQUAL(expgen.size(), 2);
+    BOOST_REQUIRE_EQUAL(expgen.replicas(), 3);
+    BOOST_REQUIRE_EQUAL(expgen.min(), 1);
+    BOOST_REQUIRE_EQUAL(expgen.max(), 1);
+
+    BOOST_REQUIRE_THROW(vpz.project().experiment().setReplicas(0),
+                        utils::ArgError);
+
+    manager::MatrixSink sink(2, 3);
+    sink.write(4, new value::Map());
+    value::Matrix *matrix = sink.release();
+
+    BOOST_REQUIRE_EQUAL(matrix->columns(), 2);
+    BOOST_REQUIRE_EQUAL(matrix->rows(), 3);
+    BOOST_REQUIRE(matrix->get(1, 1));
+    BOOST_REQUIRE(not matrix->get(0, 1));
+    delete matrix;
+}
+
+BOOST_AUTO_TEST_CASE(result_cache)
+{
+    const char *directory = "test_result_cache";
+
+    vpz::Vpz vpz;
+    vpz.parseMemory(xml);
+
+    vpz::Conditions overlay;
+    manager::ExperimentGenerator expgen(vpz, 0, 1);
+    expgen.getOverlay(1, &overlay);
+
+    uint64_t size;
+
+    {
+        manager::ResultCache cache(directory);
+        cache.clear();
+
+        std::string identity = cache.identity(vpz.project());
+        BOOST_REQUIRE_EQUAL(identity.size(), 32);
+        BOOST_REQUIRE_EQUAL(identity, cache.identity(vpz.project()));
+
+        std::string key = cache.key(identity, &overlay, 1, 0);
+        BOOST_REQUIRE_EQUAL(key, cache.key(identity, &overlay, 1, 0));
+        BOOST_REQUIRE(key != cache.key(identity, &overlay, 1, 1));
+        BOOST_REQUIRE(key != cache.key(identity, &overlay, 0, 0));
+        BOOST_REQUIRE(key != cache.key(identity, 0, 1, 0));
+
+        vpz.project().experiment().setDuration(1.0);
+        BOOST_REQUIRE(identity != cache.identity(vpz.project()));
+
+        BOOST_REQUIRE(not cache.get(key));
+
+        value::Map *result = new value::Map();
+        result->addDouble("x", 1.5);
+        cache.put(key, result);
+        delete result;
+
+        result = cache.get(key);
+        BOOST_REQUIRE(result);
+        BOOST_REQUIRE_CLOSE(result->getDouble("x"), 1.5, 1e-10);
+        delete result;
+
+        BOOST_REQUIRE_EQUAL(cache.hits(), 1);
+        BOOST_REQUIRE_EQUAL(cache.misses(), 1);
+        BOOST_REQUIRE(cache.size() > 0);
+
+        /* A result stored again replaces the previous one. */
+        uint64_t single = cache.size();
+        result = cache.get(key);
+        cache.put(key, result);
+        delete result;
+        BOOST_REQUIRE_EQUAL(cache.size(), single);
+        BOOST_REQUIRE_EQUAL(cache.hits(), 2);
+
+        /* The simulations without result do not use the cache. */
+        vpz::Vpz *empty = new vpz::Vpz();
+        empty->parseMemory(xml);
+        delete empty->project().model().model();
+        empty->project().model().setModel(new vpz::CoupledModel("top", 0));
+
+        utils::ModuleManager modules;
+        manager::Simulation sim(manager::LOG_NONE,
+                                manager::SIMULATION_NO_RETURN, 0);
+        manager::Error error;
+        sim.setCache(&cache);
+        BOOST_REQUIRE(not sim.run(empty, modules, &error));
+        BOOST_REQUIRE_EQUAL(error.code, 0);
+        BOOST_REQUIRE_EQUAL(cache.hits(), 2);
+        BOOST_REQUIRE_EQUAL(cache.misses(), 1);
+
+        result = new value::Map();
+        result->addDouble("y", 2.5);
+        cache.put(cache.key(identity, &overlay, 2, 0), result);
+        delete result;
+        BOOST_REQUIRE_EQUAL(cache.evictions(), 0);
+
+        size = cache.size();
+    }
+
+    {
+        /* Only one result fits into the capacity. */
+        manager::ResultCache cache(directory, size / 2 + 1);
+
+        BOOST_REQUIRE_EQUAL(cache.evictions(), 1);
+        BOOST_REQUIRE(cache.size() <= cache.capacity());
+
+        cache.clear();
+        BOOST_REQUIRE_EQUAL(cache.size(), 0);
+    }
+
+    std::remove(directory);
+}
+
+static value::Map * buildReplica(double x)
+{
+    value::Matrix *matrix = new value::Matrix(2, 2, 1, 1);
+    matrix->addString(0, 0, "time");
+    matrix->addString(1, 0, "top:a.x");
+    matrix->addDouble(0, 1, 10.0);
+    matrix->addDouble(1, 1, x);
+
+    value::Map *result = new value::Map();
+    result->add("view", matrix);
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(replication_control)
+{
+    BOOST_REQUIRE_THROW(manager::ReplicationControl(0), utils::ArgError);
+    BOOST_REQUIRE_THROW(manager::ReplicationControl(10, 1.0),
+                        utils::ArgError);
+
+    manager::ReplicationControl control(4, 0.95);
+    BOOST_REQUIRE_THROW(control.addStatistic("view", "top:a.x", 0.0),
+                        utils::ArgError);
+    control.addStatistic("view", "top:a.x", 0.5);
+
+    control.start(2, 3);
+    BOOST_REQUIRE_EQUAL(control.first(), 2);
+    BOOST_REQUIRE_EQUAL(control.last(), 3);
+    BOOST_REQUIRE(not control.isPrecise(2));
+
+    const double values[] = { 1.0, 2.0, 3.0, 4.0 };
+
+    for (int i = 0; i < 4; ++i) {
+        value::Map *result = buildReplica(values[i]);
+        control.update(2, result);
+        delete result;
+
+        result = buildReplica(5.0);
+        control.update(3, result);
+        delete result;
+    }
+
+    BOOST_REQUIRE_EQUAL(control.replicas(2), 4);
+    BOOST_REQUIRE_CLOSE(control.mean(2, 0), 2.5, 1e-10);
+
+    /* t(3, 0.975) = 3.182446, s = 1.290994 */
+    BOOST_REQUIRE_CLOSE(control.halfWidth(2, 0), 2.054260, 1e-3);
+    BOOST_REQUIRE(not control.isPrecise(2));
+    BOOST_REQUIRE_CLOSE(control.halfWidth(3, 0), 0.0, 1e-10);
+    BOOST_REQUIRE(control.isPrecise(3));
+
+    value::Map *result = buildReplica(1.0);
+    BOOST_REQUIRE_THROW(control.update(4, result), utils::ArgError);
+    BOOST_REQUIRE_THROW(control.update(2, 0), utils::ArgError);
+
+    manager::ReplicationControl other;
+    other.addStatistic("view", "top:a.y", 0.0, 0.1);
+    other.start(0, 0);
+    BOOST_REQUIRE_THROW(other.update(0, result), utils::ArgError);
+    delete result;
+}
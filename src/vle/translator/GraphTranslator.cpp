@@ -26,7 +26,14 @@
 
 
 #include <vle/translator/GraphTranslator.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/tokenizer.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
 
 namespace vle { namespace translator {
 
@@ -37,10 +44,6 @@ void GraphTranslator::translate(const value::Map& buffer)
     mNodeNumber = toInteger(init.get("number"));
     if (mNodeNumber <= 0) {
         throw utils::ArgError("GraphTranslator: bad node number");
-    } else {
-        BoolArray::extent_gen extents;
-
-        mGraph.resize(extents[mNodeNumber][mNodeNumber]);
     }
 
     if (init.exist("prefix")) {
@@ -54,81 +57,327 @@ void GraphTranslator::translate(const value::Map& buffer)
         mPort = toString(init.get("port"));
     }
 
-    std::string adjmat = toString(init.get("adjacency matrix"));
-    std::string classes = toString(init.get("classes"));
+    if (init.exist("adjacency matrix")) {
+        readMatrix(toString(init.get("adjacency matrix")));
+    } else if (init.exist("edges")) {
+        readEdges(init.getTuple("edges"));
+    } else if (init.exist("offsets")) {
+        readRows(init.getTuple("offsets"), init.getTuple("targets"));
+    } else if (init.exist("edges file")) {
+        std::string filename(toString(init.get("edges file")));
+
+        if (not boost::filesystem::path(filename).has_root_directory()) {
+            filename = mExecutive.getPackageDataFile(filename);
+        }
+
+        readEdgesFile(filename);
+    } else {
+        throw utils::ArgError("GraphTranslator: no adjacency matrix or edges");
+    }
+
+    if (init.exist("class")) {
+        mClass.assign(mNodeNumber, toString(init.get("class")));
+    } else {
+        typedef boost::tokenizer < boost::char_separator < char > > tokenizer;
+        boost::char_separator<char> sep(" \n\t\r");
+
+        std::string classes = toString(init.get("classes"));
+        tokenizer tok(classes, sep);
+
+        for (tokenizer::iterator it = tok.begin(); it != tok.end(); ++it) {
+            mClass.push_back(*it);
+        }
+    }
+
+    if (mClass.size() != mNodeNumber) {
+        throw utils::ArgError("GraphTranslator: bad node number in class");
+    }
 
+    makeBigBang();
+}
+
+void GraphTranslator::readMatrix(const std::string& adjmat)
+{
     typedef boost::tokenizer < boost::char_separator < char > > tokenizer;
     boost::char_separator<char> sep(" \n\t\r");
+    tokenizer tok(adjmat, sep);
 
-    {
-        tokenizer tok(adjmat, sep);
+    mOffsets.reserve(mNodeNumber + 1);
+    mOffsets.push_back(0);
 
-        size_type i = 0, j = 0;
-        for (tokenizer::iterator it = tok.begin(); it != tok.end(); ++it) {
-            mGraph[j][i] = ((*it) == "1");
+    uint32_t i = 0;
+    for (tokenizer::iterator it = tok.begin(); it != tok.end(); ++it) {
+        if (mOffsets.size() > mNodeNumber) {
+            throw utils::ArgError("GraphTranslator: bad node number in "
+                                  "matrix");
+        }
 
-            ++i;
-            if (i == mNodeNumber) {
-                i = 0;
-                ++j;
-            }
+        if ((*it) == "1") {
+            mTargets.push_back(i);
         }
 
-        if (j * mNodeNumber + i != mNodeNumber * mNodeNumber) {
-            throw utils::ArgError("GraphTranslator: bad node number in matrix");
+        ++i;
+        if (i == mNodeNumber) {
+            i = 0;
+            mOffsets.push_back(mTargets.size());
         }
     }
 
+    if (i != 0 or mOffsets.size() != mNodeNumber + 1) {
+        throw utils::ArgError("GraphTranslator: bad node number in matrix");
+    }
+}
+
+void GraphTranslator::readEdges(const value::Tuple& edges)
+{
+    if (edges.size() % 2 != 0) {
+        throw utils::ArgError("GraphTranslator: odd number of values in "
+                              "edges");
+    }
+
+    mOffsets.assign(mNodeNumber + 1, 0);
+    for (value::Tuple::size_type i = 0; i < edges.size(); i += 2) {
+        mOffsets[toNode(edges[i]) + 1]++;
+        toNode(edges[i + 1]);
+    }
+
+    for (unsigned int i = 0; i < mNodeNumber; ++i) {
+        mOffsets[i + 1] += mOffsets[i];
+    }
+
+    std::vector < uint32_t > next(mOffsets.begin(), mOffsets.end() - 1);
+    mTargets.resize(edges.size() / 2);
+    for (value::Tuple::size_type i = 0; i < edges.size(); i += 2) {
+        mTargets[next[toNode(edges[i])]++] = toNode(edges[i + 1]);
+    }
+
+    sortRows();
+}
+
+void GraphTranslator::readRows(const value::Tuple& offsets,
+                               const value::Tuple& targets)
+{
+    if (offsets.size() != mNodeNumber + 1 or offsets[0] != 0.0 or
+        offsets[mNodeNumber] != static_cast < double >(targets.size())) {
+        throw utils::ArgError("GraphTranslator: bad offsets");
+    }
+
+    mOffsets.reserve(offsets.size());
+    for (value::Tuple::size_type i = 0; i < offsets.size(); ++i) {
+        uint32_t offset = static_cast < uint32_t >(offsets[i]);
+
+        if (offset != offsets[i] or (i > 0 and offset < mOffsets.back())) {
+            throw utils::ArgError("GraphTranslator: bad offsets");
+        }
+        mOffsets.push_back(offset);
+    }
+
+    mTargets.reserve(targets.size());
+    for (value::Tuple::size_type i = 0; i < targets.size(); ++i) {
+        mTargets.push_back(toNode(targets[i]));
+    }
+
+    sortRows();
+}
+
+void GraphTranslator::readEdgesFile(const std::string& filename)
+{
+    unsigned int line;
+    uint32_t src, dst;
+
+    mOffsets.assign(mNodeNumber + 1, 0);
+
     {
-        tokenizer tok(classes, sep);
+        std::ifstream file(filename.c_str());
 
-        for (tokenizer::iterator it = tok.begin(); it != tok.end(); ++it) {
-            mClass.push_back(*it);
+        if (not file) {
+            throw utils::ArgError(fmt(
+                    _("GraphTranslator: cannot open edges file `%1%'")) %
+                filename);
+        }
+
+        line = 0;
+        while (readEdge(file, filename, line, src, dst)) {
+            mOffsets[src + 1]++;
         }
     }
 
-    if (mClass.size() != mNodeNumber) {
-        throw utils::ArgError("GraphTranslator: bad node number in class");
+    for (unsigned int i = 0; i < mNodeNumber; ++i) {
+        mOffsets[i + 1] += mOffsets[i];
     }
 
-    makeBigBang();
+    std::vector < uint32_t > next(mOffsets.begin(), mOffsets.end() - 1);
+    mTargets.resize(mOffsets[mNodeNumber]);
+
+    {
+        std::ifstream file(filename.c_str());
+
+        line = 0;
+        while (readEdge(file, filename, line, src, dst)) {
+            if (next[src] == mOffsets[src + 1]) {
+                throw utils::ArgError(fmt(
+                        _("GraphTranslator: edges file `%1%' modified "
+                          "while read")) % filename);
+            }
+            mTargets[next[src]++] = dst;
+        }
+    }
+
+    sortRows();
 }
 
-void GraphTranslator::makeBigBang()
+bool GraphTranslator::readEdge(std::istream& file,
+                               const std::string& filename,
+                               unsigned int& line,
+                               uint32_t& src,
+                               uint32_t& dst) const
+{
+    std::string buffer;
+
+    while (std::getline(file, buffer)) {
+        ++line;
+
+        const char* str = buffer.c_str();
+        while (*str == ' ' or *str == '\t') {
+            ++str;
+        }
+
+        if (*str == '\0' or *str == '\r' or *str == '#') {
+            continue;
+        }
+
+        char* end;
+        unsigned long first = std::strtoul(str, &end, 10);
+        const char* next = end;
+        unsigned long second = std::strtoul(next, &end, 10);
+
+        if (next == str or end == next or first >= mNodeNumber or
+            second >= mNodeNumber) {
+            throw utils::ArgError(fmt(
+                    _("GraphTranslator: bad edge at line %1% of `%2%'")) %
+                line % filename);
+        }
+
+        src = static_cast < uint32_t >(first);
+        dst = static_cast < uint32_t >(second);
+        return true;
+    }
+
+    return false;
+}
+
+void GraphTranslator::sortRows()
+{
+    for (unsigned int i = 0; i < mNodeNumber; ++i) {
+        std::vector < uint32_t >::iterator first = mTargets.begin() +
+            mOffsets[i];
+        std::vector < uint32_t >::iterator last = mTargets.begin() +
+            mOffsets[i + 1];
+
+        std::sort(first, last);
+
+        std::vector < uint32_t >::iterator it = std::adjacent_find(first,
+                                                                   last);
+        if (it != last) {
+            throw utils::ArgError(fmt(
+                    _("GraphTranslator: duplicated edge (%1%, %2%)")) %
+                i % *it);
+        }
+    }
+}
+
+uint32_t GraphTranslator::toNode(double value) const
 {
-    for (size_type i = 0; i < mNodeNumber; ++i){
-        std::string name = (boost::format("%1%-%2%") % mPrefix % i).str();
-        createNewNode(name, mClass[i]);
+    if (not (value >= 0.0 and value < mNodeNumber) or
+        value != static_cast < double >(static_cast < uint32_t >(value))) {
+        throw utils::ArgError(fmt(
+                _("GraphTranslator: bad node %1% in edges")) % value);
     }
 
-    for (size_type i = 0; i < mNodeNumber; ++i) {
-        for (size_type j = 0; j < mNodeNumber; ++j) {
-            if (mGraph[j][i]) {
-                connectNodes(j, i);
+    return static_cast < uint32_t >(value);
+}
+
+GraphTranslator::BoolArray& GraphTranslator::graph() const
+{
+    if (mGraph.num_elements() == 0 and not mOffsets.empty()) {
+        BoolArray::extent_gen extents;
+        mGraph.resize(extents[mNodeNumber][mNodeNumber]);
+
+        for (size_type i = 0; i < mNodeNumber; ++i) {
+            for (uint32_t j = mOffsets[i]; j < mOffsets[i + 1]; ++j) {
+                mGraph[i][mTargets[j]] = true;
             }
         }
     }
+
+    return mGraph;
 }
 
-void GraphTranslator::createNewNode(const std::string& name,
-                                    std::string& classname)
+void GraphTranslator::makeBigBang()
 {
-    mExecutive.createModelFromClass(classname, name);
-    mNode.push_back(name);
+    mExecutive.beginTransaction();
+
+    try {
+        mNode.reserve(mNodeNumber);
+
+        /*
+         * The nodes of a class are built together.
+         */
+        std::map < std::string, std::vector < std::string > > classes;
+        for (size_type i = 0; i < mNodeNumber; ++i){
+            std::string name(mPrefix);
+            name += '-';
+            name += boost::lexical_cast < std::string >(i);
+            mNode.push_back(name);
+            classes[mClass[i]].push_back(name);
+        }
+
+        for (std::map < std::string, std::vector < std::string > >::iterator
+             it = classes.begin(); it != classes.end(); ++it) {
+            mExecutive.createModelsFromClass(it->first, it->second);
+        }
+
+        /*
+         * The ports shared by all the edges of a node are added once.
+         */
+        std::vector < bool > hasInput(mNodeNumber, false);
+        for (std::vector < uint32_t >::const_iterator it = mTargets.begin();
+             it != mTargets.end(); ++it) {
+            hasInput[*it] = true;
+        }
+
+        for (size_type i = 0; i < mNodeNumber; ++i) {
+            if (mOffsets[i] != mOffsets[i + 1] and
+                (mPort == "in-out" or mPort == "out")) {
+                mExecutive.addOutputPort(mNode[i], "out");
+            }
+
+            if (hasInput[i] and (mPort == "in-out" or mPort == "in")) {
+                mExecutive.addInputPort(mNode[i], "in");
+            }
+        }
+
+        for (size_type i = 0; i < mNodeNumber; ++i) {
+            for (uint32_t j = mOffsets[i]; j < mOffsets[i + 1]; ++j) {
+                connectNodes(i, mTargets[j]);
+            }
+        }
+    } catch (...) {
+        mExecutive.commitTransaction();
+        throw;
+    }
+
+    mExecutive.commitTransaction();
 }
 
 void GraphTranslator::connectNodes(unsigned int from, unsigned int to)
 {
     if (mPort == "in-out") {
-        mExecutive.addOutputPort(mNode[from], "out");
-        mExecutive.addInputPort(mNode[to], "in");
         mExecutive.addConnection(mNode[from], "out", mNode[to], "in");
     } else if (mPort == "in") {
         mExecutive.addOutputPort(mNode[from], mNode[to]);
-        mExecutive.addInputPort(mNode[to], "in");
         mExecutive.addConnection(mNode[from], mNode[to], mNode[to], "in");
     } else if (mPort == "out") {
-        mExecutive.addOutputPort(mNode[from], "out");
         mExecutive.addInputPort(mNode[to], mNode[from]);
         mExecutive.addConnection(mNode[from], "out", mNode[to], mNode[from]);
     } else {
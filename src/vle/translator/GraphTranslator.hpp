@@ -30,7 +30,9 @@
 
 #include <vle/DllDefines.hpp>
 #include <vle/devs/Executive.hpp>
+#include <vle/value/Tuple.hpp>
 #include <boost/multi_array.hpp>
+#include <istream>
 #include <string>
 #include <vector>
 
@@ -64,6 +66,27 @@ namespace vle { namespace translator {
  *    0 0 0 1 0 0 0
  *   </string>
  *  </key>
+ *  <!-- or a sparse list of edges (source, destination) -->
+ *  <key name="edges">
+ *   <tuple>0 1 0 3 0 4 0 5 0 6 1 4 1 5 1 6 ...</tuple>
+ *  </key>
+ *  <!-- or the compressed sparse rows of the adjacency matrix: the
+ *  destinations of the node i are targets[offsets[i]] to
+ *  targets[offsets[i + 1] - 1] -->
+ *  <key name="offsets">
+ *   <tuple>0 5 8 10 11 11 13 14</tuple>
+ *  </key>
+ *  <key name="targets">
+ *   <tuple>1 3 4 5 6 4 5 6 5 6 6 2 4 3</tuple>
+ *  </key>
+ *  <!-- or a text file of edges, one `source destination' per line, lines
+ *  starting with # are ignored. A relative path is a file of the data
+ *  directory of the package of the executive. The file is read twice, to
+ *  count the edges of each node then to store them, only the compressed
+ *  rows are kept in memory. -->
+ *  <key name="edges file">
+ *   <string>edges.txt</string>
+ *  </key>
  *  <key name="classes">
  *   <string>
  *   <!-- one class per node -->
@@ -71,6 +94,10 @@ namespace vle { namespace translator {
  *   class6 class7
  *   </string>
  *  </key>
+ *  <!-- or the same class for all the nodes -->
+ *  <key name="class">
+ *   <string>class1</string>
+ *  </key>
  *  <key name="port">
  *   <string>
  *   <!-- Type of connection:
@@ -86,6 +113,13 @@ namespace vle { namespace translator {
  *  </key>
  * </map>
  * @endcode
+ *
+ * The graph is stored as compressed sparse rows: the memory and the time to
+ * build the graph depend on the number of edges, except for the `adjacency
+ * matrix' key. The nodes of a class are built together, the ports of the
+ * nodes are added once per node (or once per edge for the ports named by
+ * the nodes) and all the changes are done in one transaction of the
+ * executive, so the routing is computed once.
  */
 class VLE_API GraphTranslator
 {
@@ -122,26 +156,68 @@ public:
     void translate(const value::Map& buffer);
 
     inline int getNodeNumber() const { return mNodeNumber; }
+
+    /**
+     * @brief Get the number of edges of the graph.
+     * @return The number of edges.
+     */
+    inline std::size_t getEdgeNumber() const { return mTargets.size(); }
+
+    /**
+     * @brief Get the first edge of each node in getTargets(), plus the number
+     * of edges.
+     * @return A vector of getNodeNumber() + 1 offsets.
+     */
+    inline const std::vector < uint32_t >& getOffsets() const
+    { return mOffsets; }
+
+    /**
+     * @brief Get the destination of the edges, sorted by source.
+     * @return A vector of getEdgeNumber() destinations.
+     */
+    inline const std::vector < uint32_t >& getTargets() const
+    { return mTargets; }
     inline const std::string& getNode(index i) const { return mNode[i]; }
     inline const std::string& getClass(index i) const { return mClass[i]; }
 
-    inline iterator begin() { return mGraph.begin(); }
-    inline iterator end() { return mGraph.end(); }
-    inline const_iterator begin() const { return mGraph.begin(); }
-    inline const_iterator end() const { return mGraph.end(); }
-    inline size_type size() const { return mGraph.size(); }
+    /**
+     * @brief Get the rows of the adjacency matrix. The matrix is built
+     * from the compressed rows on the first call, whatever the key used to
+     * read the graph, and uses getNodeNumber()^2 booleans.
+     */
+    inline iterator begin() { return graph().begin(); }
+    inline iterator end() { return graph().end(); }
+    inline const_iterator begin() const { return graph().begin(); }
+    inline const_iterator end() const { return graph().end(); }
+
+    /**
+     * @brief Get the size of the adjacency matrix, see begin().
+     * @return The size of the adjacency matrix.
+     */
+    inline size_type size() const { return graph().size(); }
 
 private:
     devs::Executive& mExecutive;
     unsigned int mNodeNumber;
-    BoolArray mGraph;
+    mutable BoolArray mGraph;
     std::vector < std::string > mNode;
     std::vector < std::string > mClass;
     std::string mPrefix;
     std::string mPort;
+    std::vector < uint32_t > mOffsets;
+    std::vector < uint32_t > mTargets;
+
+    void readMatrix(const std::string& adjmat);
+    void readEdges(const value::Tuple& edges);
+    void readRows(const value::Tuple& offsets, const value::Tuple& targets);
+    void readEdgesFile(const std::string& filename);
+    bool readEdge(std::istream& file, const std::string& filename,
+                  unsigned int& line, uint32_t& src, uint32_t& dst) const;
+    void sortRows();
+    uint32_t toNode(double value) const;
+    BoolArray& graph() const;
 
     void makeBigBang();
-    void createNewNode(const std::string& name, std::string& classname);
     void connectNodes(unsigned int from, unsigned int to);
 };
 
@@ -29,6 +29,7 @@
 #include <vle/value/Boolean.hpp>
 #include <vle/value/Set.hpp>
 #include <vle/value/String.hpp>
+#include <vle/value/Map.hpp>
 #include <vle/vpz/AtomicModel.hpp>
 #include <boost/cast.hpp>
 
@@ -196,6 +197,23 @@ void MatrixTranslator::parseXML(const value::Value& value)
             m_multiple = true;
         }
 
+        if (cells.exist("implicit")) {
+            m_implicit = cells.getBoolean("implicit");
+        }
+
+        if (cells.exist("torus")) {
+            m_torus = cells.getBoolean("torus");
+        }
+
+        if (cells.exist("parameters")) {
+            const value::Map& parameters = cells.getMap("parameters");
+            for (value::Map::const_iterator it = parameters.begin();
+                 it != parameters.end(); ++it) {
+                m_parameters.insert(std::make_pair(
+                        it->first, value::toTableValue(*it->second)));
+            }
+        }
+
         if (cells.exist("init")) {
             if (m_dimension == 0) {
                 m_init = new unsigned int[m_size[0]];
@@ -221,8 +239,13 @@ void MatrixTranslator::translate(const value::Value& buffer)
         parseXML(buffer);
 
         translateDynamics();
-        translateConditions();
-        translateStructures();
+
+        if (m_implicit) {
+            translateGrid();
+        } else {
+            translateConditions();
+            translateStructures();
+        }
     } catch (const std::exception& e) {
         throw utils::InternalError(fmt(
                 _("Matrix translator error: %1%")) % e.what());
@@ -410,6 +433,60 @@ void MatrixTranslator::translateStructures()
     }
 }
 
+void MatrixTranslator::translateGrid()
+{
+    if (m_library.empty() and m_libraries.empty()) {
+        throw utils::ArgError(
+            _("MatrixTranslator: implicit grid without library"));
+    }
+
+    if (m_exe.coupledmodel().exist(m_prefix)) {
+        throw utils::ArgError(fmt(
+                _("MatrixTranslator: model '%1%' already exists")) %
+            m_prefix);
+    }
+
+    unsigned int height = m_dimension == 0 ? 1 : m_size[1];
+
+    /* the eight cells neighbourhood is named von neumann by the
+     * translator. */
+    vpz::GridModel* grid = new vpz::GridModel(
+        m_prefix, 0, m_size[0], height,
+        m_connectivity == VON_NEUMANN ? vpz::GridModel::MOORE :
+        vpz::GridModel::VON_NEUMANN, m_torus, m_symmetricport);
+
+    try {
+        for (std::map < std::string, value::Table >::const_iterator it =
+             m_parameters.begin(); it != m_parameters.end(); ++it) {
+            grid->setParameter(it->first, it->second);
+        }
+
+        std::vector < std::string > conditions(1, "cond_cell");
+
+        for (unsigned int j = 1; j <= height; j++) {
+            for (unsigned int i = 1; i <= m_size[0]; i++) {
+                if (m_dimension == 0 or existModel(i, j)) {
+                    vpz::AtomicModel* atomicModel =
+                        grid->addCell(i - 1, j - 1, getName(i, j));
+
+                    atomicModel->setDynamics(m_dimension == 0 ?
+                                             getDynamics(i) :
+                                             getDynamics(i, j));
+                    atomicModel->setConditions(conditions);
+                    atomicModel->setObservables("obs_cell");
+                    m_models[atomicModel->getName()] = atomicModel;
+                }
+            }
+        }
+    } catch (...) {
+        m_models.clear();
+        delete grid;
+        throw;
+    }
+
+    m_exe.createGridModel(grid);
+}
+
 void MatrixTranslator::translateSymmetricConnection2D(unsigned int i,
                                                       unsigned int j)
 {
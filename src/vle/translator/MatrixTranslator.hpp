@@ -30,6 +30,7 @@
 
 #include <vle/DllDefines.hpp>
 #include <vle/devs/Executive.hpp>
+#include <vle/value/Table.hpp>
 #include <string>
 #include <vector>
 
@@ -83,6 +84,14 @@ namespace vle { namespace translator {
      *    0 0 0 0 0 0 0 0 0 0 0
      *     </tuple>
      *    </key>
+     *    <!-- optional, implicit connections (vpz::GridModel) -->
+     *    <key name="implicit"><boolean>1</boolean></key>
+     *    <key name="torus"><boolean>0|1</boolean></key>
+     *    <key name="parameters">
+     *     <map>
+     *      <key name="altitude"><table width="11" height="7">...</table></key>
+     *     </map>
+     *    </key>
      *   </map>
      *  </key>
      * </map>
@@ -114,12 +123,21 @@ namespace vle { namespace translator {
      * Von neumann = 8
      * Mmoore = 4
      * @endcode
+     *
+     * With the `implicit' key, the cells are the cells of a vpz::GridModel
+     * named by the prefix: the connections between the cells are not built
+     * and the cells share the condition `cond_cell'. The values of the
+     * `cond_prefix_i_j' conditions (Neighbourhood, _x and _y) and the values
+     * of the tables of `parameters' are given to each cell by the grid. The
+     * `torus' key connects the borders of the grid. Only the libraries are
+     * allowed for the implicit grid, not the classes.
      */
     class VLE_API MatrixTranslator
     {
     public:
         MatrixTranslator(devs::Executive& exe)
-            : m_exe(exe), m_dimension(0), m_init(0), m_symmetricport(false)
+            : m_exe(exe), m_dimension(0), m_init(0), m_symmetricport(false),
+            m_implicit(false), m_torus(false)
         {}
 
         virtual ~MatrixTranslator();
@@ -154,6 +172,9 @@ namespace vle { namespace translator {
         unsigned int* m_init;
         std::map < std::string , const vpz::AtomicModel* > m_models;
         bool m_symmetricport;
+        bool m_implicit;
+        bool m_torus;
+        std::map < std::string, value::Table > m_parameters;
 
         bool existModel(unsigned int i, unsigned int j = 0);
         std::string getDynamics(unsigned int i, unsigned int j = 0);
@@ -173,6 +194,7 @@ namespace vle { namespace translator {
                                   unsigned int j);
         void translateCondition1D(unsigned int i);
         void translateConditions();
+        void translateGrid();
     };
 
 }} // namespace vle translator
@@ -0,0 +1,256 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE translator_graph_test
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <vle/translator/GraphTranslator.hpp>
+#include <vle/devs/Coordinator.hpp>
+#include <vle/devs/Executive.hpp>
+#include <vle/devs/RootCoordinator.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Dynamics.hpp>
+#include <vle/vpz/Experiment.hpp>
+#include <vle/vpz/Classes.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/value/String.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Tuple.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <vle/utils/PackageTable.hpp>
+
+using namespace vle;
+
+static bool edge(const translator::GraphTranslator& tr, int from, int to)
+{
+    return (*(tr.begin() + from))[to];
+}
+
+/*
+ * An executive in the coupled model `top' and the class `node', an empty
+ * coupled model, to build the nodes of the graphs.
+ */
+struct C
+{
+    vpz::Classes classes;
+
+    C()
+    {
+        classes.add("node").setModel(new vpz::CoupledModel("node", 0));
+    }
+};
+
+struct F : C
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Experiment expe;
+    devs::RootCoordinator root;
+    devs::Coordinator coord;
+    utils::PackageTable packages;
+    vpz::CoupledModel* top;
+    devs::Executive* exe;
+
+    F()
+        : root(modules), coord(modules, dyns, classes, expe, root),
+        top(new vpz::CoupledModel("top", 0)), exe(0)
+    {
+        devs::InitEventList events;
+        exe = new devs::Executive(
+            devs::ExecutiveInit(*top->addAtomicModel("exe"),
+                                packages.get("vle.translator.test"), coord),
+            events);
+    }
+
+    ~F()
+    {
+        delete exe;
+        delete top;
+    }
+
+    value::Map* init(int number)
+    {
+        value::Map* map = new value::Map();
+        map->addInt("number", number);
+        map->addString("class", "node");
+        map->addString("port", "in-out");
+        return map;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(test_edges, F)
+{
+    value::Map* map = init(4);
+    value::Tuple* edges = new value::Tuple();
+    double values[] = { 2, 0, 0, 3, 0, 1, 3, 2 };
+    for (int i = 0; i < 8; ++i) {
+        edges->add(values[i]);
+    }
+    map->add("edges", edges);
+
+    translator::GraphTranslator tr(*exe);
+    tr.translate(*map);
+    delete map;
+
+    BOOST_REQUIRE_EQUAL(tr.getNodeNumber(), 4);
+    BOOST_REQUIRE_EQUAL(tr.getEdgeNumber(), 4u);
+
+    uint32_t offsets[] = { 0, 2, 2, 3, 4 };
+    uint32_t targets[] = { 1, 3, 0, 2 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(tr.getOffsets().begin(),
+                                  tr.getOffsets().end(),
+                                  offsets, offsets + 5);
+    BOOST_CHECK_EQUAL_COLLECTIONS(tr.getTargets().begin(),
+                                  tr.getTargets().end(),
+                                  targets, targets + 4);
+
+    BOOST_REQUIRE_EQUAL(top->getModelList().size(), 5u);
+    vpz::BaseModel* node0 = top->findModel("vertex-0");
+    vpz::BaseModel* node3 = top->findModel("vertex-3");
+    BOOST_REQUIRE(node0 and node3);
+    BOOST_CHECK(node0->existOutputPort("out"));
+    BOOST_CHECK(node0->existInputPort("in"));
+    BOOST_CHECK(not top->findModel("vertex-1")->existOutputPort("out"));
+    BOOST_CHECK(top->existInternalConnection("vertex-0", "out",
+                                             "vertex-3", "in"));
+    BOOST_CHECK(top->existInternalConnection("vertex-3", "out",
+                                             "vertex-2", "in"));
+    BOOST_CHECK(not top->existInternalConnection("vertex-1", "out",
+                                                 "vertex-0", "in"));
+
+    /* The adjacency matrix is built from the compressed rows. */
+    BOOST_REQUIRE_EQUAL(tr.size(), 4u);
+    BOOST_CHECK(edge(tr, 0, 1) and edge(tr, 0, 3));
+    BOOST_CHECK(edge(tr, 2, 0) and edge(tr, 3, 2));
+    BOOST_CHECK(not edge(tr, 1, 0) and not edge(tr, 0, 2));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_matrix, F)
+{
+    value::Map* map = init(3);
+    map->addString("adjacency matrix", "0 1 1\n0 0 1\n1 0 0\n");
+
+    translator::GraphTranslator tr(*exe);
+    tr.translate(*map);
+    delete map;
+
+    uint32_t offsets[] = { 0, 2, 3, 4 };
+    uint32_t targets[] = { 1, 2, 2, 0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(tr.getOffsets().begin(),
+                                  tr.getOffsets().end(),
+                                  offsets, offsets + 4);
+    BOOST_CHECK_EQUAL_COLLECTIONS(tr.getTargets().begin(),
+                                  tr.getTargets().end(),
+                                  targets, targets + 4);
+    BOOST_CHECK(edge(tr, 2, 0) and not edge(tr, 1, 0));
+    BOOST_CHECK(top->existInternalConnection("vertex-2", "out",
+                                             "vertex-0", "in"));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_edges_file, F)
+{
+    namespace fs = boost::filesystem;
+
+    fs::path filename(fs::temp_directory_path() /
+                      fs::unique_path("vle-%%%%-%%%%.txt"));
+    {
+        std::ofstream out(filename.string().c_str());
+        out << "# source destination\n"
+            << "1 0\n"
+            << "\n"
+            << "  0 2\n"
+            << "0 1\n";
+    }
+
+    value::Map* map = init(3);
+    map->addString("edges file", filename.string());
+
+    translator::GraphTranslator tr(*exe);
+    tr.translate(*map);
+    delete map;
+
+    uint32_t offsets[] = { 0, 2, 3, 3 };
+    uint32_t targets[] = { 1, 2, 0 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(tr.getOffsets().begin(),
+                                  tr.getOffsets().end(),
+                                  offsets, offsets + 4);
+    BOOST_CHECK_EQUAL_COLLECTIONS(tr.getTargets().begin(),
+                                  tr.getTargets().end(),
+                                  targets, targets + 3);
+    BOOST_CHECK(top->existInternalConnection("vertex-1", "out",
+                                             "vertex-0", "in"));
+
+    fs::remove(filename);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_edges_file_errors, F)
+{
+    namespace fs = boost::filesystem;
+
+    fs::path filename(fs::temp_directory_path() /
+                      fs::unique_path("vle-%%%%-%%%%.txt"));
+    {
+        std::ofstream out(filename.string().c_str());
+        out << "0 1\n0 1\n";
+    }
+
+    value::Map* map = init(2);
+    map->addString("edges file", filename.string());
+    {
+        translator::GraphTranslator tr(*exe);
+        BOOST_CHECK_THROW(tr.translate(*map), utils::ArgError);
+    }
+
+    {
+        std::ofstream out(filename.string().c_str());
+        out << "0 1\n1 2\n";
+    }
+    {
+        translator::GraphTranslator tr(*exe);
+        BOOST_CHECK_THROW(tr.translate(*map), utils::ArgError);
+    }
+    delete map;
+
+    /* No node was built. */
+    BOOST_CHECK_EQUAL(top->getModelList().size(), 1u);
+    fs::remove(filename);
+
+    /* A relative path is a data file of the package. */
+    map = init(2);
+    map->addString("edges file", "edges.txt");
+    {
+        translator::GraphTranslator tr(*exe);
+        BOOST_CHECK_THROW(tr.translate(*map), utils::FileError);
+    }
+    delete map;
+}
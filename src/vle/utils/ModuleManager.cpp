@@ -632,6 +632,19 @@ void *ModuleManager::get(const std::string& package,
     }
 }
 
+void *ModuleManager::getSymbol(const std::string& package,
+                               const std::string& library,
+                               ModuleType type,
+                               const std::string& symbol) const
+{
+    boost::mutex::scoped_lock lock(mPimpl->mMutex);
+
+    pimpl::Module *module = mPimpl->getModule(package, library, type);
+    module->get();
+
+    return module->getSymbol(symbol.c_str());
+}
+
 void *ModuleManager::get(const std::string& symbol)
 {
     boost::mutex::scoped_lock lock(mPimpl->mMutex);
@@ -1024,4 +1037,24 @@ std::string ModuleManager::buildModuleFilename(const std::string& package,
     return current.string();
 }
 
+std::string ModuleManager::buildModuleIdentity(const std::string& package,
+                                               const std::string& library,
+                                               ModuleType type)
+{
+    std::string result = buildModuleFilename(package, library, type);
+    boost::system::error_code ec;
+
+    uintmax_t size = fs::file_size(result, ec);
+    if (ec) {
+        return result;
+    }
+
+    std::time_t time = fs::last_write_time(result, ec);
+    if (ec) {
+        return result;
+    }
+
+    return (fmt("%1%:%2%:%3%") % result % size % time).str();
+}
+
 }} // namespace vle utils
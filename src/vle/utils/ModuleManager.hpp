@@ -173,6 +173,31 @@ public:
     void *get(const std::string& package, const std::string& library,
               ModuleType type, ModuleType *newtype = 0) const;
 
+    /**
+     * @brief Get an optional symbol of a shared library. The shared library
+     * is opened as with the get function if it was never loaded.
+     *
+     * @code
+     * ModuleManager manager;
+     * if (manager.getSymbol("foo", "bar", MODULE_DYNAMICS,
+     *                       "vle_dynamics_thread_safe")) {
+     *     // the dynamics of foo/bar can be built in parallel.
+     * }
+     * @endcode
+     *
+     * @param package
+     * @param library
+     * @param type
+     * @param symbol The name of the symbol.
+     *
+     * @throw utils::InternalError if shared library does not exists.
+     *
+     * @return A pointer to the symbol or null if the shared library does not
+     * have the symbol.
+     */
+    void *getSymbol(const std::string& package, const std::string& library,
+                    ModuleType type, const std::string& symbol) const;
+
 
     /**
      * @brief Get a symbol directly in the executable.
@@ -277,6 +302,23 @@ public:
                                            const std::string& library,
                                            ModuleType type);
 
+    /**
+     * @brief Build the identity of the file of a module.
+     *
+     * The identity is the path of the module (see @c buildModuleFilename)
+     * followed by its size and the time of its last modification. It
+     * changes when the module is rebuilt.
+     *
+     * @param package
+     * @param library
+     * @param type
+     *
+     * @return The identity or only the path if the file does not exist.
+     */
+    static std::string buildModuleIdentity(const std::string& package,
+                                           const std::string& library,
+                                           ModuleType type);
+
 private:
     ModuleManager(const ModuleManager& other);
     ModuleManager& operator=(const ModuleManager& other);
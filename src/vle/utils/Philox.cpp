@@ -0,0 +1,137 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/utils/Philox.hpp>
+
+namespace vle { namespace utils {
+
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+static inline void mulhilo(uint32_t a, uint32_t b, uint32_t *hi,
+                           uint32_t *lo)
+{
+    uint64_t product = static_cast < uint64_t >(a) * b;
+
+    *hi = static_cast < uint32_t >(product >> 32);
+    *lo = static_cast < uint32_t >(product);
+}
+
+void Philox::block(const uint32_t counter[4], const uint32_t key[2],
+                   uint32_t output[4])
+{
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2],
+             c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int round = 0; round < 10; ++round) {
+        uint32_t hi0, lo0, hi1, lo1;
+
+        mulhilo(PHILOX_M0, c0, &hi0, &lo0);
+        mulhilo(PHILOX_M1, c2, &hi1, &lo1);
+
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    output[0] = c0;
+    output[1] = c1;
+    output[2] = c2;
+    output[3] = c3;
+}
+
+void Philox::seed(uint64_t key, uint64_t stream)
+{
+    m_key[0] = static_cast < uint32_t >(key);
+    m_key[1] = static_cast < uint32_t >(key >> 32);
+    m_stream = stream;
+    m_next = 0;
+    m_index = 4;
+}
+
+void Philox::generate()
+{
+    uint32_t counter[4] = {
+        static_cast < uint32_t >(m_next),
+        static_cast < uint32_t >(m_next >> 32),
+        static_cast < uint32_t >(m_stream),
+        static_cast < uint32_t >(m_stream >> 32)
+    };
+
+    block(counter, m_key, m_output);
+    m_next++;
+    m_index = 0;
+}
+
+void Philox::discard(uint64_t n)
+{
+    uint64_t target = position() + n;
+
+    m_next = target / 4;
+    m_index = 4;
+
+    if (target % 4) {
+        generate();
+        m_index = static_cast < uint32_t >(target % 4);
+    }
+}
+
+uint64_t Philox::key(uint32_t seed, uint32_t combination, uint32_t replica)
+{
+    /* The encryption is a bijection of the counter but the key keeps
+     * half of the output: the keys of the simulations are pseudo-random
+     * 64 bits numbers, not a bijection of the triplets. */
+    const uint32_t counter[4] = { combination, replica, 0, 0 };
+    const uint32_t key[2] = { seed, 0x5eed5eed };
+    uint32_t output[4];
+
+    block(counter, key, output);
+
+    return (static_cast < uint64_t >(output[1]) << 32) | output[0];
+}
+
+uint64_t Philox::stream(const std::string& name)
+{
+    uint64_t result = 14695981039346656037ULL;
+
+    for (std::string::size_type i = 0; i < name.size(); ++i) {
+        result ^= static_cast < unsigned char >(name[i]);
+        result *= 1099511628211ULL;
+    }
+
+    return result;
+}
+
+}} // namespace vle utils
@@ -0,0 +1,156 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_UTILS_PHILOX_HPP
+#define VLE_UTILS_PHILOX_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/utils/Types.hpp>
+#include <boost/config.hpp>
+#include <string>
+
+namespace vle { namespace utils {
+
+    /**
+     * @brief Philox is a counter-based pseudo-random number generator
+     * (Philox4x32-10). Each block of four numbers is the encryption of a
+     * 128 bits counter with a 64 bits key: the key selects a generator,
+     * the upper half of the counter a stream of this generator and the
+     * lower half the position in the stream. The streams are independent
+     * and any position is reached in constant time, the state is only
+     * the key and the counter.
+     *
+     * @note "Parallel random numbers: as easy as 1, 2, 3", J. K. Salmon,
+     * M. A. Moraes, R. O. Dror and D. E. Shaw, SC'11, 2011.
+     *
+     * Philox models the boost UniformRandomNumberGenerator concept:
+     * @code
+     * uint64_t key = vle::utils::Philox::key(seed, combination, replica);
+     * vle::utils::Philox gen(key, vle::utils::Philox::stream("top:a"));
+     * boost::uniform_real < > d(0., 100.);
+     * boost::variate_generator < vle::utils::Philox&,
+     *                            boost::uniform_real < > > x(gen, d);
+     * std::cout << x() << "\n";
+     * @endcode
+     */
+    class VLE_API Philox
+    {
+    public:
+        typedef uint32_t result_type;
+
+        BOOST_STATIC_CONSTANT(bool, has_fixed_range = false);
+
+        /**
+         * @brief Build a generator at the beginning of a stream.
+         * @param key The key of the generator.
+         * @param stream The stream of the generator.
+         */
+        explicit Philox(uint64_t key = 0, uint64_t stream = 0)
+        { seed(key, stream); }
+
+        /**
+         * @brief Move the generator at the beginning of a stream.
+         * @param key The key of the generator.
+         * @param stream The stream of the generator.
+         */
+        void seed(uint64_t key, uint64_t stream = 0);
+
+        /**
+         * @brief Get the next number of the stream.
+         * @return An integer [0..2^32-1].
+         */
+        result_type operator()()
+        {
+            if (m_index == 4) {
+                generate();
+            }
+
+            return m_output[m_index++];
+        }
+
+        /**
+         * @brief Skip numbers of the stream in constant time.
+         * @param n The number of numbers to skip.
+         */
+        void discard(uint64_t n);
+
+        /**
+         * @brief Get the number of numbers already read from the stream.
+         * @return The position in the stream.
+         */
+        uint64_t position() const
+        { return m_next * 4 - (4 - m_index); }
+
+        result_type min() const { return 0; }
+
+        result_type max() const { return 0xffffffff; }
+
+        /**
+         * @brief Derive the key of the generator of a simulation. The key
+         * is the low 64 bits of the encryption of the triplet: two
+         * different triplets get unrelated keys, equal only by chance
+         * (a probability of about 2^-64 for each pair).
+         * @param seed The seed of the experiment.
+         * @param combination The combination number.
+         * @param replica The replica number.
+         * @return A key.
+         */
+        static uint64_t key(uint32_t seed, uint32_t combination,
+                            uint32_t replica);
+
+        /**
+         * @brief Derive a stream from a name, for example the complete name
+         * of a model (FNV-1a hash).
+         * @param name The name.
+         * @return A stream.
+         */
+        static uint64_t stream(const std::string& name);
+
+        /**
+         * @brief Encrypt a counter with a key: the ten rounds of
+         * Philox4x32.
+         * @param counter The counter.
+         * @param key The key.
+         * @param output The four numbers.
+         */
+        static void block(const uint32_t counter[4], const uint32_t key[2],
+                          uint32_t output[4]);
+
+    private:
+        void generate();
+
+        uint32_t m_key[2];
+        uint64_t m_stream;
+        uint64_t m_next; /**< The position of the next block. */
+        uint32_t m_output[4];
+        uint32_t m_index; /**< The next number in m_output. */
+    };
+
+}} // namespace vle utils
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/utils/Profile.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/format.hpp>
+#include <ctime>
+
+#ifdef BOOST_WINDOWS
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+#endif
+
+namespace vle { namespace utils {
+
+void Profile::add(const std::string& name, double wall, double cpu, long rss,
+                  uint64_t count)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    PhaseList::iterator it = m_phases.begin();
+    while (it != m_phases.end() and it->name != name) {
+        ++it;
+    }
+
+    if (it == m_phases.end()) {
+        it = m_phases.insert(m_phases.end(), Phase(name));
+    }
+
+    it->wall += wall;
+    it->cpu += cpu;
+    it->rss += rss;
+    it->count += count;
+    it->calls++;
+}
+
+Profile::PhaseList Profile::phases() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    return m_phases;
+}
+
+void Profile::clear()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_phases.clear();
+}
+
+void Profile::write(std::ostream& out) const
+{
+    PhaseList lst(phases());
+
+    out << boost::format("%1$-20s %2$8s %3$12s %4$12s %5$12s %6$12s\n") %
+        _("phase") % _("calls") % _("wall (s)") % _("cpu (s)") %
+        _("rss (KiB)") % _("items");
+
+    for (PhaseList::const_iterator it = lst.begin(); it != lst.end(); ++it) {
+        out << boost::format(
+            "%1$-20s %2$8d %3$12.6f %4$12.6f %5$12d %6$12d\n") %
+            it->name % it->calls % it->wall % it->cpu % it->rss % it->count;
+    }
+}
+
+double Profile::wallTime()
+{
+#ifdef BOOST_WINDOWS
+    LARGE_INTEGER frequency, counter;
+
+    ::QueryPerformanceFrequency(&frequency);
+    ::QueryPerformanceCounter(&counter);
+
+    return static_cast < double >(counter.QuadPart) / frequency.QuadPart;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t timebase;
+
+    if (timebase.denom == 0) {
+        ::mach_timebase_info(&timebase);
+    }
+
+    return static_cast < double >(::mach_absolute_time()) * timebase.numer /
+        timebase.denom / 1e9;
+#else
+    struct timespec now;
+
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+}
+
+double Profile::cpuTime()
+{
+    return static_cast < double >(std::clock()) / CLOCKS_PER_SEC;
+}
+
+long Profile::peakRss()
+{
+#ifdef BOOST_WINDOWS
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (::GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                               sizeof(counters))) {
+        return static_cast < long >(counters.PeakWorkingSetSize / 1024);
+    }
+
+    return 0;
+#else
+    struct rusage usage;
+
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+
+    return 0;
+#endif
+}
+
+}} // namespace vle utils
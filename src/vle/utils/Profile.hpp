@@ -0,0 +1,208 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_UTILS_PROFILE_HPP
+#define VLE_UTILS_PROFILE_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/utils/Types.hpp>
+#include <boost/thread/mutex.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vle { namespace utils {
+
+    /**
+     * @brief Profile stores the cost of the phases of the start of the
+     * simulations: the wall clock time, the processor time, the growth of
+     * the peak resident set size and a number of items processed (models,
+     * views, edges, etc.). The measures of a phase with the same name are
+     * accumulated, a Profile can be shared by several simulations and
+     * several threads.
+     *
+     * @code
+     * utils::Profile profile;
+     * {
+     *     utils::ProfileScope scope(&profile, "parse");
+     *     vpz = new vpz::Vpz(filename);
+     * }
+     * profile.write(std::cout);
+     * @endcode
+     */
+    class VLE_API Profile
+    {
+    public:
+        /**
+         * @brief The measures of a phase.
+         */
+        struct Phase
+        {
+            Phase(const std::string& name)
+                : name(name), wall(0.0), cpu(0.0), rss(0), count(0),
+                calls(0)
+            {}
+
+            std::string name;
+            double wall; /**< Wall clock time in seconds. */
+            double cpu; /**< Processor time of the process in seconds. */
+            long rss; /**< Growth of the peak resident set size in KiB. */
+            uint64_t count; /**< Number of items processed. */
+            uint64_t calls; /**< Number of measures accumulated. */
+        };
+
+        typedef std::vector < Phase > PhaseList;
+
+        Profile()
+        {}
+
+        /**
+         * @brief Accumulate a measure into a phase, the phase is appended
+         * if it does not exist.
+         * @param name The name of the phase.
+         * @param wall The wall clock time in seconds.
+         * @param cpu The processor time in seconds.
+         * @param rss The growth of the peak resident set size in KiB.
+         * @param count The number of items processed.
+         */
+        void add(const std::string& name, double wall, double cpu, long rss,
+                 uint64_t count);
+
+        /**
+         * @brief Get a copy of the phases in the order of their first
+         * measure.
+         * @return The list of phases.
+         */
+        PhaseList phases() const;
+
+        /**
+         * @brief Delete all the phases.
+         */
+        void clear();
+
+        /**
+         * @brief Write a table of the phases: name, number of measures,
+         * wall and processor times, peak resident set size growth and
+         * number of items.
+         * @param out The output stream.
+         */
+        void write(std::ostream& out) const;
+
+        /**
+         * @brief Get the wall clock time from a monotonic clock, not
+         * changed by the adjustments of the system time.
+         * @return A number of seconds since an arbitrary origin.
+         */
+        static double wallTime();
+
+        /**
+         * @brief Get the processor time used by the process, all threads
+         * included.
+         * @return A number of seconds.
+         */
+        static double cpuTime();
+
+        /**
+         * @brief Get the peak resident set size of the process.
+         * @return A number of KiB or 0 if unknown.
+         */
+        static long peakRss();
+
+    private:
+        Profile(const Profile&);
+        Profile& operator=(const Profile&);
+
+        PhaseList m_phases;
+        mutable boost::mutex m_mutex;
+    };
+
+    /**
+     * @brief ProfileScope measures the lifetime of the object and adds it
+     * to a phase of a Profile when destroyed. Nothing is measured if the
+     * Profile is null.
+     */
+    class VLE_API ProfileScope
+    {
+    public:
+        /**
+         * @brief Start the measure of a phase.
+         * @param profile The Profile to fill, can be null.
+         * @param name The name of the phase.
+         */
+        ProfileScope(Profile* profile, const char* name)
+            : m_profile(profile), m_name(name), m_wall(0.0), m_cpu(0.0),
+            m_rss(0), m_count(0)
+        {
+            if (m_profile) {
+                m_wall = Profile::wallTime();
+                m_cpu = Profile::cpuTime();
+                m_rss = Profile::peakRss();
+            }
+        }
+
+        /**
+         * @brief Stop the measure and add it to the Profile.
+         */
+        ~ProfileScope()
+        { stop(); }
+
+        /**
+         * @brief Stop the measure before the end of the scope and add it to
+         * the Profile. Next calls do nothing.
+         */
+        void stop()
+        {
+            if (m_profile) {
+                m_profile->add(m_name, Profile::wallTime() - m_wall,
+                               Profile::cpuTime() - m_cpu,
+                               Profile::peakRss() - m_rss, m_count);
+                m_profile = 0;
+            }
+        }
+
+        /**
+         * @brief Set the number of items processed in the phase.
+         * @param count The number of items.
+         */
+        void setCount(uint64_t count)
+        { m_count = count; }
+
+    private:
+        ProfileScope(const ProfileScope&);
+        ProfileScope& operator=(const ProfileScope&);
+
+        Profile* m_profile;
+        const char* m_name;
+        double m_wall;
+        double m_cpu;
+        long m_rss;
+        uint64_t m_count;
+    };
+
+}} // namespace vle utils
+
+#endif
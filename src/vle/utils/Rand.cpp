@@ -27,6 +27,9 @@
 
 #include <cmath>
 #include <vle/utils/Rand.hpp>
+#include <vle/utils/Xoshiro.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
 
 namespace vle { namespace utils {
 
@@ -83,4 +86,91 @@ double Rand::weibull3(const double a, const double b, const double c)
     return c + b * x;
 }
 
+void Rand::fillUniform(double* out, std::size_t n, double begin, double end)
+{
+    m_fast.fillUniform(out, n);
+
+    const double width = end - begin;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = begin + width * out[i];
+    }
+}
+
+void Rand::fillInt(int* out, std::size_t n, int begin, int end)
+{
+    if (begin > end) {
+        throw utils::ArgError(fmt(
+                _("Rand: bad range [%1%, %2%] of fillInt")) % begin % end);
+    }
+
+    /*
+     * The 32 upper bits of a number are multiplied by the size of the range
+     * and the biased products are rejected (D. Lemire, "Fast random integer
+     * generation in an interval", ACM TOMACS 29(1), 2019).
+     */
+    const uint64_t range = static_cast < uint64_t >(
+        static_cast < int64_t >(end) - static_cast < int64_t >(begin) + 1);
+    const uint64_t threshold = ((static_cast < uint64_t >(1) << 32) - range)
+        % range;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        uint64_t m;
+
+        do {
+            m = (m_fast() >> 32) * range;
+        } while ((m & 0xffffffffULL) < threshold);
+
+        out[i] = static_cast < int >(static_cast < int64_t >(begin) +
+                                     static_cast < int64_t >(m >> 32));
+    }
+}
+
+void Rand::fillNormal(double* out, std::size_t n, double mean, double sigma)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = mean + sigma * m_normal(m_fast);
+    }
+}
+
+void Rand::fillExponential(double* out, std::size_t n, double rate)
+{
+    m_fast.fillUniform(out, n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = -std::log(1.0 - out[i]) / rate;
+    }
+}
+
+void Rand::fillPoisson(int* out, std::size_t n, double mean)
+{
+    if (mean < 30.0) {
+        /*
+         * Product of uniform reals until the limit exp(-mean), computed once
+         * for the whole array.
+         */
+        const double limit = std::exp(-mean);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            double p = Xoshiro::toDouble(m_fast());
+            int k = 0;
+
+            while (p > limit) {
+                p *= Xoshiro::toDouble(m_fast());
+                ++k;
+            }
+
+            out[i] = k;
+        }
+    } else {
+        boost::poisson_distribution < int, double > distrib(mean);
+        boost::variate_generator < Xoshiro&,
+            boost::poisson_distribution < int, double > > gen(m_fast, distrib);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = gen();
+        }
+    }
+}
+
 }} // namespace vle utils
@@ -42,7 +42,9 @@
 #include <boost/random/geometric_distribution.hpp>
 #include <boost/random/cauchy_distribution.hpp>
 #include <boost/random/triangle_distribution.hpp>
+#include <vle/utils/Xoshiro.hpp>
 #include <vle/DllDefines.hpp>
+#include <cstddef>
 
 namespace vle { namespace utils {
 
@@ -74,6 +76,17 @@ namespace vle { namespace utils {
      * r.triangle(0.0, 0.5, 1.0);
      * r.weibull(1.0, 1.0);
      * @endcode
+     *
+     * The fill functions draw arrays of variates from a second generator,
+     * a four lanes xoshiro256++ seeded with the same seed (see
+     * vle::utils::Xoshiro). They do not build a distribution per number
+     * and the state of the normal distribution is kept between the calls.
+     * The sequences of the per-call functions are unchanged.
+     *
+     * @code
+     * std::vector < double > x(1000000);
+     * r.fillNormal(&x[0], x.size(), 0.0, 1.0);
+     * @endcode
      */
     class VLE_API Rand
     {
@@ -84,7 +97,9 @@ namespace vle { namespace utils {
          * @brief Create a new PRNG mersene twister initializecd with a seed
          * equal to 5489.
          */
-        Rand() {}
+        Rand()
+            : m_fast(5489u), m_normal(0.0, 1.0)
+        {}
 
         /**
          * @brief Create a new PRNG mersene twister initialized with a seed
@@ -92,7 +107,7 @@ namespace vle { namespace utils {
          * @param seed The seed to assign to the PRNG.
          */
         explicit Rand(result_type seed) :
-            m_rand(seed)
+            m_rand(seed), m_fast(seed), m_normal(0.0, 1.0)
         {}
 
         /**
@@ -100,7 +115,11 @@ namespace vle { namespace utils {
          * @param seed a value to reinitialize the random number generator.
          */
         void seed(result_type seed)
-        { m_rand.seed(seed); }
+        {
+            m_rand.seed(seed);
+            m_fast.seed(seed);
+            m_normal.reset();
+        }
 
         /**
          * @brief Generate a boolean value [true, false] using the Bernoulli
@@ -367,8 +386,72 @@ namespace vle { namespace utils {
          */
         boost::mt19937& gen() { return m_rand; }
 
+        /**
+         * @brief Fill an array with reals [0, 1).
+         * @param out The array.
+         * @param n The size of the array.
+         */
+        void fillUniform(double* out, std::size_t n)
+        { m_fast.fillUniform(out, n); }
+
+        /**
+         * @brief Fill an array with reals [begin, end).
+         * @param out The array.
+         * @param n The size of the array.
+         * @param begin The minimum value.
+         * @param end The limit (exclude) of the range.
+         */
+        void fillUniform(double* out, std::size_t n, double begin, double end);
+
+        /**
+         * @brief Fill an array with integers [begin..end].
+         * @param out The array.
+         * @param n The size of the array.
+         * @param begin The minimum value include.
+         * @param end The maximum value include.
+         * @throw utils::ArgError if begin is greater than end.
+         */
+        void fillInt(int* out, std::size_t n, int begin, int end);
+
+        /**
+         * @brief Fill an array with reals using the normal law.
+         * @param out The array.
+         * @param n The size of the array.
+         * @param mean
+         * @param sigma
+         */
+        void fillNormal(double* out, std::size_t n, double mean,
+                        double sigma);
+
+        /**
+         * @brief Fill an array with reals using an exponential
+         * distribution.
+         * @param out The array.
+         * @param n The size of the array.
+         * @param rate
+         */
+        void fillExponential(double* out, std::size_t n, double rate);
+
+        /**
+         * @brief Fill an array with integers using the Poisson
+         * distribution.
+         * @param out The array.
+         * @param n The size of the array.
+         * @param mean
+         */
+        void fillPoisson(int* out, std::size_t n, double mean);
+
+        /**
+         * @brief Get a reference to the PRNG of the fill functions.
+         * @return A reference to the PRNG.
+         */
+        Xoshiro& fast() { return m_fast; }
+
     private:
         boost::mt19937  m_rand;
+        Xoshiro         m_fast;
+        boost::normal_distribution < > m_normal; /* N(0, 1) shared by the
+                                                    calls of fillNormal. */
     };
 
 }} // namespace vle utils
@@ -40,9 +40,11 @@ namespace vle {
     using boost::int8_t;
     using boost::int16_t;
     using boost::int32_t;
+    using boost::int64_t;
     using boost::uint8_t;
     using boost::uint16_t;
     using boost::uint32_t;
+    using boost::uint64_t;
 
     using boost::int_fast8_t;
     using boost::int_fast16_t;
@@ -0,0 +1,141 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/utils/Xoshiro.hpp>
+
+namespace vle { namespace utils {
+
+static uint64_t splitmix64(uint64_t* x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ * Move a xoshiro256 state 2^128 numbers ahead.
+ */
+static void jump(uint64_t s[4])
+{
+    static const uint64_t polynomial[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+
+    uint64_t t[4] = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < 4; ++i) {
+        for (int b = 0; b < 64; ++b) {
+            if (polynomial[i] & (static_cast < uint64_t >(1) << b)) {
+                t[0] ^= s[0];
+                t[1] ^= s[1];
+                t[2] ^= s[2];
+                t[3] ^= s[3];
+            }
+
+            uint64_t u = s[1] << 17;
+
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= u;
+            s[3] = (s[3] << 45) | (s[3] >> 19);
+        }
+    }
+
+    s[0] = t[0];
+    s[1] = t[1];
+    s[2] = t[2];
+    s[3] = t[3];
+}
+
+void Xoshiro::seed(uint64_t seed)
+{
+    uint64_t s[4];
+
+    s[0] = splitmix64(&seed);
+    s[1] = splitmix64(&seed);
+    s[2] = splitmix64(&seed);
+    s[3] = splitmix64(&seed);
+
+    for (int l = 0; l < 4; ++l) {
+        m_s0[l] = s[0];
+        m_s1[l] = s[1];
+        m_s2[l] = s[2];
+        m_s3[l] = s[3];
+
+        jump(s);
+    }
+
+    m_index = 4;
+}
+
+void Xoshiro::fill(uint64_t* out, std::size_t n)
+{
+    std::size_t i = 0;
+
+    while (i < n and m_index < 4) {
+        out[i++] = m_buffer[m_index++];
+    }
+
+    for (; i + 4 <= n; i += 4) {
+        next(out + i);
+    }
+
+    while (i < n) {
+        out[i++] = operator()();
+    }
+}
+
+void Xoshiro::fillUniform(double* out, std::size_t n)
+{
+    std::size_t i = 0;
+
+    while (i < n and m_index < 4) {
+        out[i++] = toDouble(m_buffer[m_index++]);
+    }
+
+    for (; i + 4 <= n; i += 4) {
+        uint64_t x[4];
+
+        next(x);
+
+        for (int l = 0; l < 4; ++l) {
+            out[i + l] = toDouble(x[l]);
+        }
+    }
+
+    while (i < n) {
+        out[i++] = toDouble(operator()());
+    }
+}
+
+}} // namespace vle utils
@@ -0,0 +1,110 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <iostream>
+#include <vector>
+#include <vle/utils/Profile.hpp>
+#include <vle/utils/Rand.hpp>
+#include <vle/vle.hpp>
+
+/*
+ * Compare the per-call functions with the fill functions of the
+ * vle::utils::Rand class. This benchmark is not a unit test, it only
+ * writes the times on the standard output.
+ */
+int main()
+{
+    vle::Init init;
+
+    const std::size_t szmax(1000000);
+    std::vector < double > x(szmax);
+    std::vector < int > y(szmax);
+    vle::utils::Rand r(123456789);
+    double start;
+
+    start = vle::utils::Profile::wallTime();
+    for (std::size_t i = 0; i < szmax; ++i) {
+        x[i] = r.getDouble();
+    }
+    std::cout << "getDouble ......: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    r.fillUniform(&x[0], szmax);
+    std::cout << "fillUniform ....: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    for (std::size_t i = 0; i < szmax; ++i) {
+        y[i] = r.getInt(0, 99);
+    }
+    std::cout << "getInt .........: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    r.fillInt(&y[0], szmax, 0, 99);
+    std::cout << "fillInt ........: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    for (std::size_t i = 0; i < szmax; ++i) {
+        x[i] = r.normal(0.0, 1.0);
+    }
+    std::cout << "normal .........: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    r.fillNormal(&x[0], szmax, 0.0, 1.0);
+    std::cout << "fillNormal .....: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    for (std::size_t i = 0; i < szmax; ++i) {
+        x[i] = r.exponential(1.0);
+    }
+    std::cout << "exponential ....: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    r.fillExponential(&x[0], szmax, 1.0);
+    std::cout << "fillExponential : "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    for (std::size_t i = 0; i < szmax; ++i) {
+        y[i] = static_cast < int >(r.poisson(3.0));
+    }
+    std::cout << "poisson ........: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    start = vle::utils::Profile::wallTime();
+    r.fillPoisson(&y[0], szmax, 3.0);
+    std::cout << "fillPoisson ....: "
+              << vle::utils::Profile::wallTime() - start << " s\n";
+
+    return 0;
+}
@@ -48,6 +48,8 @@
 #include <vle/utils/DateTime.hpp>
 #include <vle/utils/Package.hpp>
 #include <vle/utils/Path.hpp>
+#include <vle/utils/Philox.hpp>
+#include <vle/utils/Profile.hpp>
 #include <vle/utils/Rand.hpp>
 #include <vle/utils/Tools.hpp>
 #include <vle/vle.hpp>
@@ -248,6 +250,52 @@ BOOST_AUTO_TEST_CASE(test_normal)
                         (double)szmax, 1.0, 10);
 }
 
+BOOST_AUTO_TEST_CASE(test_philox)
+{
+    {
+        /* Known answers of the Random123 library. */
+        const uint32_t counter[4] = { 0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                      0x03707344 };
+        const uint32_t key[2] = { 0xa4093822, 0x299f31d0 };
+        uint32_t output[4];
+
+        vle::utils::Philox::block(counter, key, output);
+        BOOST_REQUIRE_EQUAL(output[0], 0xd16cfe09);
+        BOOST_REQUIRE_EQUAL(output[1], 0x94fdcceb);
+        BOOST_REQUIRE_EQUAL(output[2], 0x5001e420);
+        BOOST_REQUIRE_EQUAL(output[3], 0x24126ea1);
+    }
+
+    vle::utils::Philox a(1234, 5), b(1234, 5), c(1234, 6);
+
+    for (int i = 0; i < 13; ++i) {
+        a();
+    }
+    b.discard(13);
+    BOOST_REQUIRE_EQUAL(a.position(), 13);
+    BOOST_REQUIRE_EQUAL(b.position(), 13);
+    BOOST_REQUIRE_EQUAL(a(), b());
+
+    c.discard(14);
+    BOOST_REQUIRE(a() != c());
+
+    BOOST_REQUIRE(vle::utils::Philox::key(0, 0, 1) !=
+                  vle::utils::Philox::key(0, 1, 0));
+    BOOST_REQUIRE(vle::utils::Philox::key(1, 0, 0) !=
+                  vle::utils::Philox::key(0, 0, 0));
+    BOOST_REQUIRE(vle::utils::Philox::stream("top:a") !=
+                  vle::utils::Philox::stream("top:b"));
+
+    boost::uniform_real < > distrib(0.0, 10.0);
+    boost::variate_generator < vle::utils::Philox&,
+        boost::uniform_real < > > gen(a, distrib);
+    std::vector < double > vec(1000, 0);
+
+    vle::utils::generate(vec.begin(), vec.end(), gen);
+    BOOST_REQUIRE_CLOSE(std::accumulate(vec.begin(), vec.end(), 0.0) /
+                        1000.0, 5.0, 10);
+}
+
 BOOST_AUTO_TEST_CASE(date_time)
 {
     BOOST_REQUIRE_EQUAL(vle::utils::DateTime::year((2451545)),
@@ -426,3 +474,58 @@ BOOST_AUTO_TEST_CASE(test_format_copy)
                         "\"1\", \"2\", \"3\", \"4\", \"5\", \"6\", \"7\", "
                         "\"8\", \"9\";");
 }
+
+BOOST_AUTO_TEST_CASE(test_profile)
+{
+    namespace vu = vle::utils;
+
+    vu::Profile profile;
+
+    {
+        vu::ProfileScope scope(&profile, "load");
+        scope.setCount(3);
+    }
+
+    {
+        vu::ProfileScope scope(&profile, "run");
+        scope.setCount(10);
+        scope.stop();
+        scope.setCount(20);
+    }
+
+    {
+        vu::ProfileScope scope(&profile, "load");
+        scope.setCount(2);
+    }
+
+    {
+        vu::ProfileScope scope(0, "ignored");
+    }
+
+    vu::Profile::PhaseList phases = profile.phases();
+
+    BOOST_REQUIRE_EQUAL(phases.size(), 2u);
+    BOOST_REQUIRE_EQUAL(phases[0].name, "load");
+    BOOST_REQUIRE_EQUAL(phases[0].count, 5u);
+    BOOST_REQUIRE_EQUAL(phases[0].calls, 2u);
+    BOOST_REQUIRE_EQUAL(phases[1].name, "run");
+    BOOST_REQUIRE_EQUAL(phases[1].count, 10u);
+    BOOST_REQUIRE_EQUAL(phases[1].calls, 1u);
+    BOOST_REQUIRE(phases[0].wall >= 0.0);
+    BOOST_REQUIRE(phases[0].cpu >= 0.0);
+
+    std::ostringstream out;
+    profile.write(out);
+    BOOST_REQUIRE(out.str().find("load") != std::string::npos);
+
+    profile.clear();
+    BOOST_REQUIRE(profile.phases().empty());
+
+    /* the wall clock is monotonic. */
+    double previous = vu::Profile::wallTime();
+    for (int i = 0; i < 1000; ++i) {
+        double now = vu::Profile::wallTime();
+        BOOST_REQUIRE(now >= previous);
+        previous = now;
+    }
+}
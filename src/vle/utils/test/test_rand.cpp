@@ -0,0 +1,176 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE utils_library_test_rand
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <algorithm>
+#include <vector>
+#include <numeric>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/Rand.hpp>
+#include <vle/utils/Xoshiro.hpp>
+#include <vle/vle.hpp>
+
+using namespace vle;
+
+struct F
+{
+    vle::Init a;
+
+    F() : a() { }
+    ~F() { }
+};
+
+BOOST_GLOBAL_FIXTURE(F)
+
+template < typename T >
+double mean(const std::vector < T >& vec)
+{
+    return std::accumulate(vec.begin(), vec.end(), 0.0) / vec.size();
+}
+
+template < typename T >
+double variance(const std::vector < T >& vec)
+{
+    double m = mean(vec), sum = 0.0;
+
+    for (std::size_t i = 0; i < vec.size(); ++i) {
+        sum += (vec[i] - m) * (vec[i] - m);
+    }
+
+    return sum / vec.size();
+}
+
+BOOST_AUTO_TEST_CASE(test_xoshiro)
+{
+    vle::utils::Xoshiro a(1234), b(1234), c(1235);
+    std::vector < double > x(1003);
+
+    a();
+    b();
+    a.fillUniform(&x[0], x.size());
+
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(x[i], vle::utils::Xoshiro::toDouble(b()));
+        BOOST_REQUIRE(x[i] >= 0.0 and x[i] < 1.0);
+    }
+
+    BOOST_REQUIRE(a() != c());
+    BOOST_REQUIRE_CLOSE(mean(x), 0.5, 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_fill)
+{
+    const std::size_t szmax(100001);
+    vle::utils::Rand r(123456789);
+
+    {
+        std::vector < double > x(szmax);
+
+        r.fillUniform(&x[0], x.size(), -1.0, 3.0);
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            BOOST_REQUIRE(x[i] >= -1.0 and x[i] < 3.0);
+        }
+        BOOST_REQUIRE_CLOSE(mean(x), 1.0, 2);
+    }
+
+    {
+        std::vector < int > x(szmax);
+
+        r.fillInt(&x[0], x.size(), -3, 6);
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            BOOST_REQUIRE(x[i] >= -3 and x[i] <= 6);
+        }
+        BOOST_REQUIRE_CLOSE(mean(x), 1.5, 2);
+        BOOST_REQUIRE_EQUAL(*std::min_element(x.begin(), x.end()), -3);
+        BOOST_REQUIRE_EQUAL(*std::max_element(x.begin(), x.end()), 6);
+
+        r.fillInt(&x[0], x.size(), 5, 5);
+        BOOST_REQUIRE_EQUAL(*std::min_element(x.begin(), x.end()), 5);
+        BOOST_REQUIRE_EQUAL(*std::max_element(x.begin(), x.end()), 5);
+        BOOST_REQUIRE_THROW(r.fillInt(&x[0], x.size(), 6, 5),
+                            vle::utils::ArgError);
+    }
+
+    {
+        std::vector < double > x(szmax);
+
+        r.fillNormal(&x[0], x.size(), 2.0, 3.0);
+        BOOST_REQUIRE_CLOSE(mean(x), 2.0, 2);
+        BOOST_REQUIRE_CLOSE(variance(x), 9.0, 2);
+    }
+
+    {
+        std::vector < double > x(szmax);
+
+        r.fillExponential(&x[0], x.size(), 4.0);
+        BOOST_REQUIRE_CLOSE(mean(x), 0.25, 2);
+    }
+
+    {
+        std::vector < int > x(szmax), y(szmax);
+
+        r.fillPoisson(&x[0], x.size(), 3.0);
+        BOOST_REQUIRE_CLOSE(mean(x), 3.0, 2);
+        BOOST_REQUIRE_CLOSE(variance(x), 3.0, 3);
+
+        r.fillPoisson(&y[0], y.size(), 100.0);
+        BOOST_REQUIRE_CLOSE(mean(y), 100.0, 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_seed)
+{
+    vle::utils::Rand a(42), b(42);
+    std::vector < double > x(101), y(101);
+
+    /* The state of the normal distribution is kept between the fills. */
+    a.fillNormal(&x[0], 101, 0.0, 1.0);
+    a.fillNormal(&x[0], 101, 0.0, 1.0);
+    b.fillNormal(&y[0], 101, 0.0, 1.0);
+    b.fillNormal(&y[0], 1, 0.0, 1.0);
+    b.fillNormal(&y[1], 100, 0.0, 1.0);
+    BOOST_REQUIRE(x == y);
+
+    a.seed(7);
+    b.seed(7);
+    a.fillUniform(&x[0], x.size());
+    b.fillUniform(&y[0], y.size());
+    BOOST_REQUIRE(x == y);
+
+    /* The per-call functions are independent of the fill functions. */
+    vle::utils::Rand c(7);
+    a.seed(7);
+    a.fillUniform(&x[0], x.size());
+    BOOST_REQUIRE_EQUAL(a.getInt(), c.getInt());
+}
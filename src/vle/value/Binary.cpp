@@ -0,0 +1,397 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/value/Binary.hpp>
+#include <vle/value/Boolean.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/String.hpp>
+#include <vle/value/Set.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/value/Tuple.hpp>
+#include <vle/value/Table.hpp>
+#include <vle/value/XML.hpp>
+#include <vle/value/Null.hpp>
+#include <vle/value/Matrix.hpp>
+#include <cstring>
+
+namespace vle { namespace value {
+
+/*
+ * The tag written before each value is the Value::type. The NULLPOINTER tag
+ * is used for null pointers stored in value::Set, value::Map or
+ * value::Matrix.
+ */
+static const uint8_t NULLPOINTER = 0xff;
+
+void BinaryWriter::write(const Value* value)
+{
+    if (not value) {
+        writeRaw(&NULLPOINTER, 1);
+        return;
+    }
+
+    uint8_t tag = static_cast < uint8_t >(value->getType());
+    writeRaw(&tag, 1);
+
+    switch (value->getType()) {
+    case Value::BOOLEAN:
+        writeBoolean(value->toBoolean().value());
+        break;
+    case Value::INTEGER:
+        writeInt32(value->toInteger().value());
+        break;
+    case Value::DOUBLE:
+        writeDouble(value->toDouble().value());
+        break;
+    case Value::STRING:
+        writeString(value->toString().value());
+        break;
+    case Value::XMLTYPE:
+        writeString(value->toXml().value());
+        break;
+    case Value::NIL:
+        break;
+    case Value::SET:
+        {
+            const VectorValue& vec(value->toSet().value());
+            writeUint32(vec.size());
+            for (VectorValue::const_iterator it = vec.begin();
+                 it != vec.end(); ++it) {
+                write(*it);
+            }
+        }
+        break;
+    case Value::MAP:
+        {
+            const MapValue& map(value->toMap().value());
+            writeUint32(map.size());
+            for (MapValue::const_iterator it = map.begin();
+                 it != map.end(); ++it) {
+                writeString(it->first);
+                write(it->second);
+            }
+        }
+        break;
+    case Value::TUPLE:
+        {
+            const TupleValue& tuple(value->toTuple().value());
+            writeUint32(tuple.size());
+            if (not tuple.empty()) {
+                writeDoubles(&tuple[0], tuple.size());
+            }
+        }
+        break;
+    case Value::TABLE:
+        {
+            const Table& table(value->toTable());
+            writeUint32(table.width());
+            writeUint32(table.height());
+            writeDoubles(table.value().data(), table.value().num_elements());
+        }
+        break;
+    case Value::MATRIX:
+        {
+            const Matrix& matrix(value->toMatrix());
+            writeUint32(matrix.columns());
+            writeUint32(matrix.rows());
+            writeUint32(matrix.matrix().shape()[0]);
+            writeUint32(matrix.matrix().shape()[1]);
+            writeUint32(matrix.resizeColumn());
+            writeUint32(matrix.resizeRow());
+            for (Matrix::size_type j = 0; j < matrix.rows(); ++j) {
+                for (Matrix::size_type i = 0; i < matrix.columns(); ++i) {
+                    write(matrix.get(i, j));
+                }
+            }
+        }
+        break;
+    }
+}
+
+void BinaryWriter::writeBoolean(bool value)
+{
+    uint8_t tmp = value ? 1 : 0;
+    writeRaw(&tmp, 1);
+}
+
+void BinaryWriter::writeUint32(uint32_t value)
+{
+    writeRaw(&value, sizeof(value));
+}
+
+void BinaryWriter::writeInt32(int32_t value)
+{
+    writeRaw(&value, sizeof(value));
+}
+
+void BinaryWriter::writeUint64(uint64_t value)
+{
+    writeRaw(&value, sizeof(value));
+}
+
+void BinaryWriter::writeInt64(int64_t value)
+{
+    writeRaw(&value, sizeof(value));
+}
+
+void BinaryWriter::writeDouble(double value)
+{
+    writeRaw(&value, sizeof(value));
+}
+
+void BinaryWriter::writeString(const std::string& value)
+{
+    writeUint32(value.size());
+    m_buffer.append(value);
+}
+
+void BinaryWriter::writeDoubles(const double* value, std::size_t size)
+{
+    writeRaw(value, size * sizeof(double));
+}
+
+Value* BinaryReader::read()
+{
+    uint8_t tag;
+    readRaw(&tag, 1);
+
+    if (tag == NULLPOINTER) {
+        return 0;
+    }
+
+    switch (tag) {
+    case Value::BOOLEAN:
+        return Boolean::create(readBoolean());
+    case Value::INTEGER:
+        return Integer::create(readInt32());
+    case Value::DOUBLE:
+        return Double::create(readDouble());
+    case Value::STRING:
+        return String::create(readString());
+    case Value::XMLTYPE:
+        return Xml::create(readString());
+    case Value::NIL:
+        return Null::create();
+    case Value::SET:
+        {
+            uint32_t size = readUint32();
+            checkElements(size, 1);
+            Set* result = Set::create();
+            try {
+                result->value().reserve(size);
+                for (uint32_t i = 0; i < size; ++i) {
+                    result->add(read());
+                }
+            } catch (...) {
+                delete result;
+                throw;
+            }
+            return result;
+        }
+    case Value::MAP:
+        {
+            uint32_t size = readUint32();
+            checkElements(size, sizeof(uint32_t) + 1);
+            Map* result = Map::create();
+            try {
+                for (uint32_t i = 0; i < size; ++i) {
+                    std::string key = readString();
+                    result->value()[key] = read();
+                }
+            } catch (...) {
+                delete result;
+                throw;
+            }
+            return result;
+        }
+    case Value::TUPLE:
+        {
+            uint32_t size = readUint32();
+            checkElements(size, sizeof(double));
+            Tuple* result = Tuple::create(size);
+            try {
+                if (size) {
+                    readDoubles(&result->value()[0], size);
+                }
+            } catch (...) {
+                delete result;
+                throw;
+            }
+            return result;
+        }
+    case Value::TABLE:
+        {
+            uint32_t width = readUint32();
+            uint32_t height = readUint32();
+            checkElements(static_cast < uint64_t >(width) * height,
+                          sizeof(double));
+            Table* result = Table::create(width, height);
+            try {
+                readDoubles(result->value().data(),
+                            result->value().num_elements());
+            } catch (...) {
+                delete result;
+                throw;
+            }
+            return result;
+        }
+    case Value::MATRIX:
+        {
+            uint32_t columns = readUint32();
+            uint32_t rows = readUint32();
+            uint32_t columnmax = readUint32();
+            uint32_t rowmax = readUint32();
+            uint32_t stepcol = readUint32();
+            uint32_t steprow = readUint32();
+            checkElements(static_cast < uint64_t >(columns) * rows, 1);
+
+            if (columnmax < columns or rowmax < rows) {
+                throw utils::ArgError(fmt(
+                        _("Binary value: bad matrix shape at position %1%"))
+                    % position());
+            }
+
+            Matrix* result = Matrix::create(columns, rows, columnmax, rowmax,
+                                            stepcol, steprow);
+            try {
+                for (uint32_t j = 0; j < rows; ++j) {
+                    for (uint32_t i = 0; i < columns; ++i) {
+                        result->set(i, j, read());
+                    }
+                }
+            } catch (...) {
+                delete result;
+                throw;
+            }
+            return result;
+        }
+    default:
+        throw utils::ArgError(fmt(
+                _("Binary value: unknown type %1% at position %2%")) %
+            static_cast < int >(tag) % (position() - 1));
+    }
+}
+
+bool BinaryReader::readBoolean()
+{
+    uint8_t tmp;
+    readRaw(&tmp, 1);
+    return tmp != 0;
+}
+
+uint32_t BinaryReader::readUint32()
+{
+    uint32_t result;
+    readRaw(&result, sizeof(result));
+    return result;
+}
+
+int32_t BinaryReader::readInt32()
+{
+    int32_t result;
+    readRaw(&result, sizeof(result));
+    return result;
+}
+
+uint64_t BinaryReader::readUint64()
+{
+    uint64_t result;
+    readRaw(&result, sizeof(result));
+    return result;
+}
+
+int64_t BinaryReader::readInt64()
+{
+    int64_t result;
+    readRaw(&result, sizeof(result));
+    return result;
+}
+
+double BinaryReader::readDouble()
+{
+    double result;
+    readRaw(&result, sizeof(result));
+    return result;
+}
+
+std::string BinaryReader::readString()
+{
+    uint32_t size = readUint32();
+
+    if (static_cast < std::size_t >(m_end - m_current) < size) {
+        throw utils::ArgError(fmt(
+                _("Binary value: truncated string at position %1%")) %
+            position());
+    }
+
+    std::string result(m_current, size);
+    m_current += size;
+    return result;
+}
+
+void BinaryReader::readDoubles(double* value, std::size_t size)
+{
+    readRaw(value, size * sizeof(double));
+}
+
+void BinaryReader::readRaw(void* data, std::size_t size)
+{
+    if (static_cast < std::size_t >(m_end - m_current) < size) {
+        throw utils::ArgError(fmt(
+                _("Binary value: truncated buffer at position %1%")) %
+            position());
+    }
+
+    std::memcpy(data, m_current, size);
+    m_current += size;
+}
+
+void BinaryReader::checkElements(uint64_t count, std::size_t size) const
+{
+    if (static_cast < uint64_t >(m_end - m_current) / size < count) {
+        throw utils::ArgError(fmt(
+                _("Binary value: %1% elements exceed the buffer at position"
+                  " %2%")) % count % position());
+    }
+}
+
+std::string toBinary(const Value* value)
+{
+    std::string result;
+    BinaryWriter out(result);
+    out.write(value);
+    return result;
+}
+
+Value* fromBinary(const std::string& buffer)
+{
+    BinaryReader in(buffer.data(), buffer.size());
+    return in.read();
+}
+
+}} // namespace vle value
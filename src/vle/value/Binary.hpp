@@ -0,0 +1,205 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_VALUE_BINARY_HPP
+#define VLE_VALUE_BINARY_HPP 1
+
+#include <vle/value/Value.hpp>
+#include <vle/utils/Types.hpp>
+#include <vle/DllDefines.hpp>
+#include <string>
+
+namespace vle { namespace value {
+
+/**
+ * @brief The BinaryWriter appends a compact binary representation of
+ * value::Value and of some scalar types into a std::string buffer. Integers
+ * and reals are stored with the byte order of the host, the buffer can only
+ * be read by the same architecture. Double arrays of the value::Tuple and
+ * value::Table are copied in a single block.
+ * @code
+ * std::string buffer;
+ * value::BinaryWriter out(buffer);
+ * out.write(value);
+ *
+ * value::BinaryReader in(buffer.data(), buffer.size());
+ * value::Value* copy = in.read();
+ * @endcode
+ */
+class VLE_API BinaryWriter
+{
+public:
+    /**
+     * @brief Build a BinaryWriter which appends data at the end of the
+     * buffer.
+     * @param buffer The output buffer.
+     */
+    BinaryWriter(std::string& buffer)
+        : m_buffer(buffer)
+    {}
+
+    /**
+     * @brief Append a value and, recursively, all its children. The value
+     * can be null.
+     * @param value The value to write.
+     */
+    void write(const Value* value);
+
+    void writeBoolean(bool value);
+
+    void writeUint32(uint32_t value);
+
+    void writeInt32(int32_t value);
+
+    void writeUint64(uint64_t value);
+
+    void writeInt64(int64_t value);
+
+    void writeDouble(double value);
+
+    /**
+     * @brief Append the size of the string and its characters.
+     * @param value The string to write.
+     */
+    void writeString(const std::string& value);
+
+    /**
+     * @brief Append an array of double without the size.
+     * @param value The first element of the array.
+     * @param size The number of elements.
+     */
+    void writeDoubles(const double* value, std::size_t size);
+
+    /**
+     * @brief Get a reference to the output buffer.
+     * @return A reference to the output buffer.
+     */
+    std::string& buffer()
+    { return m_buffer; }
+
+private:
+    void writeRaw(const void* data, std::size_t size)
+    { m_buffer.append(static_cast < const char* >(data), size); }
+
+    std::string& m_buffer;
+};
+
+/**
+ * @brief The BinaryReader builds value::Value and scalars from a buffer filled
+ * by the BinaryWriter. The buffer is not copied and must live as long as the
+ * reader.
+ */
+class VLE_API BinaryReader
+{
+public:
+    /**
+     * @brief Build a BinaryReader on a buffer.
+     * @param buffer The first byte of the buffer.
+     * @param size The size of the buffer.
+     */
+    BinaryReader(const char* buffer, std::size_t size)
+        : m_begin(buffer), m_current(buffer), m_end(buffer + size)
+    {}
+
+    /**
+     * @brief Build a new value, and recursively, all its children.
+     * @return A new value or null if a null value was written.
+     * @throw utils::ArgError if the buffer is truncated or corrupted.
+     */
+    Value* read();
+
+    bool readBoolean();
+
+    uint32_t readUint32();
+
+    int32_t readInt32();
+
+    uint64_t readUint64();
+
+    int64_t readInt64();
+
+    double readDouble();
+
+    std::string readString();
+
+    /**
+     * @brief Copy an array of double.
+     * @param value The first element of the output array.
+     * @param size The number of elements to read.
+     * @throw utils::ArgError if the buffer is truncated.
+     */
+    void readDoubles(double* value, std::size_t size);
+
+    /**
+     * @brief Get the number of bytes already read.
+     * @return The position in the buffer.
+     */
+    std::size_t position() const
+    { return m_current - m_begin; }
+
+    /**
+     * @brief Check if all the buffer was read.
+     * @return true if all the buffer was read, false otherwise.
+     */
+    bool eof() const
+    { return m_current == m_end; }
+
+private:
+    void readRaw(void* data, std::size_t size);
+
+    /**
+     * @brief Check that the buffer can hold a number of elements before
+     * allocating them.
+     * @param count The number of elements read from the buffer.
+     * @param size The minimal size in bytes of an element.
+     * @throw utils::ArgError if the remaining bytes are too few.
+     */
+    void checkElements(uint64_t count, std::size_t size) const;
+
+    const char* m_begin;
+    const char* m_current;
+    const char* m_end;
+};
+
+/**
+ * @brief Build the binary representation of a value.
+ * @param value The value to write, can be null.
+ * @return A buffer.
+ */
+VLE_API std::string toBinary(const Value* value);
+
+/**
+ * @brief Build a value from a buffer filled by value::toBinary.
+ * @param buffer The buffer to read.
+ * @return A new value or null.
+ * @throw utils::ArgError if the buffer is truncated or corrupted.
+ */
+VLE_API Value* fromBinary(const std::string& buffer);
+
+}} // namespace vle value
+
+#endif
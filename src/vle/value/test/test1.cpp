@@ -39,6 +39,7 @@
 #include <fstream>
 #include <functional>
 #include <vle/value/Value.hpp>
+#include <vle/value/Binary.hpp>
 #include <vle/value/Boolean.hpp>
 #include <vle/value/Double.hpp>
 #include <vle/value/Integer.hpp>
@@ -252,3 +253,48 @@ BOOST_AUTO_TEST_CASE(check_matrix)
     delete(mx);
     delete(cpy);
 }
+
+BOOST_AUTO_TEST_CASE(check_binary)
+{
+    value::Map* mp = value::Map::create();
+    mp->addDouble("double", 1.5);
+    mp->addString("string", "vle");
+
+    value::Tuple* tp = value::Tuple::create(3, 2.0);
+    mp->add("tuple", tp);
+
+    value::Table* tb = value::Table::create(2, 3);
+    tb->get(1, 2) = 12.0;
+    mp->add("table", tb);
+
+    value::Matrix* mx = value::Matrix::create(2, 2, 4, 4, 1, 1);
+    mx->addInt(1, 1, 4);
+    mp->add("matrix", mx);
+
+    std::string buffer(value::toBinary(mp));
+    value::Value* cpy = value::fromBinary(buffer);
+
+    BOOST_REQUIRE(cpy);
+    BOOST_REQUIRE_EQUAL(cpy->writeToString(), mp->writeToString());
+    BOOST_REQUIRE_EQUAL(
+        value::toTableValue(cpy->toMap().get("table"))->get(1, 2), 12.0);
+    BOOST_REQUIRE_EQUAL(value::fromBinary(value::toBinary(0)),
+                        (value::Value*)0);
+
+    BOOST_REQUIRE_THROW(value::fromBinary(buffer.substr(0, buffer.size() - 1)),
+                        utils::ArgError);
+
+    /* A corrupted size must not allocate before the end of the buffer. */
+    uint32_t huge = 0xffffffff;
+    std::string tuple(1, static_cast < char >(value::Value::TUPLE));
+    tuple.append(reinterpret_cast < const char* >(&huge), sizeof(huge));
+    BOOST_REQUIRE_THROW(value::fromBinary(tuple), utils::ArgError);
+
+    std::string table(1, static_cast < char >(value::Value::TABLE));
+    table.append(reinterpret_cast < const char* >(&huge), sizeof(huge));
+    table.append(reinterpret_cast < const char* >(&huge), sizeof(huge));
+    BOOST_REQUIRE_THROW(value::fromBinary(table), utils::ArgError);
+
+    delete cpy;
+    delete mp;
+}
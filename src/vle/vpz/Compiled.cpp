@@ -0,0 +1,642 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/vpz/Compiled.hpp>
+#include <vle/vpz/Vpz.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/value/Binary.hpp>
+#include <vle/value/Set.hpp>
+#include <vle/utils/Trace.hpp>
+#include <vle/version.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace vle { namespace vpz {
+
+namespace fs = boost::filesystem;
+namespace bip = boost::interprocess;
+
+/*
+ * The header of the `.vpzc' file: a magic number, the version of the
+ * format, a marker to detect the byte order, the version of VLE and the
+ * size and the hash of the source vpz file.
+ */
+static const uint32_t VPZC_MAGIC = 0x4356505a;
+static const uint32_t VPZC_FORMAT = 3;
+static const uint32_t VPZC_ENDIAN = 0x01020304;
+
+bool Compiled::m_enabled = false;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+static void writeModel(value::BinaryWriter& out, const BaseModel* mdl)
+{
+    out.writeBoolean(mdl->isAtomic());
+    out.writeString(mdl->getName());
+    out.writeInt32(mdl->x());
+    out.writeInt32(mdl->y());
+    out.writeInt32(mdl->width());
+    out.writeInt32(mdl->height());
+
+    out.writeUint32(mdl->getInputPortList().size());
+    for (ConnectionList::const_iterator it = mdl->getInputPortList().begin();
+         it != mdl->getInputPortList().end(); ++it) {
+        out.writeString(it->first);
+    }
+
+    out.writeUint32(mdl->getOutputPortList().size());
+    for (ConnectionList::const_iterator it = mdl->getOutputPortList().begin();
+         it != mdl->getOutputPortList().end(); ++it) {
+        out.writeString(it->first);
+    }
+
+    if (mdl->isAtomic()) {
+        const AtomicModel* atom = static_cast < const AtomicModel* >(mdl);
+
+        out.writeUint32(atom->conditions().size());
+        for (std::vector < std::string >::const_iterator it =
+                 atom->conditions().begin(); it != atom->conditions().end();
+             ++it) {
+            out.writeString(*it);
+        }
+        out.writeString(atom->dynamics());
+        out.writeString(atom->observables());
+    } else {
+        const CoupledModel* cpl = static_cast < const CoupledModel* >(mdl);
+        const ModelList& models(cpl->getModelList());
+
+        out.writeUint32(models.size());
+        for (ModelList::const_iterator it = models.begin();
+             it != models.end(); ++it) {
+            writeModel(out, it->second);
+        }
+
+        /*
+         * Connections are written with the name of the models as in the
+         * `connections' tag of the vpz file: internal, input then output
+         * connections.
+         */
+        uint32_t nb = 0;
+        for (ModelList::const_iterator it = models.begin();
+             it != models.end(); ++it) {
+            const ConnectionList& cnts(it->second->getOutputPortList());
+            for (ConnectionList::const_iterator jt = cnts.begin();
+                 jt != cnts.end(); ++jt) {
+                for (ModelPortList::const_iterator kt = jt->second.begin();
+                     kt != jt->second.end(); ++kt) {
+                    if (kt->first != cpl) {
+                        ++nb;
+                    }
+                }
+            }
+        }
+
+        out.writeUint32(nb);
+        for (ModelList::const_iterator it = models.begin();
+             it != models.end(); ++it) {
+            const ConnectionList& cnts(it->second->getOutputPortList());
+            for (ConnectionList::const_iterator jt = cnts.begin();
+                 jt != cnts.end(); ++jt) {
+                for (ModelPortList::const_iterator kt = jt->second.begin();
+                     kt != jt->second.end(); ++kt) {
+                    if (kt->first != cpl) {
+                        out.writeString(it->first);
+                        out.writeString(jt->first);
+                        out.writeString(kt->first->getName());
+                        out.writeString(kt->second);
+                    }
+                }
+            }
+        }
+
+        const ConnectionList& inputs(cpl->getInternalInputPortList());
+        nb = 0;
+        for (ConnectionList::const_iterator it = inputs.begin();
+             it != inputs.end(); ++it) {
+            nb += it->second.size();
+        }
+
+        out.writeUint32(nb);
+        for (ConnectionList::const_iterator it = inputs.begin();
+             it != inputs.end(); ++it) {
+            for (ModelPortList::const_iterator jt = it->second.begin();
+                 jt != it->second.end(); ++jt) {
+                out.writeString(it->first);
+                out.writeString(jt->first->getName());
+                out.writeString(jt->second);
+            }
+        }
+
+        const ConnectionList& outputs(cpl->getInternalOutputPortList());
+        nb = 0;
+        for (ConnectionList::const_iterator it = outputs.begin();
+             it != outputs.end(); ++it) {
+            nb += it->second.size();
+        }
+
+        out.writeUint32(nb);
+        for (ConnectionList::const_iterator it = outputs.begin();
+             it != outputs.end(); ++it) {
+            for (ModelPortList::const_iterator jt = it->second.begin();
+                 jt != it->second.end(); ++jt) {
+                out.writeString(jt->first->getName());
+                out.writeString(jt->second);
+                out.writeString(it->first);
+            }
+        }
+    }
+}
+
+static BaseModel* readModel(value::BinaryReader& in, CoupledModel* parent)
+{
+    bool isatomic = in.readBoolean();
+    std::string name = in.readString();
+
+    BaseModel* mdl;
+    if (isatomic) {
+        mdl = new AtomicModel(name, parent);
+    } else {
+        mdl = new CoupledModel(name, parent);
+    }
+
+    /*
+     * If a parent exists, it owns the new model and it will be deleted with
+     * the root of the hierarchy.
+     */
+    try {
+        mdl->setX(in.readInt32());
+        mdl->setY(in.readInt32());
+        mdl->setWidth(in.readInt32());
+        mdl->setHeight(in.readInt32());
+
+        for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+            mdl->addInputPort(in.readString());
+        }
+
+        for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+            mdl->addOutputPort(in.readString());
+        }
+
+        if (isatomic) {
+            AtomicModel* atom = static_cast < AtomicModel* >(mdl);
+
+            for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+                atom->addCondition(in.readString());
+            }
+            atom->setDynamics(in.readString());
+            atom->setObservables(in.readString());
+        } else {
+            CoupledModel* cpl = static_cast < CoupledModel* >(mdl);
+
+            for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+                readModel(in, cpl);
+            }
+
+            for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+                std::string src = in.readString();
+                std::string portsrc = in.readString();
+                std::string dst = in.readString();
+                std::string portdst = in.readString();
+                cpl->addInternalConnection(src, portsrc, dst, portdst);
+            }
+
+            for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+                std::string portsrc = in.readString();
+                std::string dst = in.readString();
+                std::string portdst = in.readString();
+                cpl->addInputConnection(portsrc, dst, portdst);
+            }
+
+            for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+                std::string src = in.readString();
+                std::string portsrc = in.readString();
+                std::string portdst = in.readString();
+                cpl->addOutputConnection(src, portsrc, portdst);
+            }
+        }
+    } catch (...) {
+        if (not parent) {
+            delete mdl;
+        }
+        throw;
+    }
+
+    return mdl;
+}
+
+static void writeConditions(value::BinaryWriter& out,
+                            const Conditions& conditions)
+{
+    out.writeUint32(conditions.conditionlist().size());
+    for (Conditions::const_iterator it = conditions.begin();
+         it != conditions.end(); ++it) {
+        const Condition& cnd(it->second);
+
+        out.writeString(cnd.name());
+        out.writeBoolean(cnd.isPermanent());
+        out.writeUint32(cnd.conditionvalues().size());
+        for (Condition::const_iterator jt = cnd.begin(); jt != cnd.end();
+             ++jt) {
+            out.writeString(jt->first);
+            out.write(jt->second);
+        }
+    }
+}
+
+static void readConditions(value::BinaryReader& in, Conditions& conditions)
+{
+    for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+        Condition& cnd(conditions.add(Condition(in.readString())));
+        cnd.permanent(in.readBoolean());
+
+        for (uint32_t j = 0, nbport = in.readUint32(); j < nbport; ++j) {
+            std::string port = in.readString();
+            value::Value* values = in.read();
+
+            if (not values or not values->isSet()) {
+                delete values;
+                throw utils::ArgError(fmt(
+                        _("Compiled vpz: bad values for port '%1%' of "
+                          "condition '%2%'")) % port % cnd.name());
+            }
+
+            cnd.add(port);
+            value::Set*& set = cnd.conditionvalues()[port];
+            delete set;
+            set = static_cast < value::Set* >(values);
+        }
+    }
+}
+
+static void writeViews(value::BinaryWriter& out, const Views& views)
+{
+    const Outputs& outputs(views.outputs());
+    out.writeUint32(outputs.outputlist().size());
+    for (Outputs::const_iterator it = outputs.begin(); it != outputs.end();
+         ++it) {
+        const Output& o(it->second);
+
+        out.writeString(o.name());
+        out.writeUint32(o.format());
+        out.writeString(o.plugin());
+        out.writeString(o.location());
+        out.writeString(o.package());
+        out.write(o.data());
+    }
+
+    const Observables& observables(views.observables());
+    out.writeUint32(observables.observablelist().size());
+    for (Observables::const_iterator it = observables.begin();
+         it != observables.end(); ++it) {
+        const Observable& obs(it->second);
+
+        out.writeString(obs.name());
+        out.writeBoolean(obs.isPermanent());
+        out.writeUint32(obs.observableportlist().size());
+        for (Observable::const_iterator jt = obs.begin(); jt != obs.end();
+             ++jt) {
+            out.writeString(jt->first);
+            out.writeUint32(jt->second.viewnamelist().size());
+            for (ObservablePort::const_iterator kt = jt->second.begin();
+                 kt != jt->second.end(); ++kt) {
+                out.writeString(*kt);
+            }
+        }
+    }
+
+    out.writeUint32(views.viewlist().size());
+    for (Views::const_iterator it = views.begin(); it != views.end(); ++it) {
+        const View& v(it->second);
+
+        out.writeString(v.name());
+        out.writeUint32(v.type());
+        out.writeString(v.output());
+        out.writeDouble(v.timestep());
+        out.writeString(v.data());
+    }
+}
+
+static void readViews(value::BinaryReader& in, Views& views)
+{
+    for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+        Output o;
+
+        o.setName(in.readString());
+        Output::Format format = static_cast < Output::Format >(
+            in.readUint32());
+        std::string plugin = in.readString();
+        std::string location = in.readString();
+        std::string package = in.readString();
+
+        if (format == Output::LOCAL) {
+            o.setLocalStream(location, plugin, package);
+        } else {
+            o.setDistantStream(location, plugin, package);
+        }
+
+        views.outputs().add(o).setData(in.read());
+    }
+
+    for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+        Observable& obs(views.addObservable(in.readString()));
+        obs.permanent(in.readBoolean());
+
+        for (uint32_t j = 0, nbport = in.readUint32(); j < nbport; ++j) {
+            ObservablePort& port(obs.add(in.readString()));
+
+            for (uint32_t k = 0, nbview = in.readUint32(); k < nbview; ++k) {
+                port.add(in.readString());
+            }
+        }
+    }
+
+    for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+        std::string name = in.readString();
+        View::Type type = static_cast < View::Type >(in.readUint32());
+        std::string output = in.readString();
+        double timestep = in.readDouble();
+
+        View& v(views.add(View(name, type, output, timestep)));
+        v.setData(in.readString());
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+std::string Compiled::filename(const std::string& filename)
+{
+    return filename + 'c';
+}
+
+void Compiled::write(std::string& buffer, const Project& project)
+{
+    value::BinaryWriter out(buffer);
+
+    out.writeString(project.author());
+    out.writeString(project.date());
+    out.writeString(project.version());
+    out.writeInt32(project.instance());
+
+    out.writeBoolean(project.model().model() != 0);
+    if (project.model().model()) {
+        writeModel(out, project.model().model());
+    }
+
+    const Dynamics& dynamics(project.dynamics());
+    out.writeUint32(dynamics.dynamiclist().size());
+    for (Dynamics::const_iterator it = dynamics.begin();
+         it != dynamics.end(); ++it) {
+        out.writeString(it->second.name());
+        out.writeString(it->second.package());
+        out.writeString(it->second.library());
+        out.writeString(it->second.language());
+        out.writeBoolean(it->second.isPermanent());
+    }
+
+    const Classes& classes(project.classes());
+    out.writeUint32(classes.list().size());
+    for (Classes::const_iterator it = classes.begin(); it != classes.end();
+         ++it) {
+        out.writeString(it->second.name());
+        out.writeBoolean(it->second.model() != 0);
+        if (it->second.model()) {
+            writeModel(out, it->second.model());
+        }
+    }
+
+    const Experiment& exp(project.experiment());
+    out.writeString(exp.name());
+    out.writeDouble(exp.duration());
+    out.writeDouble(exp.begin());
+    out.writeString(exp.combination());
+    out.writeUint32(exp.samples());
+    out.writeUint32(exp.seed());
+    out.writeUint32(exp.replicas());
+    writeConditions(out, exp.conditions());
+    writeViews(out, exp.views());
+}
+
+void Compiled::write(std::string& buffer, const Conditions& conditions)
+{
+    value::BinaryWriter out(buffer);
+
+    writeConditions(out, conditions);
+}
+
+void Compiled::read(const char* buffer, std::size_t size, Project& project)
+{
+    value::BinaryReader in(buffer, size);
+
+    try {
+        std::string author = in.readString();
+        if (not author.empty()) {
+            project.setAuthor(author);
+        }
+        project.setDate(in.readString());
+        project.setVersion(in.readString());
+        project.setInstance(in.readInt32());
+
+        if (in.readBoolean()) {
+            project.model().setModel(readModel(in, 0));
+        }
+
+        for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+            Dynamic dyn(in.readString());
+            dyn.setPackage(in.readString());
+            dyn.setLibrary(in.readString());
+            dyn.setLanguage(in.readString());
+            dyn.permanent(in.readBoolean());
+            project.dynamics().add(dyn);
+        }
+
+        for (uint32_t i = 0, nb = in.readUint32(); i < nb; ++i) {
+            Class& cls(project.classes().add(in.readString()));
+            if (in.readBoolean()) {
+                cls.setModel(readModel(in, 0));
+            }
+        }
+
+        Experiment& exp(project.experiment());
+        std::string name = in.readString();
+        if (not name.empty()) {
+            exp.setName(name);
+        }
+        exp.setDuration(in.readDouble());
+        exp.setBegin(in.readDouble());
+        std::string combination = in.readString();
+        if (not combination.empty()) {
+            exp.setCombination(combination);
+        }
+        exp.setSamples(in.readUint32());
+        exp.setSeed(in.readUint32());
+        exp.setReplicas(in.readUint32());
+        readConditions(in, exp.conditions());
+        readViews(in, exp.views());
+
+        if (not in.eof()) {
+            throw utils::ArgError(_("Compiled vpz: trailing data"));
+        }
+    } catch (...) {
+        delete project.model().model();
+        project.clear();
+        throw;
+    }
+}
+
+void Compiled::read(const char* buffer, std::size_t size,
+                    Conditions& conditions)
+{
+    value::BinaryReader in(buffer, size);
+
+    try {
+        readConditions(in, conditions);
+
+        if (not in.eof()) {
+            throw utils::ArgError(_("Compiled vpz: trailing data"));
+        }
+    } catch (...) {
+        conditions.clear();
+        throw;
+    }
+}
+
+uint64_t Compiled::hash(const char* buffer, std::size_t size)
+{
+    uint64_t result = 14695981039346656037ULL;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        result ^= static_cast < unsigned char >(buffer[i]);
+        result *= 1099511628211ULL;
+    }
+
+    return result;
+}
+
+bool Compiled::load(const std::string& filename, Vpz& vpz)
+{
+    const std::string compiled(Compiled::filename(filename));
+
+    try {
+        if (not fs::exists(compiled) or fs::file_size(compiled) == 0 or
+            fs::file_size(filename) == 0) {
+            return false;
+        }
+
+        bip::file_mapping cfile(compiled.c_str(), bip::read_only);
+        bip::mapped_region cregion(cfile, bip::read_only);
+        value::BinaryReader in(static_cast < const char* >(
+                cregion.get_address()), cregion.get_size());
+
+        if (in.readUint32() != VPZC_MAGIC or
+            in.readUint32() != VPZC_FORMAT or
+            in.readUint32() != VPZC_ENDIAN or
+            in.readString() != VLE_VERSION) {
+            return false;
+        }
+
+        uint64_t size = in.readUint64();
+        uint64_t hash = in.readUint64();
+
+        if (size != fs::file_size(filename)) {
+            return false;
+        }
+
+        {
+            bip::file_mapping sfile(filename.c_str(), bip::read_only);
+            bip::mapped_region sregion(sfile, bip::read_only);
+
+            if (hash != Compiled::hash(static_cast < const char* >(
+                        sregion.get_address()), sregion.get_size())) {
+                return false;
+            }
+        }
+
+        read(static_cast < const char* >(cregion.get_address()) +
+             in.position(), cregion.get_size() - in.position(),
+             vpz.project());
+    } catch (const std::exception& e) {
+        TraceAlways(fmt(_("Compiled vpz: cannot read `%1%': %2%")) %
+                    compiled % e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool Compiled::save(const std::string& filename, const Vpz& vpz)
+{
+    const std::string compiled(Compiled::filename(filename));
+
+    try {
+        std::string buffer;
+        value::BinaryWriter out(buffer);
+
+        out.writeUint32(VPZC_MAGIC);
+        out.writeUint32(VPZC_FORMAT);
+        out.writeUint32(VPZC_ENDIAN);
+        out.writeString(VLE_VERSION);
+
+        {
+            bip::file_mapping sfile(filename.c_str(), bip::read_only);
+            bip::mapped_region sregion(sfile, bip::read_only);
+
+            out.writeUint64(sregion.get_size());
+            out.writeUint64(Compiled::hash(static_cast < const char* >(
+                        sregion.get_address()), sregion.get_size()));
+        }
+
+        Compiled::write(buffer, vpz.project());
+
+        /*
+         * The buffer is written into a temporary file and renamed to avoid
+         * reading of a partial file by another process.
+         */
+        fs::path tmp(fs::unique_path(compiled + "-%%%%%%%%"));
+        {
+            std::ofstream file(tmp.string().c_str(),
+                               std::ios::out | std::ios::binary);
+            file.write(buffer.data(), buffer.size());
+
+            if (not file) {
+                file.close();
+                fs::remove(tmp);
+                return false;
+            }
+        }
+
+        fs::rename(tmp, compiled);
+    } catch (const std::exception& /*e*/) {
+        return false;
+    }
+
+    return true;
+}
+
+}} // namespace vle vpz
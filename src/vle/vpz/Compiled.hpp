@@ -0,0 +1,151 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_VPZ_COMPILED_HPP
+#define VLE_VPZ_COMPILED_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/utils/Types.hpp>
+#include <string>
+
+namespace vle { namespace vpz {
+
+    class Vpz;
+    class Project;
+    class Conditions;
+
+    /**
+     * @brief Compiled is the binary cache of a vpz file. When enabled (see
+     * Compiled::setEnabled), the first time a vpz file is read, the Project
+     * is stored into a `.vpzc' file next to the vpz file. The next reads
+     * map the `.vpzc' file in memory and build the structures, dynamics,
+     * classes and experiment without the XML parser.
+     *
+     * The `.vpzc' file stores the size and a 64 bits FNV-1a hash of the vpz
+     * file and the version of VLE. If one of them changes, the cache is
+     * stale and the vpz file is parsed again.
+     */
+    class VLE_API Compiled
+    {
+    public:
+        /**
+         * @brief Get the name of the `.vpzc' file of a vpz file.
+         * @param filename The vpz file, for instance `foo.vpz'.
+         * @return The compiled file, for instance `foo.vpzc'.
+         */
+        static std::string filename(const std::string& filename);
+
+        /**
+         * @brief Fill the Vpz from the compiled file of the vpz file.
+         * @param filename The vpz file.
+         * @param vpz The Vpz to fill.
+         * @return true if the compiled file exists and is up to date, false
+         * otherwise.
+         */
+        static bool load(const std::string& filename, Vpz& vpz);
+
+        /**
+         * @brief Write the compiled file of the vpz file. Errors are not
+         * reported since the directory of the vpz file may be read only.
+         * @param filename The vpz file.
+         * @param vpz The Vpz to store.
+         * @return true if the compiled file is written, false otherwise.
+         */
+        static bool save(const std::string& filename, const Vpz& vpz);
+
+        /**
+         * @brief Append the binary representation of a Project into a
+         * buffer.
+         * @param buffer The output buffer.
+         * @param project The Project to write.
+         */
+        static void write(std::string& buffer, const Project& project);
+
+        /**
+         * @brief Append the binary representation of Conditions into a
+         * buffer, with the format used by Compiled::write for the
+         * conditions of the experiment.
+         * @param buffer The output buffer.
+         * @param conditions The Conditions to write.
+         */
+        static void write(std::string& buffer, const Conditions& conditions);
+
+        /**
+         * @brief Fill an empty Project with a buffer filled by
+         * Compiled::write.
+         * @param buffer The first byte of the buffer.
+         * @param size The size of the buffer.
+         * @param project The Project to fill.
+         * @throw utils::ArgError if the buffer is truncated or corrupted.
+         */
+        static void read(const char* buffer, std::size_t size,
+                         Project& project);
+
+        /**
+         * @brief Fill empty Conditions with a buffer filled by
+         * Compiled::write.
+         * @param buffer The first byte of the buffer.
+         * @param size The size of the buffer.
+         * @param conditions The Conditions to fill.
+         * @throw utils::ArgError if the buffer is truncated or corrupted.
+         */
+        static void read(const char* buffer, std::size_t size,
+                         Conditions& conditions);
+
+        /**
+         * @brief Compute the 64 bits FNV-1a hash of a buffer.
+         * @param buffer The first byte of the buffer.
+         * @param size The size of the buffer.
+         * @return The hash.
+         */
+        static uint64_t hash(const char* buffer, std::size_t size);
+
+        /**
+         * @brief Enable or disable the use of the compiled files in
+         * Vpz::parseFile. Disabled by default since the `.vpzc' files are
+         * written next to the vpz files.
+         * @param enabled true to enable.
+         */
+        static void setEnabled(bool enabled)
+        { m_enabled = enabled; }
+
+        /**
+         * @brief Check if the compiled files are used by Vpz::parseFile.
+         * @return true if enabled.
+         */
+        static bool isEnabled()
+        { return m_enabled; }
+
+    private:
+        Compiled();
+
+        static bool m_enabled;
+    };
+
+}} // namespace vle vpz
+
+#endif
@@ -26,13 +26,108 @@
 
 
 #include <vle/vpz/Condition.hpp>
+#include <vle/vpz/Vpz.hpp>
 #include <vle/utils/Algo.hpp>
 #include <vle/utils/Exception.hpp>
 #include <vle/value/Value.hpp>
 #include <vle/value/Set.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/mutex.hpp>
+#include <cstring>
 
 namespace vle { namespace vpz {
 
+class ConditionBuffer::Pimpl
+{
+public:
+    Pimpl(const std::string& filename)
+        : m_filename(filename),
+        m_file(filename.c_str(), boost::interprocess::read_only),
+        m_region(m_file, boost::interprocess::read_only)
+    {}
+
+    std::string m_filename;
+    boost::interprocess::file_mapping m_file;
+    boost::interprocess::mapped_region m_region;
+};
+
+ConditionBuffer::ConditionBuffer(const std::string& filename)
+{
+    try {
+        mPimpl = new Pimpl(filename);
+    } catch (const std::exception& e) {
+        throw utils::FileError(fmt(_("Condition: cannot map file '%1%': %2%"))
+                               % filename % e.what());
+    }
+}
+
+ConditionBuffer::~ConditionBuffer()
+{
+    delete mPimpl;
+}
+
+const char* ConditionBuffer::data() const
+{
+    return static_cast < const char* >(mPimpl->m_region.get_address());
+}
+
+std::size_t ConditionBuffer::size() const
+{
+    return mPimpl->m_region.get_size();
+}
+
+const std::string& ConditionBuffer::filename() const
+{
+    return mPimpl->m_filename;
+}
+
+/*
+ * Parse the XML content of a port. The content starts with the end of the
+ * `<port name="...">' start tag (or with the `/>' of an empty port) and
+ * finishes with the `</port>' end tag.
+ */
+static value::Set* parseLazyPort(const LazyPort& port)
+{
+    if (port.end > port.buffer->size() or port.begin >= port.end) {
+        throw utils::ArgError(fmt(
+                _("Condition: bad position of values in file '%1%'")) %
+            port.buffer->filename());
+    }
+
+    const char* begin = port.buffer->data() + port.begin;
+    const char* end = port.buffer->data() + port.end;
+
+    if (*begin == '/') {
+        return value::Set::create();
+    }
+
+    ++begin;
+    while (end - begin >= 2 and not (end[0] == '<' and end[1] == '/')) {
+        --end;
+    }
+
+    std::string buffer("<?xml version=\"1.0\"?>\n<set>");
+    buffer.append(begin, end);
+    buffer.append("</set>");
+
+    value::Value* result = Vpz::parseValue(buffer);
+    if (not result->isSet()) {
+        delete result;
+        throw utils::ArgError(fmt(
+                _("Condition: bad values in file '%1%'")) %
+            port.buffer->filename());
+    }
+
+    return static_cast < value::Set* >(result);
+}
+
+/*
+ * The lazy ports of all the conditions are read and parsed under this lock
+ * since the constant functions of a Condition parse them.
+ */
+static boost::mutex lazyMutex;
+
 Condition::Condition(const std::string& name) :
     Base(),
     m_name(name)
@@ -45,6 +140,10 @@ Condition::Condition(const Condition& cnd) :
     m_last_port(cnd.m_last_port),
     m_ispermanent(cnd.m_ispermanent)
 {
+    boost::mutex::scoped_lock lock(lazyMutex);
+
+    m_lazy = cnd.m_lazy;
+
     for (ConditionValues::const_iterator it = cnd.m_list.begin();
          it != cnd.m_list.end(); ++it) {
         m_list[it->first] = dynamic_cast < value::Set*>(it->second->clone());
@@ -60,6 +159,8 @@ Condition::~Condition()
 
 void Condition::write(std::ostream& out) const
 {
+    load();
+
     out << "<condition name=\"" << m_name.c_str() << "\" >\n";
 
     for (ConditionValues::const_iterator it = m_list.begin(); it !=
@@ -83,13 +184,24 @@ void Condition::write(std::ostream& out) const
 
 void Condition::portnames(std::list < std::string >& lst) const
 {
+    boost::mutex::scoped_lock lock(lazyMutex);
+
     lst.resize(m_list.size());
     std::transform(m_list.begin(), m_list.end(), lst.begin(),
                    utils::select1st < ConditionValues::value_type >());
+
+    if (not m_lazy.empty()) {
+        for (ConditionLazyPorts::const_iterator it = m_lazy.begin();
+             it != m_lazy.end(); ++it) {
+            lst.push_back(it->first);
+        }
+        lst.sort();
+    }
 }
 
 void Condition::add(const std::string& portname)
 {
+    load(portname);
     m_list.insert(value_type(portname, value::Set::create()));
     m_last_port.assign(portname);
 }
@@ -97,6 +209,7 @@ void Condition::add(const std::string& portname)
 void Condition::del(const std::string& portname)
 {
     m_list.erase(portname);
+    m_lazy.erase(portname);
 }
 
 void Condition::rename(const std::string& oldportname, const std::string& newportname)
@@ -114,6 +227,7 @@ void Condition::rename(const std::string& oldportname, const std::string& newpor
 void Condition::addValueToPort(const std::string& portname,
                                value::Value* value)
 {
+    load(portname);
     ConditionValues::iterator it = m_list.find(portname);
 
     if (it == m_list.end()) {
@@ -130,6 +244,7 @@ void Condition::addValueToPort(const std::string& portname,
 void Condition::addValueToPort(const std::string& portname,
                                const value::Value& value)
 {
+    load(portname);
     ConditionValues::iterator it = m_list.find(portname);
 
     if (it == m_list.end()) {
@@ -146,6 +261,7 @@ void Condition::addValueToPort(const std::string& portname,
 void Condition::setValueToPort(const std::string& portname,
                                const value::Value& value)
 {
+    load(portname);
     ConditionValues::iterator it = m_list.find(portname);
 
     if (it == m_list.end()) {
@@ -159,6 +275,7 @@ void Condition::setValueToPort(const std::string& portname,
 
 void Condition::clearValueOfPort(const std::string& portname)
 {
+    load(portname);
     ConditionValues::iterator it = m_list.find(portname);
 
     if (it == m_list.end()) {
@@ -171,6 +288,7 @@ void Condition::clearValueOfPort(const std::string& portname)
 
 void Condition::fillWithFirstValues(value::MapValue& mapToFill) const
 {
+    load();
     mapToFill.clear();
     for (const_iterator it = m_list.begin(); it != m_list.end(); ++it) {
         if (it->second->size() > 0) {
@@ -183,6 +301,17 @@ void Condition::fillWithFirstValues(value::MapValue& mapToFill) const
 
 const value::Set& Condition::getSetValues(const std::string& portname) const
 {
+    /*
+     * Another thread can parse an other port of this condition, the list
+     * of values is read under the lock.
+     */
+    boost::mutex::scoped_lock lock(lazyMutex);
+    ConditionLazyPorts::iterator lazy = m_lazy.find(portname);
+
+    if (lazy != m_lazy.end()) {
+        loadPort(lazy);
+    }
+
     ConditionValues::const_iterator it = m_list.find(portname);
 
     if (it == m_list.end()) {
@@ -196,6 +325,7 @@ const value::Set& Condition::getSetValues(const std::string& portname) const
 
 value::Set& Condition::getSetValues(const std::string& portname)
 {
+    load(portname);
     ConditionValues::iterator it = m_list.find(portname);
 
     if (it == m_list.end()) {
@@ -220,6 +350,7 @@ const value::Value& Condition::nValue(const std::string& portname,
 
 value::Set& Condition::lastAddedPort()
 {
+    load(m_last_port);
     ConditionValues::iterator it = m_list.find(m_last_port);
 
     if (it == m_list.end()) {
@@ -238,6 +369,60 @@ void Condition::deleteValueSet()
          ++it) {
         it->second->clear();
     }
+
+    for (ConditionLazyPorts::iterator it = m_lazy.begin(); it != m_lazy.end();
+         ++it) {
+        m_list.insert(value_type(it->first, value::Set::create()));
+    }
+    m_lazy.clear();
+}
+
+void Condition::addLazyPort(const std::string& portname,
+                            const LazyPort& port)
+{
+    ConditionValues::iterator it = m_list.find(portname);
+
+    if (it != m_list.end()) {
+        delete it->second;
+        m_list.erase(it);
+    }
+
+    m_lazy.erase(portname);
+    m_lazy.insert(ConditionLazyPorts::value_type(portname, port));
+    m_last_port.assign(portname);
+}
+
+bool Condition::isLazyPort(const std::string& portname) const
+{
+    boost::mutex::scoped_lock lock(lazyMutex);
+
+    return m_lazy.find(portname) != m_lazy.end();
+}
+
+void Condition::load() const
+{
+    boost::mutex::scoped_lock lock(lazyMutex);
+
+    while (not m_lazy.empty()) {
+        loadPort(m_lazy.begin());
+    }
+}
+
+void Condition::load(const std::string& portname) const
+{
+    boost::mutex::scoped_lock lock(lazyMutex);
+    ConditionLazyPorts::iterator it = m_lazy.find(portname);
+
+    if (it != m_lazy.end()) {
+        loadPort(it);
+    }
+}
+
+void Condition::loadPort(ConditionLazyPorts::iterator it) const
+{
+    value::Set* values = parseLazyPort(it->second);
+    m_list.insert(value_type(it->first, values));
+    m_lazy.erase(it);
 }
 
 }} // namespace vle vpz
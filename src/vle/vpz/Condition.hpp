@@ -32,6 +32,7 @@
 #include <vle/DllDefines.hpp>
 #include <vle/value/Map.hpp>
 #include <vle/value/Set.hpp>
+#include <boost/shared_ptr.hpp>
 #include <string>
 #include <map>
 #include <list>
@@ -43,6 +44,72 @@ namespace vle { namespace vpz {
      */
     typedef std::map < std::string, value::Set* > ConditionValues;
 
+    /**
+     * @brief A ConditionBuffer is a vpz file mapped in memory. It is shared by
+     * the ports of the conditions which are not yet parsed.
+     */
+    class VLE_API ConditionBuffer
+    {
+    public:
+        /**
+         * @brief Map a file in memory.
+         * @param filename The file to map.
+         * @throw utils::FileError if the file can not be mapped.
+         */
+        ConditionBuffer(const std::string& filename);
+
+        ~ConditionBuffer();
+
+        /**
+         * @brief Get the first byte of the file.
+         * @return The first byte of the file.
+         */
+        const char* data() const;
+
+        /**
+         * @brief Get the size of the file.
+         * @return The size of the file.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Get the name of the mapped file.
+         * @return The name of the file.
+         */
+        const std::string& filename() const;
+
+    private:
+        ConditionBuffer(const ConditionBuffer&);
+        ConditionBuffer& operator=(const ConditionBuffer&);
+
+        class Pimpl;
+        Pimpl* mPimpl;
+    };
+
+    typedef boost::shared_ptr < ConditionBuffer > ConditionBufferPtr;
+
+    /**
+     * @brief A LazyPort is the position of the XML content of a port (between
+     * the `<port name="...">' and `</port>' tags) into a ConditionBuffer.
+     */
+    struct LazyPort
+    {
+        LazyPort(const ConditionBufferPtr& buffer, std::size_t begin,
+                 std::size_t end)
+            : buffer(buffer), begin(begin), end(end)
+        {}
+
+        ConditionBufferPtr buffer;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    /**
+     * @brief Define the ConditionLazyPorts like a dictionnary, (portname,
+     * position of the values into the vpz file).
+     */
+    typedef std::map < std::string, LazyPort > ConditionLazyPorts;
+
     /**
      * @brief A condition define a couple model name, port name and a Value.
      * This class allow loading and writing a condition.
@@ -219,6 +286,30 @@ namespace vle { namespace vpz {
          */
         void deleteValueSet();
 
+        /**
+         * @brief Add a port whose values are parsed from the vpz file only
+         * when they are accessed the first time (getSetValues,
+         * fillWithFirstValues, iterators etc.). If the port exists, its
+         * values are deleted. This function is principaly used in Sax parser.
+         * @param portname The name of the port.
+         * @param port The position of the values into the vpz file.
+         */
+        void addLazyPort(const std::string& portname, const LazyPort& port);
+
+        /**
+         * @brief Check if the values of a port are not yet parsed.
+         * @param portname The name of the port.
+         * @return true if the port exists and is not yet parsed.
+         */
+        bool isLazyPort(const std::string& portname) const;
+
+        /**
+         * @brief Parse the values of all the lazy ports. The lazy ports are
+         * parsed under a lock, the constant functions of a Condition can be
+         * called from several threads.
+         */
+        void load() const;
+
 
         /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
          *
@@ -231,21 +322,21 @@ namespace vle { namespace vpz {
          * @return A constant reference to the ConditionValues.
          */
         inline const ConditionValues& conditionvalues() const
-        { return m_list; }
+        { load(); return m_list; }
 
         /**
          * @brief Get a reference to the ConditionValues.
          * @return A constant reference to the ConditionValues.
          */
         inline ConditionValues& conditionvalues()
-        { return m_list; }
+        { load(); return m_list; }
 
         /**
          * @brief Get a iterator the begin of the vpz::ConditionValues.
          * @return Get a iterator the begin of the vpz::ConditionValues.
          */
         iterator begin()
-        { return m_list.begin(); }
+        { load(); return m_list.begin(); }
 
         /**
          * @brief Get a iterator the end of the vpz::ConditionValues.
@@ -260,7 +351,7 @@ namespace vle { namespace vpz {
          * vpz::ConditionValues.
          */
         const_iterator begin() const
-        { return m_list.begin(); }
+        { load(); return m_list.begin(); }
 
         /**
          * @brief Get a constant iterator the end of the vpz::ConditionValues.
@@ -344,7 +435,21 @@ namespace vle { namespace vpz {
     private:
         Condition();
 
-        ConditionValues         m_list;         /* list of port, values. */
+        /**
+         * @brief Parse the values of a port if it is a lazy port.
+         * @param portname The name of the port.
+         */
+        void load(const std::string& portname) const;
+
+        /**
+         * @brief Parse the values of a lazy port, the lock of the lazy
+         * ports must be held.
+         * @param it The lazy port.
+         */
+        void loadPort(ConditionLazyPorts::iterator it) const;
+
+        mutable ConditionValues m_list;         /* list of port, values. */
+        mutable ConditionLazyPorts m_lazy;      /* list of port not parsed. */
         std::string             m_name;         /* name of the condition. */
         std::string             m_last_port;    /* latest added port. */
         bool                    m_ispermanent;
@@ -155,4 +155,12 @@ void Conditions::deleteValueSet()
         Condition::DeleteValueSet());
 }
 
+void Conditions::load() const
+{
+    for (ConditionList::const_iterator it = m_list.begin();
+         it != m_list.end(); ++it) {
+        it->second.load();
+    }
+}
+
 }} // namespace vle vpz
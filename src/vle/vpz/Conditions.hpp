@@ -205,6 +205,14 @@ namespace vpz {
          */
         void deleteValueSet();
 
+        /**
+         * @brief Parse the values of the lazy ports of all the conditions
+         * (see Vpz::setLazyConditions). Call it before the copies of the
+         * conditions or before sharing them between threads to parse each
+         * port only once.
+         */
+        void load() const;
+
         /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
          *
          * Get/Set
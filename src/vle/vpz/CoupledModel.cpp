@@ -769,6 +769,7 @@ void CoupledModel::delModel(BaseModel* model)
 {
     ModelList::iterator it = m_modelList.find(model->getName());
     if (it != m_modelList.end()) {
+        beforeRemove(model);
         delAllConnection(model);
         m_modelList.erase(it);
         delete model;
@@ -777,6 +778,11 @@ void CoupledModel::delModel(BaseModel* model)
 
 void CoupledModel::delAllModel()
 {
+    for (ModelList::iterator it = m_modelList.begin();
+         it != m_modelList.end(); ++it) {
+        beforeRemove(it->second);
+    }
+
     std::for_each(m_modelList.begin(), m_modelList.end(), DeleteModel(this));
     m_modelList.clear();
 }
@@ -805,6 +811,7 @@ void CoupledModel::detachModel(BaseModel* model)
 {
     ModelList::iterator it = m_modelList.find(model->getName());
     if (it != m_modelList.end()) {
+        beforeRemove(it->second);
         it->second->setParent(0);
         m_modelList.erase(it);
     } else {
@@ -752,6 +752,15 @@ namespace vle { namespace vpz {
 	 */
 	virtual void purgeConditions(const std::set < std::string >& conditionlist);
 
+    protected:
+        /**
+         * @brief Called by delModel, delAllModel and detachModel before a
+         * model leaves the model list. Does nothing by default, derived
+         * classes which reference their models override it.
+         * @param model The model removed.
+         */
+        virtual void beforeRemove(BaseModel* /*model*/) {}
+
     private:
         void delConnection(BaseModel* src, const std::string& portSrc,
                            BaseModel* dst, const std::string& portDst);
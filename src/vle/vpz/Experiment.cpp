@@ -41,6 +41,18 @@ void Experiment::write(std::ostream& out) const
             << "\" ";
     }
 
+    if (m_samples) {
+        out << "samples=\"" << m_samples << "\" ";
+    }
+
+    if (m_seed) {
+        out << "seed=\"" << m_seed << "\" ";
+    }
+
+    if (m_replicas > 1) {
+        out << "replicas=\"" << m_replicas << "\" ";
+    }
+
     out << " >\n";
 
     m_conditions.write(out);
@@ -54,6 +66,9 @@ void Experiment::clear()
     m_name.clear();
     m_duration = 1.0;
     m_begin = 0;
+    m_samples = 0;
+    m_seed = 0;
+    m_replicas = 1;
 
     m_conditions.clear();
     m_views.clear();
@@ -96,11 +111,21 @@ void Experiment::setDuration(double duration)
 
 void Experiment::setCombination(const std::string& name)
 {
-    if (name != "linear" and name != "total") {
+    if (name != "linear" and name != "total" and name != "lhs" and
+        name != "sobol" and name != "halton" and name != "random") {
         throw utils::ArgError(fmt(_("Unknow combination '%1%'")) % name);
     }
 
     m_combination.assign(name);
 }
 
+void Experiment::setReplicas(uint32_t replicas)
+{
+    if (replicas == 0) {
+        throw utils::ArgError(_("Experiment replicas error: must be > 0"));
+    }
+
+    m_replicas = replicas;
+}
+
 }} // namespace vle vpz
@@ -47,7 +47,8 @@ namespace vle { namespace vpz {
          * date at 0.0.
          */
         Experiment()
-            : m_duration(1.0), m_begin(0.0)
+            : m_duration(1.0), m_begin(0.0), m_samples(0), m_seed(0),
+            m_replicas(1)
         {}
 
         /**
@@ -61,7 +62,9 @@ namespace vle { namespace vpz {
          * including Replicas, ExperimentalCondition and Views.
          * @param out Output stream.
          * @code
-         * <experiment name="exp1" duration="0.33" begin="0.0" >
+         * <experiment name="exp1" duration="0.33" begin="0.0"
+         *             combination="lhs" samples="100" seed="12345"
+         *             replicas="10" >
          *   [...]
          * </experiment>
          * @endcode
@@ -184,7 +187,10 @@ namespace vle { namespace vpz {
 
         /**
          * @brief Set the experimental design combination.
-         * @param name The new name of experimental design combination.
+         * @param name The new name of experimental design combination:
+         * linear, total, lhs, sobol, halton or random (see
+         * manager::ExperimentDesign).
+         * @throw utils::ArgError if name is unknown.
          */
         void setCombination(const std::string& name);
 
@@ -195,11 +201,60 @@ namespace vle { namespace vpz {
         const std::string& combination() const
         { return m_combination; }
 
+        /**
+         * @brief Set the number of combinations of the sampling designs
+         * (lhs, sobol, halton and random).
+         * @param samples The number of samples.
+         */
+        void setSamples(uint32_t samples)
+        { m_samples = samples; }
+
+        /**
+         * @brief Get the number of combinations of the sampling designs.
+         * @return The number of samples, 0 if undefined.
+         */
+        uint32_t samples() const
+        { return m_samples; }
+
+        /**
+         * @brief Set the seed of the random experimental designs and of the
+         * random streams of the simulations (see utils::Philox::key).
+         * @param seed The seed.
+         */
+        void setSeed(uint32_t seed)
+        { m_seed = seed; }
+
+        /**
+         * @brief Get the seed of the random experimental designs and of the
+         * random streams of the simulations.
+         * @return The seed.
+         */
+        uint32_t seed() const
+        { return m_seed; }
+
+        /**
+         * @brief Set the number of replicas of each combination. The
+         * replicas differ only by their random streams.
+         * @param replicas The number of replicas.
+         * @throw utils::ArgError if replicas is 0.
+         */
+        void setReplicas(uint32_t replicas);
+
+        /**
+         * @brief Get the number of replicas of each combination.
+         * @return The number of replicas, 1 by default.
+         */
+        uint32_t replicas() const
+        { return m_replicas; }
+
     private:
         std::string         m_name;
         double              m_duration;
         double              m_begin;
         std::string         m_combination;
+        uint32_t            m_samples;
+        uint32_t            m_seed;
+        uint32_t            m_replicas;
         Conditions          m_conditions;
         Views               m_views;
     };
@@ -0,0 +1,389 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/vpz/FlatGraph.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/GridModel.hpp>
+#include <algorithm>
+
+namespace vle { namespace vpz {
+
+const uint32_t FlatGraph::npos = static_cast < uint32_t >(-1);
+
+void FlatGraph::build(BaseModel* model)
+{
+    clear();
+
+    if (not model) {
+        return;
+    }
+
+    AtomicModelVector atoms;
+    BaseModel::getAtomicModelList(model, atoms);
+
+    for (AtomicModelVector::iterator it = atoms.begin(); it != atoms.end();
+         ++it) {
+        addModel(*it);
+    }
+
+    Cache cache;
+    m_modelrows.reserve(m_models.size() + 1);
+
+    for (uint32_t i = 0; i < atoms.size(); ++i) {
+        m_modelrows.push_back(m_rows.size());
+        computeRows(m_models[i], cache, m_rows, m_edges);
+    }
+
+    m_modelrows.push_back(m_rows.size());
+    m_compacted = atoms.size();
+}
+
+void FlatGraph::update(BaseModel* model)
+{
+    Cache cache;
+
+    if (model->isAtomic()) {
+        updateModel(model->toAtomic(), cache);
+    } else {
+        AtomicModelVector atoms;
+        BaseModel::getAtomicModelList(model, atoms);
+
+        const ConnectionList& inputs(model->getInputPortList());
+        for (ConnectionList::const_iterator it = inputs.begin();
+             it != inputs.end(); ++it) {
+            ModelPortList sources;
+            model->getAtomicModelsSource(it->first, sources);
+
+            for (ModelPortList::iterator jt = sources.begin();
+                 jt != sources.end(); ++jt) {
+                atoms.push_back(jt->first->toAtomic());
+            }
+        }
+
+        for (AtomicModelVector::iterator it = atoms.begin();
+             it != atoms.end(); ++it) {
+            updateModel(*it, cache);
+        }
+    }
+
+    if (m_updated.size() > 64 and m_updated.size() * 4 > m_models.size()) {
+        compact();
+    }
+}
+
+void FlatGraph::remove(BaseModel* model)
+{
+    AtomicModelVector atoms;
+    BaseModel::getAtomicModelList(model, atoms);
+
+    for (AtomicModelVector::iterator it = atoms.begin(); it != atoms.end();
+         ++it) {
+        std::map < const BaseModel*, uint32_t >::iterator jt =
+            m_ids.find(*it);
+
+        if (jt != m_ids.end()) {
+            m_models[jt->second] = 0;
+            m_updated[jt->second] = Rows();
+            m_ids.erase(jt);
+        }
+    }
+}
+
+void FlatGraph::compact()
+{
+    std::vector < uint32_t > modelrows;
+    RowList rows;
+    EdgeList edges;
+
+    modelrows.reserve(m_models.size() + 1);
+    rows.reserve(m_rows.size());
+    edges.reserve(m_edges.size());
+
+    for (uint32_t i = 0; i < m_models.size(); ++i) {
+        modelrows.push_back(rows.size());
+
+        const RowList* src = 0;
+        const EdgeList* srcedges = 0;
+        RowList::size_type begin = 0, end = 0;
+
+        std::map < uint32_t, Rows >::const_iterator it = m_updated.find(i);
+        if (it != m_updated.end()) {
+            src = &it->second.rows;
+            srcedges = &it->second.edges;
+            end = src->size();
+        } else if (i < m_compacted) {
+            src = &m_rows;
+            srcedges = &m_edges;
+            begin = m_modelrows[i];
+            end = m_modelrows[i + 1];
+        }
+
+        for (RowList::size_type j = begin; j < end; ++j) {
+            const Row& row((*src)[j]);
+            uint32_t first = edges.size();
+
+            for (uint32_t k = row.begin; k < row.end; ++k) {
+                if (m_models[(*srcedges)[k].model]) {
+                    edges.push_back((*srcedges)[k]);
+                }
+            }
+
+            if (edges.size() > first) {
+                rows.push_back(Row(row.port, first, edges.size()));
+            }
+        }
+    }
+
+    modelrows.push_back(rows.size());
+
+    m_modelrows.swap(modelrows);
+    m_rows.swap(rows);
+    m_edges.swap(edges);
+    m_compacted = m_models.size();
+    m_updated.clear();
+}
+
+void FlatGraph::clear()
+{
+    m_models.clear();
+    m_ids.clear();
+    m_portnames.clear();
+    m_portids.clear();
+    m_modelrows.clear();
+    m_rows.clear();
+    m_edges.clear();
+    m_compacted = 0;
+    m_updated.clear();
+}
+
+FlatGraph::EdgeRange FlatGraph::targets(uint32_t model, uint32_t port) const
+{
+    if (not m_updated.empty()) {
+        std::map < uint32_t, Rows >::const_iterator it = m_updated.find(model);
+
+        if (it != m_updated.end()) {
+            return find(it->second.rows, 0, it->second.rows.size(),
+                        it->second.edges, port);
+        }
+    }
+
+    if (model < m_compacted) {
+        return find(m_rows, m_modelrows[model], m_modelrows[model + 1],
+                    m_edges, port);
+    }
+
+    return EdgeRange(0, 0);
+}
+
+FlatGraph::EdgeRange FlatGraph::targets(const AtomicModel* model,
+                                        const std::string& port) const
+{
+    uint32_t mdl = id(model);
+    uint32_t prt = portId(port);
+
+    if (mdl == npos or prt == npos) {
+        return EdgeRange(0, 0);
+    }
+
+    return targets(mdl, prt);
+}
+
+uint32_t FlatGraph::id(const BaseModel* model) const
+{
+    std::map < const BaseModel*, uint32_t >::const_iterator it =
+        m_ids.find(model);
+
+    return it == m_ids.end() ? npos : it->second;
+}
+
+uint32_t FlatGraph::portId(const std::string& name) const
+{
+    std::map < std::string, uint32_t >::const_iterator it =
+        m_portids.find(name);
+
+    return it == m_portids.end() ? npos : it->second;
+}
+
+uint32_t FlatGraph::edges() const
+{
+    uint32_t result = m_edges.size();
+
+    for (std::map < uint32_t, Rows >::const_iterator it = m_updated.begin();
+         it != m_updated.end(); ++it) {
+        if (it->first < m_compacted) {
+            for (uint32_t i = m_modelrows[it->first];
+                 i < m_modelrows[it->first + 1]; ++i) {
+                result -= m_rows[i].end - m_rows[i].begin;
+            }
+        }
+
+        result += it->second.edges.size();
+    }
+
+    return result;
+}
+
+uint32_t FlatGraph::addModel(AtomicModel* model)
+{
+    std::pair < std::map < const BaseModel*, uint32_t >::iterator, bool > r =
+        m_ids.insert(std::make_pair(model, m_models.size()));
+
+    if (r.second) {
+        m_models.push_back(model);
+    }
+
+    return r.first->second;
+}
+
+uint32_t FlatGraph::addPort(const std::string& name)
+{
+    std::pair < std::map < std::string, uint32_t >::iterator, bool > r =
+        m_portids.insert(std::make_pair(name, m_portnames.size()));
+
+    if (r.second) {
+        m_portnames.push_back(name);
+    }
+
+    return r.first->second;
+}
+
+/*
+ * Same walk as BaseModel::getAtomicModelsTarget but the atomic models reached
+ * by a port of a coupled model are stored into the cache and reused by all
+ * the sources connected to this port.
+ */
+void FlatGraph::resolve(ModelPortList& list, BaseModel* source, Cache& cache,
+                        EdgeList& out)
+{
+    for (ModelPortList::iterator it = list.begin(); it != list.end(); ++it) {
+        BaseModel* mdl = it->first;
+
+        if (mdl->isAtomic()) {
+            out.push_back(Edge(addModel(mdl->toAtomic()),
+                               addPort(it->second)));
+        } else {
+            CoupledModel* cpled = mdl->toCoupled();
+            ModelPortList& next(cpled == source->getParent() ?
+                                cpled->getOutPort(it->second) :
+                                cpled->getInternalInPort(it->second));
+
+            std::pair < Cache::iterator, bool > r =
+                cache.insert(Cache::value_type(&next, EdgeList()));
+
+            if (r.second) {
+                EdgeList result;
+                resolve(next, cpled, cache, result);
+                r.first->second.swap(result);
+            }
+
+            out.insert(out.end(), r.first->second.begin(),
+                       r.first->second.end());
+        }
+    }
+}
+
+void FlatGraph::computeRows(AtomicModel* model, Cache& cache, RowList& rows,
+                            EdgeList& edges)
+{
+    RowList::size_type first = rows.size();
+    ConnectionList& outputs(model->getOutputPortList());
+    const GridModel* grid = dynamic_cast < const GridModel* >(
+        model->getParent());
+
+    for (ConnectionList::iterator it = outputs.begin(); it != outputs.end();
+         ++it) {
+        uint32_t begin = edges.size();
+        resolve(it->second, model, cache, edges);
+
+        if (grid) {
+            resolveCell(*grid, model, it->first, edges);
+        }
+
+        if (edges.size() > begin) {
+            rows.push_back(Row(addPort(it->first), begin, edges.size()));
+        }
+    }
+
+    if (grid) {
+        const std::vector < std::string >& ports(grid->getCellOutputPorts());
+
+        for (std::vector < std::string >::const_iterator it = ports.begin();
+             it != ports.end(); ++it) {
+            if (outputs.find(*it) == outputs.end()) {
+                uint32_t begin = edges.size();
+                resolveCell(*grid, model, *it, edges);
+
+                if (edges.size() > begin) {
+                    rows.push_back(Row(addPort(*it), begin, edges.size()));
+                }
+            }
+        }
+    }
+
+    std::sort(rows.begin() + first, rows.end());
+}
+
+void FlatGraph::resolveCell(const GridModel& grid, AtomicModel* model,
+                            const std::string& port, EdgeList& out)
+{
+    GridModel::TargetList targets;
+    grid.getTargets(model, port, targets);
+
+    for (GridModel::TargetList::const_iterator it = targets.begin();
+         it != targets.end(); ++it) {
+        out.push_back(Edge(addModel(it->first), addPort(*it->second)));
+    }
+}
+
+void FlatGraph::updateModel(AtomicModel* model, Cache& cache)
+{
+    Rows& result(m_updated[addModel(model)]);
+
+    result.rows.clear();
+    result.edges.clear();
+    computeRows(model, cache, result.rows, result.edges);
+}
+
+FlatGraph::EdgeRange FlatGraph::find(const RowList& rows,
+                                     RowList::size_type begin,
+                                     RowList::size_type end,
+                                     const EdgeList& edges,
+                                     uint32_t port)
+{
+    RowList::const_iterator it = std::lower_bound(rows.begin() + begin,
+                                                  rows.begin() + end,
+                                                  Row(port, 0, 0));
+
+    if (it == rows.begin() + end or it->port != port) {
+        return EdgeRange(0, 0);
+    }
+
+    return EdgeRange(&edges[0] + it->begin, &edges[0] + it->end);
+}
+
+}} // namespace vle vpz
@@ -0,0 +1,258 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_VPZ_FLATGRAPH_HPP
+#define VLE_VPZ_FLATGRAPH_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/utils/Types.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vle { namespace vpz {
+
+    class BaseModel;
+    class AtomicModel;
+    class ModelPortList;
+    class GridModel;
+
+    /**
+     * @brief FlatGraph is the atomic to atomic connection graph of a model
+     * hierarchy, stored in compressed sparse row arrays. It is updated with
+     * update() or remove() when the hierarchy is modified.
+     */
+    class VLE_API FlatGraph
+    {
+    public:
+        /**
+         * @brief An edge of the graph: the identifier of the atomic model
+         * and of the input port reached.
+         */
+        struct Edge
+        {
+            Edge(uint32_t model, uint32_t port)
+                : model(model), port(port)
+            {}
+
+            uint32_t model;
+            uint32_t port;
+        };
+
+        typedef std::vector < Edge > EdgeList;
+        typedef std::pair < const Edge*, const Edge* > EdgeRange;
+
+        /**
+         * @brief The identifier returned for unknown models or ports.
+         */
+        static const uint32_t npos;
+
+        FlatGraph()
+            : m_compacted(0)
+        {}
+
+        /**
+         * @brief Build the graph of a model hierarchy.
+         * @param model The atomic or coupled model to read.
+         */
+        FlatGraph(BaseModel* model)
+            : m_compacted(0)
+        { build(model); }
+
+        /**
+         * @brief Delete the current graph and build the graph of a model
+         * hierarchy.
+         * @param model The atomic or coupled model to read, can be null.
+         */
+        void build(BaseModel* model);
+
+        /**
+         * @brief Compute again the edges of the atomic models which depend on
+         * the model: the model itself if it is atomic, otherwise the atomic
+         * models of the coupled model and the atomic models connected to the
+         * input ports of the coupled model. New atomic models get a new
+         * identifier.
+         * @param model The modified model.
+         */
+        void update(BaseModel* model);
+
+        /**
+         * @brief Remove the atomic models of a model from the graph. Must be
+         * called before the model is deleted. The edges of the other atomic
+         * models which reach the removed models are kept until the sources
+         * are updated, the identifier of a removed model is associated to a
+         * null model.
+         * @param model The model to remove.
+         */
+        void remove(BaseModel* model);
+
+        /**
+         * @brief Merge the models computed again by update() or remove() into
+         * the compressed arrays. Invalidates the EdgeRange.
+         */
+        void compact();
+
+        /**
+         * @brief Delete all the graph.
+         */
+        void clear();
+
+        /**
+         * @brief Get the edges of an output port of an atomic model. The
+         * range is invalidated by build, update, remove and compact.
+         * @param model The identifier of the atomic model.
+         * @param port The identifier of the output port.
+         * @return A range of edges, empty if the port is not connected.
+         */
+        EdgeRange targets(uint32_t model, uint32_t port) const;
+
+        /**
+         * @brief Get the edges of an output port of an atomic model.
+         * @param model The atomic model.
+         * @param port The name of the output port.
+         * @return A range of edges, empty if the model or the port are
+         * unknown or if the port is not connected.
+         */
+        EdgeRange targets(const AtomicModel* model,
+                          const std::string& port) const;
+
+        /**
+         * @brief Get the identifier of an atomic model.
+         * @param model The atomic model.
+         * @return The identifier or npos.
+         */
+        uint32_t id(const BaseModel* model) const;
+
+        /**
+         * @brief Get the atomic model of an identifier.
+         * @param id The identifier.
+         * @return The atomic model or null if it was removed.
+         */
+        AtomicModel* model(uint32_t id) const
+        { return m_models[id]; }
+
+        /**
+         * @brief Get the identifier of a port name.
+         * @param name The name of the port.
+         * @return The identifier or npos.
+         */
+        uint32_t portId(const std::string& name) const;
+
+        /**
+         * @brief Get the name of a port identifier.
+         * @param id The identifier.
+         * @return The name of the port.
+         */
+        const std::string& portName(uint32_t id) const
+        { return m_portnames[id]; }
+
+        /**
+         * @brief Get the number of identifiers of atomic models, including
+         * the removed models.
+         * @return The number of identifiers.
+         */
+        uint32_t size() const
+        { return m_models.size(); }
+
+        /**
+         * @brief Get the number of identifiers of ports.
+         * @return The number of identifiers.
+         */
+        uint32_t ports() const
+        { return m_portnames.size(); }
+
+        /**
+         * @brief Get the number of edges.
+         * @return The number of edges.
+         */
+        uint32_t edges() const;
+
+    private:
+        /**
+         * The edges of an output port: [begin, end) in an EdgeList.
+         */
+        struct Row
+        {
+            Row(uint32_t port, uint32_t begin, uint32_t end)
+                : port(port), begin(begin), end(end)
+            {}
+
+            bool operator<(const Row& other) const
+            { return port < other.port; }
+
+            uint32_t port;
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        typedef std::vector < Row > RowList;
+
+        /**
+         * The rows of an atomic model computed again by update.
+         */
+        struct Rows
+        {
+            RowList  rows;
+            EdgeList edges;
+        };
+
+        typedef std::map < const ModelPortList*, EdgeList > Cache;
+
+        uint32_t addModel(AtomicModel* model);
+        uint32_t addPort(const std::string& name);
+
+        void resolve(ModelPortList& list, BaseModel* source, Cache& cache,
+                     EdgeList& out);
+
+        void resolveCell(const GridModel& grid, AtomicModel* model,
+                         const std::string& port, EdgeList& out);
+
+        void computeRows(AtomicModel* model, Cache& cache, RowList& rows,
+                         EdgeList& edges);
+
+        void updateModel(AtomicModel* model, Cache& cache);
+
+        static EdgeRange find(const RowList& rows, RowList::size_type begin,
+                              RowList::size_type end, const EdgeList& edges,
+                              uint32_t port);
+
+        std::vector < AtomicModel* > m_models;
+        std::map < const BaseModel*, uint32_t > m_ids;
+        std::vector < std::string > m_portnames;
+        std::map < std::string, uint32_t > m_portids;
+
+        std::vector < uint32_t > m_modelrows; /* first row of each model. */
+        RowList m_rows;
+        EdgeList m_edges;
+        uint32_t m_compacted; /* number of models in the compressed arrays. */
+
+        std::map < uint32_t, Rows > m_updated;
+    };
+
+}} // namespace vle vpz
+
+#endif
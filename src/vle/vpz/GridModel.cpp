@@ -0,0 +1,317 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/vpz/GridModel.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/value/Set.hpp>
+#include <vle/value/String.hpp>
+#include <vle/value/Table.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+
+namespace vle { namespace vpz {
+
+/*
+ * The directions of the neighbours: the offsets of the coordinates and the
+ * index of the opposite direction.
+ */
+struct GridDirection
+{
+    int dx;
+    int dy;
+    unsigned int opposite;
+};
+
+static const GridDirection gridDirections[] = {
+    { -1, 0, 2 }, { 0, 1, 3 }, { 1, 0, 0 }, { 0, -1, 1 },
+    { -1, -1, 7 }, { -1, 1, 6 }, { 1, -1, 5 }, { 1, 1, 4 },
+    { -1, 0, 9 }, { 1, 0, 8 }
+};
+
+static const std::string gridDirectionNames[] = {
+    "N", "E", "S", "W", "NW", "NE", "SW", "SE", "L", "R"
+};
+
+static const std::string gridOutputPort("out");
+
+GridModel::GridModel(const std::string& name, CoupledModel* parent,
+                     uint32_t width, uint32_t height,
+                     Neighbourhood neighbourhood, bool torus,
+                     bool symmetricport)
+    : CoupledModel(name, parent), m_width(width), m_height(height),
+    m_neighbourhood(neighbourhood), m_torus(torus),
+    m_symmetricport(symmetricport)
+{
+    if (width == 0 or height == 0) {
+        throw utils::ArgError(fmt(
+                _("Grid model %1%: bad size %2%x%3%")) % name % width
+            % height);
+    }
+
+    m_cells.resize(static_cast < std::size_t >(width) * height, 0);
+    initDirections();
+}
+
+GridModel::GridModel(const GridModel& mdl)
+    : CoupledModel(mdl), m_width(mdl.m_width), m_height(mdl.m_height),
+    m_neighbourhood(mdl.m_neighbourhood), m_torus(mdl.m_torus),
+    m_symmetricport(mdl.m_symmetricport), m_directions(mdl.m_directions),
+    m_outputs(mdl.m_outputs), m_cells(mdl.m_cells.size(), 0)
+{
+    std::map < const BaseModel*, BaseModel* > clones;
+
+    ModelList::const_iterator it = mdl.getModelList().begin();
+    ModelList::const_iterator jt = getModelList().begin();
+    for (; it != mdl.getModelList().end(); ++it, ++jt) {
+        clones[it->second] = jt->second;
+    }
+
+    for (std::vector < AtomicModel* >::size_type i = 0;
+         i < mdl.m_cells.size(); ++i) {
+        if (mdl.m_cells[i]) {
+            m_cells[i] = clones[mdl.m_cells[i]]->toAtomic();
+            m_index[m_cells[i]] = i;
+        }
+    }
+
+    for (Parameters::const_iterator it = mdl.m_parameters.begin();
+         it != mdl.m_parameters.end(); ++it) {
+        m_parameters[it->first] = new value::Table(*it->second);
+    }
+}
+
+GridModel::~GridModel()
+{
+    for (Parameters::iterator it = m_parameters.begin();
+         it != m_parameters.end(); ++it) {
+        delete it->second;
+    }
+}
+
+AtomicModel* GridModel::addCell(uint32_t x, uint32_t y,
+                                const std::string& name)
+{
+    if (x >= m_width or y >= m_height) {
+        throw utils::ArgError(fmt(
+                _("Grid model %1%: cell (%2%, %3%) out of the grid")) %
+            getName() % x % y);
+    }
+
+    uint32_t index = x + y * m_width;
+    if (m_cells[index]) {
+        throw utils::ArgError(fmt(
+                _("Grid model %1%: cell (%2%, %3%) already exists")) %
+            getName() % x % y);
+    }
+
+    AtomicModel* cell = addAtomicModel(name);
+    m_cells[index] = cell;
+    m_index[cell] = index;
+
+    return cell;
+}
+
+bool GridModel::getCoordinates(const AtomicModel* cell, uint32_t& x,
+                               uint32_t& y) const
+{
+    Index::const_iterator it = m_index.find(cell);
+
+    if (it == m_index.end()) {
+        return false;
+    }
+
+    x = it->second % m_width;
+    y = it->second / m_width;
+    return true;
+}
+
+void GridModel::beforeRemove(BaseModel* model)
+{
+    Index::iterator it = m_index.find(model);
+
+    if (it != m_index.end()) {
+        m_cells[it->second] = 0;
+        m_index.erase(it);
+    }
+}
+
+void GridModel::getNeighbourhood(uint32_t x, uint32_t y,
+                                 std::vector < std::string >& directions) const
+{
+    uint32_t nx, ny;
+
+    for (std::vector < unsigned int >::const_iterator it =
+             m_directions.begin(); it != m_directions.end(); ++it) {
+        if (neighbour(x, y, *it, nx, ny)) {
+            directions.push_back(gridDirectionNames[*it]);
+        }
+    }
+}
+
+void GridModel::getTargets(const AtomicModel* cell, const std::string& port,
+                           TargetList& targets) const
+{
+    uint32_t x, y, nx, ny;
+
+    if (not getCoordinates(cell, x, y)) {
+        return;
+    }
+
+    for (std::vector < unsigned int >::const_iterator it =
+             m_directions.begin(); it != m_directions.end(); ++it) {
+        if (m_symmetricport) {
+            if (gridDirectionNames[*it] != port) {
+                continue;
+            }
+        } else if (port != gridOutputPort) {
+            return;
+        }
+
+        if (neighbour(x, y, *it, nx, ny)) {
+            AtomicModel* target = getCell(nx, ny);
+
+            if (target) {
+                targets.push_back(Target(target, &gridDirectionNames[
+                                             gridDirections[*it].opposite]));
+            }
+        }
+    }
+}
+
+void GridModel::setParameter(const std::string& name,
+                             const value::Table& table)
+{
+    if (table.width() != m_width or table.height() != m_height) {
+        throw utils::ArgError(fmt(
+                _("Grid model %1%: parameter %2% of size %3%x%4% instead of "
+                  "%5%x%6%")) % getName() % name % table.width() %
+            table.height() % m_width % m_height);
+    }
+
+    value::Table*& value(m_parameters[name]);
+    delete value;
+    value = new value::Table(table);
+}
+
+void GridModel::fillInitValues(const AtomicModel* cell,
+                               value::Map& values) const
+{
+    uint32_t x, y;
+
+    if (not getCoordinates(cell, x, y)) {
+        return;
+    }
+
+    std::vector < std::string > names;
+    names.push_back("Neighbourhood");
+    names.push_back("_x");
+    if (m_height > 1) {
+        names.push_back("_y");
+    }
+    for (Parameters::const_iterator it = m_parameters.begin();
+         it != m_parameters.end(); ++it) {
+        names.push_back(it->first);
+    }
+
+    for (std::vector < std::string >::const_iterator it = names.begin();
+         it != names.end(); ++it) {
+        if (values.exist(*it)) {
+            throw utils::ArgError(fmt(
+                    _("Grid model %1%: the initialization value %2% of the "
+                      "cell %3% already exists")) % getName() % *it %
+                cell->getName());
+        }
+    }
+
+    std::vector < std::string > directions;
+    getNeighbourhood(x, y, directions);
+
+    value::Set* neighbourhood = value::Set::create();
+    for (std::vector < std::string >::const_iterator it = directions.begin();
+         it != directions.end(); ++it) {
+        neighbourhood->add(value::String::create(*it));
+    }
+
+    values.add("Neighbourhood", neighbourhood);
+    values.add("_x", value::Integer::create(x + 1));
+    if (m_height > 1) {
+        values.add("_y", value::Integer::create(y + 1));
+    }
+
+    for (Parameters::const_iterator it = m_parameters.begin();
+         it != m_parameters.end(); ++it) {
+        values.add(it->first, value::Double::create(it->second->get(x, y)));
+    }
+}
+
+void GridModel::initDirections()
+{
+    unsigned int first, last;
+
+    if (m_height == 1) {
+        first = 8;
+        last = 10;
+    } else {
+        first = 0;
+        last = m_neighbourhood == VON_NEUMANN ? 4 : 8;
+    }
+
+    for (unsigned int i = first; i < last; ++i) {
+        m_directions.push_back(i);
+    }
+
+    if (m_symmetricport) {
+        for (unsigned int i = first; i < last; ++i) {
+            m_outputs.push_back(gridDirectionNames[i]);
+        }
+    } else {
+        m_outputs.push_back(gridOutputPort);
+    }
+}
+
+bool GridModel::neighbour(uint32_t x, uint32_t y, unsigned int direction,
+                          uint32_t& nx, uint32_t& ny) const
+{
+    int64_t px = static_cast < int64_t >(x) + gridDirections[direction].dx;
+    int64_t py = static_cast < int64_t >(y) + gridDirections[direction].dy;
+
+    if (m_torus) {
+        px = (px + m_width) % m_width;
+        py = (py + m_height) % m_height;
+    } else if (px < 0 or py < 0 or px >= m_width or py >= m_height) {
+        return false;
+    }
+
+    nx = static_cast < uint32_t >(px);
+    ny = static_cast < uint32_t >(py);
+    return true;
+}
+
+}} // namespace vle vpz
@@ -0,0 +1,224 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_VPZ_GRIDMODEL_HPP
+#define VLE_VPZ_GRIDMODEL_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/Types.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vle { namespace value {
+
+    class Map;
+    class Table;
+
+}} // namespace vle value
+
+namespace vle { namespace vpz {
+
+    /**
+     * @brief GridModel is a coupled model of atomic models placed on a
+     * vector or a matrix. The connections between the neighbour cells are
+     * implicit: they are not stored in the ports of the models but computed
+     * from the coordinates of the cells by getTargets, used by the
+     * vpz::FlatGraph of the simulation kernel.
+     *
+     * A cell sends its events to its neighbours on the output port `out',
+     * or, if the ports are symmetric, on the output port named by the
+     * direction of the neighbour. The neighbour receives the event on the
+     * input port named by the direction of the sender. The directions are
+     * `L' and `R' for a vector (height of 1), `N', `E', `S', `W' for a
+     * matrix with the von Neumann neighbourhood plus `NW', `NE', `SW' and
+     * `SE' with the Moore neighbourhood. The x coordinate goes from `N' to
+     * `S' (or `L' to `R'), the y coordinate from `W' to `E'.
+     *
+     * The cells share their dynamics, conditions and observables. The per
+     * cell parameters are stored in value::Table of the size of the grid and
+     * added to the initialization values of each cell by fillInitValues.
+     *
+     * The implicit connections are not written by writeXML nor seen by
+     * BaseModel::getAtomicModelsTarget.
+     */
+    class VLE_API GridModel : public CoupledModel
+    {
+    public:
+        enum Neighbourhood { VON_NEUMANN, MOORE };
+
+        /**
+         * @brief A cell and the input port reached.
+         */
+        typedef std::pair < AtomicModel*, const std::string* > Target;
+        typedef std::vector < Target > TargetList;
+
+        /**
+         * @brief Build an empty grid.
+         * @param name The name of the coupled model.
+         * @param parent The parent of the model, can be null.
+         * @param width The number of cells on the x axis.
+         * @param height The number of cells on the y axis, 1 for a vector.
+         * @param neighbourhood The neighbourhood of a matrix.
+         * @param torus true if the borders of the grid are connected.
+         * @param symmetricport true if a cell has an output port for each
+         * direction, false for a single output port `out'.
+         * @throw utils::ArgError if width or height is null.
+         */
+        GridModel(const std::string& name, CoupledModel* parent,
+                  uint32_t width, uint32_t height = 1,
+                  Neighbourhood neighbourhood = VON_NEUMANN,
+                  bool torus = false, bool symmetricport = false);
+
+        GridModel(const GridModel& mdl);
+
+        virtual BaseModel* clone() const
+        { return new GridModel(*this); }
+
+        virtual ~GridModel();
+
+        /**
+         * @brief Add a cell into the grid.
+         * @param x The x coordinate, from 0 to width - 1.
+         * @param y The y coordinate, from 0 to height - 1.
+         * @param name The name of the atomic model.
+         * @return The new atomic model.
+         * @throw utils::ArgError if the coordinates are out of the grid or if
+         * the cell already exists.
+         * @throw utils::DevsGraphError if the name already exists.
+         */
+        AtomicModel* addCell(uint32_t x, uint32_t y, const std::string& name);
+
+        /**
+         * @brief Get a cell.
+         * @param x The x coordinate.
+         * @param y The y coordinate.
+         * @return The atomic model or null if the cell does not exist.
+         */
+        AtomicModel* getCell(uint32_t x, uint32_t y) const
+        { return m_cells[x + y * m_width]; }
+
+        /**
+         * @brief Get the coordinates of a cell.
+         * @param cell The atomic model.
+         * @param x Filled with the x coordinate.
+         * @param y Filled with the y coordinate.
+         * @return false if the model is not a cell of this grid.
+         */
+        bool getCoordinates(const AtomicModel* cell, uint32_t& x,
+                            uint32_t& y) const;
+
+        /**
+         * @brief Get the names of the output ports of the cells.
+         * @return `out' or the directions.
+         */
+        const std::vector < std::string >& getCellOutputPorts() const
+        { return m_outputs; }
+
+        /**
+         * @brief Get the directions of the neighbours of a position. The
+         * positions out of the grid are ignored, the missing cells are not.
+         * @param x The x coordinate.
+         * @param y The y coordinate.
+         * @param directions Filled with the names of the directions.
+         */
+        void getNeighbourhood(uint32_t x, uint32_t y,
+                              std::vector < std::string >& directions) const;
+
+        /**
+         * @brief Get the cells and input ports connected to an output port
+         * of a cell.
+         * @param cell The atomic model.
+         * @param port The name of the output port.
+         * @param targets Filled with the targets.
+         */
+        void getTargets(const AtomicModel* cell, const std::string& port,
+                        TargetList& targets) const;
+
+        /**
+         * @brief Assign a parameter to all the cells.
+         * @param name The name of the initialization value.
+         * @param table The value of each cell, table(x, y) for the cell
+         * (x, y). The table is copied.
+         * @throw utils::ArgError if the size of the table is not the size of
+         * the grid.
+         */
+        void setParameter(const std::string& name, const value::Table& table);
+
+        /**
+         * @brief Add the initialization values of a cell: the coordinates
+         * `_x' and `_y' (from 1), the set `Neighbourhood' of directions
+         * (see getNeighbourhood) and the parameters.
+         * @param cell The atomic model.
+         * @param values The initialization values to fill.
+         * @throw utils::ArgError if a value already exists.
+         */
+        void fillInitValues(const AtomicModel* cell,
+                            value::Map& values) const;
+
+        uint32_t width() const { return m_width; }
+        uint32_t height() const { return m_height; }
+        Neighbourhood neighbourhood() const { return m_neighbourhood; }
+        bool isTorus() const { return m_torus; }
+        bool isSymmetricPort() const { return m_symmetricport; }
+
+    protected:
+        /**
+         * @brief Remove the cell from the grid when the model is deleted or
+         * detached from the grid.
+         * @param model The model removed.
+         */
+        virtual void beforeRemove(BaseModel* model);
+
+    private:
+        GridModel& operator=(const GridModel&);
+
+        typedef std::map < const BaseModel*, uint32_t > Index;
+        typedef std::map < std::string, value::Table* > Parameters;
+
+        void initDirections();
+
+        bool neighbour(uint32_t x, uint32_t y, unsigned int direction,
+                       uint32_t& nx, uint32_t& ny) const;
+
+        uint32_t                        m_width;
+        uint32_t                        m_height;
+        Neighbourhood                   m_neighbourhood;
+        bool                            m_torus;
+        bool                            m_symmetricport;
+        std::vector < unsigned int >    m_directions;
+        std::vector < std::string >     m_outputs;
+        std::vector < AtomicModel* >    m_cells;
+        Index                           m_index; /* position of the
+                                                    cells. */
+        Parameters                      m_parameters;
+    };
+
+}} // namespace vle vpz
+
+#endif
@@ -0,0 +1,345 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/vpz/ModelBuilder.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <algorithm>
+
+namespace vle { namespace vpz {
+
+const uint32_t ModelBuilder::coupled = static_cast < uint32_t >(-1);
+
+/*
+ * Order the indexes of the models by name.
+ */
+struct ModelBuilderNameLess
+{
+    ModelBuilderNameLess(const std::vector < std::string >& names)
+        : names(names)
+    {}
+
+    bool operator()(uint32_t a, uint32_t b) const
+    { return names[a] < names[b]; }
+
+    const std::vector < std::string >& names;
+};
+
+ModelBuilder::ModelBuilder(CoupledModel* parent)
+    : m_parent(parent)
+{
+    if (not parent) {
+        throw utils::DevsGraphError(
+            _("Cannot build models without a coupled model"));
+    }
+}
+
+void ModelBuilder::reserve(std::size_t models, std::size_t connections)
+{
+    m_names.reserve(models);
+    m_prototypes.reserve(models);
+    m_connections.reserve(connections);
+}
+
+uint32_t ModelBuilder::port(const std::string& name)
+{
+    std::pair < std::map < std::string, uint32_t >::iterator, bool > r =
+        m_portids.insert(std::make_pair(name, m_portnames.size()));
+
+    if (r.second) {
+        m_portnames.push_back(name);
+    }
+
+    return r.first->second;
+}
+
+uint32_t ModelBuilder::addAtomicModel(const std::string& name,
+                                      const std::string& dynamics,
+                                      const StringVector& conditions,
+                                      const std::string& observables)
+{
+    m_prototypelist.push_back(Prototype(dynamics, conditions, observables));
+    m_prototypes.push_back(m_prototypelist.size() - 1);
+    m_names.push_back(name);
+
+    return m_names.size() - 1;
+}
+
+uint32_t ModelBuilder::addAtomicModels(const StringVector& names,
+                                       const std::string& dynamics,
+                                       const StringVector& conditions,
+                                       const std::string& observables)
+{
+    uint32_t first = m_names.size();
+
+    m_prototypelist.push_back(Prototype(dynamics, conditions, observables));
+    m_prototypes.insert(m_prototypes.end(), names.size(),
+                        m_prototypelist.size() - 1);
+    m_names.insert(m_names.end(), names.begin(), names.end());
+
+    return first;
+}
+
+void ModelBuilder::addInputPorts(uint32_t first, uint32_t count,
+                                 uint32_t port)
+{
+    m_inputs.reserve(m_inputs.size() + count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        m_inputs.push_back(std::make_pair(first + i, port));
+    }
+}
+
+void ModelBuilder::addOutputPorts(uint32_t first, uint32_t count,
+                                  uint32_t port)
+{
+    m_outputs.reserve(m_outputs.size() + count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        m_outputs.push_back(std::make_pair(first + i, port));
+    }
+}
+
+void ModelBuilder::addConnections(const ConnectionVector& connections)
+{
+    m_connections.insert(m_connections.end(), connections.begin(),
+                         connections.end());
+}
+
+void ModelBuilder::commit(AtomicModelVector* models)
+{
+    /*
+     * The ports are sorted by name to insert them at the end of the
+     * ConnectionList of the models.
+     */
+    std::vector < uint32_t > rank(m_portnames.size());
+    std::vector < uint32_t > byrank;
+    byrank.reserve(m_portnames.size());
+
+    for (std::map < std::string, uint32_t >::const_iterator it =
+             m_portids.begin(); it != m_portids.end(); ++it) {
+        rank[it->second] = byrank.size();
+        byrank.push_back(it->second);
+    }
+
+    ModelPortVector inputs(m_inputs), outputs(m_outputs);
+    for (ModelPortVector::iterator it = inputs.begin(); it != inputs.end();
+         ++it) {
+        checkModel(it->first);
+        checkPort(it->second);
+        it->second = rank[it->second];
+    }
+    for (ModelPortVector::iterator it = outputs.begin(); it != outputs.end();
+         ++it) {
+        checkModel(it->first);
+        checkPort(it->second);
+        it->second = rank[it->second];
+    }
+
+    std::sort(inputs.begin(), inputs.end());
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+    std::sort(outputs.begin(), outputs.end());
+    outputs.erase(std::unique(outputs.begin(), outputs.end()), outputs.end());
+
+    std::vector < uint32_t > order(m_names.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), ModelBuilderNameLess(m_names));
+
+    check(order, rank, inputs, outputs);
+
+    /*
+     * The graph is valid, the models are inserted in the order of their
+     * names, the ports in the order of their names.
+     */
+    AtomicModelVector built(m_names.size());
+    ModelList& list(m_parent->getModelList());
+    ModelList::iterator hint = list.begin();
+
+    for (std::vector < uint32_t >::const_iterator it = order.begin();
+         it != order.end(); ++it) {
+        const Prototype& prototype(m_prototypelist[m_prototypes[*it]]);
+        AtomicModel* mdl = new AtomicModel(m_names[*it], 0);
+
+        mdl->setDynamics(prototype.dynamics);
+        mdl->setConditions(prototype.conditions);
+        mdl->setObservables(prototype.observables);
+        mdl->setParent(m_parent);
+
+        hint = list.insert(hint, ModelList::value_type(m_names[*it], mdl));
+        built[*it] = mdl;
+    }
+
+    for (ModelPortVector::const_iterator it = inputs.begin();
+         it != inputs.end(); ++it) {
+        ConnectionList& ports(built[it->first]->getInputPortList());
+        ports.insert(ports.end(), ConnectionList::value_type(
+                m_portnames[byrank[it->second]], ModelPortList()));
+    }
+
+    for (ModelPortVector::const_iterator it = outputs.begin();
+         it != outputs.end(); ++it) {
+        ConnectionList& ports(built[it->first]->getOutputPortList());
+        ports.insert(ports.end(), ConnectionList::value_type(
+                m_portnames[byrank[it->second]], ModelPortList()));
+    }
+
+    for (ConnectionVector::const_iterator it = m_connections.begin();
+         it != m_connections.end(); ++it) {
+        const std::string& srcPort(m_portnames[it->srcPort]);
+        const std::string& dstPort(m_portnames[it->dstPort]);
+
+        if (it->src == coupled) {
+            m_parent->getInternalInPort(srcPort).add(built[it->dst], dstPort);
+            built[it->dst]->getInPort(dstPort).add(m_parent, srcPort);
+        } else if (it->dst == coupled) {
+            built[it->src]->getOutPort(srcPort).add(m_parent, dstPort);
+            m_parent->getInternalOutPort(dstPort).add(built[it->src], srcPort);
+        } else {
+            built[it->src]->getOutPort(srcPort).add(built[it->dst], dstPort);
+            built[it->dst]->getInPort(dstPort).add(built[it->src], srcPort);
+        }
+    }
+
+    if (models) {
+        models->swap(built);
+    }
+
+    clear();
+}
+
+void ModelBuilder::clear()
+{
+    m_names.clear();
+    m_prototypes.clear();
+    m_prototypelist.clear();
+    m_inputs.clear();
+    m_outputs.clear();
+    m_connections.clear();
+}
+
+void ModelBuilder::check(const std::vector < uint32_t >& order,
+                         const std::vector < uint32_t >& rank,
+                         const ModelPortVector& inputs,
+                         const ModelPortVector& outputs) const
+{
+    const ModelList& list(m_parent->getModelList());
+    ModelList::const_iterator jt = list.begin();
+
+    for (std::vector < uint32_t >::size_type i = 0; i < order.size(); ++i) {
+        const std::string& name(m_names[order[i]]);
+
+        if (i > 0 and m_names[order[i - 1]] == name) {
+            throw utils::DevsGraphError(fmt(
+                    _("Cannot add the atomic model %1% twice in %2%")) % name
+                % m_parent->getName());
+        }
+
+        while (jt != list.end() and jt->first < name) {
+            ++jt;
+        }
+
+        if (jt != list.end() and jt->first == name) {
+            throw utils::DevsGraphError(fmt(
+                    _("Cannot add an atomic model with an existing name %1% "
+                      "in %2%")) % name % m_parent->getName());
+        }
+    }
+
+    for (ConnectionVector::const_iterator it = m_connections.begin();
+         it != m_connections.end(); ++it) {
+        checkPort(it->srcPort);
+        checkPort(it->dstPort);
+
+        if (it->src == coupled and it->dst == coupled) {
+            throw utils::DevsGraphError(fmt(
+                    _("Cannot connect the coupled model %1% to itself"))
+                % m_parent->getName());
+        }
+
+        if (it->src == coupled) {
+            if (not m_parent->existInternalInputPort(
+                    m_portnames[it->srcPort])) {
+                throw utils::DevsGraphError(fmt(
+                        _("Coupled model %1% have no input port %2%"))
+                    % m_parent->getName() % m_portnames[it->srcPort]);
+            }
+        } else {
+            checkModel(it->src);
+
+            if (not std::binary_search(outputs.begin(), outputs.end(),
+                                       ModelPort(it->src,
+                                                 rank[it->srcPort]))) {
+                throw utils::DevsGraphError(fmt(
+                        _("Model %1% have no output port %2%"))
+                    % m_names[it->src] % m_portnames[it->srcPort]);
+            }
+        }
+
+        if (it->dst == coupled) {
+            if (not m_parent->existInternalOutputPort(
+                    m_portnames[it->dstPort])) {
+                throw utils::DevsGraphError(fmt(
+                        _("Coupled model %1% have no output port %2%"))
+                    % m_parent->getName() % m_portnames[it->dstPort]);
+            }
+        } else {
+            checkModel(it->dst);
+
+            if (not std::binary_search(inputs.begin(), inputs.end(),
+                                       ModelPort(it->dst,
+                                                 rank[it->dstPort]))) {
+                throw utils::DevsGraphError(fmt(
+                        _("Model %1% have no input port %2%"))
+                    % m_names[it->dst] % m_portnames[it->dstPort]);
+            }
+        }
+    }
+}
+
+void ModelBuilder::checkModel(uint32_t model) const
+{
+    if (model >= m_names.size()) {
+        throw utils::DevsGraphError(fmt(
+                _("Unknown model index %1% in the builder of %2%")) % model
+            % m_parent->getName());
+    }
+}
+
+void ModelBuilder::checkPort(uint32_t port) const
+{
+    if (port >= m_portnames.size()) {
+        throw utils::DevsGraphError(fmt(
+                _("Unknown port identifier %1% in the builder of %2%")) % port
+            % m_parent->getName());
+    }
+}
+
+}} // namespace vle vpz
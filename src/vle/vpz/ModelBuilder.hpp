@@ -0,0 +1,274 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2013 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2013 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2013 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_VPZ_MODELBUILDER_HPP
+#define VLE_VPZ_MODELBUILDER_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/vpz/BaseModel.hpp>
+#include <vle/utils/Types.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vle { namespace vpz {
+
+    class CoupledModel;
+
+    /**
+     * @brief ModelBuilder adds a large number of atomic models, ports and
+     * connections into a coupled model. The models, ports and connections
+     * are stored into arrays and identified by integers: nothing is checked
+     * nor built until commit(), which validates the whole graph once then
+     * fills the coupled model with sorted insertions.
+     *
+     * The result is the same as a sequence of CoupledModel::addAtomicModel,
+     * BaseModel::addInputPort, BaseModel::addOutputPort and
+     * CoupledModel::addInternalConnection calls without the name lookups of
+     * each call.
+     *
+     * @code
+     * vpz::ModelBuilder builder(top);
+     * builder.reserve(names.size(), 4 * names.size());
+     *
+     * uint32_t first = builder.addAtomicModels(names, "cell");
+     * uint32_t in = builder.port("in"), out = builder.port("out");
+     * builder.addInputPorts(first, names.size(), in);
+     * builder.addOutputPorts(first, names.size(), out);
+     *
+     * for (...) {
+     *     builder.addConnection(first + i, out, first + j, in);
+     * }
+     *
+     * builder.commit();
+     * @endcode
+     */
+    class VLE_API ModelBuilder
+    {
+    public:
+        /**
+         * @brief A connection from an output port of the model src to an
+         * input port of the model dst. The models are indexes returned by
+         * addAtomicModel or ModelBuilder::coupled, the ports are identifiers
+         * returned by port().
+         */
+        struct Connection
+        {
+            Connection(uint32_t src, uint32_t srcPort, uint32_t dst,
+                       uint32_t dstPort)
+                : src(src), srcPort(srcPort), dst(dst), dstPort(dstPort)
+            {}
+
+            uint32_t src;
+            uint32_t srcPort;
+            uint32_t dst;
+            uint32_t dstPort;
+        };
+
+        typedef std::vector < Connection > ConnectionVector;
+        typedef std::vector < std::string > StringVector;
+
+        /**
+         * @brief The index of the coupled model itself in a Connection: an
+         * input connection if it is the source, an output connection if it
+         * is the destination. The port must exist in the coupled model.
+         */
+        static const uint32_t coupled;
+
+        /**
+         * @brief Build an empty builder for a coupled model.
+         * @param parent The coupled model to fill.
+         * @throw utils::DevsGraphError if parent is null.
+         */
+        ModelBuilder(CoupledModel* parent);
+
+        /**
+         * @brief Reserve the memory of the arrays.
+         * @param models The number of atomic models to add.
+         * @param connections The number of connections to add.
+         */
+        void reserve(std::size_t models, std::size_t connections);
+
+        /**
+         * @brief Get the identifier of a port name, used for the input and
+         * output ports of all the models.
+         * @param name The name of the port.
+         * @return The identifier of the port.
+         */
+        uint32_t port(const std::string& name);
+
+        /**
+         * @brief Add an atomic model.
+         * @param name The name of the model.
+         * @param dynamics The name of the dynamics.
+         * @param conditions The names of the conditions.
+         * @param observables The name of the observables.
+         * @return The index of the model.
+         */
+        uint32_t addAtomicModel(
+            const std::string& name,
+            const std::string& dynamics = std::string(),
+            const StringVector& conditions = StringVector(),
+            const std::string& observables = std::string());
+
+        /**
+         * @brief Add a list of atomic models which share the same dynamics,
+         * conditions and observables.
+         * @param names The names of the models.
+         * @param dynamics The name of the dynamics.
+         * @param conditions The names of the conditions.
+         * @param observables The name of the observables.
+         * @return The index of the first model, the others follow.
+         */
+        uint32_t addAtomicModels(
+            const StringVector& names,
+            const std::string& dynamics = std::string(),
+            const StringVector& conditions = StringVector(),
+            const std::string& observables = std::string());
+
+        /**
+         * @brief Add an input port to a model.
+         * @param model The index of the model.
+         * @param port The identifier of the port.
+         */
+        void addInputPort(uint32_t model, uint32_t port)
+        { m_inputs.push_back(std::make_pair(model, port)); }
+
+        /**
+         * @brief Add an output port to a model.
+         * @param model The index of the model.
+         * @param port The identifier of the port.
+         */
+        void addOutputPort(uint32_t model, uint32_t port)
+        { m_outputs.push_back(std::make_pair(model, port)); }
+
+        /**
+         * @brief Add an input port to the models [first, first + count).
+         * @param first The index of the first model.
+         * @param count The number of models.
+         * @param port The identifier of the port.
+         */
+        void addInputPorts(uint32_t first, uint32_t count, uint32_t port);
+
+        /**
+         * @brief Add an output port to the models [first, first + count).
+         * @param first The index of the first model.
+         * @param count The number of models.
+         * @param port The identifier of the port.
+         */
+        void addOutputPorts(uint32_t first, uint32_t count, uint32_t port);
+
+        /**
+         * @brief Add a connection.
+         * @param src The index of the source model or ModelBuilder::coupled.
+         * @param srcPort The identifier of the output port of the source.
+         * @param dst The index of the destination model or
+         * ModelBuilder::coupled.
+         * @param dstPort The identifier of the input port of the
+         * destination.
+         */
+        void addConnection(uint32_t src, uint32_t srcPort, uint32_t dst,
+                           uint32_t dstPort)
+        { m_connections.push_back(Connection(src, srcPort, dst, dstPort)); }
+
+        /**
+         * @brief Add a list of connections.
+         * @param connections The connections to add.
+         */
+        void addConnections(const ConnectionVector& connections);
+
+        /**
+         * @brief Check the models, ports and connections then add them into
+         * the coupled model. If an error is found, the coupled model is not
+         * modified. The builder is empty after a successful commit.
+         * @param models If not null, filled with the atomic models built,
+         * in the order of their indexes.
+         * @throw utils::DevsGraphError if a name of model is duplicated or
+         * already used in the coupled model, if an index of model or an
+         * identifier of port is unknown or if a connection uses a port not
+         * added to the model.
+         */
+        void commit(AtomicModelVector* models = 0);
+
+        /**
+         * @brief Delete all the models, ports and connections not yet
+         * committed.
+         */
+        void clear();
+
+        /**
+         * @brief Get the number of models not yet committed.
+         * @return The number of models.
+         */
+        uint32_t size() const
+        { return m_names.size(); }
+
+    private:
+        /**
+         * The dynamics, conditions and observables shared by a list of
+         * models.
+         */
+        struct Prototype
+        {
+            Prototype(const std::string& dynamics,
+                      const StringVector& conditions,
+                      const std::string& observables)
+                : dynamics(dynamics), conditions(conditions),
+                observables(observables)
+            {}
+
+            std::string  dynamics;
+            StringVector conditions;
+            std::string  observables;
+        };
+
+        typedef std::pair < uint32_t, uint32_t > ModelPort;
+        typedef std::vector < ModelPort > ModelPortVector;
+
+        void check(const std::vector < uint32_t >& order,
+                   const std::vector < uint32_t >& rank,
+                   const ModelPortVector& inputs,
+                   const ModelPortVector& outputs) const;
+
+        void checkModel(uint32_t model) const;
+
+        void checkPort(uint32_t port) const;
+
+        CoupledModel*                       m_parent;
+        StringVector                        m_names;
+        std::vector < uint32_t >            m_prototypes;
+        std::vector < Prototype >           m_prototypelist;
+        StringVector                        m_portnames;
+        std::map < std::string, uint32_t >  m_portids;
+        ModelPortVector                     m_inputs;
+        ModelPortVector                     m_outputs;
+        ConnectionVector                    m_connections;
+    };
+
+}} // namespace vle vpz
+
+#endif
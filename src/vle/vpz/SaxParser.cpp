@@ -48,21 +48,27 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <libxml/SAX2.h>
 #include <libxml/parser.h>
+#include <libxml/parserInternals.h>
 #include <cerrno>
+#include <cctype>
 #include <cstring>
+#include <locale>
+#include <sstream>
+#include <algorithm>
+#include <limits>
 
 namespace vle { namespace vpz {
 
 SaxParser::SaxParser(Vpz& vpz)
-    : m_stop(false), m_vpzstack(vpz), m_vpz(vpz), m_isValue(false),
-    m_isVPZ(false)
+    : m_stop(false), m_vpzstack(vpz), m_numbers(0), m_numbersX(0),
+    m_numbersY(0), m_ctxt(0), m_lazyconditions(false), m_lazybegin(0),
+    m_skip(0), m_validate(false), m_vpz(vpz), m_isValue(false), m_isVPZ(false)
 {
     fillTagList();
 }
 
 void SaxParser::parseFile(const std::string& filename)
 {
-    setlocale(LC_ALL, "C");
     memset(&m_sax, 0, sizeof(xmlSAXHandler));
     m_sax.initialized = XML_SAX2_MAGIC;
     m_sax.startDocument = &SaxParser::onStartDocument;
@@ -75,7 +81,49 @@ void SaxParser::parseFile(const std::string& filename)
     m_sax.error = &SaxParser::onError;
     m_sax.fatalError = &SaxParser::onFatalError;
 
-    if (xmlSAXUserParseFile(&m_sax, this, filename.c_str())) {
+    m_lazybuffer.reset();
+    if (m_lazyconditions and not m_validate) {
+        try {
+            m_lazybuffer.reset(new ConditionBuffer(filename));
+
+            const unsigned char* data = (const unsigned char*)
+                m_lazybuffer->data();
+            if (m_lazybuffer->size() >= 2 and data[0] == 0x1f and
+                data[1] == 0x8b) {
+                m_lazybuffer.reset();
+            }
+        } catch (const std::exception& /*e*/) {
+            m_lazybuffer.reset();
+        }
+    }
+
+    /*
+     * Same as the xmlSAXUserParseFile function but the context is stored to
+     * get the position of the parser in the file.
+     */
+    int ret = -1;
+    if (m_validate) {
+        ret = parseValidFile(filename);
+    } else if ((m_ctxt = xmlCreateFileParserCtxt(filename.c_str()))) {
+        xmlSAXHandlerPtr sax = m_ctxt->sax;
+        m_ctxt->sax = &m_sax;
+        m_ctxt->userData = this;
+
+        xmlParseDocument(m_ctxt);
+
+        if (m_ctxt->wellFormed) {
+            ret = 0;
+        } else {
+            ret = m_ctxt->errNo != 0 ? m_ctxt->errNo : -1;
+        }
+
+        m_ctxt->sax = sax;
+        xmlFreeParserCtxt(m_ctxt);
+        m_ctxt = 0;
+    }
+    m_lazybuffer.reset();
+
+    if (ret) {
         if (m_error.empty()) {
             throw utils::SaxParserError(fmt(
                     _("Error parsing file '%1%'")) % filename);
@@ -91,12 +139,10 @@ void SaxParser::parseFile(const std::string& filename)
     }
 
     xmlMemoryDump();
-    setlocale(LC_ALL, "");
 }
 
 void SaxParser::parseMemory(const std::string& buffer)
 {
-    setlocale(LC_ALL, "C");
     memset(&m_sax, 0, sizeof(xmlSAXHandler));
     m_sax.initialized = XML_SAX2_MAGIC;
     m_sax.startDocument = &SaxParser::onStartDocument;
@@ -123,7 +169,92 @@ void SaxParser::parseMemory(const std::string& buffer)
                 _("Error when parsing memory: %1%")) % m_error);
     }
     xmlMemoryDump();
-    setlocale(LC_ALL, "");
+}
+
+int SaxParser::parseValidFile(const std::string& filename)
+{
+    /*
+     * The xmlTextReader validates the document against the DTD while it is
+     * read and frees the nodes already read, the memory stays bounded. Each
+     * node is forwarded to the SAX callbacks.
+     */
+    xmlTextReaderPtr reader = xmlReaderForFile(filename.c_str(), NULL,
+                                               XML_PARSE_DTDVALID);
+    if (not reader) {
+        return -1;
+    }
+
+    xmlTextReaderSetErrorHandler(reader, &SaxParser::onReaderError, this);
+
+    std::vector < std::string > values;
+    std::vector < const xmlChar* > atts;
+
+    onStartDocument(this);
+
+    int ret = 0;
+    while (not isStopped() and (ret = xmlTextReaderRead(reader)) == 1) {
+        switch (xmlTextReaderNodeType(reader)) {
+        case XML_READER_TYPE_ELEMENT:
+            {
+                const xmlChar* name = xmlTextReaderConstName(reader);
+                bool empty = xmlTextReaderIsEmptyElement(reader);
+
+                values.clear();
+                while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+                    const xmlChar* value = xmlTextReaderConstValue(reader);
+                    values.push_back(xmlCharToString(
+                            xmlTextReaderConstName(reader)));
+                    values.push_back(value ? xmlCharToString(value) : "");
+                }
+                xmlTextReaderMoveToElement(reader);
+
+                atts.clear();
+                for (std::vector < std::string >::const_iterator it =
+                     values.begin(); it != values.end(); ++it) {
+                    atts.push_back((const xmlChar*)it->c_str());
+                }
+                atts.push_back(0);
+
+                onStartElement(this, name, &atts[0]);
+                if (empty) {
+                    onEndElement(this, name);
+                }
+            }
+            break;
+        case XML_READER_TYPE_END_ELEMENT:
+            onEndElement(this, xmlTextReaderConstName(reader));
+            break;
+        case XML_READER_TYPE_TEXT:
+        case XML_READER_TYPE_WHITESPACE:
+        case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+            {
+                const xmlChar* value = xmlTextReaderConstValue(reader);
+                onCharacters(this, value, xmlStrlen(value));
+            }
+            break;
+        case XML_READER_TYPE_CDATA:
+            {
+                const xmlChar* value = xmlTextReaderConstValue(reader);
+                onCDataBlock(this, value, xmlStrlen(value));
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (not isStopped()) {
+        if (ret != 0) {
+            ret = -1;
+        } else if (xmlTextReaderIsValid(reader) != 1) {
+            stopParser(_("the document is not valid"));
+        } else {
+            onEndDocument(this);
+        }
+    }
+
+    xmlFreeTextReader(reader);
+    return ret;
 }
 
 void SaxParser::stopParser(const std::string& error)
@@ -137,6 +268,8 @@ void SaxParser::clearParserState()
     m_vpzstack.clear();
     m_valuestack.clear();
     m_lastCharacters.clear();
+    m_numbers = 0;
+    m_skip = 0;
     m_isValue = false;
     m_isVPZ = false;
     m_stop = false;
@@ -166,6 +299,11 @@ void SaxParser::onStartElement(void* ctx, const xmlChar* name,
     SaxParser* sax = static_cast < SaxParser* >(ctx);
 
     if (not sax->isStopped()) {
+        if (sax->m_skip) {
+            ++sax->m_skip;
+            return;
+        }
+
         sax->clearLastCharactersStored();
         StartFuncList::iterator it = sax->m_starts.find(name);
         if (it != sax->m_starts.end()) {
@@ -186,6 +324,11 @@ void SaxParser::onEndElement(void* ctx, const xmlChar* name)
     SaxParser* sax = static_cast < SaxParser* >(ctx);
 
     if (not sax->isStopped()) {
+        if (sax->m_skip > 1) {
+            --sax->m_skip;
+            return;
+        }
+
         EndFuncList::iterator it = sax->m_ends.find(name);
         if (it != sax->m_ends.end()) {
             try {
@@ -204,11 +347,97 @@ void SaxParser::onCharacters(void* ctx, const xmlChar* ch, int len)
 {
     SaxParser* sax = static_cast < SaxParser* >(ctx);
 
-    if (not sax->isStopped()) {
-        std::string buf((const char*)ch, len);
+    if (not sax->isStopped() and not sax->m_skip) {
+        if (sax->m_numbers) {
+            try {
+                sax->addToNumbers((const char*)ch, (const char*)ch + len);
+            } catch (const std::exception& e) {
+                sax->stopParser(e.what());
+            }
+        } else {
+            sax->addToCharacters((const char*)ch, len);
+        }
+    }
+}
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' or c == '\n' or c == '\t' or c == '\r';
+}
+
+void SaxParser::addToNumbers(const char* begin, const char* end)
+{
+    if (not m_lastCharacters.empty()) {
+        const char* it = std::find_if(begin, end, isSpace);
+        m_lastCharacters.append(begin, it);
 
-        sax->addToCharacters(buf);
+        if (it == end) {
+            return;
+        }
+
+        addToNumbers(xmlCharToDouble(m_lastCharacters.data(),
+                                     m_lastCharacters.data() +
+                                     m_lastCharacters.size()));
+        m_lastCharacters.clear();
+        begin = it;
+    }
+
+    for (;;) {
+        while (begin != end and isSpace(*begin)) {
+            ++begin;
+        }
+
+        if (begin == end) {
+            return;
+        }
+
+        const char* it = begin;
+        while (it != end and not isSpace(*it)) {
+            ++it;
+        }
+
+        if (it == end) {
+            m_lastCharacters.assign(begin, end);
+            return;
+        }
+
+        addToNumbers(xmlCharToDouble(begin, it));
+        begin = it;
+    }
+}
+
+void SaxParser::addToNumbers(double value)
+{
+    if (m_numbers->isTuple()) {
+        m_numbers->toTuple().value().push_back(value);
+    } else {
+        value::Table& table(m_numbers->toTable());
+
+        if (m_numbersX >= table.width() or m_numbersY >= table.height()) {
+            throw utils::SaxParserError(
+                _("VPZ parser: bad height or width for number of real in "
+                  "table"));
+        }
+
+        table.get(m_numbersX, m_numbersY) = value;
+
+        if (++m_numbersX >= table.width()) {
+            m_numbersX = 0;
+            ++m_numbersY;
+        }
+    }
+}
+
+void SaxParser::flushNumbers()
+{
+    if (not m_lastCharacters.empty()) {
+        addToNumbers(xmlCharToDouble(m_lastCharacters.data(),
+                                     m_lastCharacters.data() +
+                                     m_lastCharacters.size()));
+        m_lastCharacters.clear();
     }
+
+    m_numbers = 0;
 }
 
 
@@ -216,7 +445,7 @@ void SaxParser::onCDataBlock(void* ctx, const xmlChar* value, int len)
 {
     SaxParser* sax = static_cast < SaxParser* >(ctx);
 
-    if (not sax->isStopped()) {
+    if (not sax->isStopped() and not sax->m_skip) {
         std::string buf((const char*)value, len);
 
         sax->m_cdata.assign(buf);
@@ -241,8 +470,6 @@ void SaxParser::onWarning(void* /* ctx */, const char *msg, ...)
 
 void SaxParser::onError(void* ctx, const char *msg, ...)
 {
-    setlocale(LC_ALL, "");
-
     SaxParser* sax = static_cast < SaxParser* >(ctx);
     char* buffer = new char[1024];
     memset(buffer, 0, 1024);
@@ -258,8 +485,6 @@ void SaxParser::onError(void* ctx, const char *msg, ...)
 
 void SaxParser::onFatalError(void* ctx, const char *msg, ...)
 {
-    setlocale(LC_ALL, "");
-
     SaxParser* sax = static_cast < SaxParser* >(ctx);
     char* buffer = new char[1024];
     memset(buffer, 0, 1024);
@@ -274,6 +499,22 @@ void SaxParser::onFatalError(void* ctx, const char *msg, ...)
     delete [] buffer;
 }
 
+void SaxParser::onReaderError(void* arg, const char* msg,
+                              xmlParserSeverities severity,
+                              xmlTextReaderLocatorPtr locator)
+{
+    SaxParser* sax = static_cast < SaxParser* >(arg);
+
+    if (severity == XML_PARSER_SEVERITY_WARNING or
+        severity == XML_PARSER_SEVERITY_VALIDITY_WARNING) {
+        TraceAlways(fmt(_("XML warning: %1%")) % msg);
+    } else if (not sax->isStopped()) {
+        sax->stopParser((fmt(_("line %1%: %2%")) %
+                         xmlTextReaderLocatorLineNumber(locator) %
+                         msg).str());
+    }
+}
+
 //
 //
 //
@@ -376,6 +617,7 @@ void SaxParser::onKey(const xmlChar** att)
 void SaxParser::onTuple(const xmlChar**)
 {
     m_valuestack.pushTuple();
+    m_numbers = m_valuestack.topValue();
 }
 
 void SaxParser::onTable(const xmlChar** att)
@@ -398,6 +640,9 @@ void SaxParser::onTable(const xmlChar** att)
 
     try {
         m_valuestack.pushTable(xmlCharToInt(width), xmlCharToInt(height));
+        m_numbers = m_valuestack.topValue();
+        m_numbersX = 0;
+        m_numbersY = 0;
     } catch (const std::exception& e) {
         throw utils::SaxParserError(fmt(
             _("Table value tag can not convert attributes 'width' or "
@@ -448,6 +693,18 @@ void SaxParser::onOut(const xmlChar**)
 void SaxParser::onPort(const xmlChar** att)
 {
     m_vpzstack.pushPort(att);
+
+    if (m_lazybuffer and m_ctxt and m_vpzstack.top()->isCondition() and
+        not (m_ctxt->input->buf and m_ctxt->input->buf->encoder)) {
+        for (int i = 0; att[i] != 0; i += 2) {
+            if (xmlStrcmp(att[i], (const xmlChar*)"name") == 0) {
+                m_lazyport = xmlCharToString(att[i + 1]);
+            }
+        }
+
+        m_lazybegin = position();
+        m_skip = 1;
+    }
 }
 
 void SaxParser::onSubModels(const xmlChar**)
@@ -555,18 +812,34 @@ void SaxParser::onEndBoolean()
 
 void SaxParser::onEndInteger()
 {
+    const char* begin = m_lastCharacters.data();
+    const char* end = begin + m_lastCharacters.size();
+
+    while (begin != end and isSpace(*begin)) {
+        ++begin;
+    }
+    while (begin != end and isSpace(*(end - 1))) {
+        --end;
+    }
+
     m_valuestack.pushOnVectorValue(
-        value::Integer::create(
-            xmlCharToInt(
-                ((xmlChar*)lastCharactersStored().c_str()))));
+        value::Integer::create(xmlCharToInt(begin, end)));
 }
 
 void SaxParser::onEndDouble()
 {
+    const char* begin = m_lastCharacters.data();
+    const char* end = begin + m_lastCharacters.size();
+
+    while (begin != end and isSpace(*begin)) {
+        ++begin;
+    }
+    while (begin != end and isSpace(*(end - 1))) {
+        --end;
+    }
+
     m_valuestack.pushOnVectorValue(
-        value::Double::create(
-            xmlCharToDouble(
-                ((xmlChar*)lastCharactersStored().c_str()))));
+        value::Double::create(xmlCharToDouble(begin, end)));
 }
 
 void SaxParser::onEndString()
@@ -596,71 +869,20 @@ void SaxParser::onEndMap()
 
 void SaxParser::onEndTuple()
 {
-    value::Tuple& tuple(m_valuestack.topValue()->toTuple());
-
-    std::string cpy(lastCharactersStored());
-    boost::algorithm::trim(cpy);
-
-    std::vector < std::string > result;
-    boost::algorithm::split(result, cpy,
-                            boost::algorithm::is_any_of(" \n\t\r"));
-
-    for (std::vector < std::string >::iterator it = result.begin();
-         it != result.end(); ++it) {
-        boost::algorithm::trim(*it);
-        if (not (*it).empty()) {
-            tuple.add(xmlCharToDouble((const xmlChar*)((*it).c_str())));
-        }
-    }
-
+    flushNumbers();
     m_valuestack.popValue();
 }
 
 void SaxParser::onEndTable()
 {
-    value::Table& table(m_valuestack.topValue()->toTable());
+    flushNumbers();
 
-    std::string cpy(lastCharactersStored());
-    boost::algorithm::trim(cpy);
-
-    std::vector < std::string > result;
-    boost::algorithm::split(result, cpy,
-                            boost::algorithm::is_any_of(" \n\t\r"));
-
-    size_t size;
-    try {
-        size = boost::numeric_cast < size_t >(table.width() * table.height());
-    } catch (const std::exception /*e*/) {
-        throw utils::SaxParserError(
-            fmt(_("VPZ parser: bad height (%1%) or width (%2%) table ")) %
-            table.width() % table.height());
-    }
-
-    if (result.size() != size) {
+    value::Table& table(m_valuestack.topValue()->toTable());
+    if (m_numbersX != 0 or m_numbersY != table.height()) {
         throw utils::SaxParserError(
             _("VPZ parser: bad height or width for number of real in table"));
     }
 
-    value::Table::index i = 0;
-    value::Table::index j = 0;
-    for (std::vector < std::string >::iterator it = result.begin(); it !=
-         result.end(); ++it) {
-        boost::algorithm::trim(*it);
-        if (not (*it).empty()) {
-            table.get(i, j) = xmlCharToDouble((const xmlChar*)((*it).c_str()));
-            if (i + 1 >= table.width()) {
-                i = 0;
-                if (j + 1 >= table.height()) {
-                    break;
-                } else {
-                    j++;
-                }
-            } else {
-                i++;
-            }
-        }
-    }
-
     m_valuestack.popValue();
 }
 
@@ -677,7 +899,12 @@ void SaxParser::onEndNull()
 
 void SaxParser::onEndPort()
 {
-    if (m_vpzstack.top()->isCondition()) {
+    if (m_vpzstack.top()->isCondition() and m_skip) {
+        Condition* cnd(static_cast < Condition* >(m_vpzstack.top()));
+        cnd->addLazyPort(m_lazyport, LazyPort(m_lazybuffer, m_lazybegin,
+                                              position()));
+        m_skip = 0;
+    } else if (m_vpzstack.top()->isCondition()) {
         value::Set& vals(m_vpzstack.popConditionPort());
         std::vector < value::Value* >& lst(getValues());
         for (std::vector < value::Value* >::iterator it =
@@ -840,6 +1067,12 @@ value::Value* SaxParser::getValue(const size_t pos) const
     return m_valuestack.getResult(pos);
 }
 
+std::size_t SaxParser::position() const
+{
+    return m_ctxt->input->consumed + (m_ctxt->input->cur -
+                                      m_ctxt->input->base);
+}
+
 bool xmlCharToBoolean(const xmlChar* str)
 {
     if ((xmlStrncmp(str, (const xmlChar*)"true", 4) == 0) or
@@ -896,21 +1129,50 @@ unsigned long int xmlCharToUnsignedInt(const xmlChar* str)
     return r;
 }
 
+/*
+ * Compare the beginning of str with a lower case word, ignoring the case.
+ */
+static bool startsWithNoCase(const char* str, const char* word)
+{
+    for (; *word; ++str, ++word) {
+        if (std::tolower(static_cast < unsigned char >(*str)) != *word) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 double xmlCharToDouble(const xmlChar* str)
 {
-    char* res = 0;
+    /*
+     * The strtod function depends on the LC_NUMERIC category of the global
+     * locale of the process. The stream uses the classic locale instead,
+     * the infinity and the not-a-number written by the std::ostream are
+     * converted by hand.
+     */
+    const char* it = (const char*)str;
 
-    errno = 0;
-    double r = strtod((const char*)str, &res);
-    int err = errno;
+    while (std::isspace(static_cast < unsigned char >(*it))) {
+        ++it;
+    }
 
-    if ((err == ERANGE and r == HUGE_VAL) or (err != 0 and r == 0)) {
-        throw utils::SaxParserError(fmt(
-                _("error to convert '%1%' to double: %2%")) % str %
-            strerror(err));
+    const char* word = (*it == '-' or *it == '+') ? it + 1 : it;
+
+    if (startsWithNoCase(word, "inf")) {
+        return *it == '-' ? -std::numeric_limits < double >::infinity()
+            : std::numeric_limits < double >::infinity();
     }
 
-    if (res == (const char*)str) {
+    if (startsWithNoCase(word, "nan")) {
+        return std::numeric_limits < double >::quiet_NaN();
+    }
+
+    std::istringstream in(it);
+    in.imbue(std::locale::classic());
+
+    double r;
+    if (not (in >> r)) {
         throw utils::SaxParserError(fmt(
                 _("error to convert '%1%' to double")) % str);
     }
@@ -918,4 +1180,172 @@ double xmlCharToDouble(const xmlChar* str)
     return r;
 }
 
+/*
+ * Powers of ten exactly representable by a double.
+ */
+static const double exactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/*
+ * Try to convert the characters [begin, end) with at most 19 significant
+ * digits and without rounding error: the mantissa is lower than 2^53 and
+ * the power of ten is exact, the result of the multiplication or the
+ * division is correctly rounded. Return false otherwise.
+ */
+static bool fastCharToDouble(const char* begin, const char* end,
+                             double& result)
+{
+    const char* it = begin;
+    bool negative = false;
+
+    if (it != end and (*it == '-' or *it == '+')) {
+        negative = *it == '-';
+        ++it;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool empty = true;
+
+    for (; it != end and *it >= '0' and *it <= '9'; ++it) {
+        empty = false;
+        if (digits == 19) {
+            return false;
+        }
+        mantissa = mantissa * 10 + (*it - '0');
+        if (mantissa) {
+            ++digits;
+        }
+    }
+
+    if (it != end and *it == '.') {
+        for (++it; it != end and *it >= '0' and *it <= '9'; ++it) {
+            empty = false;
+            if (digits == 19) {
+                if (*it != '0') {
+                    return false;
+                }
+                continue;
+            }
+            mantissa = mantissa * 10 + (*it - '0');
+            --exponent;
+            if (mantissa) {
+                ++digits;
+            }
+        }
+    }
+
+    if (empty) {
+        return false;
+    }
+
+    if (it != end and (*it == 'e' or *it == 'E')) {
+        ++it;
+        bool negexp = false;
+        if (it != end and (*it == '-' or *it == '+')) {
+            negexp = *it == '-';
+            ++it;
+        }
+
+        if (it == end) {
+            return false;
+        }
+
+        int exp = 0;
+        for (; it != end and *it >= '0' and *it <= '9'; ++it) {
+            if (exp > 1000) {
+                return false;
+            }
+            exp = exp * 10 + (*it - '0');
+        }
+        exponent += negexp ? -exp : exp;
+    }
+
+    if (it != end or mantissa > (static_cast < uint64_t >(1) << 53)) {
+        return false;
+    }
+
+    if (mantissa == 0) {
+        result = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    if (exponent < -22 or exponent > 22) {
+        return false;
+    }
+
+    result = static_cast < double >(mantissa);
+    if (exponent < 0) {
+        result /= exactPowersOfTen[-exponent];
+    } else {
+        result *= exactPowersOfTen[exponent];
+    }
+
+    if (negative) {
+        result = -result;
+    }
+
+    return true;
+}
+
+double xmlCharToDouble(const char* begin, const char* end)
+{
+    double result;
+
+    if (fastCharToDouble(begin, end, result)) {
+        return result;
+    }
+
+    /*
+     * Use the locale independent conversion with a null terminated copy
+     * of the characters.
+     */
+    char buffer[64];
+    std::size_t size = end - begin;
+
+    if (size < sizeof(buffer)) {
+        std::memcpy(buffer, begin, size);
+        buffer[size] = '\0';
+        return xmlCharToDouble((const xmlChar*)buffer);
+    }
+
+    return xmlCharToDouble((const xmlChar*)std::string(begin, end).c_str());
+}
+
+long int xmlCharToInt(const char* begin, const char* end)
+{
+    const char* it = begin;
+    bool negative = false;
+
+    if (it != end and (*it == '-' or *it == '+')) {
+        negative = *it == '-';
+        ++it;
+    }
+
+    if (it != end and end - it < std::numeric_limits < long int >::digits10) {
+        long int result = 0;
+
+        for (; it != end and *it >= '0' and *it <= '9'; ++it) {
+            result = result * 10 + (*it - '0');
+        }
+
+        if (it == end) {
+            return negative ? -result : result;
+        }
+    }
+
+    char buffer[64];
+    std::size_t size = end - begin;
+
+    if (size < sizeof(buffer)) {
+        std::memcpy(buffer, begin, size);
+        buffer[size] = '\0';
+        return xmlCharToInt((const xmlChar*)buffer);
+    }
+
+    return xmlCharToInt((const xmlChar*)std::string(begin, end).c_str());
+}
+
 }} // namespace vle vpz
@@ -29,11 +29,14 @@
 #define VLE_VPZ_SAXPARSER_HPP
 
 #include <libxml/SAX2.h>
+#include <libxml/xmlreader.h>
 #include <vle/vpz/Base.hpp>
 #include <vle/vpz/SaxStackValue.hpp>
 #include <vle/vpz/SaxStackVpz.hpp>
 #include <vle/DllDefines.hpp>
 #include <vle/value/Value.hpp>
+#include <vle/value/Table.hpp>
+#include <vle/vpz/Condition.hpp>
 #include <map>
 
 namespace vle { namespace vpz {
@@ -79,6 +82,29 @@ namespace vle { namespace vpz {
          */
         void clearParserState();
 
+        /**
+         * @brief Enable or disable the lazy reading of the conditions in
+         * parseFile. If enabled, the values of the ports of the conditions
+         * are not parsed, only their positions in the file are stored and
+         * the values are parsed when the port is accessed the first time (see
+         * Condition::addLazyPort). The file must not be modified until all
+         * ports are accessed. Compressed files are always fully read.
+         * @param lazy true to enable.
+         */
+        inline void setLazyConditions(bool lazy)
+        { m_lazyconditions = lazy; }
+
+        /**
+         * @brief Enable or disable the validation of the file against the
+         * DTD in parseFile. If enabled, the file is read with the libxml2
+         * xmlTextReader which validates the document while it is read, the
+         * VLE classes are built in the same pass. The lazy reading of the
+         * conditions is not available in this mode.
+         * @param validate true to enable.
+         */
+        inline void setValidation(bool validate)
+        { m_validate = validate; }
+
         /**
          * @brief Return true if the SaxParser have read a value.
          * @return true if the parser have read a value, false otherwise.
@@ -146,6 +172,19 @@ namespace vle { namespace vpz {
 
         static void onFatalError(void *user_data, const char *msg, ...);
 
+        static void onReaderError(void* arg, const char* msg,
+                                  xmlParserSeverities severity,
+                                  xmlTextReaderLocatorPtr locator);
+
+        /**
+         * @brief Read and validate the file with a xmlTextReader and call
+         * the SAX callbacks for each node.
+         * @param filename The name of the file to parse.
+         * @return 0 on success, -1 if the file is not readable or not well
+         * formed.
+         */
+        int parseValidFile(const std::string& filename);
+
         /**
          * @brief Get the last characters from internal buffer.
          * @return A characters buffer.
@@ -166,6 +205,41 @@ namespace vle { namespace vpz {
         void addToCharacters(const std::string& characters)
         { m_lastCharacters.append(characters); }
 
+        /**
+         * @brief Append characters to the last characters readed.
+         * @param characters The first character to append.
+         * @param len The number of characters to append.
+         */
+        void addToCharacters(const char* characters, std::size_t len)
+        { m_lastCharacters.append(characters, len); }
+
+        /**
+         * @brief Convert the reals of a characters buffer and store them into
+         * the value::Tuple or value::Table currently read. The last real of
+         * the buffer may be incomplete, it is stored into the last
+         * characters buffer and it is completed by the next call.
+         * @param begin The first character of the buffer.
+         * @param end The end of the buffer.
+         * @throw utils::SaxParserError if a real can not be converted or if
+         * the value::Table is full.
+         */
+        void addToNumbers(const char* begin, const char* end);
+
+        /**
+         * @brief Store a real into the value::Tuple or value::Table currently
+         * read.
+         * @param value The real to store.
+         * @throw utils::SaxParserError if the value::Table is full.
+         */
+        void addToNumbers(double value);
+
+        /**
+         * @brief Convert the incomplete real stored into the last characters
+         * buffer and stop the conversion of the characters of the
+         * value::Tuple or value::Table.
+         */
+        void flushNumbers();
+
         /**
          * @brief Stop the parsing of the XML file.
          * @param error The message to store into the error's buffer string.
@@ -185,6 +259,24 @@ namespace vle { namespace vpz {
         ValueStackSax m_valuestack;
         std::string   m_lastCharacters;
         std::string   m_cdata;
+
+        value::Value* m_numbers;      /* value::Tuple or value::Table read. */
+        value::Table::index m_numbersX; /* column of the next real in table. */
+        value::Table::index m_numbersY; /* row of the next real in table. */
+
+        xmlParserCtxtPtr   m_ctxt;       /* libxml2 context of parseFile. */
+        bool               m_lazyconditions;
+        ConditionBufferPtr m_lazybuffer; /* file mapped for lazy ports. */
+        std::string        m_lazyport;   /* name of the lazy port read. */
+        std::size_t        m_lazybegin;  /* position of the lazy port. */
+        int                m_skip;       /* depth of the skipped tags. */
+        bool               m_validate;   /* validate parseFile with the DTD. */
+
+        /**
+         * @brief Get the position of the libxml2 parser in the file.
+         * @return The number of bytes read.
+         */
+        std::size_t position() const;
         Vpz&          m_vpz;
 
         bool          m_isValue;
@@ -377,7 +469,8 @@ namespace vle { namespace vpz {
     VLE_API unsigned long int xmlCharToUnsignedInt(const xmlChar* str);
 
     /**
-     * @brief Convert the xmlChar pointer to a double.
+     * @brief Convert the xmlChar pointer to a double. The conversion uses
+     * the classic locale and does not depend on the locale of the process.
      * @param str The constant xmlChar pointer to translate.
      * @throw utils::SaxParserError if the xmlChar can not be translated into a
      * double
@@ -385,6 +478,32 @@ namespace vle { namespace vpz {
      */
     VLE_API double xmlCharToDouble(const xmlChar* str);
 
+    /**
+     * @brief Convert the characters [begin, end) to a double. Contrary to
+     * the strtod function, this conversion does not depend on the locale and
+     * does not need a null terminated string. Reals with at most 19
+     * significant digits and a decimal exponent in [-22, 22] are converted
+     * exactly without memory allocation, others use the locale independent
+     * conversion of xmlCharToDouble(const xmlChar*).
+     * @param begin The first character to convert.
+     * @param end The end of the characters to convert.
+     * @throw utils::SaxParserError if the characters can not be translated
+     * into a double.
+     * @return The double.
+     */
+    VLE_API double xmlCharToDouble(const char* begin, const char* end);
+
+    /**
+     * @brief Convert the characters [begin, end) to a long integer without
+     * memory allocation.
+     * @param begin The first character to convert.
+     * @param end The end of the characters to convert.
+     * @throw utils::SaxParserError if the characters can not be translated
+     * into a long integer.
+     * @return The long integer.
+     */
+    VLE_API long int xmlCharToInt(const char* begin, const char* end);
+
 }} // namespace vle vpz
 
 #endif
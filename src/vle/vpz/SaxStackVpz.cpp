@@ -520,6 +520,9 @@ void SaxStackVpz::pushExperiment(const xmlChar** att)
     const xmlChar* duration = 0;
     const xmlChar* begin = 0;
     const xmlChar* combination = 0;
+    const xmlChar* samples = 0;
+    const xmlChar* seed = 0;
+    const xmlChar* replicas = 0;
 
     for (int i = 0; att[i] != 0; i += 2) {
         if (xmlStrcmp(att[i], (const xmlChar*)"name") == 0) {
@@ -530,6 +533,12 @@ void SaxStackVpz::pushExperiment(const xmlChar** att)
             begin = att[i + 1];
         } else if (xmlStrcmp(att[i], (const xmlChar*)"combination") == 0) {
             combination = att[i + 1];
+        } else if (xmlStrcmp(att[i], (const xmlChar*)"samples") == 0) {
+            samples = att[i + 1];
+        } else if (xmlStrcmp(att[i], (const xmlChar*)"seed") == 0) {
+            seed = att[i + 1];
+        } else if (xmlStrcmp(att[i], (const xmlChar*)"replicas") == 0) {
+            replicas = att[i + 1];
         }
     }
 
@@ -550,6 +559,18 @@ void SaxStackVpz::pushExperiment(const xmlChar** att)
     if (combination) {
         exp.setCombination(xmlCharToString(combination));
     }
+
+    if (samples) {
+        exp.setSamples(xmlCharToUnsignedInt(samples));
+    }
+
+    if (seed) {
+        exp.setSeed(xmlCharToUnsignedInt(seed));
+    }
+
+    if (replicas) {
+        exp.setReplicas(xmlCharToUnsignedInt(replicas));
+    }
 }
 
 void SaxStackVpz::pushConditions()
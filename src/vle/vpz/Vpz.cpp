@@ -26,6 +26,7 @@
 
 
 #include <vle/vpz/Vpz.hpp>
+#include <vle/vpz/Compiled.hpp>
 #include <fstream>
 #include <iomanip>
 #include <limits>
@@ -35,6 +36,9 @@
 
 namespace vle { namespace vpz {
 
+bool Vpz::m_lazyconditions = false;
+bool Vpz::m_validation = false;
+
 Vpz::Vpz(const std::string& filename) :
     m_filename(filename)
 {
@@ -62,14 +66,42 @@ void Vpz::write(std::ostream& out) const
     m_project.write(out);
 }
 
+/*
+ * Check the magic number of the gzip format at the beginning of the file.
+ */
+static bool isGzipFile(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    char magic[2] = { 0, 0 };
+
+    file.read(magic, 2);
+
+    return file and static_cast < unsigned char >(magic[0]) == 0x1f and
+        static_cast < unsigned char >(magic[1]) == 0x8b;
+}
+
 void Vpz::parseFile(const std::string& filename)
 {
     m_filename.assign(filename);
+    m_isGzip = isGzipFile(filename);
+
+    if (not m_lazyconditions and not m_validation and
+        Compiled::isEnabled() and Compiled::load(filename, *this)) {
+        return;
+    }
+
     vpz::SaxParser saxparser(*this);
+    saxparser.setLazyConditions(m_lazyconditions);
+    saxparser.setValidation(m_validation);
 
     try {
         saxparser.parseFile(filename);
     } catch(const std::exception& sax) {
+        if (m_validation) {
+            saxparser.clearParserState();
+            throw utils::SaxParserError(sax.what());
+        }
+
         try {
             validateFile(filename);
         } catch(const std::exception& dom) {
@@ -79,6 +111,10 @@ void Vpz::parseFile(const std::string& filename)
         }
         throw utils::SaxParserError(sax.what());
     }
+
+    if (not m_lazyconditions and Compiled::isEnabled()) {
+        Compiled::save(filename, *this);
+    }
 }
 
 void Vpz::parseMemory(const std::string& buffer)
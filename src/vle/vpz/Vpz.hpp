@@ -85,7 +85,10 @@ namespace vle { namespace vpz {
         { return VLE_VPZ_VPZ; }
 
         /**
-         * @brief Open a VPZ file project.
+         * @brief Open a VPZ file project. If the compiled files are enabled
+         * (see vpz::Compiled) and the compiled file of the file is up to
+         * date, it is used instead of the XML parser, otherwise the compiled
+         * file is built after the parsing.
          * @param filename file to read.
          * @throw utils::ArgError if an error occured during loading.
          */
@@ -173,6 +176,41 @@ namespace vle { namespace vpz {
          */
         static void validateMemory(const std::string& buffer);
 
+        /**
+         * @brief Enable or disable the lazy reading of the conditions in
+         * parseFile: the values of the ports of the conditions are parsed
+         * only when they are accessed. The compiled files (see vpz::Compiled)
+         * are not used in this mode. Disabled by default.
+         * @param lazy true to enable.
+         */
+        static void setLazyConditions(bool lazy)
+        { m_lazyconditions = lazy; }
+
+        /**
+         * @brief Check if the conditions are read lazily.
+         * @return true if enabled.
+         */
+        static bool isLazyConditions()
+        { return m_lazyconditions; }
+
+        /**
+         * @brief Enable or disable the validation of the file against the DTD
+         * in parseFile. The validation and the building of the Vpz are done
+         * in a single pass over the file (see SaxParser::setValidation) and
+         * the compiled files are not read in this mode. Disabled by default,
+         * the file is then validated only if the parsing fails.
+         * @param validation true to enable.
+         */
+        static void setValidation(bool validation)
+        { m_validation = validation; }
+
+        /**
+         * @brief Check if the files are validated during the parsing.
+         * @return true if enabled.
+         */
+        static bool isValidation()
+        { return m_validation; }
+
         /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
          *
          * Get/Set functions
@@ -218,6 +256,9 @@ namespace vle { namespace vpz {
         bool                m_isGzip;
         std::string         m_filename;
         vpz::Project        m_project;
+
+        static bool         m_lazyconditions;
+        static bool         m_validation;
     };
 
 }} // namespace vle vpz
@@ -50,6 +50,7 @@
 #include <vle/vle.hpp>
 #include <limits>
 #include <fstream>
+#include <clocale>
 
 struct F
 {
@@ -334,6 +335,81 @@ BOOST_AUTO_TEST_CASE(value_table)
 }
 
 
+BOOST_AUTO_TEST_CASE(value_numbers_fast_path)
+{
+    const char* t1 = "<?xml version=\"1.0\"?>\n"
+        "<table width=\"2\" height=\"2\">\n"
+        "  0.100000000000000\t-2.5e-3\n\n"
+        "  1.7976931348623157e308 12345678901234567890.5  \n"
+        "</table>\n";
+
+    value::Table* v = value::toTableValue(vpz::Vpz::parseValue(t1));
+    BOOST_REQUIRE_EQUAL(v->get(0, 0), 0.1);
+    BOOST_REQUIRE_EQUAL(v->get(1, 0), -2.5e-3);
+    BOOST_REQUIRE_EQUAL(v->get(0, 1), 1.7976931348623157e308);
+    BOOST_REQUIRE_EQUAL(v->get(1, 1), 12345678901234567890.5);
+    delete v;
+
+    const char* t2 = "<?xml version=\"1.0\"?>\n"
+        "<table width=\"2\" height=\"2\">1 2 3</table>\n";
+    BOOST_REQUIRE_THROW(vpz::Vpz::parseValue(t2), std::exception);
+
+    const char* t3 = "<?xml version=\"1.0\"?>\n"
+        "<table width=\"2\" height=\"1\">1 2 3</table>\n";
+    BOOST_REQUIRE_THROW(vpz::Vpz::parseValue(t3), std::exception);
+
+    const char* t4 = "<?xml version=\"1.0\"?>\n"
+        "<set><double> 1.25 </double><integer>\n-42\n</integer></set>\n";
+    value::Set* s = value::toSetValue(vpz::Vpz::parseValue(t4));
+    BOOST_REQUIRE_EQUAL(value::toDouble(s->get(0)), 1.25);
+    BOOST_REQUIRE_EQUAL(value::toInteger(s->get(1)), -42);
+    delete s;
+
+    std::string str("3.14159265358979 1e-400 -0.5");
+    const char* b = str.c_str();
+    BOOST_REQUIRE_EQUAL(vpz::xmlCharToDouble(b, b + 16), 3.14159265358979);
+    BOOST_REQUIRE_EQUAL(vpz::xmlCharToDouble(b + 24, b + 28), -0.5);
+    BOOST_REQUIRE_EQUAL(vpz::xmlCharToInt(b, b + 1), 3l);
+    BOOST_REQUIRE_THROW(vpz::xmlCharToDouble(b, b), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(value_numbers_locale)
+{
+    const char* t1 = "<?xml version=\"1.0\"?>\n"
+        "<table width=\"0\" height=\"1\">1</table>\n";
+    BOOST_REQUIRE_THROW(vpz::Vpz::parseValue(t1), std::exception);
+
+    /*
+     * The slow path of the conversion (more than 19 digits or a large
+     * exponent) does not depend on the LC_NUMERIC of the process.
+     */
+    const char* locales[] = { "fr_FR.UTF-8", "de_DE.UTF-8", "fr_FR", 0 };
+    std::string previous(setlocale(LC_NUMERIC, 0));
+    for (const char** it = locales; *it; ++it) {
+        if (setlocale(LC_NUMERIC, *it)) {
+            break;
+        }
+    }
+
+    std::string str("1.25000000000000000000001 1e300 -inf");
+    const char* b = str.c_str();
+    BOOST_REQUIRE_EQUAL(vpz::xmlCharToDouble(b, b + 25), 1.25);
+    BOOST_REQUIRE_EQUAL(vpz::xmlCharToDouble(b + 26, b + 31), 1e300);
+    BOOST_REQUIRE_EQUAL(vpz::xmlCharToDouble(b + 32, b + 36),
+                        -std::numeric_limits < double >::infinity());
+    BOOST_REQUIRE_EQUAL(vpz::xmlCharToDouble((const xmlChar*)"0.5e-300"),
+                        0.5e-300);
+
+    const char* t2 = "<?xml version=\"1.0\"?>\n"
+        "<tuple>1.5 0.00000000000000000000000000000025</tuple>\n";
+    value::Tuple* tuple = value::toTupleValue(vpz::Vpz::parseValue(t2));
+    BOOST_REQUIRE_EQUAL(tuple->operator[](0), 1.5);
+    BOOST_REQUIRE_EQUAL(tuple->operator[](1), 2.5e-31);
+    delete tuple;
+
+    setlocale(LC_NUMERIC, previous.c_str());
+}
+
 BOOST_AUTO_TEST_CASE(value_table_map)
 {
     const char* t1 = "<?xml version=\"1.0\"?>\n"
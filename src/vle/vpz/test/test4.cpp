@@ -34,16 +34,24 @@
 #include <boost/test/output_test_stream.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
 #include <iostream>
+#include <fstream>
+#include <set>
+#include <list>
+#include <vector>
 #include <vle/value/Value.hpp>
 #include <vle/value/Map.hpp>
 #include <vle/value/Integer.hpp>
 #include <vle/value/Double.hpp>
 #include <vle/vpz/Vpz.hpp>
+#include <vle/vpz/Compiled.hpp>
 #include <vle/vpz/AtomicModel.hpp>
 #include <vle/vpz/CoupledModel.hpp>
 #include <vle/utils/Path.hpp>
 #include <vle/vle.hpp>
+#include <vle/version.hpp>
 
 struct F
 {
@@ -870,3 +878,239 @@ BOOST_AUTO_TEST_CASE(test_equal_views)
     delete vpz.project().model().model();
 }
 
+
+/*
+ * The connections are written in the order of the addresses of the models,
+ * the files are compared line by line without order.
+ */
+static std::multiset < std::string > sorted_lines(const std::string& buffer)
+{
+    std::vector < std::string > lines;
+    boost::algorithm::split(lines, buffer, boost::algorithm::is_any_of("\n"));
+
+    return std::multiset < std::string >(lines.begin(), lines.end());
+}
+
+BOOST_AUTO_TEST_CASE(test_compiled)
+{
+    vpz::Vpz vpz;
+    vpz.parseFile(utils::Path::path().getTemplate("unittest.vpz"));
+
+    std::string buffer;
+    vpz::Compiled::write(buffer, vpz.project());
+    BOOST_REQUIRE(not buffer.empty());
+
+    vpz::Vpz vpz2;
+    vpz::Compiled::read(buffer.data(), buffer.size(), vpz2.project());
+    check_unittest_vpz(vpz2);
+    BOOST_REQUIRE(sorted_lines(vpz.writeToString()) ==
+                  sorted_lines(vpz2.writeToString()));
+
+    BOOST_REQUIRE_THROW(vpz::Compiled::read(buffer.data(),
+                                            buffer.size() / 2,
+                                            vpz::Vpz().project()),
+                        utils::ArgError);
+
+    delete vpz.project().model().model();
+    delete vpz2.project().model().model();
+}
+
+BOOST_AUTO_TEST_CASE(test_compiled_file)
+{
+    namespace fs = boost::filesystem;
+
+    fs::path filename(fs::temp_directory_path() /
+                      fs::unique_path("vle-%%%%-%%%%.vpz"));
+    fs::copy_file(utils::Path::path().getTemplate("unittest.vpz"), filename);
+    std::string compiled(vpz::Compiled::filename(filename.string()));
+
+    /* Disabled by default: no file is written. */
+    BOOST_REQUIRE(not vpz::Compiled::isEnabled());
+    {
+        vpz::Vpz vpz(filename.string());
+        delete vpz.project().model().model();
+    }
+    BOOST_REQUIRE(not fs::exists(compiled));
+
+    vpz::Compiled::setEnabled(true);
+
+    vpz::Vpz parsed(filename.string());
+    BOOST_REQUIRE(fs::exists(compiled));
+
+    vpz::Vpz loaded;
+    BOOST_REQUIRE(vpz::Compiled::load(filename.string(), loaded));
+    check_unittest_vpz(loaded);
+    BOOST_REQUIRE(sorted_lines(parsed.writeToString()) ==
+                  sorted_lines(loaded.writeToString()));
+
+    vpz::Vpz cached(filename.string());
+    BOOST_REQUIRE_EQUAL(cached.isGzip(), parsed.isGzip());
+    BOOST_REQUIRE(sorted_lines(cached.writeToString()) ==
+                  sorted_lines(parsed.writeToString()));
+
+    /* A change of the source invalidates the compiled file. */
+    {
+        std::ofstream out(filename.string().c_str(), std::ios::app);
+        out << "\n";
+    }
+    vpz::Vpz stale;
+    BOOST_REQUIRE(not vpz::Compiled::load(filename.string(), stale));
+    BOOST_REQUIRE(vpz::Compiled::save(filename.string(), parsed));
+    BOOST_REQUIRE(vpz::Compiled::load(filename.string(), stale));
+
+    /* A truncated compiled file is ignored. */
+    fs::resize_file(compiled, fs::file_size(compiled) / 2);
+    vpz::Vpz truncated;
+    BOOST_REQUIRE(not vpz::Compiled::load(filename.string(), truncated));
+
+    vpz::Compiled::setEnabled(false);
+
+    delete parsed.project().model().model();
+    delete loaded.project().model().model();
+    delete cached.project().model().model();
+    delete stale.project().model().model();
+    fs::remove(compiled);
+    fs::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(test_lazy_conditions)
+{
+    vpz::Vpz vpz;
+    vpz.parseFile(utils::Path::path().getTemplate("unittest.vpz"));
+
+    vpz::Vpz::setLazyConditions(true);
+    vpz::Vpz lazy(utils::Path::path().getTemplate("unittest.vpz"));
+    vpz::Vpz::setLazyConditions(false);
+
+    vpz::Condition& ca(lazy.project().experiment().conditions().get("ca"));
+    BOOST_REQUIRE(ca.isLazyPort("x"));
+
+    vpz::Condition copy(ca);
+    BOOST_REQUIRE(copy.isLazyPort("x"));
+
+    const value::Set& x(ca.getSetValues("x"));
+    BOOST_REQUIRE(not ca.isLazyPort("x"));
+    BOOST_REQUIRE_EQUAL(x.size(), (value::Set::size_type)1);
+    BOOST_REQUIRE_CLOSE(x.getDouble(0), 1.2, 1e-10);
+
+    BOOST_REQUIRE(copy.isLazyPort("x"));
+    BOOST_REQUIRE_CLOSE(copy.getSetValues("x").getDouble(0), 1.2, 1e-10);
+
+    BOOST_REQUIRE(sorted_lines(vpz.writeToString()) ==
+                  sorted_lines(lazy.writeToString()));
+
+    delete vpz.project().model().model();
+    delete lazy.project().model().model();
+}
+
+/*
+ * Read the lazy ports of a condition through the constant functions.
+ */
+struct lazy_reader
+{
+    const vpz::Condition& condition;
+    double& result;
+
+    lazy_reader(const vpz::Condition& condition, double& result)
+        : condition(condition), result(result)
+    {}
+
+    void operator()()
+    {
+        std::list < std::string > ports;
+        condition.portnames(ports);
+
+        result = 0.0;
+        for (std::list < std::string >::const_iterator it = ports.begin();
+             it != ports.end(); ++it) {
+            result += condition.getSetValues(*it).getDouble(0);
+        }
+    }
+};
+
+BOOST_AUTO_TEST_CASE(test_lazy_conditions_threads)
+{
+    vpz::Vpz::setLazyConditions(true);
+    vpz::Vpz lazy(utils::Path::path().getTemplate("unittest.vpz"));
+    vpz::Vpz::setLazyConditions(false);
+
+    const vpz::Condition& ca(lazy.project().experiment().conditions().get(
+            "ca"));
+    BOOST_REQUIRE(ca.isLazyPort("x"));
+
+    std::vector < double > results(8, 0.0);
+    boost::thread_group gp;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        gp.create_thread(lazy_reader(ca, results[i]));
+    }
+    gp.join_all();
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        BOOST_REQUIRE_CLOSE(results[i], 1.2, 1e-10);
+    }
+
+    /* Conditions::load parses all the lazy ports, the copies have none. */
+    const vpz::Conditions& cnds(lazy.project().experiment().conditions());
+    BOOST_REQUIRE(cnds.get("cb").isLazyPort("x"));
+    cnds.load();
+    BOOST_REQUIRE(not cnds.get("cb").isLazyPort("x"));
+
+    vpz::Conditions copy(cnds);
+    BOOST_REQUIRE(not copy.get("cc").isLazyPort("x"));
+    BOOST_REQUIRE_CLOSE(copy.get("cc").getSetValues("x").getDouble(0), 1.4,
+                        1e-10);
+
+    delete lazy.project().model().model();
+}
+
+BOOST_AUTO_TEST_CASE(test_validation)
+{
+    vpz::Vpz vpz;
+    vpz.parseFile(utils::Path::path().getTemplate("unittest.vpz"));
+
+    /* Without DOCTYPE, the file is well formed but not valid. */
+    std::string buffer = vpz.writeToString();
+    std::string::size_type begin = buffer.find("<!DOCTYPE");
+    BOOST_REQUIRE(begin != std::string::npos);
+    buffer.erase(begin, buffer.find('\n', begin) - begin);
+    delete vpz.project().model().model();
+
+    boost::filesystem::path filename(
+        boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("vle-%%%%-%%%%.vpz"));
+    {
+        std::ofstream out(filename.string().c_str());
+        out << buffer;
+    }
+
+    vpz::Vpz::setValidation(true);
+    BOOST_REQUIRE_THROW(vpz::Vpz(filename.string()), utils::SaxParserError);
+    vpz::Vpz::setValidation(false);
+
+    vpz::Vpz valid(filename.string());
+    check_unittest_vpz(valid);
+    delete valid.project().model().model();
+
+    /* With a DOCTYPE to the installed DTD, the file is valid. */
+    boost::filesystem::path dtd(
+        boost::filesystem::path(
+            utils::Path::path().getTemplateDir()).parent_path() / "dtd" /
+        (fmt("vle-%1%.%2%.0.dtd") % VLE_MAJOR_VERSION %
+         VLE_MINOR_VERSION).str());
+    BOOST_REQUIRE(boost::filesystem::exists(dtd));
+
+    buffer.insert(begin, (fmt("<!DOCTYPE vle_project SYSTEM \"%1%\">") %
+                          dtd.string()).str());
+    {
+        std::ofstream out(filename.string().c_str());
+        out << buffer;
+    }
+
+    vpz::Vpz::setValidation(true);
+    vpz::Vpz checked(filename.string());
+    vpz::Vpz::setValidation(false);
+    check_unittest_vpz(checked);
+    delete checked.project().model().model();
+
+    boost::filesystem::remove(filename);
+}
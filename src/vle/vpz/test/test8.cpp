@@ -38,6 +38,13 @@
 #include <fstream>
 #include <vle/vpz/AtomicModel.hpp>
 #include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/FlatGraph.hpp>
+#include <vle/vpz/ModelBuilder.hpp>
+#include <vle/vpz/GridModel.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/value/Set.hpp>
+#include <vle/value/Table.hpp>
+#include <vle/value/Double.hpp>
 #include <vle/utils/Path.hpp>
 #include <vle/utils/Trace.hpp>
 #include <vle/value/Value.hpp>
@@ -783,3 +790,241 @@ BOOST_AUTO_TEST_CASE(test_name)
     BOOST_REQUIRE_EQUAL(a->getCompleteName(), "top,top2,g");
     BOOST_REQUIRE_EQUAL(b->getCompleteName(), "top,top1,x");
 }
+
+BOOST_AUTO_TEST_CASE(test_flat_graph)
+{
+    CoupledModel* top = new CoupledModel("top", 0);
+    CoupledModel* sub = top->addCoupledModel("sub");
+    AtomicModel* a = top->addAtomicModel("a");
+    AtomicModel* b = sub->addAtomicModel("b");
+    AtomicModel* c = sub->addAtomicModel("c");
+
+    a->addInputPort("in");
+    a->addOutputPort("out");
+    b->addInputPort("in");
+    b->addOutputPort("out");
+    c->addInputPort("in");
+    sub->addInputPort("in");
+    sub->addOutputPort("out");
+
+    top->addInternalConnection("a", "out", "sub", "in");
+    top->addInternalConnection("sub", "out", "a", "in");
+    sub->addInputConnection("in", "b", "in");
+    sub->addInputConnection("in", "c", "in");
+    sub->addOutputConnection("b", "out", "out");
+
+    FlatGraph graph(top);
+    BOOST_REQUIRE_EQUAL(graph.size(), 3u);
+    BOOST_REQUIRE_EQUAL(graph.edges(), 3u);
+
+    ModelPortList result;
+    a->getAtomicModelsTarget("out", result);
+    FlatGraph::EdgeRange r = graph.targets(a, "out");
+    BOOST_REQUIRE_EQUAL(result.size(),
+                        static_cast < std::size_t >(r.second - r.first));
+    for (const FlatGraph::Edge* it = r.first; it != r.second; ++it) {
+        BOOST_REQUIRE(result.exist(graph.model(it->model),
+                                   graph.portName(it->port)));
+    }
+
+    r = graph.targets(b, "out");
+    BOOST_REQUIRE_EQUAL(r.second - r.first, 1);
+    BOOST_REQUIRE_EQUAL(graph.model(r.first->model), a);
+    BOOST_REQUIRE_EQUAL(graph.portName(r.first->port), "in");
+
+    r = graph.targets(c, "out");
+    BOOST_REQUIRE(r.first == r.second);
+
+    AtomicModel* d = sub->addAtomicModel("d");
+    d->addInputPort("in");
+    sub->addInputConnection("in", "d", "in");
+    graph.update(sub);
+    BOOST_REQUIRE_EQUAL(graph.size(), 4u);
+    BOOST_REQUIRE_EQUAL(graph.edges(), 4u);
+    r = graph.targets(a, "out");
+    BOOST_REQUIRE_EQUAL(r.second - r.first, 3);
+
+    uint32_t id = graph.id(c);
+    graph.remove(c);
+    sub->delAllConnection(c);
+    sub->delModel(c);
+    graph.update(sub);
+    BOOST_REQUIRE(graph.model(id) == 0);
+    BOOST_REQUIRE_EQUAL(graph.id(c), FlatGraph::npos);
+    r = graph.targets(a, "out");
+    BOOST_REQUIRE_EQUAL(r.second - r.first, 2);
+
+    graph.compact();
+    BOOST_REQUIRE_EQUAL(graph.edges(), 3u);
+    r = graph.targets(a, "out");
+    BOOST_REQUIRE_EQUAL(r.second - r.first, 2);
+    r = graph.targets(b, "out");
+    BOOST_REQUIRE_EQUAL(r.second - r.first, 1);
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_model_builder)
+{
+    CoupledModel* top = new CoupledModel("top", 0);
+    top->addInputPort("in");
+    top->addOutputPort("out");
+    top->addAtomicModel("x");
+
+    ModelBuilder builder(top);
+    builder.reserve(10, 20);
+
+    std::vector < std::string > names;
+    for (int i = 0; i < 10; ++i) {
+        names.push_back(boost::lexical_cast < std::string >(i));
+    }
+
+    std::vector < std::string > conditions(1, "cond");
+    uint32_t first = builder.addAtomicModels(names, "dyn", conditions, "obs");
+    uint32_t in = builder.port("in"), out = builder.port("out");
+    BOOST_REQUIRE_EQUAL(builder.port("in"), in);
+
+    builder.addInputPorts(first, 10, in);
+    builder.addOutputPorts(first, 10, out);
+    for (uint32_t i = 0; i < 9; ++i) {
+        builder.addConnection(first + i, out, first + i + 1, in);
+    }
+    builder.addConnection(ModelBuilder::coupled, in, first, in);
+    builder.addConnection(first + 9, out, ModelBuilder::coupled, out);
+
+    AtomicModelVector models;
+    BOOST_REQUIRE_NO_THROW(builder.commit(&models));
+    BOOST_REQUIRE_EQUAL(builder.size(), 0u);
+    BOOST_REQUIRE_EQUAL(models.size(), 10u);
+    BOOST_REQUIRE_EQUAL(top->getModelList().size(), 11u);
+
+    AtomicModel* a = dynamic_cast < AtomicModel* >(top->findModel("3"));
+    BOOST_REQUIRE_EQUAL(a, models[3]);
+    BOOST_REQUIRE_EQUAL(a->getParent(), top);
+    BOOST_REQUIRE_EQUAL(a->dynamics(), "dyn");
+    BOOST_REQUIRE_EQUAL(a->observables(), "obs");
+    BOOST_REQUIRE_EQUAL(a->conditions().size(), 1u);
+    BOOST_REQUIRE(top->existInternalConnection("3", "out", "4", "in"));
+    BOOST_REQUIRE(top->existInternalConnection("2", "out", "3", "in"));
+    BOOST_REQUIRE(top->existInputConnection("in", "0", "in"));
+    BOOST_REQUIRE(top->existOutputConnection("9", "out", "out"));
+
+    ModelPortList result;
+    models[8]->getAtomicModelsTarget("out", result);
+    BOOST_REQUIRE_EQUAL(result.size(), 1u);
+    BOOST_REQUIRE(result.exist(models[9], "in"));
+
+    builder.addAtomicModel("x");
+    BOOST_REQUIRE_THROW(builder.commit(), utils::DevsGraphError);
+    builder.clear();
+
+    uint32_t y = builder.addAtomicModel("y");
+    uint32_t z = builder.addAtomicModel("z");
+    builder.addOutputPort(y, out);
+    builder.addConnection(y, out, z, in);
+    BOOST_REQUIRE_THROW(builder.commit(), utils::DevsGraphError);
+    BOOST_REQUIRE(not top->exist("y"));
+    BOOST_REQUIRE(not top->exist("z"));
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_grid_model)
+{
+    CoupledModel* top = new CoupledModel("top", 0);
+    GridModel* grid = new GridModel("grid", top, 3, 3);
+
+    for (uint32_t y = 0; y < 3; ++y) {
+        for (uint32_t x = 0; x < 3; ++x) {
+            grid->addCell(x, y, (fmt("cell_%1%_%2%") % x % y).str());
+        }
+    }
+
+    BOOST_REQUIRE_THROW(grid->addCell(1, 1, "other"), utils::ArgError);
+    BOOST_REQUIRE_THROW(grid->addCell(3, 0, "other"), utils::ArgError);
+
+    AtomicModel* center = grid->getCell(1, 1);
+    uint32_t x, y;
+    BOOST_REQUIRE(grid->getCoordinates(center, x, y));
+    BOOST_REQUIRE_EQUAL(x, 1u);
+    BOOST_REQUIRE_EQUAL(y, 1u);
+
+    GridModel::TargetList targets;
+    grid->getTargets(center, "out", targets);
+    BOOST_REQUIRE_EQUAL(targets.size(), 4u);
+    targets.clear();
+    grid->getTargets(grid->getCell(0, 0), "out", targets);
+    BOOST_REQUIRE_EQUAL(targets.size(), 2u);
+    targets.clear();
+    grid->getTargets(center, "E", targets);
+    BOOST_REQUIRE(targets.empty());
+
+    FlatGraph graph(top);
+    BOOST_REQUIRE_EQUAL(graph.size(), 9u);
+    BOOST_REQUIRE_EQUAL(graph.edges(), 24u);
+    FlatGraph::EdgeRange r = graph.targets(center, "out");
+    BOOST_REQUIRE_EQUAL(r.second - r.first, 4);
+    for (const FlatGraph::Edge* it = r.first; it != r.second; ++it) {
+        AtomicModel* target = graph.model(it->model);
+        BOOST_REQUIRE(grid->getCoordinates(target, x, y));
+        if (x == 0) {
+            BOOST_REQUIRE_EQUAL(graph.portName(it->port), "S");
+        } else if (x == 2) {
+            BOOST_REQUIRE_EQUAL(graph.portName(it->port), "N");
+        } else if (y == 0) {
+            BOOST_REQUIRE_EQUAL(graph.portName(it->port), "E");
+        } else {
+            BOOST_REQUIRE_EQUAL(graph.portName(it->port), "W");
+        }
+    }
+
+    value::Table table(3, 3);
+    table.get(2, 1) = 4.5;
+    grid->setParameter("altitude", table);
+    BOOST_REQUIRE_THROW(grid->setParameter("bad", value::Table(2, 3)),
+                        utils::ArgError);
+
+    value::Map init;
+    grid->fillInitValues(grid->getCell(2, 1), init);
+    BOOST_REQUIRE_EQUAL(init.getInt("_x"), 3);
+    BOOST_REQUIRE_EQUAL(init.getInt("_y"), 2);
+    BOOST_REQUIRE_EQUAL(init.getSet("Neighbourhood").size(), 3u);
+    BOOST_REQUIRE_CLOSE(init.getDouble("altitude"), 4.5, 1e-10);
+    BOOST_REQUIRE_THROW(grid->fillInitValues(grid->getCell(2, 1), init),
+                        utils::ArgError);
+
+    GridModel* torus = new GridModel("torus", top, 4, 4, GridModel::MOORE,
+                                     true, true);
+    for (uint32_t y = 0; y < 4; ++y) {
+        for (uint32_t x = 0; x < 4; ++x) {
+            torus->addCell(x, y, (fmt("cell_%1%_%2%") % x % y).str());
+        }
+    }
+
+    targets.clear();
+    torus->getTargets(torus->getCell(0, 0), "NW", targets);
+    BOOST_REQUIRE_EQUAL(targets.size(), 1u);
+    BOOST_REQUIRE_EQUAL(targets[0].first, torus->getCell(3, 3));
+    BOOST_REQUIRE_EQUAL(*targets[0].second, "SE");
+
+    graph.build(top);
+    BOOST_REQUIRE_EQUAL(graph.edges(), 24u + 16u * 8u);
+
+    /* the deleted or detached cells leave the grid. */
+    grid->delModel(grid->getCell(1, 0));
+    BOOST_REQUIRE(not grid->getCell(1, 0));
+    targets.clear();
+    grid->getTargets(center, "out", targets);
+    BOOST_REQUIRE_EQUAL(targets.size(), 3u);
+
+    AtomicModel* corner = grid->getCell(2, 2);
+    grid->detachModel(corner);
+    BOOST_REQUIRE(not grid->getCell(2, 2));
+    BOOST_REQUIRE(not grid->getCoordinates(corner, x, y));
+    delete corner;
+
+    BOOST_REQUIRE_NO_THROW(grid->addCell(2, 2, "cell_2_2"));
+    BOOST_REQUIRE(grid->getCoordinates(grid->getCell(2, 2), x, y));
+
+    delete top;
+}